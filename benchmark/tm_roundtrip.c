@@ -0,0 +1,281 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ */
+
+/*
+ * load -> run -> save -> load -> run, at the default opt level, and compare
+ * every graph output of the two runs. the saved file carries the graph as the
+ * passes left it, so a lost fused attribute shows up as a mismatch here.
+ * the benchmark models carry all zero weights, they are refilled with a signed
+ * pattern first, or every activation would see zeros only.
+ */
+
+#include <unistd.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include "tengine_c_api.h"
+#include "tengine_ir.h"
+
+#define MAX_OUTPUT_NUM  16
+#define DIFF_TOLERANCE  1e-6f
+
+struct graph_result
+{
+    int num;
+    int size[MAX_OUTPUT_NUM];
+    float* data[MAX_OUTPUT_NUM];
+};
+
+static void release_result(struct graph_result* res)
+{
+    for (int i = 0; i < res->num; i++)
+        free(res->data[i]);
+
+    res->num = 0;
+}
+
+static void fill_weights(graph_t graph)
+{
+    struct ir_graph* ir_graph = ( struct ir_graph* )graph;
+
+    for (int i = 0; i < ir_graph->tensor_num; i++)
+    {
+        struct ir_tensor* tensor = ir_graph->tensor_list[i];
+        if (tensor->tensor_type != TENSOR_TYPE_CONST || tensor->data_type != TENGINE_DT_FP32 || tensor->data == NULL)
+            continue;
+
+        float* data = ( float* )tensor->data;
+        unsigned int seed = i * 2654435761u + 1;
+        for (int j = 0; j < tensor->elem_num; j++)
+        {
+            seed = seed * 1103515245 + 12345;
+            data[j] = (float)(( int )((seed >> 8) % 1000) - 500) / 20000.f;
+        }
+    }
+}
+
+/* run the graph once and copy all the outputs out, the graph is left prerun for saving */
+static int run_and_fetch(graph_t graph, float* input_data, int* dims, struct graph_result* res)
+{
+    int img_size = dims[1] * dims[2] * dims[3];
+
+    tensor_t input_tensor = get_graph_input_tensor(graph, 0, 0);
+    if (input_tensor == NULL)
+    {
+        fprintf(stderr, "Get input tensor failed\n");
+        return -1;
+    }
+
+    if (set_tensor_shape(input_tensor, dims, 4) < 0)
+    {
+        fprintf(stderr, "Set input tensor shape failed\n");
+        return -1;
+    }
+
+    if (prerun_graph(graph) < 0)
+    {
+        fprintf(stderr, "Prerun graph failed\n");
+        return -1;
+    }
+
+    if (set_tensor_buffer(input_tensor, input_data, img_size * sizeof(float)) < 0)
+    {
+        fprintf(stderr, "Set input tensor buffer failed\n");
+        return -1;
+    }
+
+    if (run_graph(graph, 1) < 0)
+    {
+        fprintf(stderr, "Run graph failed\n");
+        return -1;
+    }
+
+    res->num = 0;
+    int node_num = get_graph_output_node_number(graph);
+    for (int i = 0; i < node_num; i++)
+    {
+        node_t node = get_graph_output_node(graph, i);
+        int tensor_num = get_node_output_number(node);
+
+        for (int j = 0; j < tensor_num && res->num < MAX_OUTPUT_NUM; j++)
+        {
+            tensor_t tensor = get_graph_output_tensor(graph, i, j);
+            int size = get_tensor_buffer_size(tensor);
+            float* data = ( float* )malloc(size);
+
+            if (data == NULL)
+            {
+                fprintf(stderr, "malloc output buffer failed\n");
+                release_result(res);
+                return -1;
+            }
+            memcpy(data, get_tensor_buffer(tensor), size);
+
+            res->size[res->num] = size / sizeof(float);
+            res->data[res->num] = data;
+            res->num++;
+        }
+    }
+
+    return 0;
+}
+
+static int roundtrip_graph(const char* graph_name, const char* model_file, int img_h, int img_w, int c, int n)
+{
+    char tmp_file[] = "/tmp/tm_roundtrip_XXXXXX";
+    int fd = mkstemp(tmp_file);
+    if (fd < 0)
+    {
+        fprintf(stderr, "Create temp file failed\n");
+        return -1;
+    }
+    close(fd);
+
+    int img_size = img_h * img_w * c;
+    int dims[] = {n, c, img_h, img_w};    // nchw
+    float* input_data = ( float* )malloc(img_size * sizeof(float));
+    if (input_data == NULL)
+    {
+        fprintf(stderr, "malloc input data buffer failed\n");
+        unlink(tmp_file);
+        return -1;
+    }
+
+    /* a fixed pattern with both signs, so that the activations clip something */
+    for (int i = 0; i < img_size; i++)
+        input_data[i] = (float)((i * 7919) % 255) / 255.f - 0.5f;
+
+    struct graph_result before = {0};
+    struct graph_result after = {0};
+    int ret = -1;
+
+    graph_t graph = create_graph(NULL, "tengine", model_file);
+    if (graph == NULL)
+    {
+        fprintf(stderr, "Create graph failed, errno: %d\n", get_tengine_errno());
+        goto out;
+    }
+    fill_weights(graph);
+
+    if (run_and_fetch(graph, input_data, dims, &before) < 0)
+        goto out;
+
+    if (save_graph(graph, "tengine", tmp_file) < 0)
+    {
+        fprintf(stderr, "Save graph failed, errno: %d\n", get_tengine_errno());
+        goto out;
+    }
+
+    postrun_graph(graph);
+    destroy_graph(graph);
+
+    graph = create_graph(NULL, "tengine", tmp_file);
+    if (graph == NULL)
+    {
+        fprintf(stderr, "Reload saved graph failed, errno: %d\n", get_tengine_errno());
+        goto out;
+    }
+
+    if (run_and_fetch(graph, input_data, dims, &after) < 0)
+        goto out;
+
+    if (before.num != after.num)
+    {
+        fprintf(stderr, "%20s  output number %d -> %d\n", graph_name, before.num, after.num);
+        goto out;
+    }
+
+    float max_diff = 0.f;
+    for (int i = 0; i < before.num; i++)
+    {
+        if (before.size[i] != after.size[i])
+        {
+            fprintf(stderr, "%20s  output %d size %d -> %d\n", graph_name, i, before.size[i], after.size[i]);
+            goto out;
+        }
+
+        for (int j = 0; j < before.size[i]; j++)
+        {
+            float diff = fabsf(before.data[i][j] - after.data[i][j]) / fmaxf(1.f, fabsf(before.data[i][j]));
+            if (!(diff <= max_diff))
+                max_diff = diff;
+        }
+    }
+
+    fprintf(stderr, "%20s  outputs = %d   max diff = %g\n", graph_name, before.num, max_diff);
+    ret = max_diff <= DIFF_TOLERANCE ? 0 : -1;
+
+out:
+    if (graph != NULL)
+    {
+        postrun_graph(graph);
+        destroy_graph(graph);
+    }
+    release_result(&before);
+    release_result(&after);
+    free(input_data);
+    unlink(tmp_file);
+
+    if (ret < 0)
+        fprintf(stderr, "%20s  round trip FAILED\n", graph_name);
+
+    return ret;
+}
+
+int main(int argc, char* argv[])
+{
+    if (init_tengine() != 0)
+    {
+        fprintf(stderr, "Initial tengine failed.\n");
+        return -1;
+    }
+    fprintf(stderr, "tengine-lite library version: %s\n", get_tengine_version());
+
+    int failed = 0;
+    failed += roundtrip_graph("squeezenet_v1.1",  "./models/squeezenet_v1.1_benchmark.tmfile",    227, 227, 3, 1) < 0;
+    failed += roundtrip_graph("mobilenetv1",      "./models/mobilenet_benchmark.tmfile",          224, 224, 3, 1) < 0;
+    failed += roundtrip_graph("mobilenetv2",      "./models/mobilenet_v2_benchmark.tmfile",       224, 224, 3, 1) < 0;
+    failed += roundtrip_graph("mobilenetv3",      "./models/mobilenet_v3_benchmark.tmfile",       224, 224, 3, 1) < 0;
+    failed += roundtrip_graph("shufflenetv2",     "./models/shufflenet_v2_benchmark.tmfile",      224, 224, 3, 1) < 0;
+    failed += roundtrip_graph("resnet18",         "./models/resnet18_benchmark.tmfile",           224, 224, 3, 1) < 0;
+    failed += roundtrip_graph("resnet50",         "./models/resnet50_benchmark.tmfile",           224, 224, 3, 1) < 0;
+    failed += roundtrip_graph("googlenet",        "./models/googlenet_benchmark.tmfile",          224, 224, 3, 1) < 0;
+    failed += roundtrip_graph("inceptionv3",      "./models/inception_v3_benchmark.tmfile",       299, 299, 3, 1) < 0;
+    failed += roundtrip_graph("vgg16",            "./models/vgg16_benchmark.tmfile",              224, 224, 3, 1) < 0;
+    failed += roundtrip_graph("mssd",             "./models/mssd_benchmark.tmfile",               300, 300, 3, 1) < 0;
+    failed += roundtrip_graph("retinaface",       "./models/retinaface_benchmark.tmfile",         320, 240, 3, 1) < 0;
+    failed += roundtrip_graph("yolov3_tiny",      "./models/yolov3_tiny_benchmark.tmfile",        416, 416, 3, 1) < 0;
+    failed += roundtrip_graph("mobilefacenets",   "./models/mobilefacenets_benchmark.tmfile",     112, 112, 3, 1) < 0;
+
+    release_tengine();
+
+    if (failed)
+    {
+        fprintf(stderr, "%d ROUND TRIP FAILED\n", failed);
+        return -1;
+    }
+    fprintf(stderr, "ALL ROUND TRIP DONE\n");
+
+    return 0;
+}
@@ -0,0 +1,579 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ */
+
+/*
+ * run one graph from many threads, and check every result against a serial run of the same input:
+ *   1. each thread runs a session of the graph, with run_graph(session, 0) and wait_graph()
+ *   2. each thread queues its requests to a batcher with run_batched_request()
+ *   3. the main thread posts all the requests with post_batched_request() and waits for the callbacks
+ */
+
+#include <unistd.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <pthread.h>
+
+#include "common.h"
+#include "tengine_c_api.h"
+#include "tengine_operations.h"
+
+#define DEFAULT_IMG_H 224
+#define DEFAULT_IMG_W 224
+#define DEFAULT_THREAD_COUNT 4
+#define DEFAULT_REQUEST_COUNT 4
+#define DEFAULT_MAX_BATCH 4
+#define DEFAULT_MAX_DELAY_US 2000
+#define MAX_OUTPUT_NUM 16
+#define DIFF_TOLERANCE 1e-4f
+
+struct request
+{
+    float* input;
+    float* reference[MAX_OUTPUT_NUM];
+    float* output[MAX_OUTPUT_NUM];
+};
+
+struct worker
+{
+    pthread_t tid;
+    graph_t session;
+    float* session_input;
+    batcher_t batcher;
+    struct request* requests;
+    int first;
+    int step;
+    int request_num;
+    int ret;
+};
+
+static int input_size;
+static int output_num;
+static int output_size[MAX_OUTPUT_NUM];
+
+static int posted_done;
+static int posted_failed;
+static pthread_mutex_t posted_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t posted_cond = PTHREAD_COND_INITIALIZER;
+
+/* the outputs of the graph, in the order of get_graph_output_tensor(), by node then tensor */
+static tensor_t get_output_tensor(graph_t graph, int idx)
+{
+    int node_num = get_graph_output_node_number(graph);
+    for (int i = 0; i < node_num; i++)
+    {
+        int tensor_num = get_node_output_number(get_graph_output_node(graph, i));
+        if (idx < tensor_num)
+            return get_graph_output_tensor(graph, i, idx);
+
+        idx -= tensor_num;
+    }
+
+    return NULL;
+}
+
+static void fetch_output(graph_t graph, float* output[])
+{
+    for (int i = 0; i < output_num; i++)
+        memcpy(output[i], get_tensor_buffer(get_output_tensor(graph, i)), output_size[i] * sizeof(float));
+}
+
+static void clear_output(struct request* requests, int request_num)
+{
+    for (int i = 0; i < request_num; i++)
+        for (int j = 0; j < output_num; j++)
+            memset(requests[i].output[j], 0, output_size[j] * sizeof(float));
+}
+
+/* the largest relative difference of all the requests from their serial run */
+static float check_output(struct request* requests, int request_num)
+{
+    float max_diff = 0.f;
+
+    for (int i = 0; i < request_num; i++)
+    {
+        for (int j = 0; j < output_num; j++)
+        {
+            float* ref = requests[i].reference[j];
+            float* out = requests[i].output[j];
+
+            for (int k = 0; k < output_size[j]; k++)
+            {
+                float diff = fabsf(ref[k] - out[k]) / fmaxf(1.f, fabsf(ref[k]));
+                if (!(diff <= max_diff))
+                    max_diff = diff;
+            }
+        }
+    }
+
+    return max_diff;
+}
+
+static void* session_worker(void* arg)
+{
+    struct worker* worker = ( struct worker* )arg;
+
+    worker->ret = 0;
+    for (int i = worker->first; i < worker->request_num; i += worker->step)
+    {
+        struct request* req = &worker->requests[i];
+        memcpy(worker->session_input, req->input, input_size * sizeof(float));
+
+        /* queue the run, the thread could prepare the next input here, and then wait for it */
+        if (run_graph(worker->session, 0) < 0 || wait_graph(worker->session, 0) < 0)
+        {
+            worker->ret = -1;
+            break;
+        }
+
+        fetch_output(worker->session, req->output);
+    }
+
+    return NULL;
+}
+
+static void* batcher_worker(void* arg)
+{
+    struct worker* worker = ( struct worker* )arg;
+
+    worker->ret = 0;
+    for (int i = worker->first; i < worker->request_num; i += worker->step)
+    {
+        struct request* req = &worker->requests[i];
+        void* input_data[1] = {req->input};
+
+        if (run_batched_request(worker->batcher, input_data, ( void** )req->output) < 0)
+        {
+            worker->ret = -1;
+            break;
+        }
+    }
+
+    return NULL;
+}
+
+static void posted_request_done(batcher_t batcher, int ret, void* arg)
+{
+    pthread_mutex_lock(&posted_lock);
+    posted_done++;
+    if (ret < 0)
+        posted_failed++;
+    pthread_cond_signal(&posted_cond);
+    pthread_mutex_unlock(&posted_lock);
+}
+
+static int run_sessions(graph_t graph, struct options* opt, struct worker* workers, int thread_num)
+{
+    int ret = 0;
+
+    for (int i = 0; i < thread_num; i++)
+    {
+        workers[i].session = create_graph_session(graph);
+        if (workers[i].session == NULL)
+        {
+            fprintf(stderr, "Create graph session failed, errno: %d\n", get_tengine_errno());
+            thread_num = i;
+            ret = -1;
+            goto out;
+        }
+
+        if (prerun_graph_multithread(workers[i].session, *opt) < 0)
+        {
+            fprintf(stderr, "Prerun graph session failed\n");
+            thread_num = i + 1;
+            ret = -1;
+            goto out;
+        }
+
+        /* each session has its own input, set like the one of the graph */
+        tensor_t input_tensor = get_graph_input_tensor(workers[i].session, 0, 0);
+        workers[i].session_input = ( float* )malloc(input_size * sizeof(float));
+        if (workers[i].session_input == NULL ||
+            set_tensor_buffer(input_tensor, workers[i].session_input, input_size * sizeof(float)) < 0)
+        {
+            fprintf(stderr, "Set session input buffer failed\n");
+            thread_num = i + 1;
+            ret = -1;
+            goto out;
+        }
+    }
+
+    for (int i = 0; i < thread_num; i++)
+        pthread_create(&workers[i].tid, NULL, session_worker, &workers[i]);
+
+    for (int i = 0; i < thread_num; i++)
+    {
+        pthread_join(workers[i].tid, NULL);
+        if (workers[i].ret < 0)
+            ret = -1;
+    }
+
+out:
+    for (int i = 0; i < thread_num; i++)
+    {
+        if (workers[i].session != NULL)
+        {
+            postrun_graph(workers[i].session);
+            destroy_graph(workers[i].session);
+            workers[i].session = NULL;
+        }
+
+        free(workers[i].session_input);
+        workers[i].session_input = NULL;
+    }
+
+    return ret;
+}
+
+static int run_batcher(batcher_t batcher, struct worker* workers, int thread_num)
+{
+    int ret = 0;
+
+    for (int i = 0; i < thread_num; i++)
+    {
+        workers[i].batcher = batcher;
+        pthread_create(&workers[i].tid, NULL, batcher_worker, &workers[i]);
+    }
+
+    for (int i = 0; i < thread_num; i++)
+    {
+        pthread_join(workers[i].tid, NULL);
+        if (workers[i].ret < 0)
+            ret = -1;
+    }
+
+    return ret;
+}
+
+static int post_batcher(batcher_t batcher, struct request* requests, int request_num)
+{
+    int posted = 0;
+
+    posted_done = 0;
+    posted_failed = 0;
+
+    for (int i = 0; i < request_num; i++)
+    {
+        void* input_data[1] = {requests[i].input};
+
+        if (post_batched_request(batcher, input_data, ( void** )requests[i].output, posted_request_done, NULL) < 0)
+        {
+            fprintf(stderr, "Post batched request failed\n");
+            break;
+        }
+        posted++;
+    }
+
+    /* the buffers are used till the callbacks */
+    pthread_mutex_lock(&posted_lock);
+    while (posted_done < posted)
+        pthread_cond_wait(&posted_cond, &posted_lock);
+    pthread_mutex_unlock(&posted_lock);
+
+    return (posted < request_num || posted_failed) ? -1 : 0;
+}
+
+/* the batched and the posted requests, returns how many of the two differ, or -1 if the batcher failed */
+static int check_batcher(graph_t graph, struct options* opt, struct worker* workers, int thread_num,
+                         struct request* requests, int request_num, int max_batch)
+{
+    batcher_t batcher = create_graph_batcher(graph, max_batch, DEFAULT_MAX_DELAY_US, opt);
+    if (batcher == NULL && get_tengine_errno() == ENOTSUP)
+    {
+        /* e.g. the detection outputs are sized by the run, and do not follow the batch */
+        fprintf(stderr, "batched requests: skipped, the outputs of the graph could not be batched\n");
+        return 0;
+    }
+
+    if (batcher == NULL)
+    {
+        fprintf(stderr, "Create graph batcher failed, errno: %d\n", get_tengine_errno());
+        return -1;
+    }
+
+    int failed = 0;
+    float max_diff;
+
+    clear_output(requests, request_num);
+    double start = get_current_time();
+    int batch_ret = run_batcher(batcher, workers, thread_num);
+    double end = get_current_time();
+    max_diff = check_output(requests, request_num);
+    fprintf(stderr, "batched requests: %s, max diff %g, %.2f ms\n", batch_ret < 0 ? "run failed" : "done", max_diff,
+            end - start);
+    failed += batch_ret < 0 || !(max_diff <= DIFF_TOLERANCE);
+
+    clear_output(requests, request_num);
+    start = get_current_time();
+    int post_ret = post_batcher(batcher, requests, request_num);
+    end = get_current_time();
+    max_diff = check_output(requests, request_num);
+    fprintf(stderr, "posted requests : %s, max diff %g, %.2f ms\n", post_ret < 0 ? "run failed" : "done", max_diff,
+            end - start);
+    failed += post_ret < 0 || !(max_diff <= DIFF_TOLERANCE);
+
+    struct batcher_stat stat;
+    if (get_graph_batcher_stat(batcher, &stat) == 0)
+        fprintf(stderr, "batcher stat    : %u requests in %u batches\n", stat.request_num, stat.batch_num);
+
+    destroy_graph_batcher(batcher);
+
+    return failed;
+}
+
+int tengine_concurrent(const char* model_file, int img_h, int img_w, int thread_num, int request_count, int max_batch)
+{
+    struct options opt;
+    opt.num_thread = 1;
+    opt.cluster = TENGINE_CLUSTER_ALL;
+    opt.precision = TENGINE_MODE_FP32;
+
+    int request_num = thread_num * request_count;
+    struct request* requests = ( struct request* )calloc(request_num, sizeof(struct request));
+    struct worker* workers = ( struct worker* )calloc(thread_num, sizeof(struct worker));
+    graph_t graph = NULL;
+    int ret = -1;
+
+    if (requests == NULL || workers == NULL)
+    {
+        fprintf(stderr, "malloc requests failed\n");
+        goto out;
+    }
+
+    /* create graph, load tengine model xxx.tmfile */
+    graph = create_graph(NULL, "tengine", model_file);
+    if (NULL == graph)
+    {
+        fprintf(stderr, "Create graph failed.\n");
+        fprintf(stderr, "errno: %d \n", get_tengine_errno());
+        goto out;
+    }
+
+    /* the graph holds one item, the sessions and the batches follow its shape */
+    input_size = img_h * img_w * 3;
+    int dims[] = {1, 3, img_h, img_w};    // nchw
+    float* input_data = ( float* )malloc(input_size * sizeof(float));
+    tensor_t input_tensor = get_graph_input_tensor(graph, 0, 0);
+
+    if (input_data == NULL || input_tensor == NULL || set_tensor_shape(input_tensor, dims, 4) < 0 ||
+        set_tensor_buffer(input_tensor, input_data, input_size * sizeof(float)) < 0)
+    {
+        fprintf(stderr, "Set input tensor failed\n");
+        free(input_data);
+        goto out;
+    }
+
+    if (prerun_graph_multithread(graph, opt) < 0)
+    {
+        fprintf(stderr, "Prerun multithread graph failed.\n");
+        goto out_input;
+    }
+
+    output_num = 0;
+    for (tensor_t tensor; output_num < MAX_OUTPUT_NUM && (tensor = get_output_tensor(graph, output_num)) != NULL;)
+    {
+        output_size[output_num] = get_tensor_buffer_size(tensor) / sizeof(float);
+        output_num++;
+    }
+
+    /* a different input for each request, so a result given to the wrong request shows up */
+    for (int i = 0; i < request_num; i++)
+    {
+        requests[i].input = ( float* )malloc(input_size * sizeof(float));
+        if (requests[i].input == NULL)
+            goto out_request;
+
+        for (int k = 0; k < input_size; k++)
+            requests[i].input[k] = (float)((k * 7919 + i * 131) % 255) / 255.f - 0.5f;
+
+        for (int j = 0; j < output_num; j++)
+        {
+            requests[i].reference[j] = ( float* )malloc(output_size[j] * sizeof(float));
+            requests[i].output[j] = ( float* )malloc(output_size[j] * sizeof(float));
+            if (requests[i].reference[j] == NULL || requests[i].output[j] == NULL)
+                goto out_request;
+        }
+    }
+
+    /* the serial run, the results to compare with */
+    for (int i = 0; i < request_num; i++)
+    {
+        memcpy(input_data, requests[i].input, input_size * sizeof(float));
+        if (run_graph(graph, 1) < 0)
+        {
+            fprintf(stderr, "Run graph failed\n");
+            goto out_request;
+        }
+        fetch_output(graph, requests[i].reference);
+    }
+
+    for (int i = 0; i < thread_num; i++)
+    {
+        workers[i].requests = requests;
+        workers[i].first = i;
+        workers[i].step = thread_num;
+        workers[i].request_num = request_num;
+    }
+
+    fprintf(stderr, "\nmodel file : %s\n", model_file);
+    fprintf(stderr, "img_h, img_w : %d %d, threads %d, requests %d, max batch %d\n", img_h, img_w, thread_num,
+            request_num, max_batch);
+    fprintf(stderr, "--------------------------------------\n");
+
+    int failed = 0;
+
+    clear_output(requests, request_num);
+    double start = get_current_time();
+    int session_ret = run_sessions(graph, &opt, workers, thread_num);
+    double end = get_current_time();
+    float max_diff = check_output(requests, request_num);
+    fprintf(stderr, "graph sessions  : %s, max diff %g, %.2f ms\n", session_ret < 0 ? "run failed" : "done", max_diff,
+            end - start);
+    failed += session_ret < 0 || !(max_diff <= DIFF_TOLERANCE);
+
+    int batch_failed = check_batcher(graph, &opt, workers, thread_num, requests, request_num, max_batch);
+    if (batch_failed < 0)
+        goto out_request;
+    failed += batch_failed;
+
+    fprintf(stderr, "--------------------------------------\n");
+
+    if (failed == 0)
+        ret = 0;
+    fprintf(stderr, "%s\n", ret == 0 ? "all results match the serial run" : "RESULTS DIFFER from the serial run");
+
+out_request:
+    for (int i = 0; i < request_num; i++)
+    {
+        free(requests[i].input);
+        for (int j = 0; j < output_num; j++)
+        {
+            free(requests[i].reference[j]);
+            free(requests[i].output[j]);
+        }
+    }
+    postrun_graph(graph);
+out_input:
+    free(input_data);
+out:
+    if (graph != NULL)
+        destroy_graph(graph);
+    free(requests);
+    free(workers);
+
+    return ret;
+}
+
+void show_usage()
+{
+    fprintf(stderr, "[Usage]:  [-h]\n    [-m model_file] [-g img_h,img_w] [-t thread_count] [-r request_count] "
+                    "[-b max_batch]\n");
+    fprintf(stderr, "\nmobilenet example: \n    ./tm_concurrent -m /path/to/mobilenet.tmfile -g 224,224 -t 4 -r 4\n");
+}
+
+int main(int argc, char* argv[])
+{
+    int thread_num = DEFAULT_THREAD_COUNT;
+    int request_count = DEFAULT_REQUEST_COUNT;
+    int max_batch = DEFAULT_MAX_BATCH;
+    char* model_file = NULL;
+    float img_hw[2] = {0.f};
+    int img_h = 0;
+    int img_w = 0;
+
+    int res;
+    while ((res = getopt(argc, argv, "m:g:t:r:b:h")) != -1)
+    {
+        switch (res)
+        {
+            case 'm':
+                model_file = optarg;
+                break;
+            case 'g':
+                split(img_hw, optarg, ",");
+                img_h = ( int )img_hw[0];
+                img_w = ( int )img_hw[1];
+                break;
+            case 't':
+                thread_num = atoi(optarg);
+                break;
+            case 'r':
+                request_count = atoi(optarg);
+                break;
+            case 'b':
+                max_batch = atoi(optarg);
+                break;
+            case 'h':
+                show_usage();
+                return 0;
+            default:
+                break;
+        }
+    }
+
+    /* check files */
+    if (model_file == NULL)
+    {
+        fprintf(stderr, "Error: Tengine model file not specified!\n");
+        show_usage();
+        return -1;
+    }
+
+    if (!check_file_exist(model_file))
+        return -1;
+
+    if (img_h == 0)
+    {
+        img_h = DEFAULT_IMG_H;
+        fprintf(stderr, "Image height not specified, use default %d\n", img_h);
+    }
+
+    if (img_w == 0)
+    {
+        img_w = DEFAULT_IMG_W;
+        fprintf(stderr, "Image width not specified, use default  %d\n", img_w);
+    }
+
+    if (thread_num < 1 || request_count < 1 || max_batch < 1 || max_batch > BATCHER_MAX_BATCH)
+    {
+        fprintf(stderr, "Error: thread count, request count and max batch must be positive, max batch at most %d\n",
+                BATCHER_MAX_BATCH);
+        return -1;
+    }
+
+    /* inital tengine */
+    if (init_tengine() != 0)
+    {
+        fprintf(stderr, "Initial tengine failed.\n");
+        return -1;
+    }
+    fprintf(stderr, "tengine-lite library version: %s\n", get_tengine_version());
+
+    int ret = tengine_concurrent(model_file, img_h, img_w, thread_num, request_count, max_batch);
+
+    release_tengine();
+
+    return ret < 0 ? -1 : 0;
+}
@@ -25,6 +25,8 @@
 #ifndef __EXEC_SCHEDULER_H__
 #define __EXEC_SCHEDULER_H__
 
+#include "tengine_c_api.h"
+
 struct ir_graph;
 
 struct exec_scheduler
@@ -33,9 +35,19 @@ struct exec_scheduler
 
     int (*prerun)(struct exec_scheduler*, struct ir_graph*, int num_thread, int cpu_affinity, int mode);
     int (*run)(struct exec_scheduler*, struct ir_graph*, int block);
-    int (*wait)(struct exec_scheduler*, struct ir_graph*);
+    /* 1 when the runs queued are done with their hooks, 0 if not yet with try_wait, or -1 on error */
+    int (*wait)(struct exec_scheduler*, struct ir_graph*, int try_wait);
+    /* change a hook of set_graph_event_hook, once the hook running returns */
+    int (*set_hook)(struct exec_scheduler*, struct ir_graph*, int event, event_handler_t func, void* arg);
     int (*postrun)(struct exec_scheduler*, struct ir_graph*);
     void (*release)(struct exec_scheduler*);
+
+    /* drop what the scheduler keeps in exec_attr->sched_priv, the graph is destroyed */
+    void (*release_graph)(struct exec_scheduler*, struct ir_graph*);
 };
 
+/* the status of a graph run in the background is set by the thread running it */
+int get_graph_status(struct ir_graph* ir_graph);
+void set_graph_status(struct ir_graph* ir_graph, int status);
+
 #endif
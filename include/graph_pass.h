@@ -0,0 +1,90 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#ifndef __GRAPH_PASS_H__
+#define __GRAPH_PASS_H__
+
+struct options;
+struct ir_graph;
+struct ir_node;
+struct ir_tensor;
+
+/* the passes rewrite the graph in prerun, after the shapes are inferred and before the graph is
+   allocated to devices. a pass returns the number of rewrites it made, or -1 on error. the graph
+   is restored as it was before a failed pass, and prerun goes on with the next one */
+
+typedef int (*graph_pass_t)(struct ir_graph* graph, const struct options* opt);
+
+/* the priorities of the builtin passes */
+#define GRAPH_PASS_FOLD_CONSTANT 100
+#define GRAPH_PASS_ELIMINATE_COMMON 120
+#define GRAPH_PASS_ELIMINATE_NODE 150
+#define GRAPH_PASS_MATMUL_TO_FC 250
+#define GRAPH_PASS_FOLD_BN_SCALE 300
+#define GRAPH_PASS_FUSE_PAD 350
+#define GRAPH_PASS_FUSE_RESIDUAL_ADD 400
+#define GRAPH_PASS_FUSE_ACTIVATION 500
+#define GRAPH_PASS_BLOCKED_LAYOUT 900
+
+/* the passes run by priority, the smaller first, when the opt level of prerun is at least level */
+int register_graph_pass(const char* name, int level, int priority, graph_pass_t pass);
+int unregister_graph_pass(const char* name);
+
+/* run the enabled passes once for the graph, the records are kept in the graph */
+int run_graph_passes(struct ir_graph* graph, const struct options* opt);
+
+/* the rewrite helpers for the passes. the removed nodes and tensors are only marked and skipped by the
+   helpers, they are dropped, and the nodes are sorted and renumbered, when the pass returns.
+   the input nodes, the output nodes and their tensors are never removed */
+
+/* detach the node from its inputs, and remove it with its outputs, which must have no consumer left.
+   the const inputs left without consumer are removed as well */
+int remove_graph_node(struct ir_graph* graph, struct ir_node* node);
+
+/* move all consumers of a tensor to another one */
+int replace_graph_tensor(struct ir_graph* graph, struct ir_tensor* old_tensor, struct ir_tensor* new_tensor);
+
+/* let one input of the node read another tensor, the other consumers keep the old one.
+   the old tensor is removed if it is a const left without consumer */
+int replace_node_input_tensor(struct ir_graph* graph, struct ir_node* node, int input_idx, struct ir_tensor* tensor);
+
+/* turn the node into another op with the default param, the inputs and the outputs are kept */
+int set_graph_node_op(struct ir_graph* graph, struct ir_node* node, int op_type, int op_version);
+
+/* node takes over the output of next, its only consumer, then next and the tensor between them are removed */
+int fuse_graph_node(struct ir_graph* graph, struct ir_node* node, struct ir_node* next);
+
+/* a const tensor owning zeroed data, and the const node producing it */
+struct ir_tensor* create_graph_const_tensor(struct ir_graph* graph, const char* name, int data_type, const int dims[],
+                                            int dim_num);
+
+/* the data of a const tensor the pass may write, copied on the first call of the pass, as the data loaded
+   could be mapped or shared with the other graphs, and is kept to restore the graph if the pass fails */
+void* get_tensor_private_data(struct ir_graph* graph, struct ir_tensor* tensor);
+
+int is_graph_input_node(struct ir_graph* graph, struct ir_node* node);
+int is_graph_output_node(struct ir_graph* graph, struct ir_node* node);
+
+#endif
@@ -26,6 +26,8 @@
 #define __NN_DEVICE_H__
 
 struct subgraph;
+struct mem_plan_summary;
+struct mem_plan_tensor;
 
 struct nn_device
 {
@@ -39,6 +41,8 @@ struct nn_device
     int (*async_wait)(struct nn_device* dev, struct subgraph* subgraph, int try_wait);
     int (*release)(struct nn_device* dev);
     int (*release_exec_graph)(struct nn_device* dev, void* exec_graph);
+    int (*get_mem_plan)(struct nn_device* dev, struct subgraph* subgraph, struct mem_plan_summary* summary,
+                        struct mem_plan_tensor* tensors, int max_num);
 };
 
 extern struct nn_device* get_nn_device_by_name(const char* name);
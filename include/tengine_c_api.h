@@ -80,6 +80,38 @@ extern "C" {
 #define GRAPH_PERF_STAT_RESET 4
 #define GRAPH_PERF_STAT_GET 5
 
+/* graph attribute: int, how the cpu device allocates activation memory */
+#define GRAPH_ATTR_CPU_MEM_ARENA "cpu_mem_arena"
+
+#define CPU_MEM_ARENA_OFF 0 /* separated buffers for tensors and shared memory */
+#define CPU_MEM_ARENA_ON 1 /* one aligned and prefaulted mapping for all of them */
+#define CPU_MEM_ARENA_HUGEPAGE 2 /* as ON, and backed by transparent huge pages */
+#define CPU_MEM_ARENA_HUGETLB 3 /* as ON, and backed by hugetlbfs pages, falls back to HUGEPAGE */
+
+/* context attribute: int, non-zero lets the graphs of the context share one activation arena.
+   set it before prerun, the graphs must never run at the same time, and the output tensors
+   of a graph keep their data when the other graphs run */
+#define CONTEXT_ATTR_SHARE_MEM_ARENA "share_mem_arena"
+
+/* graph attribute: int, non-zero lets the graphs loaded from the same model share one copy of
+   the packed weights, which the cpu device makes in prerun. the weights converted while loading
+   the model are always shared */
+#define GRAPH_ATTR_SHARE_WEIGHTS "share_weights"
+
+/* graph attribute: const char*, a directory to keep the packed weights in, read in prerun.
+   the later preruns of the same model file map them instead of packing again, and the weights
+   are shared as GRAPH_ATTR_SHARE_WEIGHTS does. see get_weight_cache_stat() */
+#define GRAPH_ATTR_WEIGHT_CACHE_DIR "weight_cache_dir"
+
+/* graph attribute: int, how many nodes the cpu device runs at the same time, read in prerun. the threads
+   of the graph are shared by them, so each node runs on num_thread / n threads. 0, the default, chooses
+   by the branches of the graph, 1 runs the nodes one by one */
+#define GRAPH_ATTR_CPU_INTER_OP_THREAD "cpu_inter_op_thread"
+
+/* graph attribute: int, GRAPH_OPT_xxx, the optimization passes the first prerun rewrites the graph with.
+   not set, or GRAPH_OPT_DEFAULT, is chosen by the library */
+#define GRAPH_ATTR_OPT_LEVEL "opt_level"
+
 /* follow the std. UNIX log level definitioin */
 enum log_level
 {
@@ -127,10 +159,21 @@ typedef void* node_t;
 
 typedef int (*event_handler_t)(graph_t, int, void* arg);
 
+typedef void* batcher_t;
+
+/* called when a request posted to a batcher is done, ret is 0 or -1 if its batch failed */
+typedef void (*batch_done_t)(batcher_t batcher, int ret, void* arg);
+
 typedef void (*log_print_t)(const char*);
 
 
 /* graph exec options */
+/* graph optimization levels, see GRAPH_ATTR_OPT_LEVEL */
+#define GRAPH_OPT_DEFAULT 0 /* chosen by the library, now GRAPH_OPT_ALL */
+#define GRAPH_OPT_NONE 1 /* run the graph as loaded */
+#define GRAPH_OPT_BASIC 2 /* the rewrites keeping the results bitwise, e.g. removing dead nodes */
+#define GRAPH_OPT_ALL 3 /* and the fusions and foldings, which may change the rounding */
+
 struct options
 {
     int num_thread;
@@ -138,6 +181,17 @@ struct options
     int precision;
 };
 
+/* the records of the graph optimization passes run in prerun, see get_graph_pass_stat() */
+
+struct graph_pass_stat
+{
+    const char* name; /* pass name */
+    int level; /* the opt level needed to run */
+    int enabled; /* 0 if skipped, by the opt level or enable_graph_pass() */
+    int change_num; /* the rewrites made, -1 if failed */
+    int64_t time; /* us */
+};
+
 /* performance profiling records */
 
 struct perf_info
@@ -151,6 +205,61 @@ struct perf_info
     uint32_t base; /* 1ms second time number */
 };
 
+/* activation memory plan records, see get_graph_mem_plan() */
+
+struct mem_plan_tensor
+{
+    const char* name; /* tensor name */
+    int tensor_idx;
+    int block_id; /* the planned block holding the data */
+    int offset; /* data offset in the arena, or in the private blocks */
+    int size; /* bytes reserved by the block, or of the tensor if it is a view */
+    int first_use; /* index of the node writing the tensor */
+    int last_use; /* index of the last node reading the tensor, -1 if none */
+    int inplace_tensor; /* index of the input tensor whose block is reused in place, -1 if none */
+    int view_parent; /* index of the tensor holding this one at an offset, e.g. a concat output, -1 if none */
+    int live_out; /* the block is still alive after the run, e.g. graph outputs */
+    int private_block; /* the block is kept out of the context arena */
+};
+
+struct mem_plan_summary
+{
+    int tensor_num; /* planned tensors */
+    int block_num;
+    int arena_size; /* bytes for all blocks, the activation peak */
+    int private_size; /* bytes for the private blocks when the context arena is shared */
+    int shared_mem_size; /* scratch memory shared by the nodes */
+    int shared_pack4_mem_size;
+    int total_size; /* sum of the above */
+};
+
+/* the packed weights found in and added to the cache directory, see GRAPH_ATTR_WEIGHT_CACHE_DIR */
+
+struct weight_cache_stat
+{
+    uint32_t hit_num; /* mapped from the cache files */
+    uint32_t miss_num; /* packed and written to the cache files */
+    int64_t saved_time; /* us of prerun saved by the hits */
+    int64_t fill_time; /* us spent to pack the missed ones */
+};
+
+/* the requests done by a batcher, see get_graph_batcher_stat() */
+
+#define BATCHER_MAX_BATCH 64
+#define BATCHER_TIME_BUCKET_NUM 24
+
+struct batcher_stat
+{
+    uint32_t request_num; /* the requests done */
+    uint32_t batch_num; /* the batches run */
+    uint32_t fail_num; /* the requests of the failed batches */
+    uint32_t batch_size_hist[BATCHER_MAX_BATCH]; /* [i]: the batches of i + 1 requests */
+    uint32_t queue_time_hist[BATCHER_TIME_BUCKET_NUM]; /* [i]: the requests queued for [2^i, 2^(i+1)) us before
+                                                          their batch runs, [0] takes the shorter, the last the longer */
+    int64_t queue_time; /* us, of all the requests */
+    int64_t run_time; /* us, of all the batches with the copies of their inputs and outputs */
+};
+
 struct custom_kernel_tensor
 {
     int dim[MAX_SHAPE_DIM_NUM]; /* the shape dim array */
@@ -355,6 +464,21 @@ int request_tengine_version(const char* version);
 
 graph_t create_graph(context_t context, const char* model_format, const char* file_name, ...);
 
+/*!
+ * @brief Create a session of a prerun graph, to run the model in more threads at the same time.
+ *        The session shares the nodes and the weights of the graph, optimized by its prerun, and
+ *        has its own tensors, activation memory, kernel scratch and threads. The packed weights
+ *        are shared by the sessions, and with the graph too if it sets GRAPH_ATTR_SHARE_WEIGHTS.
+ *
+ *        The session is a graph to the other functions: set its input buffers, prerun, run and
+ *        destroy it. Each session and the graph could be run by one thread at the same time.
+ *        The graph must be destroyed after its sessions.
+ *
+ * @param [in] graph: The graph handle, or a session of it.
+ * @return The session handle or NULL if failed.
+ */
+graph_t create_graph_session(graph_t graph);
+
 /*!
  * @brief save the graph into file using the model format
  *
@@ -363,6 +487,8 @@ graph_t create_graph(context_t context, const char* model_format, const char* fi
  * @param [in] file_name, the file name of saved model
  *
  * @return  0 success or -1 fail
+ * @note  A graph after prerun is saved with the rewrites of its graph passes, but in the nchw layout,
+ *        without the reorders the cpu device inserts for its blocked kernels.
  */
 
 int save_graph(graph_t graph, const char* model_format, const char* file_name, ...);
@@ -417,6 +543,7 @@ graph_t merge_graph(int graph_num, graph_t graph0, graph_t graph1, ...);
 
 /*!
  * @brief Destory the runtime graph and release allocated resource.
+ *        A graph with sessions left is not destroyed, and the errno is EBUSY.
  *
  * @param [in] graph: The graph handle.
  * @return 0: Success, -1: Fail.
@@ -975,6 +1102,7 @@ int set_graph_thread_mask(graph_t graph, size_t cpu_mask);
 /*!
  * @brief The interface to set some proprietary attribute items for graph.
  *        The backend device to run the graph may use the attribute item.
+ *        For example, GRAPH_ATTR_CPU_MEM_ARENA is read by the cpu device in prerun.
  *
  * @param [in] graph: The graph handle.
  * @param [in] attr_name: The attribute name.
@@ -1000,10 +1128,10 @@ int get_graph_attr(graph_t graph, const char* attr_name, void* buf, int size);
 
 /*!
  * @brief Initialize resource for graph execution, and set cluster and threads count will used.
+ *        The first prerun rewrites the graph with the optimization passes of GRAPH_ATTR_OPT_LEVEL.
  *
  * @param [in] graph: The graph handle.
- * @param [in] cluster: The wanted cluster of all cpu clusters.
- * @param [in] threads: The threads count of graph will used to run.
+ * @param [in] opt: The threads count, the cluster and the precision.
  *
  * @return 0: Success, -1: Fail.
  *
@@ -1012,6 +1140,7 @@ int prerun_graph_multithread(graph_t graph, struct options opt);
 
 /*!
  * @brief Initialize resource for graph execution.
+ *        The first prerun rewrites the graph with the optimization passes of GRAPH_ATTR_OPT_LEVEL.
  *
  * @param [in] graph: The graph handle.
  *
@@ -1027,6 +1156,8 @@ int prerun_graph(graph_t graph);
  * @param [in] block: Blocking or nonlocking.
  * @return 0: Success, -1: Fail.
  * @note  If block is 0, need to call wait_graph to get result or set GRAPH_DONE event hook.
+ *        The run is queued to a thread of the graph and the call returns at once. The graph must not
+ *        be run again, nor its tensors touched, until it is done; such a run fails with EBUSY.
  *
  */
 int run_graph(graph_t graph, int block);
@@ -1038,6 +1169,10 @@ int run_graph(graph_t graph, int block);
  * @param [in] try_wait: If set, just check status and return.
  * @return  1: Graph is done.
  *          0: Try again.
+ *         -1: The run failed.
+ * @note  The runs queued are done when their GRAPH_EXEC_DONE or GRAPH_EXEC_ABORT hooks return, and a
+ *        run queued by such a hook is not waited for. A hook waiting for its own graph gets the result
+ *        of the run at once.
  *
  */
 int wait_graph(graph_t graph, int try_wait);
@@ -1067,10 +1202,75 @@ int get_graph_exec_status(graph_t graph);
  * @param [in] cb_func: The callback funtion.
  * @param [in] cb_arg: The argument will be passed to callback function.
  * @return 0: Success, -1: Fail.
+ * @note  GRAPH_EXEC_START, GRAPH_EXEC_DONE and GRAPH_EXEC_ABORT are supported, a NULL cb_func removes
+ *        the hook. The hooks of a run with block 0 are called in the thread of the graph, and the graph
+ *        is ready again when GRAPH_EXEC_DONE is called, so the hook may start the next run.
+ *        A hook being called is waited for before it is changed, so cb_arg may be released once this
+ *        returns. A hook must not postrun or destroy its own graph.
  *
  */
 int set_graph_event_hook(graph_t graph, int event, event_handler_t cb_func, void* cb_arg);
 
+/*!
+ * @brief Create a batcher, which merges the requests of one item each into batches of the graph.
+ *        A thread of the batcher takes the queued requests when max_batch of them are queued, or when
+ *        the first one has waited max_delay_us, copies their inputs into a batch, runs it and copies
+ *        the outputs back. The batches run on sessions of the graph, see create_graph_session(), whose
+ *        batch is the dims[0] of the graph inputs times 1, 2, 4 and so on up to max_batch. A batch takes
+ *        the smallest session holding its requests, the slots left run the data of an earlier batch.
+ *
+ * @param [in] graph: The prerun graph, whose inputs and outputs hold one item each along dims[0].
+ *                    The batcher does not run it, and it must be destroyed after the batcher.
+ * @param [in] max_batch: The most requests in a batch, from 1 to BATCHER_MAX_BATCH.
+ * @param [in] max_delay_us: The most time a request waits for the others of its batch.
+ * @param [in] opt: The options to prerun the sessions with, NULL for one thread and fp32.
+ * @return The batcher handle or NULL if failed, e.g. ENOTSUP if the outputs do not follow the batch.
+ */
+batcher_t create_graph_batcher(graph_t graph, int max_batch, int max_delay_us, struct options* opt);
+
+/*!
+ * @brief Run the requests queued, and destroy the batcher.
+ *
+ * @param [in] batcher: The batcher handle.
+ * @return 0: Success, -1: Fail.
+ */
+int destroy_graph_batcher(batcher_t batcher);
+
+/*!
+ * @brief Queue a request to a batcher and wait till it is done. It could be called by many threads.
+ *
+ * @param [in] batcher: The batcher handle.
+ * @param [in] input_data: The input data of the request, one buffer for each input tensor of the graph, in
+ *                         the order of get_graph_input_tensor(graph, node, tensor), by node then tensor.
+ *                         Each holds the size of the tensor in the graph.
+ * @param [out] output_data: The buffers for the outputs, in the order of get_graph_output_tensor().
+ * @return 0: Success, -1: Fail.
+ */
+int run_batched_request(batcher_t batcher, void* input_data[], void* output_data[]);
+
+/*!
+ * @brief Queue a request to a batcher and return at once.
+ *
+ * @param [in] batcher: The batcher handle.
+ * @param [in] input_data: As run_batched_request(), the buffers are read when the batch of the request runs.
+ * @param [out] output_data: As run_batched_request().
+ * @param [in] cb_func: Called in the thread of the batcher when the request is done, could be NULL.
+ * @param [in] cb_arg: The argument passed to cb_func.
+ * @return 0: Success, -1: Fail.
+ * @note  The buffers must be kept till cb_func is called, or till destroy_graph_batcher() returns.
+ */
+int post_batched_request(batcher_t batcher, void* input_data[], void* output_data[], batch_done_t cb_func,
+                         void* cb_arg);
+
+/*!
+ * @brief Get the statistics of a batcher.
+ *
+ * @param [in] batcher: The batcher handle.
+ * @param [out] stat: The counters since the batcher is created.
+ * @return 0: Success, -1: Fail.
+ */
+int get_graph_batcher_stat(batcher_t batcher, struct batcher_stat* stat);
+
 /***************** Device related *****************************/
 
 /*!
@@ -1167,6 +1367,7 @@ int remove_context_device(context_t context, const char* dev_name);
 
 /*!
  * @brief Set attribute item of a context.
+ *        For example, CONTEXT_ATTR_SHARE_MEM_ARENA.
  *
  * @param [in] context: The context handle.
  * @param [in] attr_name: The attribute item name.
@@ -1240,6 +1441,48 @@ void set_log_output(log_print_t func);
  */
 void dump_graph(graph_t graph);
 
+/*!
+ * @brief Get the activation memory plan of a graph after prerun.
+ *
+ * @param [in] graph: The graph handle.
+ * @param [out] summary: The sizes of the plan, could be NULL.
+ * @param [out] tensors: The buffer to hold the per tensor records, could be NULL.
+ * @param [in] max_num: The record number the buffer can hold.
+ *
+ * @return The number of planned tensors, which may be bigger than max_num. -1: Fail.
+ */
+int get_graph_mem_plan(graph_t graph, struct mem_plan_summary* summary, struct mem_plan_tensor* tensors, int max_num);
+
+/*!
+ * @brief Get the records of the optimization passes run for a graph in prerun.
+ *
+ * @param [in] graph: The graph handle.
+ * @param [out] stat: The buffer to hold the records, in the order the passes run.
+ * @param [in] max_num: The record number the buffer can hold.
+ *
+ * @return The number of the records, which may be bigger than max_num.
+ */
+int get_graph_pass_stat(graph_t graph, struct graph_pass_stat* stat, int max_num);
+
+/*!
+ * @brief Enable or disable a graph optimization pass for the later preruns in the process.
+ *
+ * @param [in] pass_name: The pass name, as in struct graph_pass_stat.
+ * @param [in] enable: 0 to disable, others to enable.
+ *
+ * @return 0: Success, -1: Fail, the pass is not found.
+ */
+int enable_graph_pass(const char* pass_name, int enable);
+
+/*!
+ * @brief Get the statistics of the persisted weight cache of the process.
+ *
+ * @param [out] stat: The counters since the process started.
+ *
+ * @return 0: Success, -1: Fail.
+ */
+int get_weight_cache_stat(struct weight_cache_stat* stat);
+
 /**************************** Plug-in operate set *******************/
 /*!
  * @brief Load one plugin from disk, and execute the init function.
@@ -26,7 +26,9 @@
 #define __TENGINE_EXEC_H__
 
 #include <stdint.h>
+#include <stddef.h>
 
+#include "tengine_c_api.h"
 #include "vector.h"
 #include "nn_device.h"
 #include "dev_allocator.h"
@@ -61,6 +63,15 @@ struct dev_mem
     uint64_t dev_mem_addr; /* why not pointer? as in 32bit CPU, the dev address may be 64bit */
 };
 
+/* activation memory shared by the graphs of one context, which never run at the same time */
+struct shared_mem_arena
+{
+    void* mem;
+    size_t mem_size;
+    int ref_count;
+    int generation; /* changed when mem is moved, the users have to rebind */
+};
+
 struct exec_context
 {
     struct exec_scheduler* scheduler;
@@ -68,6 +79,8 @@ struct exec_context
     struct nn_device* def_dev;
     char* name;
     struct vector* dev_list;
+    int share_mem_arena;
+    struct shared_mem_arena* mem_arena;
 };
 
 struct exec_attr
@@ -81,6 +94,10 @@ struct exec_attr
     struct exec_context* exec_context;
     void* sched_priv;
     void* allocator_priv;
+
+    /* the callbacks of set_graph_event_hook, by enum graph_exec_event */
+    event_handler_t event_hook[GRAPH_EXEC_DONE + 1];
+    void* event_arg[GRAPH_EXEC_DONE + 1];
 };
 
 void init_exec_attr(struct exec_attr* attr, struct exec_context* context);
@@ -37,6 +37,10 @@
 #define TENGINE_NODE_TYPE_OUTPUT 4
 #define MAX_CONSUMER_NUM 8
 
+/* the blocked layout of the fp32 tensors between the x86 pack8 kernels, [n][c / 8][h][w][8], the dims are
+   still nchw. the reorder nodes inserted by the blocked_layout pass convert from and to it */
+#define TENGINE_LAYOUT_NCHW8 2
+
 typedef int16_t fp16_t;
 
 struct nn_device;
@@ -44,6 +48,7 @@ struct exec_context;
 struct exec_attr;
 struct dev_mem;
 struct ir_node;
+struct graph_checkpoint;
 
 struct ir_tensor
 {
@@ -61,6 +66,7 @@ struct ir_tensor
     uint8_t free_host_mem; /* should free host memory ? */
     uint8_t internal_allocated; /* how memory is allocated? */
     uint8_t layout;
+    uint8_t removed; /* by a graph pass, dropped when the pass returns */
 
     uint16_t quant_param_num;
     uint32_t elem_num;
@@ -133,6 +139,7 @@ struct ir_node
     uint8_t attr_num;
     uint8_t node_type; /* subgraph_input, subgraph_output, intermediate */
     int8_t subgraph_idx;
+    uint8_t removed; /* by a graph pass, dropped when the pass returns */
 
     int16_t* input_tensors;
     int16_t* output_tensors;
@@ -185,18 +192,29 @@ struct ir_graph
     struct serializer* serializer;
     void* serializer_priv; /* serializer saved content */
     void* dev_priv; /* DLA serializer may use this to pass some info to DLA device */
+    char* model_key; /* identifies the model data, the graphs with the same key may share weights */
 
     struct nn_device * nn_dev; /* assigned nn_dev for this graph */
     struct exec_attr* exec_attr;
     struct ir_attr* attr_mem;
     struct vector* subgraph_list;
     struct vector* graph_list; /* for composed graph */
+    struct vector* pass_stat_list; /* the graph passes run in prerun, see graph_pass.h */
+    struct graph_checkpoint* pass_checkpoint; /* the graph before the running pass, see graph_pass.c */
+
+    struct ir_graph* parent; /* the graph a session shares the ops and the weights of, see create_graph_session */
+    int session_num; /* the sessions of the graph not destroyed yet */
 };
 
 struct ir_graph* create_ir_graph(struct exec_context* context);
 void init_ir_graph(struct ir_graph* ir_graph, struct exec_context* context);
 void destroy_ir_graph(struct ir_graph* ir_graph);
 
+/* a graph with copies of the nodes and the tensors of graph, which is prerun. the const tensors keep
+   the data of graph, the other tensors have none. the op params are copied, as the node ops may write
+   them, and the buffers they point to are shared. graph must outlive the session */
+struct ir_graph* create_ir_graph_session(struct ir_graph* graph, struct exec_context* context);
+
 int set_ir_graph_input_node(struct ir_graph* ir_graph, int16_t input_nodes[], int input_number);
 int set_ir_graph_output_node(struct ir_graph* ir_graph, int16_t output_nodes[], int output_number);
 
@@ -280,6 +298,9 @@ struct ir_attr* remove_single_attr(struct ir_attr* attr_mem, int attr_num, const
 
 void remove_all_attr(struct ir_attr* attr_mem, int attr_num);
 
+/* a new block with the same attrs, NULL if attr_num is 0 or on error */
+struct ir_attr* copy_all_attr(struct ir_attr* attr_mem, int attr_num);
+
 int set_attr_val(struct ir_attr* attr_mem, int attr_num, const char* attr_name, const char* type_name, const void* buf,
                  int size);
 
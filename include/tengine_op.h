@@ -122,6 +122,7 @@ enum
     OP_UPSAMPLE,
     OP_ZEROSLIKE,
     OP_MISH,
+    OP_REORDER,
     OP_BUILTIN_LAST
 };
 
@@ -115,5 +115,6 @@
 #define OP_UPSAMPLE_NAME "Upsample"
 #define OP_ZEROSLIKE_NAME "ZerosLike"
 #define OP_MISH_NAME "Mish"
+#define OP_REORDER_NAME "Reorder"
 
 #endif
@@ -37,6 +37,9 @@ struct serializer
     /* load graph from memory */
     int (*load_mem)(struct serializer*, struct ir_graph*, const void* addr, int size, va_list ap);
 
+    /* save graph into file */
+    int (*save_model)(struct serializer*, struct ir_graph*, const char* fname, va_list ap);
+
     /* unload graph, free serializer related and device releated  resource */
     int (*unload_graph)(struct serializer*, struct ir_graph*, void* s_priv, void* dev_priv);
 
@@ -44,6 +47,8 @@ struct serializer
     int (*register_op_loader)(struct serializer*, int op_type, int op_ver, void* op_load_func, void* op_type_map_func,
                               void* op_ver_map_func);
     int (*unregister_op_loader)(struct serializer*, int op_type, int op_ver, void* op_load_func);
+    int (*register_op_saver)(struct serializer*, int op_type, int op_ver, void* op_save_func);
+    int (*unregister_op_saver)(struct serializer*, int op_type, int op_ver, void* op_save_func);
 
     /* interface for regiser and unregister */
     int (*init)(struct serializer*);
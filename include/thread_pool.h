@@ -0,0 +1,50 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#ifndef __THREAD_POOL_H__
+#define __THREAD_POOL_H__
+
+/* the threads running the parallel loops of the kernels, owned by an exec graph. it is created at prerun
+   with the thread number and the cluster of the graph, and replaces the openmp regions opened by each op.
+   the caller of a loop is thread 0, so num_thread - 1 workers are started and bound to the cluster.
+   between the loops the workers spin for a while, so the next node finds them awake, and then park.
+   a pool runs the loops of one caller at a time */
+
+struct thread_pool;
+
+typedef void (*thread_pool_func_t)(void* arg, int idx);
+
+struct thread_pool* create_thread_pool(int num_thread, int cluster);
+void destroy_thread_pool(struct thread_pool* pool);
+
+/* 1 for a NULL pool */
+int get_thread_pool_size(struct thread_pool* pool);
+
+/* call func for each idx in [0, num). the range is split into one contiguous part per thread in order,
+   so an idx always runs on the same thread and the results are deterministic. a NULL pool, or a loop
+   started from a task of the pool, runs in the caller */
+void thread_pool_parallel_for(struct thread_pool* pool, int num, thread_pool_func_t func, void* arg);
+
+#endif
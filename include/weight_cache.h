@@ -0,0 +1,63 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#ifndef __WEIGHT_CACHE_H__
+#define __WEIGHT_CACHE_H__
+
+#include <stdint.h>
+
+/* the weights shared by the graphs loaded from the same model in the process.
+   an entry is found by the model key, the const tensor index, the kind and the size,
+   and is released when the last graph puts it. the data is read only once filled */
+
+#define WEIGHT_CACHE_RAW 0 /* the tensor data converted by the serializer */
+#define WEIGHT_CACHE_FILE 1 /* the whole model file read into memory, tensor index -1 */
+#define WEIGHT_CACHE_CONV_GEMM 2 /* the interleaved kernel of the gemm convolution */
+#define WEIGHT_CACHE_CONV_WINO 3 /* the transformed kernel of the winograd convolution */
+#define WEIGHT_CACHE_CONV_PACK8 4 /* the packed kernel of the nchw8 convolution */
+
+struct ir_tensor;
+
+typedef int (*weight_fill_t)(void* mem, void* arg);
+
+/* return the entry, created and filled by fill when not in the cache yet */
+void* get_shared_weight(const char* model_key, int tensor_idx, int kind, int size, weight_fill_t fill, void* arg);
+
+/* as get_shared_weight, and the filled data is also kept in a file under dir, so that the later processes
+   map it instead of filling again. src is the tensor the data is made from, its fingerprint is also
+   a part of the key. dir could be NULL */
+void* get_persist_weight(const char* dir, const char* model_key, int tensor_idx, int kind, int size,
+                         struct ir_tensor* src, weight_fill_t fill, void* arg);
+
+/* drop one reference, the memory is freed with the last one */
+void put_shared_weight(void* mem);
+
+/* the number and the total size of the entries in the cache */
+void get_shared_weight_stat(int* entry_num, int* mem_size);
+
+/* the entries mapped from and written to the files, and the time in us they took or saved */
+void get_persist_weight_stat(int* hit_num, int* miss_num, int64_t* saved_time, int64_t* fill_time);
+
+#endif
@@ -45,6 +45,7 @@ extern "C" {
     #include "pooling_param.h"
     #include "batchnorm_param.h"
     #include "eltwise_param.h"
+    #include "fc_param.h"
     #include "relu_param.h"
 }
 
@@ -944,6 +945,19 @@ public:
         fc_info.set_weights_trained_layout(DataLayout::NCHW);    // lay out
         fc->configure(itensor, wtensor, btensor, otensor, fc_info);
         functions_map_.push_back(fc);
+
+        /* the activation fused into fc, run in place */
+        struct fc_param* param = (struct fc_param*)node->op.param_mem;
+        if(param->activation >= 0)
+        {
+            CLActivationLayer* act = new CLActivationLayer();
+            if(param->activation == 0)
+                act->configure(otensor, nullptr, ActivationLayerInfo(ActivationLayerInfo::ActivationFunction::RELU));
+            else
+                act->configure(otensor, nullptr, ActivationLayerInfo(ActivationLayerInfo::ActivationFunction::BOUNDED_RELU,
+                                                                      param->activation));
+            functions_map_.push_back(act);
+        }
         wtensor->allocator()->allocate();
         wtensor->map();
         void* data = w_tensor->data;
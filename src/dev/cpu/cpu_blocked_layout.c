@@ -0,0 +1,311 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_op.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "nn_device.h"
+#include "graph_pass.h"
+#include "convolution_param.h"
+#include "pooling_param.h"
+#include "eltwise_param.h"
+#include "concat_param.h"
+#include "reorder_param.h"
+
+#define PACK 8
+
+/* keep the activations in the nchw8 layout from one x86 pack8 kernel to the next. the convolutions and
+   the poolings read and write nchw8, the activations, the eltwise and the concat along the channels are
+   the same in any layout and follow their inputs. a reorder node is inserted where a tensor meets a node
+   of the other layout, so only at the inputs and the outputs of the blocked chains */
+
+#if __AVX__
+
+static int is_blocked_shape(struct ir_tensor* tensor)
+{
+    return tensor->data_type == TENGINE_DT_FP32 && tensor->dim_num == 4 && tensor->dims[1] % PACK == 0 &&
+           tensor->dims[1] > 0;
+}
+
+static int is_const_fp32(struct ir_tensor* tensor)
+{
+    return tensor->tensor_type == TENSOR_TYPE_CONST && tensor->data != NULL && tensor->data_type == TENGINE_DT_FP32;
+}
+
+static int is_blocked_conv(struct ir_graph* graph, struct ir_node* node)
+{
+    struct conv_param* param = ( struct conv_param* )node->op.param_mem;
+
+    if (node->input_num < 2 || node->input_num > 4 || node->output_num != 1)
+        return 0;
+
+    struct ir_tensor* input = get_ir_graph_tensor(graph, node->input_tensors[0]);
+    struct ir_tensor* filter = get_ir_graph_tensor(graph, node->input_tensors[1]);
+    struct ir_tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+    int inc = input->dims[1];
+    int outc = output->dims[1];
+
+    if (!is_blocked_shape(input) || !is_blocked_shape(output) || !is_const_fp32(filter) || filter->dim_num != 4 ||
+        filter->dims[0] != outc || filter->dims[2] != param->kernel_h || filter->dims[3] != param->kernel_w)
+        return 0;
+
+    if (node->input_num > 2 && !is_const_fp32(get_ir_graph_tensor(graph, node->input_tensors[2])))
+        return 0;
+
+    if (param->pad_h0 < 0 || param->pad_w0 < 0 || param->stride_h < 1 || param->stride_w < 1 ||
+        param->dilation_h < 1 || param->dilation_w < 1)
+        return 0;
+
+    /* the plain and the depthwise ones */
+    if (param->group == 1)
+        return filter->dims[1] == inc;
+
+    return param->group == inc && param->group == outc && filter->dims[1] == 1;
+}
+
+static int is_blocked_pool(struct ir_graph* graph, struct ir_node* node)
+{
+    struct pool_param* param = ( struct pool_param* )node->op.param_mem;
+    struct ir_tensor* input = get_ir_graph_tensor(graph, node->input_tensors[0]);
+    struct ir_tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+    return node->input_num == 1 && node->output_num == 1 && is_blocked_shape(input) && is_blocked_shape(output) &&
+           (param->pool_method == POOL_MAX || param->pool_method == POOL_AVG) && param->pad_h0 >= 0 &&
+           param->pad_w0 >= 0;
+}
+
+static int is_same_dims(struct ir_tensor* a, struct ir_tensor* b)
+{
+    return a->dim_num == b->dim_num && memcmp(a->dims, b->dims, sizeof(int) * a->dim_num) == 0;
+}
+
+/* the nodes computing the same in any layout, given their inputs are all in it */
+static int is_layout_free(struct ir_graph* graph, struct ir_node* node)
+{
+    if (node->output_num != 1 || node->input_num < 1)
+        return 0;
+
+    struct ir_tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+    if (!is_blocked_shape(output))
+        return 0;
+
+    for (int i = 0; i < node->input_num; i++)
+    {
+        struct ir_tensor* input = get_ir_graph_tensor(graph, node->input_tensors[i]);
+
+        if (!is_blocked_shape(input))
+            return 0;
+    }
+
+    switch (node->op.op_type)
+    {
+        case OP_RELU:
+        case OP_RELU6:
+        case OP_CLIP:
+            return node->input_num == 1;
+        case OP_ELTWISE:
+        {
+            int type = (( struct eltwise_param* )node->op.param_mem)->type;
+
+            if (type != ELT_SUM && type != ELT_PROD && type != ELT_MAX)
+                return 0;
+
+            return node->input_num == 2 &&
+                   is_same_dims(get_ir_graph_tensor(graph, node->input_tensors[0]), output) &&
+                   is_same_dims(get_ir_graph_tensor(graph, node->input_tensors[1]), output);
+        }
+        case OP_CONCAT:
+            return (( struct concat_param* )node->op.param_mem)->axis == 1;
+        default:
+            return 0;
+    }
+}
+
+/* the inputs in the layout of the node, the others are the weights */
+static int is_data_input(struct ir_node* node, int idx)
+{
+    if (node->op.op_type == OP_CONV)
+        return idx == 0 || idx == 3;
+
+    return 1;
+}
+
+static struct ir_tensor* create_reorder(struct ir_graph* graph, struct ir_tensor* tensor, int layout)
+{
+    char name[256];
+
+    snprintf(name, sizeof(name), "%s/%s", tensor->name ? tensor->name : "tensor",
+             layout == TENGINE_LAYOUT_NCHW8 ? "nchw8" : "nchw");
+
+    struct ir_tensor* output = create_ir_tensor(graph, name, tensor->data_type);
+
+    if (output == NULL || set_ir_tensor_shape(output, tensor->dims, tensor->dim_num) < 0)
+        return NULL;
+
+    output->tensor_type = TENSOR_TYPE_VAR;
+    output->layout = layout;
+
+    struct ir_node* node = create_ir_node(graph, name, OP_REORDER, 1);
+
+    if (node == NULL)
+        return NULL;
+
+    (( struct reorder_param* )node->op.param_mem)->layout = layout;
+
+    if (set_ir_node_input_tensor(node, 0, tensor) < 0 || set_ir_node_output_tensor(node, 0, output) < 0)
+        return NULL;
+
+    return output;
+}
+
+static int blocked_layout(struct ir_graph* graph, const struct options* opt)
+{
+    if (graph->nn_dev != NULL && strcmp(graph->nn_dev->name, "cpu_dev") != 0)
+        return 0;
+
+    if (graph->graph_layout != TENGINE_LAYOUT_NCHW || opt->precision != TENGINE_MODE_FP32)
+        return 0;
+
+    int node_num = graph->node_num;
+    int tensor_num = graph->tensor_num;
+    int8_t* blocked = ( int8_t* )sys_malloc(node_num);
+    int16_t* reorder = ( int16_t* )sys_malloc(sizeof(int16_t) * tensor_num * 2);
+    int change_num = 0;
+
+    if (blocked == NULL || reorder == NULL)
+    {
+        sys_free(blocked);
+        sys_free(reorder);
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    /* the nodes are sorted, the producers are decided first */
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, i);
+
+        blocked[i] = 0;
+
+        if (node->removed || is_graph_input_node(graph, node) || is_graph_output_node(graph, node))
+            continue;
+
+        if (node->op.op_type == OP_CONV)
+            blocked[i] = is_blocked_conv(graph, node);
+        else if (node->op.op_type == OP_POOL)
+            blocked[i] = is_blocked_pool(graph, node);
+        else if (is_layout_free(graph, node))
+        {
+            /* only to keep a chain, as the reorders would cost more than they save */
+            for (int j = 0; j < node->input_num; j++)
+            {
+                struct ir_tensor* input = get_ir_graph_tensor(graph, node->input_tensors[j]);
+
+                if (input->producer >= 0 && blocked[input->producer])
+                    blocked[i] = 1;
+            }
+        }
+
+        if (blocked[i])
+            get_ir_graph_tensor(graph, node->output_tensors[0])->layout = TENGINE_LAYOUT_NCHW8;
+    }
+
+    /* the reorder of a tensor into each layout is shared by its consumers */
+    for (int i = 0; i < tensor_num * 2; i++)
+        reorder[i] = -1;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, i);
+
+        if (node->removed)
+            continue;
+
+        for (int j = 0; j < node->input_num; j++)
+        {
+            if (node->input_tensors[j] < 0 || node->input_tensors[j] >= tensor_num || !is_data_input(node, j))
+                continue;
+
+            struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->input_tensors[j]);
+
+            /* the other layouts are only labels, the data follows the dims */
+            if ((tensor->layout == TENGINE_LAYOUT_NCHW8) == blocked[i])
+                continue;
+
+            int layout = blocked[i] ? TENGINE_LAYOUT_NCHW8 : TENGINE_LAYOUT_NCHW;
+            int16_t* cached = &reorder[tensor->idx * 2 + blocked[i]];
+
+            if (*cached < 0)
+            {
+                struct ir_tensor* output = create_reorder(graph, tensor, layout);
+
+                if (output == NULL)
+                    goto error;
+
+                *cached = output->idx;
+            }
+
+            if (replace_node_input_tensor(graph, node, j, get_ir_graph_tensor(graph, *cached)) < 0)
+                goto error;
+        }
+
+        change_num += blocked[i];
+    }
+
+    sys_free(blocked);
+    sys_free(reorder);
+
+    TLOG_INFO("blocked_layout: %d nodes in nchw8, %d reorders\n", change_num, graph->node_num - node_num);
+
+    return change_num;
+
+error:
+    sys_free(blocked);
+    sys_free(reorder);
+
+    return -1;
+}
+
+static int reg_blocked_layout(void* arg)
+{
+    return register_graph_pass("blocked_layout", GRAPH_OPT_ALL, GRAPH_PASS_BLOCKED_LAYOUT, blocked_layout);
+}
+
+static int unreg_blocked_layout(void* arg)
+{
+    return unregister_graph_pass("blocked_layout");
+}
+
+REGISTER_MODULE_INIT(MOD_FUNC_LEVEL, "reg_blocked_layout", reg_blocked_layout);
+REGISTER_MODULE_EXIT(MOD_FUNC_LEVEL, "unreg_blocked_layout", unreg_blocked_layout);
+
+#endif
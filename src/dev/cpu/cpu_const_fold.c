@@ -0,0 +1,241 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_op.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "graph_pass.h"
+#include "cpu_device.h"
+#include "cpu_node_ops.h"
+
+#define MAX_FOLD_OUTPUT_NUM 8
+
+/* fold the nodes whose outputs are known at prerun: the nodes with only const inputs, and the nodes
+   reading only the shapes of their inputs, e.g. priorbox. each of them is run once by its cpu node ops,
+   and its outputs are replaced by const tensors. the shapes are fixed at prerun, so are the results */
+
+static int is_shape_only_op(int op_type)
+{
+    return op_type == OP_PRIORBOX;
+}
+
+static int is_foldable_node(struct ir_graph* graph, struct ir_node* node)
+{
+    int op_type = node->op.op_type;
+
+    if (node->removed || op_type == OP_CONST || op_type == OP_INPUT || node->input_num == 0 ||
+        is_graph_input_node(graph, node) || is_graph_output_node(graph, node))
+        return 0;
+
+    for (int i = 0; i < node->input_num; i++)
+    {
+        if (node->input_tensors[i] < 0)
+            continue;
+
+        struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->input_tensors[i]);
+
+        if (tensor->tensor_type == TENSOR_TYPE_CONST && tensor->data != NULL)
+            continue;
+
+        if (!is_shape_only_op(op_type) || tensor->dim_num == 0 || tensor->elem_num == 0)
+            return 0;
+    }
+
+    for (int i = 0; i < node->output_num; i++)
+    {
+        struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->output_tensors[i]);
+
+        /* the scale list would be shared by the two tensors */
+        if (tensor->dim_num == 0 || tensor->elem_num == 0 || tensor->quant_param_num > 1)
+            return 0;
+    }
+
+    return 1;
+}
+
+static int run_node(struct exec_graph* exec_graph, struct ir_node* node, struct node_ops* node_ops)
+{
+    struct exec_node exec_node;
+    int ret = -1;
+
+    if (init_exec_node(exec_graph, &exec_node, node, node_ops) < 0)
+        return -1;
+
+    void* shared_mem = NULL;
+    void* shared_pack4_mem = NULL;
+
+    if (exec_node.shared_mem_size > 0)
+        shared_mem = sys_malloc(exec_node.shared_mem_size);
+
+    if (exec_node.shared_pack4_mem_size > 0)
+        shared_pack4_mem = sys_malloc(exec_node.shared_pack4_mem_size);
+
+    if ((exec_node.shared_mem_size > 0 && shared_mem == NULL) ||
+        (exec_node.shared_pack4_mem_size > 0 && shared_pack4_mem == NULL))
+    {
+        set_tengine_errno(ENOMEM);
+        goto out;
+    }
+
+    exec_graph->shared_mem = shared_mem;
+    exec_graph->shared_mem_size = exec_node.shared_mem_size;
+    exec_graph->shared_pack4_mem = shared_pack4_mem;
+    exec_graph->shared_pack4_mem_size = exec_node.shared_pack4_mem_size;
+
+    if (node_ops->prerun && node_ops->prerun(node_ops, &exec_node, exec_graph) < 0)
+        goto out;
+
+    if ((node_ops->reshape && node_ops->reshape(node_ops, &exec_node, exec_graph) < 0) ||
+        node_ops->run(node_ops, &exec_node, exec_graph) < 0)
+        TLOG_ERR("fold_constant: failed to run node %d, %s\n", node->idx, node->name);
+    else
+        ret = 0;
+
+    if (node_ops->postrun)
+        node_ops->postrun(node_ops, &exec_node, exec_graph);
+
+out:
+    release_exec_node(exec_graph, &exec_node, node_ops);
+
+    sys_free(shared_mem);
+    sys_free(shared_pack4_mem);
+
+    return ret;
+}
+
+static int fold_node(struct ir_graph* graph, struct exec_graph* exec_graph, struct ir_node* node)
+{
+    struct node_ops* node_ops = find_node_ops(exec_graph, node);
+
+    if (node_ops == NULL)
+        return 0;
+
+    struct ir_tensor* const_tensor[MAX_FOLD_OUTPUT_NUM];
+    int output_num = node->output_num;
+
+    if (output_num > MAX_FOLD_OUTPUT_NUM)
+        return 0;
+
+    for (int i = 0; i < output_num; i++)
+    {
+        struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->output_tensors[i]);
+        struct ir_tensor* c = create_graph_const_tensor(graph, tensor->name, tensor->data_type, tensor->dims,
+                                                        tensor->dim_num);
+
+        if (c == NULL)
+            return -1;
+
+        c->layout = tensor->layout;
+        c->quant_param_num = tensor->quant_param_num;
+        c->scale = tensor->scale;
+        c->zero_point = tensor->zero_point;
+
+        /* the node writes into the const tensors */
+        tensor->data = c->data;
+        const_tensor[i] = c;
+    }
+
+    int ret = run_node(exec_graph, node, node_ops);
+
+    for (int i = 0; i < output_num; i++)
+        get_ir_graph_tensor(graph, node->output_tensors[i])->data = NULL;
+
+    /* the const tensors left unused are dropped with the pass */
+    if (ret < 0)
+    {
+        for (int i = 0; i < output_num; i++)
+            remove_graph_node(graph, get_ir_graph_node(graph, const_tensor[i]->producer));
+
+        return 0;
+    }
+
+    for (int i = 0; i < output_num; i++)
+    {
+        struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->output_tensors[i]);
+
+        if (replace_graph_tensor(graph, tensor, const_tensor[i]) < 0)
+            return -1;
+    }
+
+    if (remove_graph_node(graph, node) < 0)
+        return -1;
+
+    return 1;
+}
+
+static int fold_constant(struct ir_graph* graph, const struct options* opt)
+{
+    struct cpu_device* dev = ( struct cpu_device* )get_nn_device_by_name("cpu_dev");
+    struct exec_graph exec_graph;
+    int node_num = graph->node_num;
+    int fold_num = 0;
+
+    if (dev == NULL)
+        return 0;
+
+    memset(&exec_graph, 0, sizeof(exec_graph));
+
+    exec_graph.dev = dev;
+    exec_graph.num_thread = 1;
+    exec_graph.cpu_affinity = opt->cluster;
+    exec_graph.mode = opt->precision;
+
+    /* the nodes are sorted, so a chain of them folds in one sweep */
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, i);
+
+        if (!is_foldable_node(graph, node))
+            continue;
+
+        int ret = fold_node(graph, &exec_graph, node);
+
+        if (ret < 0)
+            return -1;
+
+        fold_num += ret;
+    }
+
+    return fold_num;
+}
+
+static int reg_fold_constant(void* arg)
+{
+    return register_graph_pass("fold_constant", GRAPH_OPT_BASIC, GRAPH_PASS_FOLD_CONSTANT, fold_constant);
+}
+
+static int unreg_fold_constant(void* arg)
+{
+    return unregister_graph_pass("fold_constant");
+}
+
+REGISTER_MODULE_INIT(MOD_FUNC_LEVEL, "reg_fold_constant", reg_fold_constant);
+REGISTER_MODULE_EXIT(MOD_FUNC_LEVEL, "unreg_fold_constant", unreg_fold_constant);
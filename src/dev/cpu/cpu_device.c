@@ -25,20 +25,32 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <assert.h>
+#include <stdbool.h>
 
 #include "sys_port.h"
 #include "tengine_errno.h"
 #include "tengine_utils.h"
 #include "tengine_ir.h"
+#include "tengine_exec.h"
 #include "nn_device.h"
 #include "cpu_device.h"
 #include "cpu_node_ops.h"
 #include "tengine_log.h"
 #include "tengine_op.h"
+#include "thread_pool.h"
+#include "cpu_inter_op.h"
 #include "compiler_fp16.h"
+#include "concat_param.h"
+#include "split_param.h"
+#include "slice_param.h"
 
 #include <sys/time.h>
 
+#ifdef __linux__
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
 #include <stdlib.h>
 #include <sys/stat.h>
 #include <stdio.h>
@@ -1130,7 +1142,11 @@ void extract_feature_blob_f32(const char* comment, const char* layer_name, const
 }
 #endif
 
-#define INPLACE_BLOCK_FLAG 0x40
+/* far above any block id, the lower bits hold the index of the input reused in place */
+#define INPLACE_BLOCK_FLAG 0x40000000
+#define NODE_REMOVED (-2)
+#define MEM_BLOCK_GUARD_SIZE 128
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
 static void release_mem_pool(struct mem_pool* mem_pool);
 
 struct mem_record
@@ -1155,8 +1171,22 @@ static int find_tensor_mem_list(struct vector* tensor_mem_list, const struct ir_
     return -1;
 }
 
-static int init_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_node, struct ir_node* ir_node,
-                          struct node_ops* node_ops)
+/* the caller reads graph outputs after run, so they are never released inside the graph */
+static int get_tensor_use_count(struct ir_graph* ir_graph, struct ir_tensor* ir_tensor)
+{
+    if (ir_tensor->producer >= 0)
+    {
+        struct ir_node* producer = get_ir_graph_node(ir_graph, ir_tensor->producer);
+
+        if (producer->node_type == TENGINE_NODE_TYPE_OUTPUT)
+            return ir_tensor->consumer_num + 1;
+    }
+
+    return ir_tensor->consumer_num;
+}
+
+int init_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_node, struct ir_node* ir_node,
+                   struct node_ops* node_ops)
 {
     exec_node->ir_node = ir_node;
     exec_node->node_ops = node_ops;
@@ -1167,11 +1197,11 @@ static int init_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_
     exec_node->shared_pack4_mem_size = 0;
     exec_node->output_num = ir_node->output_num;
 
-    int8_t* block_id = exec_node->block_id;
+    int* block_id = exec_node->block_id;
 
     if (exec_node->output_num > 4)
     {
-        exec_node->block_id_ptr = ( int8_t* )sys_malloc(sizeof(int8_t) * exec_node->output_num);
+        exec_node->block_id_ptr = ( int* )sys_malloc(sizeof(int) * exec_node->output_num);
         block_id = exec_node->block_id_ptr;
     }
 
@@ -1184,7 +1214,7 @@ static int init_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_
     return 0;
 }
 
-static void release_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_node, struct node_ops* node_ops)
+void release_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_node, struct node_ops* node_ops)
 {
     if (node_ops->release_node)
         node_ops->release_node(node_ops, exec_node, exec_graph);
@@ -1196,6 +1226,147 @@ static void release_exec_node(struct exec_graph* exec_graph, struct exec_node* e
         sys_free(exec_node->block_id_ptr);
 }
 
+static int get_graph_mem_arena_mode(struct ir_graph* ir_graph)
+{
+    int mode = CPU_MEM_ARENA_OFF;
+
+    if (ir_graph->attr_num == 0)
+        return mode;
+
+    if (get_attr_val(ir_graph->attr_mem, ir_graph->attr_num, GRAPH_ATTR_CPU_MEM_ARENA, NULL, &mode, sizeof(int)) < 0)
+        return CPU_MEM_ARENA_OFF;
+
+    return mode;
+}
+
+static int get_graph_inter_op_thread(struct ir_graph* ir_graph)
+{
+    int inter_op_thread = 0;
+
+    if (ir_graph->attr_num == 0)
+        return 0;
+
+    if (get_attr_val(ir_graph->attr_mem, ir_graph->attr_num, GRAPH_ATTR_CPU_INTER_OP_THREAD, NULL, &inter_op_thread,
+                     sizeof(int)) < 0)
+        return 0;
+
+    return inter_op_thread;
+}
+
+/* the directory to persist the packed weights in, or NULL */
+static const char* get_graph_weight_cache_dir(struct ir_graph* ir_graph)
+{
+    const char* dir = NULL;
+
+    if (ir_graph->attr_num == 0)
+        return NULL;
+
+    if (get_attr_val(ir_graph->attr_mem, ir_graph->attr_num, GRAPH_ATTR_WEIGHT_CACHE_DIR, NULL, &dir,
+                     sizeof(const char*)) < 0)
+        return NULL;
+
+    return dir;
+}
+
+/* the key to share the packed weights with, or NULL to keep them private */
+static const char* get_graph_weight_key(struct ir_graph* ir_graph)
+{
+    int share = 0;
+
+    if (ir_graph->attr_num == 0 || ir_graph->model_key == NULL)
+        return NULL;
+
+    /* the persisted weights are shared as well */
+    if (get_graph_weight_cache_dir(ir_graph) != NULL)
+        return ir_graph->model_key;
+
+    if (get_attr_val(ir_graph->attr_mem, ir_graph->attr_num, GRAPH_ATTR_SHARE_WEIGHTS, NULL, &share, sizeof(int)) < 0 ||
+        share == 0)
+        return NULL;
+
+    return ir_graph->model_key;
+}
+
+static void* map_arena_mem(size_t size, int mode, size_t* mapped_size)
+{
+#ifdef __linux__
+    size_t page_size = sysconf(_SC_PAGESIZE);
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    void* addr = MAP_FAILED;
+
+#ifdef MAP_POPULATE
+    /* take the page faults here instead of in the first run */
+    flags |= MAP_POPULATE;
+#endif
+
+#ifdef MAP_HUGETLB
+    if (mode == CPU_MEM_ARENA_HUGETLB)
+    {
+        size_t huge_size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+
+        addr = mmap(NULL, huge_size, PROT_READ | PROT_WRITE, flags | MAP_HUGETLB, -1, 0);
+
+        if (addr != MAP_FAILED)
+        {
+            *mapped_size = huge_size;
+            return addr;
+        }
+
+        TLOG_INFO("no hugetlbfs page for arena of %zu bytes, use transparent huge page\n", huge_size);
+        mode = CPU_MEM_ARENA_HUGEPAGE;
+    }
+#endif
+
+    if (mode == CPU_MEM_ARENA_HUGEPAGE)
+    {
+        /* over map to cut a huge page aligned range, so that the whole arena can be backed by huge pages */
+        size_t huge_size = (size + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+        size_t map_size = huge_size + HUGE_PAGE_SIZE;
+        char* base = mmap(NULL, map_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+        if (base == MAP_FAILED)
+            return NULL;
+
+        char* aligned = ( char* )((( size_t )base + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1));
+
+        if (aligned > base)
+            munmap(base, aligned - base);
+        if (base + map_size > aligned + huge_size)
+            munmap(aligned + huge_size, base + map_size - aligned - huge_size);
+
+#ifdef MADV_HUGEPAGE
+        madvise(aligned, huge_size, MADV_HUGEPAGE);
+#endif
+        /* touch once, the pages are faulted in huge page granularity */
+        memset(aligned, 0, huge_size);
+
+        *mapped_size = huge_size;
+        return aligned;
+    }
+
+    size = (size + page_size - 1) & ~(page_size - 1);
+    addr = mmap(NULL, size, PROT_READ | PROT_WRITE, flags, -1, 0);
+
+    if (addr == MAP_FAILED)
+        return NULL;
+
+    *mapped_size = size;
+    return addr;
+#else
+    *mapped_size = size;
+    return sys_malloc(size);
+#endif
+}
+
+static void unmap_arena_mem(void* addr, size_t size)
+{
+#ifdef __linux__
+    munmap(addr, size);
+#else
+    sys_free(addr);
+#endif
+}
+
 static struct exec_graph* new_exec_graph(void)
 {
     struct exec_graph* exec_graph = ( struct exec_graph* )sys_malloc(sizeof(struct exec_graph));
@@ -1204,9 +1375,18 @@ static struct exec_graph* new_exec_graph(void)
         return NULL;
 
     exec_graph->exec_node_list = create_vector(sizeof(struct exec_node), NULL);
+    exec_graph->view_list = create_vector(sizeof(struct tensor_view), NULL);
+    exec_graph->view_root_list = create_vector(sizeof(struct view_root), NULL);
 
-    if (exec_graph->exec_node_list == NULL)
+    if (exec_graph->exec_node_list == NULL || exec_graph->view_list == NULL || exec_graph->view_root_list == NULL)
     {
+        if (exec_graph->exec_node_list)
+            release_vector(exec_graph->exec_node_list);
+        if (exec_graph->view_list)
+            release_vector(exec_graph->view_list);
+        if (exec_graph->view_root_list)
+            release_vector(exec_graph->view_root_list);
+
         sys_free(exec_graph);
         return NULL;
     }
@@ -1218,11 +1398,54 @@ static struct exec_graph* new_exec_graph(void)
     exec_graph->shared_pack4_mem = NULL;
     exec_graph->shared_pack4_mem_size = 0;
 
+    exec_graph->mem_arena = NULL;
+    exec_graph->mem_arena_size = 0;
+    exec_graph->mem_arena_mode = CPU_MEM_ARENA_OFF;
+
+    exec_graph->ctx_arena = NULL;
+    exec_graph->ctx_arena_gen = 0;
+
+    exec_graph->weight_key = NULL;
+    exec_graph->weight_cache_dir = NULL;
+
+    exec_graph->thread_pool = NULL;
+    exec_graph->inter_op = NULL;
+
     return exec_graph;
 }
 
 static void free_exec_graph_mem(struct exec_graph* graph)
 {
+    /* the last graph leaving the context arena releases it */
+    if (graph->ctx_arena)
+    {
+        struct shared_mem_arena* arena = graph->ctx_arena;
+
+        arena->ref_count--;
+
+        if (arena->ref_count == 0 && arena->mem != NULL)
+        {
+            unmap_arena_mem(arena->mem, arena->mem_size);
+            arena->mem = NULL;
+            arena->mem_size = 0;
+            arena->generation++;
+        }
+
+        graph->ctx_arena = NULL;
+        graph->shared_mem = NULL;
+        graph->shared_pack4_mem = NULL;
+    }
+
+    /* the shared memory is inside the arena */
+    if (graph->mem_arena)
+    {
+        unmap_arena_mem(graph->mem_arena, graph->mem_arena_size);
+        graph->mem_arena = NULL;
+        graph->mem_arena_size = 0;
+        graph->shared_mem = NULL;
+        graph->shared_pack4_mem = NULL;
+    }
+
     /* free the shared memory */
     if (graph->shared_mem)
     {
@@ -1263,6 +1486,13 @@ static void release_exec_graph(void* exec_graph)
     free_exec_graph_mem(graph);
 
     release_vector(graph->exec_node_list);
+    release_vector(graph->view_list);
+    release_vector(graph->view_root_list);
+
+    free(graph->weight_cache_dir);
+
+    release_inter_op_exec(graph->inter_op);
+    destroy_thread_pool(graph->thread_pool);
 
     sys_free(graph);
 }
@@ -1285,6 +1515,11 @@ static struct exec_graph* create_exec_graph(struct subgraph* subgraph, int num_t
     exec_graph->num_thread = num_thread;
     exec_graph->cpu_affinity = cpu_affinity;
     exec_graph->mode = mode;
+    exec_graph->mem_arena_mode = get_graph_mem_arena_mode(ir_graph);
+    exec_graph->weight_key = get_graph_weight_key(ir_graph);
+
+    if (exec_graph->weight_key != NULL && get_graph_weight_cache_dir(ir_graph) != NULL)
+        exec_graph->weight_cache_dir = strdup(get_graph_weight_cache_dir(ir_graph));
 
     for (int i = 0; i < node_num; i++)
     {
@@ -1351,119 +1586,313 @@ static int find_inplace_input(struct exec_node* exec_node, int output_slot, stru
 
     struct ir_tensor* tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[input_slot]);
 
-    if (tensor->consumer_num > 1)
+    if (get_tensor_use_count(ir_graph, tensor) > 1)
         return -1;
 
     return input_slot;
 }
 
+#ifdef DEBUG_MEM_PLAN
+static int mem_pool_legacy_size(struct mem_pool* mem_pool)
+{
+    /* replay the block lifetimes with the old first-fit policy:
+       a block is reused only when all tensors on it are freed, and it grows to the largest request */
+    int block_num = get_vector_num(mem_pool->block_list);
+    int* legacy_size = ( int* )sys_malloc(sizeof(int) * (block_num + 1));
+    int* legacy_busy = ( int* )sys_malloc(sizeof(int) * (block_num + 1));
+    int* legacy_map = ( int* )sys_malloc(sizeof(int) * (block_num + 1));
+    int legacy_num = 0;
+    int total = 0;
+
+    if (legacy_size == NULL || legacy_busy == NULL || legacy_map == NULL)
+    {
+        sys_free(legacy_size);
+        sys_free(legacy_busy);
+        sys_free(legacy_map);
+        return -1;
+    }
+
+    for (int step = 0; step <= mem_pool->step_num; step++)
+    {
+        for (int i = 0; i < block_num; i++)
+        {
+            struct mem_block_entry* entry = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, i);
+
+            if (entry->alloc_step != step)
+                continue;
+
+            int j;
+            for (j = 0; j < legacy_num; j++)
+            {
+                if (!legacy_busy[j])
+                    break;
+            }
+
+            if (j == legacy_num)
+            {
+                legacy_size[j] = 0;
+                legacy_num++;
+            }
+
+            if (legacy_size[j] < entry->size)
+                legacy_size[j] = entry->size;
+
+            legacy_busy[j] = 1;
+            legacy_map[i] = j;
+        }
+
+        for (int i = 0; i < block_num; i++)
+        {
+            struct mem_block_entry* entry = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, i);
+
+            if (entry->free_step == step)
+                legacy_busy[legacy_map[i]] = 0;
+        }
+    }
+
+    for (int i = 0; i < legacy_num; i++)
+        total += legacy_size[i];
+
+    sys_free(legacy_size);
+    sys_free(legacy_busy);
+    sys_free(legacy_map);
+
+    return total;
+}
+#endif
+
 static void mem_pool_dump(struct mem_pool* mem_pool)
 {
     int block_number = get_vector_num(mem_pool->block_list);
 
-    TLOG_INFO("block number: %d align size: %d\n", block_number, mem_pool->align_size);
+    TLOG_INFO("block number: %d align size: %d arena: %p\n", block_number, mem_pool->align_size, mem_pool->arena);
 
     for (int i = 0; i < block_number; i++)
     {
         struct mem_block_entry* entry = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, i);
 
-        TLOG_INFO("%d: %p (%d) used: %d free: %d\n", i, entry->addr, entry->block_size, entry->alloc_count,
-                  entry->free_count);
+        TLOG_INFO("%d: offset: %d size: %d live: [%d, %d]%s\n", i, entry->offset, entry->size, entry->alloc_step,
+                  entry->free_step, entry->keep ? " private" : "");
     }
+
+    if (mem_pool->keep_size > 0)
+        TLOG_INFO("private blocks size: %d\n", mem_pool->keep_size);
+
+#ifdef DEBUG_MEM_PLAN
+    int legacy_size = mem_pool_legacy_size(mem_pool);
+
+    TLOG_INFO("planned arena size: %d, first-fit block list: %d, saved: %d\n", mem_pool->arena_size, legacy_size,
+              legacy_size - mem_pool->arena_size);
+#else
+    TLOG_INFO("planned arena size: %d\n", mem_pool->arena_size);
+#endif
 }
 
 static void* mem_pool_get_mem_block(struct mem_pool* mem_pool, int block_id)
 {
     struct mem_block_entry* entry = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, block_id);
 
-    unsigned long addr = ( long )(entry->addr);
-    unsigned long aligned_addr = (addr + 4 + mem_pool->align_size) & (~(mem_pool->align_size - 1));
+    unsigned long addr = ( long )(entry->keep ? mem_pool->keep_mem : mem_pool->arena);
+    unsigned long aligned_addr = (addr + mem_pool->align_size - 1) & (~(mem_pool->align_size - 1));
 
-    return ( void* )aligned_addr;
+    return ( void* )(aligned_addr + entry->offset);
 }
 
-static int mem_pool_get_backend_mem(struct mem_pool* mem_pool)
+static int block_overlap(struct mem_pool* mem_pool, int a_id, int b_id)
 {
-    int block_num = get_vector_num(mem_pool->block_list);
-
-    for (int i = 0; i < block_num; i++)
-    {
-        struct mem_block_entry* entry = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, i);
-
-        entry->block_size = entry->max_req_size + mem_pool->align_size + 128;
+    struct mem_block_entry* a = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, a_id);
+    struct mem_block_entry* b = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, b_id);
 
-        entry->addr = sys_malloc(entry->block_size);
+    if (a->alloc_step <= b->free_step && b->alloc_step <= a->free_step)
+        return 1;
 
-        if (entry->addr == NULL)
-            return -1;
+    /* the nodes after the last step of one may run with the nodes of the other */
+    if (mem_pool->inter_op != NULL)
+    {
+        if (a->free_step < b->alloc_step)
+            return !is_block_ordered(mem_pool->inter_op, a_id, b_id);
+        else
+            return !is_block_ordered(mem_pool->inter_op, b_id, a_id);
     }
 
     return 0;
 }
 
-static int mem_pool_allocate(struct mem_pool* mem_pool, int size)
+/* greedy by size: place the big blocks first, each into the tightest gap left by
+   the already placed blocks whose lifetime overlaps with it.
+   the kept blocks are planned the same way, in their own space */
+static int mem_pool_plan(struct mem_pool* mem_pool)
 {
     int block_num = get_vector_num(mem_pool->block_list);
-    ;
+
+    if (block_num == 0)
+        return 0;
+
+    int* order = ( int* )sys_malloc(sizeof(int) * block_num);
+    int* live = ( int* )sys_malloc(sizeof(int) * block_num);
+
+    if (order == NULL || live == NULL)
+    {
+        sys_free(order);
+        sys_free(live);
+        return -1;
+    }
 
     for (int i = 0; i < block_num; i++)
+        order[i] = i;
+
+    for (int i = 1; i < block_num; i++)
     {
-        struct mem_block_entry* entry = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, i);
+        int id = order[i];
+        struct mem_block_entry* e = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, id);
+        int j = i - 1;
 
-        if (entry->free_count != entry->alloc_count)
-            continue;
+        while (j >= 0)
+        {
+            struct mem_block_entry* p = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, order[j]);
+
+            if (p->size > e->size || (p->size == e->size && p->alloc_step <= e->alloc_step))
+                break;
+
+            order[j + 1] = order[j];
+            j--;
+        }
+
+        order[j + 1] = id;
+    }
+
+    int arena_size = 0;
+    int keep_size = 0;
+
+    for (int i = 0; i < block_num; i++)
+    {
+        struct mem_block_entry* e = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, order[i]);
+        int live_num = 0;
+
+        /* collect placed blocks alive at the same time, sorted by offset */
+        for (int j = 0; j < i; j++)
+        {
+            struct mem_block_entry* p = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, order[j]);
+
+            if (p->keep != e->keep || !block_overlap(mem_pool, order[i], order[j]))
+                continue;
+
+            int k = live_num - 1;
+
+            while (k >= 0)
+            {
+                struct mem_block_entry* q = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, live[k]);
+
+                if (q->offset <= p->offset)
+                    break;
+
+                live[k + 1] = live[k];
+                k--;
+            }
+
+            live[k + 1] = order[j];
+            live_num++;
+        }
+
+        int best_offset = -1;
+        int best_gap = 0;
+        int prev_end = 0;
+
+        for (int j = 0; j < live_num; j++)
+        {
+            struct mem_block_entry* p = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, live[j]);
+            int gap = p->offset - prev_end;
 
-        /* TODO: use the best match alg */
+            if (gap >= e->size && (best_offset < 0 || gap < best_gap))
+            {
+                best_offset = prev_end;
+                best_gap = gap;
+            }
+
+            if (p->offset + p->size > prev_end)
+                prev_end = p->offset + p->size;
+        }
 
-        entry->alloc_count++;
+        if (best_offset < 0)
+            best_offset = prev_end;
 
-        if (entry->max_req_size < size)
-            entry->max_req_size = size;
+        e->offset = best_offset;
 
-        return i;
+        if (e->keep)
+        {
+            if (e->offset + e->size > keep_size)
+                keep_size = e->offset + e->size;
+        }
+        else if (e->offset + e->size > arena_size)
+            arena_size = e->offset + e->size;
     }
 
-    /* create new block */
+    sys_free(order);
+    sys_free(live);
+
+    mem_pool->arena_size = arena_size;
+    mem_pool->keep_size = keep_size;
+
+    return 0;
+}
+
+static int mem_pool_get_backend_mem(struct mem_pool* mem_pool)
+{
+    if (mem_pool_plan(mem_pool) < 0)
+        return -1;
+
+    if (mem_pool->arena_size == 0)
+        return 0;
+
+    mem_pool->arena = sys_malloc(mem_pool->arena_size + mem_pool->align_size);
+    mem_pool->own_arena = 1;
+
+    if (mem_pool->arena == NULL)
+        return -1;
+
+    return 0;
+}
+
+static int mem_pool_allocate(struct mem_pool* mem_pool, int size, int step)
+{
+    int block_num = get_vector_num(mem_pool->block_list);
 
     struct mem_block_entry e;
 
-    e.addr = NULL;
-    e.max_req_size = size;
-    e.alloc_count = 1;
-    e.free_count = 0;
+    /* the tail guard keeps the slack the old per block malloc had for vector over-write */
+    e.offset = 0;
+    e.size = ((size + mem_pool->align_size - 1) & (~(mem_pool->align_size - 1))) + MEM_BLOCK_GUARD_SIZE;
+    e.alloc_step = step;
+    e.free_step = mem_pool->step_num;
+    e.keep = 0;
 
     push_vector_data(mem_pool->block_list, &e);
 
     return block_num;
 }
 
-static void mem_pool_free(struct mem_pool* mem_pool, int block_id)
+static void mem_pool_free(struct mem_pool* mem_pool, int block_id, int step)
 {
     struct mem_block_entry* block = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, block_id);
 
-    block->free_count++;
+    block->free_step = step;
 }
 
 static void release_mem_pool(struct mem_pool* mem_pool)
 {
     if (mem_pool->block_list != NULL)
-    {
-        int block_num = get_vector_num(mem_pool->block_list);
-
-        for (int i = 0; i < block_num; i++)
-        {
-            struct mem_block_entry* entry = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, i);
+        release_vector(mem_pool->block_list);
 
-            sys_free(entry->addr);
-        }
+    if (mem_pool->own_arena)
+        sys_free(mem_pool->arena);
 
-        release_vector(mem_pool->block_list);
-    }
+    if (mem_pool->keep_mem != NULL)
+        sys_free(mem_pool->keep_mem);
 
     sys_free(mem_pool);
 }
 
-static struct mem_pool* create_mem_pool(void)
+static struct mem_pool* create_mem_pool(int step_num)
 {
     struct mem_pool* mem_pool = ( struct mem_pool* )sys_malloc(sizeof(struct mem_pool));
 
@@ -1471,6 +1900,13 @@ static struct mem_pool* create_mem_pool(void)
         return NULL;
 
     mem_pool->align_size = 16;
+    mem_pool->arena = NULL;
+    mem_pool->arena_size = 0;
+    mem_pool->own_arena = 0;
+    mem_pool->keep_mem = NULL;
+    mem_pool->keep_size = 0;
+    mem_pool->inter_op = NULL;
+    mem_pool->step_num = step_num;
     mem_pool->block_list = create_vector(sizeof(struct mem_block_entry), NULL);
 
     if (mem_pool->block_list == NULL)
@@ -1479,6 +1915,7 @@ static struct mem_pool* create_mem_pool(void)
     mem_pool->allocate = mem_pool_allocate;
     mem_pool->free = mem_pool_free;
     mem_pool->dump = mem_pool_dump;
+    mem_pool->plan = mem_pool_plan;
     mem_pool->get_backend_mem = mem_pool_get_backend_mem;
     mem_pool->get_mem_block = mem_pool_get_mem_block;
 
@@ -1491,77 +1928,780 @@ error:
     return NULL;
 }
 
-static int alloc_exec_graph_mem(struct exec_graph* exec_graph)
+/* put the pool blocks and both shared scratch buffers in one mapping */
+static int alloc_exec_graph_arena(struct exec_graph* exec_graph)
 {
-    struct mem_pool* mem_pool;
-    int max_shared_mem_size = 0;
-    int max_shared_pack4_mem_size = 0;
+    struct mem_pool* mem_pool = exec_graph->mem_pool;
 
-    int node_num = get_vector_num(exec_graph->exec_node_list);
+    if (mem_pool->plan(mem_pool) < 0)
+        return -1;
 
-    struct vector* tensor_mem_list = create_vector(sizeof(struct mem_record), NULL);
+    size_t align = mem_pool->align_size;
+    size_t pool_size = (mem_pool->arena_size + align - 1) & ~(align - 1);
+    size_t shared_size = (exec_graph->shared_mem_size + align - 1) & ~(align - 1);
+    size_t pack4_size = (exec_graph->shared_pack4_mem_size + align - 1) & ~(align - 1);
+    size_t total_size = pool_size + shared_size + pack4_size;
 
-    if (tensor_mem_list == NULL)
-        return -1;
+    if (total_size == 0)
+        return 0;
 
-    mem_pool = create_mem_pool();
+    char* arena = map_arena_mem(total_size, exec_graph->mem_arena_mode, &exec_graph->mem_arena_size);
 
-    if (mem_pool == NULL)
+    if (arena == NULL)
         return -1;
 
-    exec_graph->mem_pool = mem_pool;
+    exec_graph->mem_arena = arena;
 
-    for (int i = 0; i < node_num; i++)
-    {
-        struct exec_node* exec_node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, i);
-        struct ir_node* ir_node = exec_node->ir_node;
-        struct ir_graph* ir_graph = ir_node->graph;
+    mem_pool->arena = arena;
+    mem_pool->own_arena = 0;
 
-        int8_t* block_id;
+    if (shared_size > 0)
+        exec_graph->shared_mem = arena + pool_size;
+    if (pack4_size > 0)
+        exec_graph->shared_pack4_mem = arena + pool_size + shared_size;
 
-        if (exec_node->output_num > 4)
-            block_id = exec_node->block_id_ptr;
-        else
-            block_id = exec_node->block_id;
+    TLOG_DEBUG("memory arena: %p size=%zu mode=%d\n", arena, exec_graph->mem_arena_size, exec_graph->mem_arena_mode);
 
-        for (int j = 0; j < ir_node->output_num; j++)
-        {
-            struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j]);
+    return 0;
+}
 
-            if (ir_tensor->data != NULL)
-                continue;
+/* point the shared memory of the graph into the context arena */
+static void set_ctx_arena_mem(struct exec_graph* exec_graph)
+{
+    struct mem_pool* mem_pool = exec_graph->mem_pool;
+    char* mem = ( char* )exec_graph->ctx_arena->mem;
 
-            int inplace_input = find_inplace_input(exec_node, j, ir_node, ir_graph);
+    size_t align = mem_pool->align_size;
+    size_t pool_size = (mem_pool->arena_size + align - 1) & ~(align - 1);
+    size_t shared_size = (exec_graph->shared_mem_size + align - 1) & ~(align - 1);
 
-            if (inplace_input >= 0)
-            {
-                struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[inplace_input]);
+    mem_pool->arena = mem;
 
-                int idx = find_tensor_mem_list(tensor_mem_list, input_tensor);
+    if (exec_graph->shared_mem_size > 0)
+        exec_graph->shared_mem = mem + pool_size;
+    if (exec_graph->shared_pack4_mem_size > 0)
+        exec_graph->shared_pack4_mem = mem + pool_size + shared_size;
 
-                /* if the input is from outside buffer, input_r should be NULL */
-                if (idx < 0)
-                    continue;
+    exec_graph->ctx_arena_gen = exec_graph->ctx_arena->generation;
+}
 
-                struct mem_record* input_r = ( struct mem_record* )get_vector_data(tensor_mem_list, idx);
+/* the transient blocks and the shared scratch go to the arena of the context, sized to the
+   largest graph, while blocks still alive after the last node stay private to the graph,
+   so the outputs survive the run of another graph */
+static int alloc_exec_graph_ctx_arena(struct exec_graph* exec_graph, struct shared_mem_arena* arena)
+{
+    struct mem_pool* mem_pool = exec_graph->mem_pool;
+    int block_num = get_vector_num(mem_pool->block_list);
 
-                input_r->ir_tensor = ir_tensor;
-                input_r->used = ir_tensor->consumer_num;
-                block_id[j] = INPLACE_BLOCK_FLAG | inplace_input;
-                continue;
-            }
+    for (int i = 0; i < block_num; i++)
+    {
+        struct mem_block_entry* entry = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, i);
+
+        if (entry->free_step == mem_pool->step_num)
+            entry->keep = 1;
+    }
+
+    if (mem_pool->plan(mem_pool) < 0)
+        return -1;
+
+    if (mem_pool->keep_size > 0)
+    {
+        mem_pool->keep_mem = sys_malloc(mem_pool->keep_size + mem_pool->align_size);
+
+        if (mem_pool->keep_mem == NULL)
+            return -1;
+    }
+
+    size_t align = mem_pool->align_size;
+    size_t pool_size = (mem_pool->arena_size + align - 1) & ~(align - 1);
+    size_t shared_size = (exec_graph->shared_mem_size + align - 1) & ~(align - 1);
+    size_t pack4_size = (exec_graph->shared_pack4_mem_size + align - 1) & ~(align - 1);
+    size_t total_size = pool_size + shared_size + pack4_size + align;
+
+    /* the graphs using the old mapping rebind before their next run */
+    if (arena->mem_size < total_size)
+    {
+        size_t mapped_size;
+        void* mem = map_arena_mem(total_size, exec_graph->mem_arena_mode, &mapped_size);
+
+        if (mem == NULL)
+            return -1;
+
+        if (arena->mem != NULL)
+            unmap_arena_mem(arena->mem, arena->mem_size);
+
+        arena->mem = mem;
+        arena->mem_size = mapped_size;
+        arena->generation++;
+    }
+
+    arena->ref_count++;
+    exec_graph->ctx_arena = arena;
+
+    set_ctx_arena_mem(exec_graph);
+
+    TLOG_DEBUG("context arena: %p size=%zu users=%d, graph needs %zu\n", arena->mem, arena->mem_size,
+               arena->ref_count, total_size);
+
+    return 0;
+}
+
+static int find_tensor_view(struct exec_graph* exec_graph, int tensor_idx)
+{
+    int view_num = get_vector_num(exec_graph->view_list);
+
+    for (int i = 0; i < view_num; i++)
+    {
+        struct tensor_view* view = ( struct tensor_view* )get_vector_data(exec_graph->view_list, i);
+
+        if (view->tensor_idx == tensor_idx)
+            return i;
+    }
+
+    return -1;
+}
+
+/* the number of views directly inside the tensor */
+static int get_tensor_view_num(struct exec_graph* exec_graph, int tensor_idx)
+{
+    int view_num = get_vector_num(exec_graph->view_list);
+    int count = 0;
+
+    for (int i = 0; i < view_num; i++)
+    {
+        struct tensor_view* view = ( struct tensor_view* )get_vector_data(exec_graph->view_list, i);
+
+        if (view->parent_idx == tensor_idx)
+            count++;
+    }
+
+    return count;
+}
+
+static void add_tensor_view(struct exec_graph* exec_graph, int tensor_idx, int parent_idx, int offset)
+{
+    struct tensor_view view;
+
+    view.tensor_idx = tensor_idx;
+    view.parent_idx = parent_idx;
+    view.offset = offset;
+
+    push_vector_data(exec_graph->view_list, &view);
+}
+
+/* the tensor owning the buffer of a view, and the offset of the view inside it */
+static struct ir_tensor* get_view_root(struct exec_graph* exec_graph, struct ir_graph* ir_graph,
+                                       struct ir_tensor* ir_tensor, int* offset)
+{
+    int root_offset = 0;
+
+    while (1)
+    {
+        int view_idx = find_tensor_view(exec_graph, ir_tensor->idx);
+
+        if (view_idx < 0)
+            break;
+
+        struct tensor_view* view = ( struct tensor_view* )get_vector_data(exec_graph->view_list, view_idx);
+
+        root_offset += view->offset;
+        ir_tensor = get_ir_graph_tensor(ir_graph, view->parent_idx);
+    }
+
+    if (offset)
+        *offset = root_offset;
+
+    return ir_tensor;
+}
+
+static int is_view_member(struct exec_graph* exec_graph, int tensor_idx)
+{
+    return find_tensor_view(exec_graph, tensor_idx) >= 0 || get_tensor_view_num(exec_graph, tensor_idx) > 0;
+}
+
+/* how many times the block of a root is read: by the nodes still executed, for the root and all views
+   inside, plus one if any of them is a graph output */
+static int get_tree_use_count(struct exec_graph* exec_graph, struct ir_graph* ir_graph, int* step_map,
+                              struct ir_tensor* root)
+{
+    int view_num = get_vector_num(exec_graph->view_list);
+    int count = 0;
+    int live_out = 0;
+
+    for (int i = -1; i < view_num; i++)
+    {
+        struct ir_tensor* ir_tensor = root;
+
+        if (i >= 0)
+        {
+            struct tensor_view* view = ( struct tensor_view* )get_vector_data(exec_graph->view_list, i);
+
+            ir_tensor = get_ir_graph_tensor(ir_graph, view->tensor_idx);
+
+            if (get_view_root(exec_graph, ir_graph, ir_tensor, NULL) != root)
+                continue;
+        }
+
+        for (int k = 0; k < ir_tensor->consumer_num; k++)
+        {
+            if (step_map[ir_tensor->consumer[k]] != NODE_REMOVED)
+                count++;
+        }
+
+        if (get_tensor_use_count(ir_graph, ir_tensor) > ir_tensor->consumer_num)
+            live_out = 1;
+    }
+
+    return count + live_out;
+}
+
+/* follow a concat input up to the tensor owning the buffer: through the in-place outputs,
+   the views of whole tensors and the inner concats done in place */
+static struct ir_tensor* find_slice_owner(struct exec_graph* exec_graph, struct ir_graph* ir_graph, int* step_map,
+                                          struct ir_tensor* ir_tensor)
+{
+    while (1)
+    {
+        if (ir_tensor->data != NULL || ir_tensor->tensor_type != TENSOR_TYPE_VAR || ir_tensor->producer < 0)
+            return NULL;
+
+        int view_idx = find_tensor_view(exec_graph, ir_tensor->idx);
+
+        if (view_idx >= 0)
+        {
+            struct tensor_view* view = ( struct tensor_view* )get_vector_data(exec_graph->view_list, view_idx);
+            struct ir_tensor* parent = get_ir_graph_tensor(ir_graph, view->parent_idx);
+
+            if (view->offset != 0 || parent->elem_num * parent->elem_size != ir_tensor->elem_num * ir_tensor->elem_size ||
+                get_tensor_use_count(ir_graph, parent) != 1 || get_tensor_view_num(exec_graph, parent->idx) != 1)
+                return NULL;
+
+            ir_tensor = parent;
+            continue;
+        }
+
+        int step = step_map[ir_tensor->producer];
+
+        if (step == NODE_REMOVED)
+            return get_tensor_view_num(exec_graph, ir_tensor->idx) > 0 ? ir_tensor : NULL;
+
+        if (step < 0)
+            return NULL;
+
+        struct exec_node* exec_node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, step);
+        struct ir_node* ir_node = exec_node->ir_node;
+        int slot = 0;
+
+        while (ir_node->output_tensors[slot] != ir_tensor->idx)
+            slot++;
+
+        int input_slot = find_inplace_input(exec_node, slot, ir_node, ir_graph);
+
+        if (input_slot < 0)
+            return ir_tensor;
+
+        ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[input_slot]);
+    }
+}
+
+/* the in-place outputs between a concat input and its owner become views as well */
+static void link_slice_chain(struct exec_graph* exec_graph, struct ir_graph* ir_graph, int* step_map,
+                             struct ir_tensor* ir_tensor, struct ir_tensor* owner)
+{
+    while (ir_tensor != owner)
+    {
+        int view_idx = find_tensor_view(exec_graph, ir_tensor->idx);
+
+        if (view_idx >= 0)
+        {
+            struct tensor_view* view = ( struct tensor_view* )get_vector_data(exec_graph->view_list, view_idx);
+
+            ir_tensor = get_ir_graph_tensor(ir_graph, view->parent_idx);
+            continue;
+        }
+
+        struct exec_node* exec_node =
+            ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, step_map[ir_tensor->producer]);
+        struct ir_node* ir_node = exec_node->ir_node;
+        int slot = 0;
+
+        while (ir_node->output_tensors[slot] != ir_tensor->idx)
+            slot++;
+
+        int input_slot = find_inplace_input(exec_node, slot, ir_node, ir_graph);
+
+        add_tensor_view(exec_graph, ir_tensor->idx, ir_node->input_tensors[input_slot], 0);
+
+        ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[input_slot]);
+    }
+}
+
+/* if the concat can be done in place, return the owner tensors of its inputs in owner_list */
+static int check_concat_in_place(struct exec_graph* exec_graph, struct ir_node* ir_node, int* step_map,
+                                 struct ir_tensor** owner_list)
+{
+    struct ir_graph* ir_graph = ir_node->graph;
+    struct ir_tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct concat_param* concat_param = ( struct concat_param* )ir_node->op.param_mem;
+    int align = exec_graph->mem_pool->align_size;
+
+    if (output_tensor->data != NULL || concat_param->axis < 0 || concat_param->axis >= output_tensor->dim_num)
+        return 0;
+
+    /* the slices are contiguous only if nothing is outside the axis */
+    for (int i = 0; i < concat_param->axis; i++)
+    {
+        if (output_tensor->dims[i] != 1)
+            return 0;
+    }
+
+    int offset = 0;
+
+    for (int i = 0; i < ir_node->input_num; i++)
+    {
+        struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]);
+
+        if (get_tensor_use_count(ir_graph, input_tensor) != 1 || input_tensor->data_type != output_tensor->data_type)
+            return 0;
+
+        /* requantized while copied */
+        if (input_tensor->data_type != TENGINE_DT_FP32 && input_tensor->data_type != TENGINE_DT_FP16 &&
+            (input_tensor->scale != output_tensor->scale || input_tensor->zero_point != output_tensor->zero_point))
+            return 0;
+
+        owner_list[i] = find_slice_owner(exec_graph, ir_graph, step_map, input_tensor);
+
+        if (owner_list[i] == NULL)
+            return 0;
+
+        /* the same tensor twice */
+        for (int j = 0; j < i; j++)
+        {
+            if (owner_list[j] == owner_list[i])
+                return 0;
+        }
+
+        /* keep the slices aligned as the pool blocks for the vector stores */
+        if (offset % align)
+            return 0;
+
+        offset += input_tensor->elem_num * input_tensor->elem_size;
+    }
+
+    return offset == output_tensor->elem_num * output_tensor->elem_size;
+}
+
+/* let the producers of a concat write into the slices of its output */
+static int plan_concat_view(struct exec_graph* exec_graph, struct ir_node* ir_node, int* step_map)
+{
+    struct ir_graph* ir_graph = ir_node->graph;
+    struct ir_tensor** owner_list = ( struct ir_tensor** )sys_malloc(sizeof(struct ir_tensor*) * ir_node->input_num);
+
+    if (owner_list == NULL)
+        return -1;
+
+    if (!check_concat_in_place(exec_graph, ir_node, step_map, owner_list))
+    {
+        sys_free(owner_list);
+        return 0;
+    }
+
+    int offset = 0;
+
+    for (int i = 0; i < ir_node->input_num; i++)
+    {
+        struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[i]);
+
+        link_slice_chain(exec_graph, ir_graph, step_map, input_tensor, owner_list[i]);
+        add_tensor_view(exec_graph, owner_list[i]->idx, ir_node->output_tensors[0], offset);
+
+        offset += input_tensor->elem_num * input_tensor->elem_size;
+    }
+
+    sys_free(owner_list);
+
+    return 1;
+}
+
+/* the outputs of the shape only nodes are the input, or contiguous parts of it */
+static int get_shape_view_offset(struct ir_node* ir_node, struct ir_tensor* input_tensor, int* offset_list)
+{
+    struct ir_graph* ir_graph = ir_node->graph;
+    int axis = -1;
+
+    switch (ir_node->op.op_type)
+    {
+        case OP_RESHAPE:
+            /* transposed while copied */
+            if (ir_graph->model_layout == TENGINE_LAYOUT_NHWC)
+                return 0;
+        case OP_FLATTEN:
+        case OP_SQUEEZE:
+        case OP_UNSQUEEZE:
+        case OP_EXPANDDIMS:
+            offset_list[0] = 0;
+            return 1;
+        case OP_SPLIT: {
+            struct split_param* split_param = ( struct split_param* )ir_node->op.param_mem;
+
+            if (split_param->is_caffe)
+            {
+                for (int i = 0; i < ir_node->output_num; i++)
+                    offset_list[i] = 0;
+
+                return 1;
+            }
+
+            axis = split_param->axis;
+            break;
+        }
+        case OP_SLICE: {
+            struct slice_param* slice_param = ( struct slice_param* )ir_node->op.param_mem;
+
+            if (!slice_param->iscaffe)
+                return 0;
+
+            axis = slice_param->axis;
+            break;
+        }
+        default:
+            return 0;
+    }
+
+    if (axis < 0 || axis >= input_tensor->dim_num)
+        return 0;
+
+    for (int i = 0; i < axis; i++)
+    {
+        if (input_tensor->dims[i] != 1)
+            return 0;
+    }
+
+    int offset = 0;
+
+    for (int i = 0; i < ir_node->output_num; i++)
+    {
+        struct ir_tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[i]);
+
+        offset_list[i] = offset;
+        offset += output_tensor->elem_num * output_tensor->elem_size;
+    }
+
+    return 1;
+}
+
+/* make the outputs of a shape only node views of its input */
+static int plan_shape_view(struct exec_graph* exec_graph, struct ir_node* ir_node, int* step_map)
+{
+    struct ir_graph* ir_graph = ir_node->graph;
+    struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    int align = exec_graph->mem_pool->align_size;
+    int input_size = input_tensor->elem_num * input_tensor->elem_size;
+
+    /* the input must be planned here too */
+    if (input_tensor->data != NULL || input_tensor->tensor_type != TENSOR_TYPE_VAR || input_tensor->producer < 0 ||
+        step_map[input_tensor->producer] == -1)
+        return 0;
+
+    int* offset_list = ( int* )sys_malloc(sizeof(int) * ir_node->output_num);
+
+    if (offset_list == NULL)
+        return -1;
+
+    if (!get_shape_view_offset(ir_node, input_tensor, offset_list))
+    {
+        sys_free(offset_list);
+        return 0;
+    }
+
+    for (int i = 0; i < ir_node->output_num; i++)
+    {
+        struct ir_tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[i]);
+        int output_size = output_tensor->elem_num * output_tensor->elem_size;
+
+        if (output_tensor->data != NULL || output_tensor->data_type != input_tensor->data_type ||
+            offset_list[i] % align || offset_list[i] + output_size > input_size)
+        {
+            sys_free(offset_list);
+            return 0;
+        }
+    }
+
+    for (int i = 0; i < ir_node->output_num; i++)
+        add_tensor_view(exec_graph, ir_node->output_tensors[i], input_tensor->idx, offset_list[i]);
+
+    sys_free(offset_list);
+
+    return 1;
+}
+
+/* drop the nodes whose outputs can be views of other tensors from the exec list.
+   step_map is filled with the step of each node, or NODE_REMOVED */
+static int plan_tensor_views(struct exec_graph* exec_graph, struct ir_graph* ir_graph, int* step_map)
+{
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+    int remove_num = 0;
+
+    for (int i = 0; i < ir_graph->node_num; i++)
+        step_map[i] = -1;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, i);
+
+        step_map[exec_node->ir_node->idx] = i;
+    }
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, i);
+        struct ir_node* ir_node = exec_node->ir_node;
+        int ret;
+
+        if (ir_node->op.op_type == OP_CONCAT)
+            ret = plan_concat_view(exec_graph, ir_node, step_map);
+        else
+            ret = plan_shape_view(exec_graph, ir_node, step_map);
+
+        if (ret < 0)
+            return -1;
+
+        if (ret == 0)
+            continue;
+
+        step_map[ir_node->idx] = NODE_REMOVED;
+        remove_num++;
+
+        TLOG_DEBUG("node %d, %s: outputs are views, not executed\n", ir_node->idx, ir_node->name);
+    }
+
+    for (int i = node_num - 1; i >= 0; i--)
+    {
+        struct exec_node* exec_node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, i);
+
+        if (step_map[exec_node->ir_node->idx] != NODE_REMOVED)
+            continue;
+
+        release_exec_node(exec_graph, exec_node, exec_node->node_ops);
+        remove_vector_by_idx(exec_graph->exec_node_list, i);
+    }
+
+    node_num = get_vector_num(exec_graph->exec_node_list);
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, i);
+
+        step_map[exec_node->ir_node->idx] = i;
+    }
+
+    return remove_num;
+}
+
+static void bind_exec_graph_mem(struct exec_graph* exec_graph, struct ir_graph* ir_graph)
+{
+    struct mem_pool* pool = exec_graph->mem_pool;
+    int root_num = get_vector_num(exec_graph->view_root_list);
+    int view_num = get_vector_num(exec_graph->view_list);
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+
+    for (int i = 0; i < root_num; i++)
+    {
+        struct view_root* root = ( struct view_root* )get_vector_data(exec_graph->view_root_list, i);
+        struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, root->tensor_idx);
+
+        ir_tensor->data = pool->get_mem_block(pool, root->block_id);
+        ir_tensor->free_host_mem = 0;
+        ir_tensor->internal_allocated = MEM_POOL_ALLOCATED;
+    }
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, i);
+        struct ir_node* ir_node = exec_node->ir_node;
+
+        int* block_id;
+
+        if (exec_node->output_num > 4)
+            block_id = exec_node->block_id_ptr;
+        else
+            block_id = exec_node->block_id;
+
+        for (int j = 0; j < ir_node->output_num; j++)
+        {
+            struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j]);
+
+            if (block_id[j] < 0)
+                continue;
+
+            if (block_id[j] & INPLACE_BLOCK_FLAG)
+            {
+                int input_idx = block_id[j] & (INPLACE_BLOCK_FLAG - 1);
+
+                struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[input_idx]);
+                ir_tensor->data = input_tensor->data;
+                ir_tensor->free_host_mem = 0;
+                ir_tensor->internal_allocated = MEM_POOL_ALLOCATED;
+            }
+            else
+            {
+                ir_tensor->data = pool->get_mem_block(pool, block_id[j]);
+                ir_tensor->free_host_mem = 0;
+                ir_tensor->internal_allocated = MEM_POOL_ALLOCATED;
+            }
+        }
+    }
+
+    /* the roots are bound now */
+    for (int i = 0; i < view_num; i++)
+    {
+        struct tensor_view* view = ( struct tensor_view* )get_vector_data(exec_graph->view_list, i);
+        struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, view->tensor_idx);
+        int offset;
+
+        struct ir_tensor* root = get_view_root(exec_graph, ir_graph, ir_tensor, &offset);
+
+        ir_tensor->data = ( char* )root->data + offset;
+        ir_tensor->free_host_mem = 0;
+        ir_tensor->internal_allocated = MEM_POOL_ALLOCATED;
+    }
+}
+
+static int alloc_exec_graph_mem(struct exec_graph* exec_graph, struct ir_graph* ir_graph)
+{
+    struct mem_pool* mem_pool;
+    int max_shared_mem_size = 0;
+    int max_shared_pack4_mem_size = 0;
+
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+
+    struct vector* tensor_mem_list = create_vector(sizeof(struct mem_record), NULL);
+
+    if (tensor_mem_list == NULL)
+        return -1;
+
+    mem_pool = create_mem_pool(node_num);
+
+    if (mem_pool == NULL)
+        return -1;
+
+    exec_graph->mem_pool = mem_pool;
+
+    int* step_map = ( int* )sys_malloc(sizeof(int) * ir_graph->node_num);
+
+    if (step_map == NULL || plan_tensor_views(exec_graph, ir_graph, step_map) < 0)
+    {
+        sys_free(step_map);
+        return -1;
+    }
+
+    node_num = get_vector_num(exec_graph->exec_node_list);
+    mem_pool->step_num = node_num;
+
+    /* the blocks touched by each node decide which nodes may run at the same time */
+    struct inter_op_exec* inter_op =
+        create_inter_op_exec(node_num, exec_graph->num_thread, get_graph_inter_op_thread(ir_graph));
+
+    exec_graph->inter_op = inter_op;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, i);
+        struct ir_node* ir_node = exec_node->ir_node;
+        struct ir_graph* ir_graph = ir_node->graph;
+
+        int* block_id;
+
+        if (exec_node->output_num > 4)
+            block_id = exec_node->block_id_ptr;
+        else
+            block_id = exec_node->block_id;
+
+        for (int j = 0; j < ir_node->output_num; j++)
+        {
+            struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j]);
+
+            if (ir_tensor->data != NULL)
+                continue;
 
-            /* allocate mem from pool */
             int mem_size = ir_tensor->elem_size * ir_tensor->elem_num;
 
+            /* the root block lives from the first write into it */
+            if (find_tensor_view(exec_graph, ir_tensor->idx) >= 0)
+            {
+                int offset;
+                struct ir_tensor* root = get_view_root(exec_graph, ir_graph, ir_tensor, &offset);
+                int idx = find_tensor_mem_list(tensor_mem_list, root);
+
+                if (idx >= 0)
+                {
+                    struct mem_record* root_r = ( struct mem_record* )get_vector_data(tensor_mem_list, idx);
+
+                    if (inter_op)
+                        add_block_touch(inter_op, root_r->block_id, i, offset, mem_size, 1);
+
+                    continue;
+                }
+
+                struct mem_record r;
+                struct view_root view_root;
+
+                r.ir_tensor = root;
+                r.block_id = mem_pool->allocate(mem_pool, root->elem_size * root->elem_num, i);
+                r.used = get_tree_use_count(exec_graph, ir_graph, step_map, root);
+
+                if (inter_op)
+                    add_block_touch(inter_op, r.block_id, i, offset, mem_size, 1);
+
+                view_root.tensor_idx = root->idx;
+                view_root.block_id = r.block_id;
+
+                push_vector_data(tensor_mem_list, &r);
+                push_vector_data(exec_graph->view_root_list, &view_root);
+
+                continue;
+            }
+
+            int inplace_input = find_inplace_input(exec_node, j, ir_node, ir_graph);
+
+            /* the views of the input still read the data */
+            if (inplace_input >= 0 && is_view_member(exec_graph, ir_node->input_tensors[inplace_input]))
+                inplace_input = -1;
+
+            if (inplace_input >= 0)
+            {
+                struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[inplace_input]);
+
+                int idx = find_tensor_mem_list(tensor_mem_list, input_tensor);
+
+                /* if the input is from outside buffer, input_r should be NULL */
+                if (idx < 0)
+                    continue;
+
+                struct mem_record* input_r = ( struct mem_record* )get_vector_data(tensor_mem_list, idx);
+
+                input_r->ir_tensor = ir_tensor;
+                input_r->used = get_tree_use_count(exec_graph, ir_graph, step_map, ir_tensor);
+                block_id[j] = INPLACE_BLOCK_FLAG | inplace_input;
+
+                if (inter_op)
+                    add_block_touch(inter_op, input_r->block_id, i, 0, mem_size, 1);
+
+                continue;
+            }
+
+            /* allocate mem from pool */
             struct mem_record r;
 
             r.ir_tensor = ir_tensor;
-            r.block_id = mem_pool->allocate(mem_pool, mem_size);
-            r.used = ir_tensor->consumer_num;
+            r.block_id = mem_pool->allocate(mem_pool, mem_size, i);
+            r.used = get_tree_use_count(exec_graph, ir_graph, step_map, ir_tensor);
 
             block_id[j] = r.block_id;
 
+            if (inter_op)
+                add_block_touch(inter_op, r.block_id, i, 0, mem_size, 1);
+
             push_vector_data(tensor_mem_list, &r);
         }
 
@@ -1573,18 +2713,24 @@ static int alloc_exec_graph_mem(struct exec_graph* exec_graph)
             if (ir_tensor->data != NULL)
                 continue;
 
-            int idx = find_tensor_mem_list(tensor_mem_list, ir_tensor);
+            int offset;
+            struct ir_tensor* root = get_view_root(exec_graph, ir_graph, ir_tensor, &offset);
+            int idx = find_tensor_mem_list(tensor_mem_list, root);
 
             if (idx < 0)
                 continue;
 
             struct mem_record* input_r = ( struct mem_record* )get_vector_data(tensor_mem_list, idx);
 
+            if (inter_op)
+                add_block_touch(inter_op, input_r->block_id, i, offset, ir_tensor->elem_size * ir_tensor->elem_num,
+                                0);
+
             input_r->used--;
 
             if (input_r->used == 0)
             {
-                mem_pool->free(mem_pool, input_r->block_id);
+                mem_pool->free(mem_pool, input_r->block_id, i);
                 remove_vector_by_idx(tensor_mem_list, idx);
             }
         }
@@ -1600,81 +2746,86 @@ static int alloc_exec_graph_mem(struct exec_graph* exec_graph)
 
     release_vector(tensor_mem_list);
 
-    exec_graph->shared_mem_size = max_shared_mem_size;
-    exec_graph->shared_pack4_mem_size = max_shared_pack4_mem_size;
-
-    if (max_shared_mem_size > 0)
+    if (inter_op)
     {
-        exec_graph->shared_mem = sys_malloc(max_shared_mem_size);
+        int worker_num = plan_inter_op_exec(inter_op, exec_graph, ir_graph, step_map);
 
-        if (exec_graph->shared_mem == NULL)
+        if (worker_num < 0)
         {
-            TLOG_ERR("cannot allocate shared memory. size=%d\n", max_shared_mem_size);
+            sys_free(step_map);
             return -1;
         }
-    }
-    if (max_shared_pack4_mem_size > 0)
-    {
-        exec_graph->shared_pack4_mem = sys_malloc(max_shared_pack4_mem_size);
 
-        if (exec_graph->shared_pack4_mem == NULL)
+        if (worker_num > 1)
+            mem_pool->inter_op = inter_op;
+        else
         {
-            TLOG_ERR("cannot allocate shared pack4 memory. size=%d\n", max_shared_pack4_mem_size);
-            return -1;
+            release_inter_op_exec(inter_op);
+            exec_graph->inter_op = NULL;
         }
     }
 
-    TLOG_DEBUG("shared memory: %p size=%d\n", exec_graph->shared_mem, max_shared_mem_size);
-    TLOG_DEBUG("shared pack4 memory: %p size=%d\n", exec_graph->shared_pack4_mem, max_shared_pack4_mem_size);
+    sys_free(step_map);
 
-    if (mem_pool->get_backend_mem(mem_pool) < 0)
-    {
-        TLOG_ERR("cannot allocate enough memory from backend\n");
-        return -1;
-    }
+    exec_graph->shared_mem_size = max_shared_mem_size;
+    exec_graph->shared_pack4_mem_size = max_shared_pack4_mem_size;
 
-    mem_pool->dump(mem_pool);
+    struct exec_context* context = get_ir_graph_context(ir_graph);
 
-    /* now, the real allocate */
-    for (int i = 0; i < node_num; i++)
+    if (context->share_mem_arena && context->mem_arena != NULL)
     {
-        struct exec_node* exec_node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, i);
-        struct ir_node* ir_node = exec_node->ir_node;
-        struct ir_graph* ir_graph = ir_node->graph;
-        struct mem_pool* mem_pool = exec_graph->mem_pool;
-
-        int8_t* block_id;
-
-        if (exec_node->output_num > 4)
-            block_id = exec_node->block_id_ptr;
-        else
-            block_id = exec_node->block_id;
-
-        for (int j = 0; j < ir_node->output_num; j++)
+        if (alloc_exec_graph_ctx_arena(exec_graph, context->mem_arena) < 0)
         {
-            struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j]);
-
-            if (block_id[j] < 0)
-                continue;
+            TLOG_ERR("cannot allocate context memory arena\n");
+            return -1;
+        }
+    }
+    else if (exec_graph->mem_arena_mode != CPU_MEM_ARENA_OFF)
+    {
+        if (alloc_exec_graph_arena(exec_graph) < 0)
+        {
+            TLOG_ERR("cannot allocate memory arena\n");
+            return -1;
+        }
+    }
+    else
+    {
+        if (max_shared_mem_size > 0)
+        {
+            exec_graph->shared_mem = sys_malloc(max_shared_mem_size);
 
-            if (block_id[j] & INPLACE_BLOCK_FLAG)
+            if (exec_graph->shared_mem == NULL)
             {
-                int input_idx = block_id[j] & (INPLACE_BLOCK_FLAG - 1);
-
-                struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[input_idx]);
-                ir_tensor->data = input_tensor->data;
-                ir_tensor->free_host_mem = 0;
-                ir_tensor->internal_allocated = MEM_POOL_ALLOCATED;
+                TLOG_ERR("cannot allocate shared memory. size=%d\n", max_shared_mem_size);
+                return -1;
             }
-            else
+        }
+        if (max_shared_pack4_mem_size > 0)
+        {
+            exec_graph->shared_pack4_mem = sys_malloc(max_shared_pack4_mem_size);
+
+            if (exec_graph->shared_pack4_mem == NULL)
             {
-                ir_tensor->data = mem_pool->get_mem_block(mem_pool, block_id[j]);
-                ir_tensor->free_host_mem = 0;
-                ir_tensor->internal_allocated = MEM_POOL_ALLOCATED;
+                TLOG_ERR("cannot allocate shared pack4 memory. size=%d\n", max_shared_pack4_mem_size);
+                return -1;
             }
         }
+
+        if (mem_pool->get_backend_mem(mem_pool) < 0)
+        {
+            TLOG_ERR("cannot allocate enough memory from backend\n");
+            return -1;
+        }
     }
 
+    TLOG_DEBUG("shared memory: %p size=%d\n", exec_graph->shared_mem, max_shared_mem_size);
+    TLOG_DEBUG("shared pack4 memory: %p size=%d\n", exec_graph->shared_pack4_mem, max_shared_pack4_mem_size);
+
+    mem_pool->dump(mem_pool);
+
+    /* now, the real allocate */
+    bind_exec_graph_mem(exec_graph, ir_graph);
+
     return 0;
 }
 
@@ -1697,6 +2848,30 @@ static int prerun_exec_graph(struct exec_graph* exec_graph)
     return 0;
 }
 
+/* the threads of the graph are split among the workers of the independent nodes, the caller is worker 0 */
+static int start_exec_graph_thread(struct exec_graph* exec_graph)
+{
+    if (exec_graph->inter_op != NULL)
+    {
+        exec_graph->mem_pool->inter_op = NULL;
+        exec_graph->num_thread = get_inter_op_caller_thread(exec_graph->inter_op);
+    }
+
+    /* the prerun of the nodes may use it as well */
+    if (exec_graph->num_thread > 1)
+    {
+        exec_graph->thread_pool = create_thread_pool(exec_graph->num_thread, exec_graph->cpu_affinity);
+
+        if (exec_graph->thread_pool == NULL)
+            return -1;
+    }
+
+    if (exec_graph->inter_op != NULL && start_inter_op_exec(exec_graph->inter_op, exec_graph) < 0)
+        return -1;
+
+    return 0;
+}
+
 static int prerun(struct nn_device* dev, struct subgraph* subgraph, int num_thread, int cpu_affinity, int mode)
 {
     struct exec_graph* exec_graph;
@@ -1707,7 +2882,8 @@ static int prerun(struct nn_device* dev, struct subgraph* subgraph, int num_thre
     if (exec_graph == NULL)
         return -1;
 
-    if (alloc_exec_graph_mem(exec_graph) < 0 || prerun_exec_graph(exec_graph) < 0)
+    if (alloc_exec_graph_mem(exec_graph, subgraph->graph) < 0 || start_exec_graph_thread(exec_graph) < 0 ||
+        prerun_exec_graph(exec_graph) < 0)
     {
         release_exec_graph(exec_graph);
         return -1;
@@ -1732,6 +2908,16 @@ static int run(struct nn_device* dev, struct subgraph* subgraph)
 {
     struct exec_graph* exec_graph = subgraph->exec_graph;
 
+    /* another graph of the context has grown the arena */
+    if (exec_graph->ctx_arena && exec_graph->ctx_arena_gen != exec_graph->ctx_arena->generation)
+    {
+        set_ctx_arena_mem(exec_graph);
+        bind_exec_graph_mem(exec_graph, subgraph->graph);
+    }
+
+    if (exec_graph->inter_op != NULL)
+        return run_inter_op_exec(exec_graph->inter_op, exec_graph);
+
     int node_num = get_vector_num(exec_graph->exec_node_list);
 
     for (int i = 0; i < node_num; i++)
@@ -1823,6 +3009,200 @@ static int cpu_dev_release_exec_graph(struct nn_device* dev, void* exec_graph)
     return 0;
 }
 
+/* the tensor and where its data is, to resolve the in-place outputs */
+struct mem_plan_record
+{
+    int tensor_idx;
+    int block_id;
+    int offset; /* inside the block */
+    int size;
+};
+
+static void fill_mem_plan_tensor(struct mem_plan_tensor* t, struct exec_graph* exec_graph, struct ir_tensor* ir_tensor,
+                                 struct mem_plan_record* r)
+{
+    struct mem_pool* mem_pool = exec_graph->mem_pool;
+    struct mem_block_entry* entry = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, r->block_id);
+
+    t->name = ir_tensor->name;
+    t->tensor_idx = ir_tensor->idx;
+    t->block_id = r->block_id;
+    t->offset = entry->offset + r->offset;
+    t->size = r->size;
+    t->first_use = ir_tensor->producer;
+    t->last_use = -1;
+    t->inplace_tensor = -1;
+    t->view_parent = -1;
+    t->live_out = entry->free_step == mem_pool->step_num;
+    t->private_block = entry->keep;
+
+    for (int k = 0; k < ir_tensor->consumer_num; k++)
+    {
+        if (ir_tensor->consumer[k] > t->last_use)
+            t->last_use = ir_tensor->consumer[k];
+    }
+}
+
+static int find_mem_plan_record(struct vector* record_list, int tensor_idx)
+{
+    for (int i = 0; i < get_vector_num(record_list); i++)
+    {
+        struct mem_plan_record* r = ( struct mem_plan_record* )get_vector_data(record_list, i);
+
+        if (r->tensor_idx == tensor_idx)
+            return i;
+    }
+
+    return -1;
+}
+
+static int cpu_dev_get_mem_plan(struct nn_device* dev, struct subgraph* subgraph, struct mem_plan_summary* summary,
+                                struct mem_plan_tensor* tensors, int max_num)
+{
+    struct exec_graph* exec_graph = subgraph->exec_graph;
+    struct ir_graph* ir_graph = subgraph->graph;
+
+    if (exec_graph == NULL || exec_graph->mem_pool == NULL)
+    {
+        set_tengine_errno(EINVAL);
+        return -1;
+    }
+
+    struct mem_pool* mem_pool = exec_graph->mem_pool;
+    struct vector* record_list = create_vector(sizeof(struct mem_plan_record), NULL);
+
+    if (record_list == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    int tensor_num = 0;
+
+    /* the roots allocated for views, bound before the executed nodes */
+    for (int i = 0; i < get_vector_num(exec_graph->view_root_list); i++)
+    {
+        struct view_root* root = ( struct view_root* )get_vector_data(exec_graph->view_root_list, i);
+        struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, root->tensor_idx);
+        struct mem_block_entry* entry = ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, root->block_id);
+        struct mem_plan_record r;
+
+        r.tensor_idx = root->tensor_idx;
+        r.block_id = root->block_id;
+        r.offset = 0;
+        r.size = entry->size;
+
+        push_vector_data(record_list, &r);
+
+        if (tensor_num < max_num)
+            fill_mem_plan_tensor(tensors + tensor_num, exec_graph, ir_tensor, &r);
+
+        tensor_num++;
+    }
+
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct exec_node* exec_node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, i);
+        struct ir_node* ir_node = exec_node->ir_node;
+
+        int* block_id;
+
+        if (exec_node->output_num > 4)
+            block_id = exec_node->block_id_ptr;
+        else
+            block_id = exec_node->block_id;
+
+        for (int j = 0; j < ir_node->output_num; j++)
+        {
+            struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[j]);
+            struct mem_plan_record r;
+            int inplace_tensor = -1;
+
+            if (block_id[j] < 0)
+                continue;
+
+            if (block_id[j] & INPLACE_BLOCK_FLAG)
+            {
+                int input_idx = block_id[j] & (INPLACE_BLOCK_FLAG - 1);
+
+                inplace_tensor = ir_node->input_tensors[input_idx];
+
+                int input_r = find_mem_plan_record(record_list, inplace_tensor);
+
+                /* the input is from an outside buffer */
+                if (input_r < 0)
+                    continue;
+
+                r = *( struct mem_plan_record* )get_vector_data(record_list, input_r);
+            }
+            else
+            {
+                struct mem_block_entry* entry =
+                    ( struct mem_block_entry* )get_vector_data(mem_pool->block_list, block_id[j]);
+
+                r.block_id = block_id[j];
+                r.offset = 0;
+                r.size = entry->size;
+            }
+
+            r.tensor_idx = ir_tensor->idx;
+
+            push_vector_data(record_list, &r);
+
+            if (tensor_num < max_num)
+            {
+                fill_mem_plan_tensor(tensors + tensor_num, exec_graph, ir_tensor, &r);
+                tensors[tensor_num].inplace_tensor = inplace_tensor;
+            }
+
+            tensor_num++;
+        }
+    }
+
+    /* the views, where their roots are */
+    for (int i = 0; i < get_vector_num(exec_graph->view_list); i++)
+    {
+        struct tensor_view* view = ( struct tensor_view* )get_vector_data(exec_graph->view_list, i);
+        struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, view->tensor_idx);
+        int offset;
+
+        struct ir_tensor* root = get_view_root(exec_graph, ir_graph, ir_tensor, &offset);
+        int root_r = find_mem_plan_record(record_list, root->idx);
+
+        if (root_r < 0)
+            continue;
+
+        struct mem_plan_record r = *( struct mem_plan_record* )get_vector_data(record_list, root_r);
+
+        r.tensor_idx = view->tensor_idx;
+        r.offset += offset;
+        r.size = ir_tensor->elem_num * ir_tensor->elem_size;
+
+        if (tensor_num < max_num)
+        {
+            fill_mem_plan_tensor(tensors + tensor_num, exec_graph, ir_tensor, &r);
+            tensors[tensor_num].view_parent = view->parent_idx;
+        }
+
+        tensor_num++;
+    }
+
+    release_vector(record_list);
+
+    summary->tensor_num = tensor_num;
+    summary->block_num = get_vector_num(mem_pool->block_list);
+    summary->arena_size = mem_pool->arena_size;
+    summary->private_size = mem_pool->keep_size;
+    summary->shared_mem_size = exec_graph->shared_mem_size;
+    summary->shared_pack4_mem_size = exec_graph->shared_pack4_mem_size;
+    summary->total_size = summary->arena_size + summary->private_size + summary->shared_mem_size +
+                          summary->shared_pack4_mem_size;
+
+    return tensor_num;
+}
+
 static struct cpu_device cpu_dev = {
     .base = {.name = "cpu_dev",
              .prerun = prerun,
@@ -1831,6 +3211,7 @@ static struct cpu_device cpu_dev = {
              .async_run = NULL,
              .async_wait = NULL,
              .release_exec_graph = cpu_dev_release_exec_graph,
+             .get_mem_plan = cpu_dev_get_mem_plan,
              .init = NULL,
              .release = NULL},
     .master_cpu = 0,
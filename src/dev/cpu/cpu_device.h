@@ -31,6 +31,7 @@
 
 struct node_ops;
 struct ir_node;
+struct inter_op_exec;
 
 struct cpu_device
 {
@@ -56,21 +57,37 @@ struct exec_node
 
     union
     {
-        int8_t block_id[4];
-        int8_t* block_id_ptr;
+        int block_id[4];
+        int* block_id_ptr;
     };
 
     int shared_mem_size;
     int shared_pack4_mem_size;
 };
 
+/* a tensor placed inside the buffer of its parent, e.g. an input of a concat done in place */
+struct tensor_view
+{
+    uint16_t tensor_idx;
+    uint16_t parent_idx;
+    int offset; /* in bytes, inside the parent */
+};
+
+/* a parent whose producer is not executed, so the block is recorded here */
+struct view_root
+{
+    uint16_t tensor_idx;
+    int block_id;
+};
+
+/* one entry per planned tensor buffer, steps are indexes in exec_node_list */
 struct mem_block_entry
 {
-    void* addr;
-    int block_size;
-    int max_req_size;
-    int alloc_count;
-    int free_count;
+    int offset; /* offset inside the arena */
+    int size;
+    int alloc_step; /* the node writes it first */
+    int free_step; /* the node reads it last */
+    int keep; /* lives in keep_mem, not in the arena */
 };
 
 struct mem_pool
@@ -78,10 +95,22 @@ struct mem_pool
     uint8_t align_size; /* must be 2^n */
     struct vector* block_list;
 
+    void* arena; /* one backend buffer holds all blocks */
+    int arena_size;
+    int step_num;
+    uint8_t own_arena;
+
+    void* keep_mem; /* private blocks of a graph sharing the context arena */
+    int keep_size;
+
+    /* the nodes run at the same time, so the steps do not order the blocks, see cpu_inter_op.h */
+    struct inter_op_exec* inter_op;
+
+    int (*plan)(struct mem_pool*);
     int (*get_backend_mem)(struct mem_pool*);
     void* (*get_mem_block)(struct mem_pool*, int block_id);
-    int (*allocate)(struct mem_pool*, int size);
-    void (*free)(struct mem_pool*, int block_id);
+    int (*allocate)(struct mem_pool*, int size, int step);
+    void (*free)(struct mem_pool*, int block_id, int step);
     void (*dump)(struct mem_pool*);
 };
 
@@ -91,6 +120,9 @@ struct exec_graph
     struct mem_pool* mem_pool;
     struct cpu_device* dev;
 
+    struct vector* view_list;
+    struct vector* view_root_list;
+
     void* shared_mem;
     int shared_mem_size;
     void* shared_pack4_mem;
@@ -98,10 +130,36 @@ struct exec_graph
     int num_thread;
     int cpu_affinity;
     int mode;
+
+    /* the threads of the kernels, NULL for a single thread, see thread_pool.h */
+    struct thread_pool* thread_pool;
+
+    /* the workers running the independent nodes at the same time, NULL to run them in order */
+    struct inter_op_exec* inter_op;
+
+    /* one mapping for pool blocks and shared memory, see GRAPH_ATTR_CPU_MEM_ARENA */
+    int mem_arena_mode;
+    void* mem_arena;
+    size_t mem_arena_size;
+
+    /* the context arena, see CONTEXT_ATTR_SHARE_MEM_ARENA */
+    struct shared_mem_arena* ctx_arena;
+    int ctx_arena_gen;
+
+    /* the packed weights are in the weight cache under this key, see GRAPH_ATTR_SHARE_WEIGHTS */
+    const char* weight_key;
+
+    /* and persisted under this directory, see GRAPH_ATTR_WEIGHT_CACHE_DIR */
+    char* weight_cache_dir;
 };
 
 #define GET_MEM_PTR_HEADER(ptr) ( struct mem_ptr_header* )(( char* )ptr - 4);
 
 int register_cpu_device(void);
 
+/* bind the node ops to an exec node, and release it, also used to run a single node out of an exec graph */
+int init_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_node, struct ir_node* ir_node,
+                   struct node_ops* node_ops);
+void release_exec_node(struct exec_graph* exec_graph, struct exec_node* exec_node, struct node_ops* node_ops);
+
 #endif
@@ -0,0 +1,753 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "vector.h"
+#include "cpu.h"
+#include "thread_pool.h"
+#include "cpu_device.h"
+#include "cpu_node_ops.h"
+#include "cpu_inter_op.h"
+
+#ifndef CONFIG_BAREMETAL_BUILD
+
+#include <pthread.h>
+
+struct block_touch
+{
+    int block_id;
+    int step;
+    int offset;
+    int size;
+    int write;
+};
+
+struct inter_op_worker
+{
+    struct inter_op_exec* inter_op;
+    int num_thread;
+    struct thread_pool* thread_pool;
+    void* shared_mem;
+    void* shared_pack4_mem;
+
+    /* the exec graph of the run, with the threads and the shared memory of the worker */
+    struct exec_graph graph;
+
+    pthread_t thread;
+};
+
+struct inter_op_exec
+{
+    int node_num;
+    int num_thread;
+    int inter_op_thread;
+    int worker_num;
+
+    /* the plan, dropped when the workers start */
+    struct vector* touch_list;
+    int block_num;
+    int* block_touch_start; /* the touches of block b are block_touch[start[b], start[b + 1]) */
+    int* block_touch;
+    uint32_t* reach; /* bit i of row j: node j runs after node i */
+    int row_size;
+
+    /* the successors of node i are succ[succ_start[i], succ_start[i + 1]) */
+    int* dep_num;
+    int* succ_start;
+    int* succ;
+
+    /* the state of a run, under the mutex */
+    int* wait_num;
+    int* queue;
+    int head;
+    int tail;
+    int done_num;
+    int running;
+    int error;
+    int stop;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    struct inter_op_worker* workers;
+    int started_num;
+};
+
+#define TEST_BIT(row, i) ((row)[(i) >> 5] & (1u << ((i)&31)))
+#define SET_BIT(row, i) ((row)[(i) >> 5] |= (1u << ((i)&31)))
+
+struct inter_op_exec* create_inter_op_exec(int node_num, int num_thread, int inter_op_thread)
+{
+    if (num_thread < 2 || inter_op_thread == 1 || node_num < 2)
+        return NULL;
+
+    struct inter_op_exec* inter_op = ( struct inter_op_exec* )sys_malloc(sizeof(struct inter_op_exec));
+
+    if (inter_op == NULL)
+        return NULL;
+
+    memset(inter_op, 0, sizeof(struct inter_op_exec));
+
+    inter_op->node_num = node_num;
+    inter_op->num_thread = num_thread;
+    inter_op->inter_op_thread = inter_op_thread;
+    inter_op->worker_num = 1;
+    inter_op->touch_list = create_vector(sizeof(struct block_touch), NULL);
+
+    if (inter_op->touch_list == NULL)
+    {
+        sys_free(inter_op);
+        return NULL;
+    }
+
+    pthread_mutex_init(&inter_op->mutex, NULL);
+    pthread_cond_init(&inter_op->cond, NULL);
+
+    return inter_op;
+}
+
+static void release_plan(struct inter_op_exec* inter_op)
+{
+    if (inter_op->touch_list != NULL)
+        release_vector(inter_op->touch_list);
+
+    sys_free(inter_op->block_touch_start);
+    sys_free(inter_op->block_touch);
+    sys_free(inter_op->reach);
+
+    inter_op->touch_list = NULL;
+    inter_op->block_touch_start = NULL;
+    inter_op->block_touch = NULL;
+    inter_op->reach = NULL;
+}
+
+void release_inter_op_exec(struct inter_op_exec* inter_op)
+{
+    if (inter_op == NULL)
+        return;
+
+    pthread_mutex_lock(&inter_op->mutex);
+    inter_op->stop = 1;
+    pthread_cond_broadcast(&inter_op->cond);
+    pthread_mutex_unlock(&inter_op->mutex);
+
+    for (int i = 1; i < inter_op->started_num; i++)
+        pthread_join(inter_op->workers[i].thread, NULL);
+
+    if (inter_op->workers != NULL)
+    {
+        for (int i = 1; i < inter_op->worker_num; i++)
+        {
+            struct inter_op_worker* worker = inter_op->workers + i;
+
+            destroy_thread_pool(worker->thread_pool);
+            sys_free(worker->shared_mem);
+            sys_free(worker->shared_pack4_mem);
+        }
+
+        sys_free(inter_op->workers);
+    }
+
+    release_plan(inter_op);
+
+    sys_free(inter_op->dep_num);
+    sys_free(inter_op->succ_start);
+    sys_free(inter_op->succ);
+    sys_free(inter_op->wait_num);
+    sys_free(inter_op->queue);
+
+    pthread_mutex_destroy(&inter_op->mutex);
+    pthread_cond_destroy(&inter_op->cond);
+
+    sys_free(inter_op);
+}
+
+int add_block_touch(struct inter_op_exec* inter_op, int block_id, int step, int offset, int size, int write)
+{
+    struct block_touch touch;
+
+    touch.block_id = block_id;
+    touch.step = step;
+    touch.offset = offset;
+    touch.size = size;
+    touch.write = write;
+
+    if (block_id >= inter_op->block_num)
+        inter_op->block_num = block_id + 1;
+
+    return push_vector_data(inter_op->touch_list, &touch);
+}
+
+static int touch_conflict(struct block_touch* a, struct block_touch* b)
+{
+    return a->step != b->step && (a->write || b->write) && a->offset < b->offset + b->size &&
+           b->offset < a->offset + a->size;
+}
+
+/* group the touches by block, in the order of the steps */
+static int sort_block_touch(struct inter_op_exec* inter_op)
+{
+    int touch_num = get_vector_num(inter_op->touch_list);
+    int block_num = inter_op->block_num;
+
+    inter_op->block_touch_start = ( int* )sys_malloc(sizeof(int) * (block_num + 1));
+    inter_op->block_touch = ( int* )sys_malloc(sizeof(int) * (touch_num + 1));
+
+    if (inter_op->block_touch_start == NULL || inter_op->block_touch == NULL)
+        return -1;
+
+    memset(inter_op->block_touch_start, 0, sizeof(int) * (block_num + 1));
+
+    for (int i = 0; i < touch_num; i++)
+    {
+        struct block_touch* touch = ( struct block_touch* )get_vector_data(inter_op->touch_list, i);
+
+        inter_op->block_touch_start[touch->block_id + 1]++;
+    }
+
+    for (int i = 0; i < block_num; i++)
+        inter_op->block_touch_start[i + 1] += inter_op->block_touch_start[i];
+
+    int* fill = ( int* )sys_malloc(sizeof(int) * (block_num + 1));
+
+    if (fill == NULL)
+        return -1;
+
+    memcpy(fill, inter_op->block_touch_start, sizeof(int) * (block_num + 1));
+
+    for (int i = 0; i < touch_num; i++)
+    {
+        struct block_touch* touch = ( struct block_touch* )get_vector_data(inter_op->touch_list, i);
+
+        inter_op->block_touch[fill[touch->block_id]++] = i;
+    }
+
+    sys_free(fill);
+
+    return 0;
+}
+
+static void add_block_deps(struct inter_op_exec* inter_op, uint32_t* pred)
+{
+    for (int b = 0; b < inter_op->block_num; b++)
+    {
+        int start = inter_op->block_touch_start[b];
+        int end = inter_op->block_touch_start[b + 1];
+
+        for (int i = start; i < end; i++)
+        {
+            struct block_touch* later = ( struct block_touch* )get_vector_data(inter_op->touch_list,
+                                                                                inter_op->block_touch[i]);
+
+            for (int j = start; j < i; j++)
+            {
+                struct block_touch* earlier = ( struct block_touch* )get_vector_data(inter_op->touch_list,
+                                                                                      inter_op->block_touch[j]);
+
+                if (earlier->step < later->step && touch_conflict(earlier, later))
+                    SET_BIT(pred + later->step * inter_op->row_size, earlier->step);
+            }
+        }
+    }
+}
+
+static void add_producer_deps(struct inter_op_exec* inter_op, struct exec_graph* exec_graph, struct ir_graph* ir_graph,
+                              const int* step_map, uint32_t* pred)
+{
+    for (int i = 0; i < inter_op->node_num; i++)
+    {
+        struct exec_node* exec_node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, i);
+        struct ir_node* ir_node = exec_node->ir_node;
+
+        for (int j = 0; j < ir_node->input_num; j++)
+        {
+            struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[j]);
+
+            if (ir_tensor->producer < 0)
+                continue;
+
+            /* the nodes of the views are not executed, their blocks carry the order */
+            int step = step_map[ir_tensor->producer];
+
+            if (step >= 0 && step < i)
+                SET_BIT(pred + i * inter_op->row_size, step);
+        }
+    }
+}
+
+/* the largest number of nodes at the same depth */
+static int get_graph_width(struct inter_op_exec* inter_op, uint32_t* pred)
+{
+    int node_num = inter_op->node_num;
+    int* level = ( int* )sys_malloc(sizeof(int) * node_num * 2);
+
+    if (level == NULL)
+        return 1;
+
+    int* count = level + node_num;
+    int width = 1;
+
+    memset(count, 0, sizeof(int) * node_num);
+
+    for (int i = 0; i < node_num; i++)
+    {
+        uint32_t* row = pred + i * inter_op->row_size;
+
+        level[i] = 0;
+
+        for (int j = 0; j < i; j++)
+        {
+            if (TEST_BIT(row, j) && level[j] + 1 > level[i])
+                level[i] = level[j] + 1;
+        }
+
+        if (++count[level[i]] > width)
+            width = count[level[i]];
+    }
+
+    sys_free(level);
+
+    return width;
+}
+
+static int build_succ_list(struct inter_op_exec* inter_op, uint32_t* pred)
+{
+    int node_num = inter_op->node_num;
+    int edge_num = 0;
+
+    inter_op->dep_num = ( int* )sys_malloc(sizeof(int) * node_num);
+    inter_op->succ_start = ( int* )sys_malloc(sizeof(int) * (node_num + 1));
+
+    if (inter_op->dep_num == NULL || inter_op->succ_start == NULL)
+        return -1;
+
+    memset(inter_op->succ_start, 0, sizeof(int) * (node_num + 1));
+
+    for (int i = 0; i < node_num; i++)
+    {
+        uint32_t* row = pred + i * inter_op->row_size;
+
+        inter_op->dep_num[i] = 0;
+
+        for (int j = 0; j < i; j++)
+        {
+            if (!TEST_BIT(row, j))
+                continue;
+
+            inter_op->dep_num[i]++;
+            inter_op->succ_start[j + 1]++;
+            edge_num++;
+        }
+    }
+
+    for (int i = 0; i < node_num; i++)
+        inter_op->succ_start[i + 1] += inter_op->succ_start[i];
+
+    inter_op->succ = ( int* )sys_malloc(sizeof(int) * (edge_num + 1));
+
+    int* fill = ( int* )sys_malloc(sizeof(int) * node_num);
+
+    if (inter_op->succ == NULL || fill == NULL)
+    {
+        sys_free(fill);
+        return -1;
+    }
+
+    memcpy(fill, inter_op->succ_start, sizeof(int) * node_num);
+
+    for (int i = 0; i < node_num; i++)
+    {
+        uint32_t* row = pred + i * inter_op->row_size;
+
+        for (int j = 0; j < i; j++)
+        {
+            if (TEST_BIT(row, j))
+                inter_op->succ[fill[j]++] = i;
+        }
+    }
+
+    sys_free(fill);
+
+    return 0;
+}
+
+static int choose_worker_num(struct inter_op_exec* inter_op, int width)
+{
+    int num_thread = inter_op->num_thread;
+
+    if (inter_op->inter_op_thread > 1)
+        return inter_op->inter_op_thread < num_thread ? inter_op->inter_op_thread : num_thread;
+
+    /* the big nodes of a graph scale better inside, so each worker keeps two threads at least */
+    int worker_num = num_thread / 2;
+
+    if (worker_num > width)
+        worker_num = width;
+
+    return worker_num > 1 ? worker_num : 1;
+}
+
+int plan_inter_op_exec(struct inter_op_exec* inter_op, struct exec_graph* exec_graph, struct ir_graph* ir_graph,
+                       const int* step_map)
+{
+    int node_num = get_vector_num(exec_graph->exec_node_list);
+
+    inter_op->node_num = node_num;
+    inter_op->row_size = (node_num + 31) / 32;
+
+    size_t matrix_size = sizeof(uint32_t) * inter_op->row_size * node_num;
+    uint32_t* pred = ( uint32_t* )sys_malloc(matrix_size);
+
+    inter_op->reach = ( uint32_t* )sys_malloc(matrix_size);
+
+    if (pred == NULL || inter_op->reach == NULL || sort_block_touch(inter_op) < 0)
+    {
+        sys_free(pred);
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    memset(pred, 0, matrix_size);
+
+    add_producer_deps(inter_op, exec_graph, ir_graph, step_map, pred);
+    add_block_deps(inter_op, pred);
+
+    /* the steps are in a topological order, so the rows of the predecessors are complete */
+    memcpy(inter_op->reach, pred, matrix_size);
+
+    for (int i = 0; i < node_num; i++)
+    {
+        uint32_t* row = inter_op->reach + i * inter_op->row_size;
+
+        for (int j = 0; j < i; j++)
+        {
+            if (!TEST_BIT(pred + i * inter_op->row_size, j))
+                continue;
+
+            uint32_t* prev = inter_op->reach + j * inter_op->row_size;
+
+            for (int k = 0; k < inter_op->row_size; k++)
+                row[k] |= prev[k];
+        }
+    }
+
+    int width = get_graph_width(inter_op, pred);
+
+    inter_op->worker_num = choose_worker_num(inter_op, width);
+
+    int ret = inter_op->worker_num > 1 ? build_succ_list(inter_op, pred) : 0;
+
+    sys_free(pred);
+
+    if (ret < 0)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    TLOG_DEBUG("inter op: %d nodes, width %d, %d workers of %d threads\n", node_num, width, inter_op->worker_num,
+               inter_op->num_thread);
+
+    return inter_op->worker_num;
+}
+
+int is_block_ordered(struct inter_op_exec* inter_op, int block_a, int block_b)
+{
+    if (inter_op->reach == NULL || block_a >= inter_op->block_num || block_b >= inter_op->block_num)
+        return 0;
+
+    for (int i = inter_op->block_touch_start[block_a]; i < inter_op->block_touch_start[block_a + 1]; i++)
+    {
+        struct block_touch* a = ( struct block_touch* )get_vector_data(inter_op->touch_list, inter_op->block_touch[i]);
+
+        for (int j = inter_op->block_touch_start[block_b]; j < inter_op->block_touch_start[block_b + 1]; j++)
+        {
+            struct block_touch* b =
+                ( struct block_touch* )get_vector_data(inter_op->touch_list, inter_op->block_touch[j]);
+
+            if (!TEST_BIT(inter_op->reach + b->step * inter_op->row_size, a->step))
+                return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int get_worker_thread(struct inter_op_exec* inter_op, int idx)
+{
+    int num_thread = inter_op->num_thread / inter_op->worker_num;
+
+    return idx < inter_op->num_thread % inter_op->worker_num ? num_thread + 1 : num_thread;
+}
+
+int get_inter_op_caller_thread(struct inter_op_exec* inter_op)
+{
+    return get_worker_thread(inter_op, 0);
+}
+
+static int run_node(struct exec_graph* exec_graph, int step)
+{
+    struct exec_node* node = ( struct exec_node* )get_vector_data(exec_graph->exec_node_list, step);
+    struct node_ops* node_ops = node->node_ops;
+
+    if (node_ops->reshape && node_ops->reshape(node_ops, node, exec_graph) < 0)
+    {
+        TLOG_ERR("%s: failed to reshape node %d, %s\n", exec_graph->dev->base.name, node->ir_node->idx,
+                 node->ir_node->name);
+        return -1;
+    }
+
+    if (node_ops->run(node_ops, node, exec_graph) < 0)
+    {
+        TLOG_ERR("%s: failed to run node %d, %s\n", exec_graph->dev->base.name, node->ir_node->idx,
+                 node->ir_node->name);
+        return -1;
+    }
+
+    return 0;
+}
+
+/* take the ready nodes until the run is over for the caller, or the workers stop. the mutex is held */
+static void run_ready_nodes(struct inter_op_exec* inter_op, struct exec_graph* exec_graph, int caller)
+{
+    while (1)
+    {
+        if (caller && (inter_op->done_num == inter_op->node_num || (inter_op->error && inter_op->running == 0)))
+            return;
+
+        if (!caller && inter_op->stop)
+            return;
+
+        if (inter_op->error || inter_op->head == inter_op->tail)
+        {
+            pthread_cond_wait(&inter_op->cond, &inter_op->mutex);
+            continue;
+        }
+
+        int step = inter_op->queue[inter_op->head++];
+
+        inter_op->running++;
+
+        /* the others may take a node as well */
+        if (inter_op->head < inter_op->tail)
+            pthread_cond_signal(&inter_op->cond);
+
+        pthread_mutex_unlock(&inter_op->mutex);
+
+        int ret = run_node(exec_graph, step);
+
+        pthread_mutex_lock(&inter_op->mutex);
+
+        inter_op->running--;
+
+        if (ret < 0)
+            inter_op->error = 1;
+        else
+        {
+            inter_op->done_num++;
+
+            for (int i = inter_op->succ_start[step]; i < inter_op->succ_start[step + 1]; i++)
+            {
+                int next = inter_op->succ[i];
+
+                if (--inter_op->wait_num[next] == 0)
+                    inter_op->queue[inter_op->tail++] = next;
+            }
+        }
+
+        pthread_cond_broadcast(&inter_op->cond);
+    }
+}
+
+static void* worker_main(void* arg)
+{
+    struct inter_op_worker* worker = ( struct inter_op_worker* )arg;
+    struct inter_op_exec* inter_op = worker->inter_op;
+
+    set_cpu_affine(get_cluster_mask(worker->graph.cpu_affinity));
+
+    pthread_mutex_lock(&inter_op->mutex);
+    run_ready_nodes(inter_op, &worker->graph, 0);
+    pthread_mutex_unlock(&inter_op->mutex);
+
+    return NULL;
+}
+
+int start_inter_op_exec(struct inter_op_exec* inter_op, struct exec_graph* exec_graph)
+{
+    int node_num = inter_op->node_num;
+    int worker_num = inter_op->worker_num;
+
+    release_plan(inter_op);
+
+    inter_op->wait_num = ( int* )sys_malloc(sizeof(int) * node_num);
+    inter_op->queue = ( int* )sys_malloc(sizeof(int) * node_num);
+    inter_op->workers = ( struct inter_op_worker* )sys_malloc(sizeof(struct inter_op_worker) * worker_num);
+
+    if (inter_op->wait_num == NULL || inter_op->queue == NULL || inter_op->workers == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    memset(inter_op->workers, 0, sizeof(struct inter_op_worker) * worker_num);
+
+    /* worker 0 is the caller, running on the exec graph itself */
+    inter_op->started_num = 1;
+
+    for (int i = 1; i < worker_num; i++)
+    {
+        struct inter_op_worker* worker = inter_op->workers + i;
+
+        worker->inter_op = inter_op;
+        worker->num_thread = get_worker_thread(inter_op, i);
+
+        if (exec_graph->shared_mem_size > 0)
+            worker->shared_mem = sys_malloc(exec_graph->shared_mem_size);
+        if (exec_graph->shared_pack4_mem_size > 0)
+            worker->shared_pack4_mem = sys_malloc(exec_graph->shared_pack4_mem_size);
+
+        if ((exec_graph->shared_mem_size > 0 && worker->shared_mem == NULL) ||
+            (exec_graph->shared_pack4_mem_size > 0 && worker->shared_pack4_mem == NULL))
+        {
+            set_tengine_errno(ENOMEM);
+            return -1;
+        }
+
+        if (worker->num_thread > 1)
+        {
+            worker->thread_pool = create_thread_pool(worker->num_thread, exec_graph->cpu_affinity);
+
+            if (worker->thread_pool == NULL)
+                return -1;
+        }
+
+        worker->graph = *exec_graph;
+
+        if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0)
+        {
+            TLOG_ERR("inter op: failed to start worker %d of %d\n", i, worker_num);
+            set_tengine_errno(EAGAIN);
+            return -1;
+        }
+
+        inter_op->started_num++;
+    }
+
+    return 0;
+}
+
+int run_inter_op_exec(struct inter_op_exec* inter_op, struct exec_graph* exec_graph)
+{
+    pthread_mutex_lock(&inter_op->mutex);
+
+    /* the shared memory of the graph may have moved with the context arena */
+    for (int i = 1; i < inter_op->worker_num; i++)
+    {
+        struct inter_op_worker* worker = inter_op->workers + i;
+
+        worker->graph = *exec_graph;
+        worker->graph.num_thread = worker->num_thread;
+        worker->graph.thread_pool = worker->thread_pool;
+        worker->graph.shared_mem = worker->shared_mem;
+        worker->graph.shared_pack4_mem = worker->shared_pack4_mem;
+    }
+
+    inter_op->head = 0;
+    inter_op->tail = 0;
+    inter_op->done_num = 0;
+    inter_op->running = 0;
+    inter_op->error = 0;
+
+    for (int i = 0; i < inter_op->node_num; i++)
+    {
+        inter_op->wait_num[i] = inter_op->dep_num[i];
+
+        if (inter_op->dep_num[i] == 0)
+            inter_op->queue[inter_op->tail++] = i;
+    }
+
+    pthread_cond_broadcast(&inter_op->cond);
+
+    run_ready_nodes(inter_op, exec_graph, 1);
+
+    int ret = inter_op->error ? -1 : 0;
+
+    pthread_mutex_unlock(&inter_op->mutex);
+
+    return ret;
+}
+
+#else
+
+/* no threads on bare metal, the nodes run in order */
+
+struct inter_op_exec* create_inter_op_exec(int node_num, int num_thread, int inter_op_thread)
+{
+    return NULL;
+}
+
+void release_inter_op_exec(struct inter_op_exec* inter_op) {}
+
+int add_block_touch(struct inter_op_exec* inter_op, int block_id, int step, int offset, int size, int write)
+{
+    return 0;
+}
+
+int plan_inter_op_exec(struct inter_op_exec* inter_op, struct exec_graph* exec_graph, struct ir_graph* ir_graph,
+                       const int* step_map)
+{
+    return 1;
+}
+
+int is_block_ordered(struct inter_op_exec* inter_op, int block_a, int block_b)
+{
+    return 0;
+}
+
+int get_inter_op_caller_thread(struct inter_op_exec* inter_op)
+{
+    return 1;
+}
+
+int start_inter_op_exec(struct inter_op_exec* inter_op, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+int run_inter_op_exec(struct inter_op_exec* inter_op, struct exec_graph* exec_graph)
+{
+    return -1;
+}
+
+#endif
@@ -0,0 +1,65 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#ifndef __CPU_INTER_OP_H__
+#define __CPU_INTER_OP_H__
+
+/* run the independent nodes of an exec graph at the same time. the threads of the graph are split into
+   workers, each runs one ready node at a time with its own share of the threads, its own thread pool
+   and its own shared memory. a node is ready when the nodes it depends on are done: the producers of
+   its inputs, and the earlier nodes touching the same bytes of a planned block, as the blocks of the
+   views and of the in-place outputs are written by several nodes.
+   the memory plan keeps two blocks apart unless the nodes touching one are all done before the nodes
+   touching the other may start, see is_block_ordered() */
+
+struct exec_graph;
+struct ir_graph;
+struct inter_op_exec;
+
+/* the number of workers is set by GRAPH_ATTR_CPU_INTER_OP_THREAD, it is 0 to choose by the width of
+   the graph. NULL if the nodes run in order, when the graph has a single thread or a single branch */
+struct inter_op_exec* create_inter_op_exec(int node_num, int num_thread, int inter_op_thread);
+void release_inter_op_exec(struct inter_op_exec* inter_op);
+
+/* record a node reading or writing a range of a block, in the order of the steps */
+int add_block_touch(struct inter_op_exec* inter_op, int block_id, int step, int offset, int size, int write);
+
+/* build the dependencies of the nodes, and choose the number of workers from them.
+   returns the number of workers, 1 if the graph is better run in order */
+int plan_inter_op_exec(struct inter_op_exec* inter_op, struct exec_graph* exec_graph, struct ir_graph* ir_graph,
+                       const int* step_map);
+
+/* the nodes touching block a are all done before any node touching block b may start */
+int is_block_ordered(struct inter_op_exec* inter_op, int block_a, int block_b);
+
+/* the threads of worker 0, which is the caller of the run */
+int get_inter_op_caller_thread(struct inter_op_exec* inter_op);
+
+/* start the workers after the memory is allocated, and drop the plan */
+int start_inter_op_exec(struct inter_op_exec* inter_op, struct exec_graph* exec_graph);
+
+int run_inter_op_exec(struct inter_op_exec* inter_op, struct exec_graph* exec_graph);
+
+#endif
@@ -86,10 +86,6 @@ static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struc
     int stride_w = param->stride_w;
     int dilation_h = param->dilation_h;
     int dilation_w = param->dilation_w;
-    int pad_h0 = param->pad_h0;
-    int pad_w0 = param->pad_w0;
-    int pad_h1 = param->pad_h1;
-    int pad_w1 = param->pad_w1;
 
     input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
     output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
@@ -101,10 +97,14 @@ static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struc
     if (input_tensor->data_type != TENGINE_DT_FP32)
         return 0;
 
+    /* nor the fused residual add */
+    if (ir_node->input_num > 3)
+        return 0;
+
     if (kernel_h != kernel_w || input_tensor->dims[0] > 1)
         return 0;
 
-    if (param->group > 1 && in_c == 1 && out_c == 1 && pad_h0 == pad_h1 && pad_w0 == pad_w1 && dilation_h == 1 && dilation_w == 1 && kernel_h == 3 && kernel_w == 3 &&
+    if (param->group > 1 && in_c == 1 && out_c == 1 && dilation_h == 1 && dilation_w == 1 && kernel_h == 3 && kernel_w == 3 &&
         ((stride_h == 1 && stride_w == 1) || (stride_h == 2 && stride_w == 2)))
         return OPS_SCORE_BEST;
     else
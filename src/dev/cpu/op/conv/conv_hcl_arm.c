@@ -46,6 +46,10 @@ static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct
     /* get cpu affinity */
     conv_priv_info->cpu_type = exec_graph->cpu_affinity;
 
+    /* share the packed kernel with the other graphs of the model */
+    conv_priv_info->weight_key = exec_graph->weight_key;
+    conv_priv_info->weight_cache_dir = exec_graph->weight_cache_dir;
+
     /* fp32 prerun */
     if (exec_graph->mode == TENGINE_MODE_FP32)
     {
@@ -128,6 +132,12 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct conv_param* conv_param = ( struct conv_param* )ir_node->op.param_mem;
     struct conv_priv_info* conv_priv_info = ( struct conv_priv_info* )exec_node->ops_priv;
 
+    /* the shared memory moves when the memory arena of the context grows */
+    if (conv_priv_info->external_im2col_mem)
+        conv_priv_info->im2col_buffer = exec_graph->shared_mem;
+    if (conv_priv_info->external_im2col_pack4_mem)
+        conv_priv_info->im2col_buffer_pack4 = exec_graph->shared_pack4_mem;
+
     /* fp32 run */
     if (exec_graph->mode == TENGINE_MODE_FP32)
     {
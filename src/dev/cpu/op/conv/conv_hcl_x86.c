@@ -46,6 +46,10 @@ static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct
     /* get cpu affinity */
     conv_priv_info->cpu_type = exec_graph->cpu_affinity;
 
+    /* share the packed kernel with the other graphs of the model */
+    conv_priv_info->weight_key = exec_graph->weight_key;
+    conv_priv_info->weight_cache_dir = exec_graph->weight_cache_dir;
+
     /* fp32 prerun */
     if (exec_graph->mode == TENGINE_MODE_FP32 || exec_graph->mode == TENGINE_MODE_UINT8)
     {
@@ -103,6 +107,7 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct ir_tensor* weight_tensor;
     struct ir_tensor* output_tensor;
     struct ir_tensor* bias_tensor = NULL;
+    struct ir_tensor* residual_tensor = NULL;
     int num_thread = exec_graph->num_thread;
     int cpu_affinity = exec_graph->cpu_affinity;
 
@@ -112,15 +117,23 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
     if (ir_node->input_num > 2)
         bias_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[2]);
+    if (ir_node->input_num > 3)
+        residual_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[3]);
 
     struct conv_param* conv_param = ( struct conv_param* )ir_node->op.param_mem;
     struct conv_priv_info* conv_priv_info = ( struct conv_priv_info* )exec_node->ops_priv;
 
+    /* the shared memory moves when the memory arena of the context grows */
+    if (conv_priv_info->external_im2col_mem)
+        conv_priv_info->im2col_buffer = exec_graph->shared_mem;
+    if (conv_priv_info->external_im2col_pack4_mem)
+        conv_priv_info->im2col_buffer_pack4 = exec_graph->shared_pack4_mem;
+
     /* fp32 run */
     if (exec_graph->mode == TENGINE_MODE_FP32 || exec_graph->mode == TENGINE_MODE_UINT8)
     {
-        if (conv_hcl_run(input_tensor, weight_tensor, bias_tensor, output_tensor, conv_priv_info, conv_param, num_thread,
-                         cpu_affinity) < 0)
+        if (conv_hcl_run(input_tensor, weight_tensor, bias_tensor, residual_tensor, output_tensor, conv_priv_info,
+                         conv_param, exec_graph->thread_pool, num_thread, cpu_affinity) < 0)
         {
             TLOG_ERR("hcl conv run failed\n");
             set_tengine_errno(EFAULT);
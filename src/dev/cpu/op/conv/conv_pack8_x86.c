@@ -0,0 +1,172 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+#include "sys_port.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "tengine_ir.h"
+#include "../../cpu_node_ops.h"
+#include "tengine_op.h"
+#include "convolution_param.h"
+#include "weight_cache.h"
+#include "x86/conv_pack8_kernel_x86.h"
+
+/* the convolution of the nchw8 tensors, which only the blocked_layout pass makes */
+
+struct pack_arg
+{
+    struct ir_tensor* filter_tensor;
+    struct conv_param* conv_param;
+};
+
+static int pack_kernel(void* mem, void* pack_arg)
+{
+    struct pack_arg* arg = ( struct pack_arg* )pack_arg;
+
+    conv_pack8_pack_kernel(arg->filter_tensor, ( float* )mem, arg->conv_param);
+
+    return 0;
+}
+
+static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct ir_node* ir_node = exec_node->ir_node;
+    struct ir_graph* ir_graph = ir_node->graph;
+    struct ir_tensor* filter_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
+    struct conv_param* conv_param = ( struct conv_param* )ir_node->op.param_mem;
+    int mem_size = conv_pack8_get_kernel_size(filter_tensor, conv_param);
+
+    /* the packed kernel of the graphs loaded from the same model */
+    if (exec_graph->weight_key != NULL)
+    {
+        struct pack_arg arg;
+
+        arg.filter_tensor = filter_tensor;
+        arg.conv_param = conv_param;
+
+        exec_node->ops_priv = get_persist_weight(exec_graph->weight_cache_dir, exec_graph->weight_key,
+                                                 filter_tensor->idx, WEIGHT_CACHE_CONV_PACK8, mem_size, filter_tensor,
+                                                 pack_kernel, &arg);
+
+        return exec_node->ops_priv == NULL ? -1 : 0;
+    }
+
+    float* kernel = ( float* )sys_malloc(mem_size);
+
+    if (kernel == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    conv_pack8_pack_kernel(filter_tensor, kernel, conv_param);
+    exec_node->ops_priv = kernel;
+
+    return 0;
+}
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct ir_node* ir_node = exec_node->ir_node;
+    struct ir_graph* ir_graph = ir_node->graph;
+    struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct ir_tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct ir_tensor* bias_tensor = NULL;
+    struct ir_tensor* residual_tensor = NULL;
+
+    if (ir_node->input_num > 2)
+        bias_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[2]);
+    if (ir_node->input_num > 3)
+        residual_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[3]);
+
+    struct conv_param* conv_param = ( struct conv_param* )ir_node->op.param_mem;
+
+    if (conv_pack8_run(input_tensor, ( const float* )exec_node->ops_priv, bias_tensor, residual_tensor, output_tensor,
+                       conv_param, exec_graph->thread_pool) < 0)
+    {
+        TLOG_ERR("pack8 conv run failed\n");
+        set_tengine_errno(EFAULT);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int postrun(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    if (exec_graph->weight_key != NULL && exec_node->ops_priv != NULL)
+        put_shared_weight(exec_node->ops_priv);
+    else
+        sys_free(exec_node->ops_priv);
+
+    exec_node->ops_priv = NULL;
+
+    return 0;
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct ir_node* exec_node)
+{
+    struct ir_node* ir_node = exec_node;
+    struct ir_graph* ir_graph = ir_node->graph;
+    struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+
+    if (conv_pack8_run == NULL || input_tensor->layout != TENGINE_LAYOUT_NCHW8)
+        return 0;
+
+    /* no other kernel reads it */
+    return OPS_SCORE_STATIC;
+}
+
+static struct node_ops hcl_node_ops = {.prerun = prerun,
+                                       .run = run,
+                                       .reshape = NULL,
+                                       .postrun = postrun,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score};
+
+static int reg_conv_pack8_ops(void* arg)
+{
+    return register_builtin_node_ops(OP_CONV, &hcl_node_ops);
+}
+
+static int unreg_conv_pack8_ops(void* arg)
+{
+    unregister_builtin_node_ops(OP_CONV, &hcl_node_ops);
+    return 0;
+}
+
+AUTO_REGISTER_OPS(reg_conv_pack8_ops);
+AUTO_UNREGISTER_OPS(unreg_conv_pack8_ops);
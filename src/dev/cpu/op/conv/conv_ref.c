@@ -35,7 +35,7 @@
 #include "convolution_param.h"
 
 static  int ref_conv_fp32(struct ir_tensor* input_tensor, struct ir_tensor* output_tensor, struct ir_tensor* kernel,
-                      struct ir_tensor* bias, struct conv_param* conv_param)
+                      struct ir_tensor* bias, struct ir_tensor* residual, struct conv_param* conv_param)
 {
     int batch = input_tensor->dims[0];
     int group = conv_param->group;
@@ -58,6 +58,9 @@ static  int ref_conv_fp32(struct ir_tensor* input_tensor, struct ir_tensor* outp
     float* bias_data = NULL;
     if (bias != NULL)
         bias_data = bias->data;
+    float* residual_data = NULL;
+    if (residual != NULL)
+        residual_data = residual->data;
 
     if (conv_param->kernel_h == 0)
         conv_param->kernel_h = 1;
@@ -130,6 +133,10 @@ static  int ref_conv_fp32(struct ir_tensor* input_tensor, struct ir_tensor* outp
                         if (bias != NULL)
                             total += bias_data[output_c * g + c];
 
+                        /* the fused residual add, before the activation */
+                        if (residual != NULL)
+                            total += residual_data[output_offset];
+
                         if(conv_param->activation >= 0)
                         {
                             if(total < 0 && conv_param->activation != 1)
@@ -460,6 +467,7 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct ir_tensor* input_tensor;
     struct ir_tensor* weight_tensor;
     struct ir_tensor* bias_tensor = NULL;
+    struct ir_tensor* residual_tensor = NULL;
     struct ir_tensor* output_tensor = NULL;
     int num_thread   = exec_graph->num_thread;
     int cpu_affinity = exec_graph->cpu_affinity;
@@ -470,13 +478,17 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     {
         bias_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[2]);
     }
+    if (ir_node->input_num > 3)
+    {
+        residual_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[3]);
+    }
     output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
 
     struct conv_param* conv_param = ( struct conv_param* )ir_node->op.param_mem;
 
     int ret = 0;
     if (input_tensor->data_type == TENGINE_DT_FP32)
-        ret = ref_conv_fp32(input_tensor, output_tensor, weight_tensor, bias_tensor, conv_param);
+        ret = ref_conv_fp32(input_tensor, output_tensor, weight_tensor, bias_tensor, residual_tensor, conv_param);
     else if (input_tensor->data_type == TENGINE_DT_FP16)
         ret = ref_conv_fp16(input_tensor, output_tensor, weight_tensor, bias_tensor, conv_param);
     else if (input_tensor->data_type == TENGINE_DT_UINT8)
@@ -26,6 +26,7 @@
 #include <math.h>
 
 #include "conv_kernel_arm.h"
+#include "weight_cache.h"
 #include "wino_conv_kernel_arm.h"
 #ifdef __aarch64__
 #include "wino_conv_kernel_1_arm.h"
@@ -548,6 +549,23 @@ int conv_hcl_get_shared_pack4_mem_size(struct ir_tensor* filter, struct ir_tenso
     return 0;
 }
 
+struct interleave_arg
+{
+    struct ir_tensor* filter_tensor;
+    struct conv_priv_info* priv_info;
+    struct conv_param* param;
+};
+
+static int interleave_shared_kernel(void* mem, void* interleave_arg)
+{
+    struct interleave_arg* arg = ( struct interleave_arg* )interleave_arg;
+
+    arg->priv_info->interleave_buffer = mem;
+    interleave(arg->filter_tensor, arg->priv_info, arg->param);
+
+    return 0;
+}
+
 int conv_hcl_prerun(struct ir_tensor* input_tensor, struct ir_tensor* filter_tensor, struct ir_tensor* output_tensor,
                     struct conv_priv_info* priv_info, struct conv_param* param)
 {
@@ -576,6 +594,29 @@ int conv_hcl_prerun(struct ir_tensor* input_tensor, struct ir_tensor* filter_ten
         priv_info->im2col_buffer_size = mem_size;
     }
 
+    /* the interleaved kernel of the graphs loaded from the same model */
+    if (priv_info->weight_key != NULL && !priv_info->external_interleave_mem)
+    {
+        struct interleave_arg arg;
+        int mem_size = get_private_mem_size(filter_tensor, param);
+
+        arg.filter_tensor = filter_tensor;
+        arg.priv_info = priv_info;
+        arg.param = param;
+
+        void* mem = get_persist_weight(priv_info->weight_cache_dir, priv_info->weight_key, filter_tensor->idx,
+                                       WEIGHT_CACHE_CONV_GEMM, mem_size, filter_tensor, interleave_shared_kernel, &arg);
+
+        if (mem == NULL)
+            return -1;
+
+        priv_info->interleave_buffer = mem;
+        priv_info->interleave_buffer_size = mem_size;
+        priv_info->shared_interleave_mem = 1;
+
+        return 0;
+    }
+
     /* alloc mem of kernel interleave */
     if (!priv_info->external_interleave_mem)
     {
@@ -598,6 +639,13 @@ int conv_hcl_postrun(struct conv_priv_info* priv_info)
         wino_conv_hcl_postrun(priv_info);
     }
 
+    if (priv_info->shared_interleave_mem)
+    {
+        put_shared_weight(priv_info->interleave_buffer);
+        priv_info->interleave_buffer = NULL;
+        priv_info->shared_interleave_mem = 0;
+    }
+
     if (!priv_info->external_interleave_mem && priv_info->interleave_buffer != NULL)
     {
         sys_free(priv_info->interleave_buffer);
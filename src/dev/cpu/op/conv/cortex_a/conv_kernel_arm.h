@@ -48,6 +48,9 @@ struct conv_priv_info
     int external_interleave_pack4_mem;    // flag
     int cpu_type;
     int winograd;
+    const char* weight_key;    // share the packed kernel in the weight cache, if set
+    const char* weight_cache_dir;    // and persist it in this directory, if set
+    int shared_interleave_mem;    // flag
 
     /* hybrid int8 params */
     void* p_input_max;
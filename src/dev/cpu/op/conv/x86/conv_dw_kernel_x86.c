@@ -2531,8 +2531,10 @@ int conv_dw_run(struct ir_tensor* input_tensor, struct ir_tensor* weight_tensor,
 
     int ksize_h = param->kernel_h;
     int ksize_w = param->kernel_w;
-    int pad_w = param->pad_w0;
-    int pad_h = param->pad_h0;
+    int pad_w0 = param->pad_w0;
+    int pad_w1 = param->pad_w1;
+    int pad_h0 = param->pad_h0;
+    int pad_h1 = param->pad_h1;
 
     int stride_w = param->stride_w;
     int stride_h = param->stride_h;
@@ -2543,8 +2545,8 @@ int conv_dw_run(struct ir_tensor* input_tensor, struct ir_tensor* weight_tensor,
     int activation = param->activation;
 
     /* pading */
-    int inh_tmp = inh + pad_h + pad_h;
-    int inw_tmp = inw + pad_w + pad_w;
+    int inh_tmp = inh + pad_h0 + pad_h1;
+    int inw_tmp = inw + pad_w0 + pad_w1;
     float* input_tmp = NULL;
     if (inh_tmp == inh && inw_tmp == inw)
         input_tmp = input;
@@ -2555,7 +2557,7 @@ int conv_dw_run(struct ir_tensor* input_tensor, struct ir_tensor* weight_tensor,
         {
             float* pad_in = input + g * inh * inw;
             float* pad_out = input_tmp + g * inh_tmp * inw_tmp;
-            pad(pad_in, pad_out, inh, inw, inh_tmp, inw_tmp, pad_h, pad_w, 0.f);
+            pad(pad_in, pad_out, inh, inw, inh_tmp, inw_tmp, pad_h0, pad_w0, 0.f);
         }
     }
 
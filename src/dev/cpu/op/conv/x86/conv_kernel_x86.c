@@ -26,6 +26,9 @@
 #include <stdlib.h>
 #include <math.h>
 #include "conv_kernel_x86.h"
+#include "weight_cache.h"
+#include "thread_pool.h"
+#include "tengine_errno.h"
 #include "wino_conv_kernel_x86.h"
 #if __SSE2__
 #include <emmintrin.h>
@@ -192,1061 +195,1244 @@ static void im2col_ir(struct ir_tensor* input, struct ir_tensor* output, struct
                param->kernel_h, param->kernel_w, param->stride_h, param->stride_w, param->pad_h0, param->pad_w0, param->dilation_h, param->dilation_w);
 }
 
+/* the epilogue of sgemm, the bias, the residual if fused and the activation are applied to the output tile
+   before it is stored. activation -1: none, 0: relu, n > 0: relu clipped at n */
+static inline const float* residual_at(const float* residual, const float* pC, const float* output)
+{
+    return residual ? residual + (output - pC) : NULL;
+}
+
+static inline float epilogue_fp32(float data, float bias, const float* residual, int activation)
+{
+    data += bias;
+    if (residual)
+        data += residual[0];
+
+    if (activation >= 0)
+    {
+        data = max(data, 0.f);
+        if (activation > 0)
+            data = min(data, ( float )activation);
+    }
+
+    return data;
+}
+
+#if __SSE__
+static inline __m128 epilogue_sse(__m128 data, __m128 bias, const float* residual, int activation)
+{
+    data = _mm_add_ps(data, bias);
+    if (residual)
+        data = _mm_add_ps(data, _mm_loadu_ps(residual));
+
+    if (activation >= 0)
+    {
+        data = _mm_max_ps(data, _mm_setzero_ps());
+        if (activation > 0)
+            data = _mm_min_ps(data, _mm_set1_ps(( float )activation));
+    }
+
+    return data;
+}
+#endif
+
 #if __AVX__
-void input_pack4(int K, int N, float* pB, float* pB_t, int num_thread)
+static inline __m256 epilogue_avx(__m256 data, __m256 bias, const float* residual, int activation)
 {
-    int nn_size = N >> 3;
-    int remian_size_start = nn_size << 3;
+    data = _mm256_add_ps(data, bias);
+    if (residual)
+        data = _mm256_add_ps(data, _mm256_loadu_ps(residual));
 
-// [ch00, ch10, ch20, ch30, ch01, ch11, ch21, ch31, ch02, ch12, ch22, ch32, ch03, ch13, ch23, ch33 ....]
-#pragma omp parallel for num_threads(num_thread)
-    for (int ii = 0; ii < nn_size; ii++)
+    if (activation >= 0)
     {
-        int i = ii * 8;
-        const float* img = pB + i;
-        float* tmp = pB_t + (i / 8) * 8 * K;
+        data = _mm256_max_ps(data, _mm256_setzero_ps());
+        if (activation > 0)
+            data = _mm256_min_ps(data, _mm256_set1_ps(( float )activation));
+    }
 
-        for (int j = 0; j < K; j++)
-        {
+    return data;
+}
+#endif
+
+/* the parallel loops of the gemm and the packing run on the thread pool of the graph */
+struct input_pack4_arg
+{
+    int K;
+    int N;
+    float* pB;
+    float* pB_t;
+};
+
+struct sgemm_arg
+{
+    int N;
+    int K;
+    float* pA_t;
+    float* pB_t;
+    float* pC;
+    const float* bias;
+    const float* residual;
+    int activation;
+    int remain_outch_start;
+};
+
+#if __AVX__
+// [ch00, ch10, ch20, ch30, ch01, ch11, ch21, ch31, ch02, ch12, ch22, ch32, ch03, ch13, ch23, ch33 ....]
+static void input_pack4_block(void* arg, int ii)
+{
+    const struct input_pack4_arg* a = ( const struct input_pack4_arg* )arg;
+    int K = a->K;
+    int N = a->N;
+    float* pB = a->pB;
+    float* pB_t = a->pB_t;
+
+    int i = ii * 8;
+    const float* img = pB + i;
+    float* tmp = pB_t + (i / 8) * 8 * K;
+
+    for (int j = 0; j < K; j++)
+    {
 #if __AVX__
-            _mm256_storeu_ps(tmp, _mm256_loadu_ps(img));
+        _mm256_storeu_ps(tmp, _mm256_loadu_ps(img));
 #else
-            tmp[0] = img[0];
-            tmp[1] = img[1];
-            tmp[2] = img[2];
-            tmp[3] = img[3];
-            tmp[4] = img[4];
-            tmp[5] = img[5];
-            tmp[6] = img[6];
-            tmp[7] = img[7];
+        tmp[0] = img[0];
+        tmp[1] = img[1];
+        tmp[2] = img[2];
+        tmp[3] = img[3];
+        tmp[4] = img[4];
+        tmp[5] = img[5];
+        tmp[6] = img[6];
+        tmp[7] = img[7];
 #endif    // __SSE__
-            tmp += 8;
-            img += N;
-        }
+        tmp += 8;
+        img += N;
     }
+}
 
 // [ch00, ch01, ch02, ch03 ....]
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = remian_size_start; i < N; i++)
-    {
-        const float* img = pB + i;
-        float* tmp = pB_t + (i / 8 + i % 8) * 8 * K;
+static void input_pack4_remain(void* arg, int idx)
+{
+    const struct input_pack4_arg* a = ( const struct input_pack4_arg* )arg;
+    int K = a->K;
+    int N = a->N;
+    float* pB = a->pB;
+    float* pB_t = a->pB_t;
+    int i = (a->N >> 3 << 3) + idx;
 
-        for (int j = 0; j < K; j++)
-        {
-            tmp[0] = img[0];
+    const float* img = pB + i;
+    float* tmp = pB_t + (i / 8 + i % 8) * 8 * K;
 
-            tmp += 1;
-            img += N;
-        }
+    for (int j = 0; j < K; j++)
+    {
+        tmp[0] = img[0];
+
+        tmp += 1;
+        img += N;
     }
 }
-static void sgemm(int M, int N, int K, float* pA_t, float* pB_t, float* pC, int num_thread)
+
+void input_pack4(int K, int N, float* pB, float* pB_t, struct thread_pool* thread_pool)
 {
-    int nn_outch = 0;
-    int remain_outch_start = 0;
+    struct input_pack4_arg arg = {K, N, pB, pB_t};
+    int nn_size = N >> 3;
 
-    nn_outch = M >> 3;
-    remain_outch_start = nn_outch << 3;
+    thread_pool_parallel_for(thread_pool, nn_size, input_pack4_block, &arg);
+    thread_pool_parallel_for(thread_pool, N - (nn_size << 3), input_pack4_remain, &arg);
+}
 
-#pragma omp parallel for num_threads(num_thread)
-    for (int pp = 0; pp < nn_outch; pp++)
+/* 8 outputs, then 4, then 1 */
+static void sgemm_block8(void* arg, int pp)
+{
+    const struct sgemm_arg* a = ( const struct sgemm_arg* )arg;
+    int N = a->N;
+    int K = a->K;
+    float* pA_t = a->pA_t;
+    float* pB_t = a->pB_t;
+    float* pC = a->pC;
+    const float* bias = a->bias;
+    const float* residual = a->residual;
+    int activation = a->activation;
+
+    int i = pp * 8;
+
+    float* output0 = pC + ( i )*N;
+    float* output1 = pC + (i + 1) * N;
+    float* output2 = pC + (i + 2) * N;
+    float* output3 = pC + (i + 3) * N;
+    float* output4 = pC + (i + 4) * N;
+    float* output5 = pC + (i + 5) * N;
+    float* output6 = pC + (i + 6) * N;
+    float* output7 = pC + (i + 7) * N;
+
+    float bias0_7[8];
+    for (int n = 0; n < 8; n++)
+        bias0_7[n] = bias ? bias[i + n] : 0.f;
+
+    int j = 0;
+    for (; j + 7 < N; j += 8)
     {
-        int i = pp * 8;
-
-        float* output0 = pC + ( i )*N;
-        float* output1 = pC + (i + 1) * N;
-        float* output2 = pC + (i + 2) * N;
-        float* output3 = pC + (i + 3) * N;
-        float* output4 = pC + (i + 4) * N;
-        float* output5 = pC + (i + 5) * N;
-        float* output6 = pC + (i + 6) * N;
-        float* output7 = pC + (i + 7) * N;
-
-        int j = 0;
-        for (; j + 7 < N; j += 8)
-        {
-            float* va = pA_t + (i / 8) * 8 * K;
-            float* vb = pB_t + (j / 8) * 8 * K;
+        float* va = pA_t + (i / 8) * 8 * K;
+        float* vb = pB_t + (j / 8) * 8 * K;
 #if __AVX__
-            __m256 _sum0 = _mm256_set1_ps(0.0);
-            __m256 _sum1 = _mm256_set1_ps(0.0);
-            __m256 _sum2 = _mm256_set1_ps(0.0);
-            __m256 _sum3 = _mm256_set1_ps(0.0);
-            __m256 _sum4 = _mm256_set1_ps(0.0);
-            __m256 _sum5 = _mm256_set1_ps(0.0);
-            __m256 _sum6 = _mm256_set1_ps(0.0);
-            __m256 _sum7 = _mm256_set1_ps(0.0);
-
-            int k = 0;
-            for (; k + 3 < K; k = k + 4)
-            {
-                // k0
-                __m256 _va0 = _mm256_broadcast_ss(va);
-                __m256 _va1 = _mm256_broadcast_ss(va + 1);
-                __m256 _va2 = _mm256_broadcast_ss(va + 2);
-                __m256 _va3 = _mm256_broadcast_ss(va + 3);
-                __m256 _vb0 = _mm256_loadu_ps(vb);
-                __m256 _vb1 = _mm256_loadu_ps(vb + 8);
-                __m256 _vb2 = _mm256_loadu_ps(vb + 16);
-                __m256 _vb3 = _mm256_loadu_ps(vb + 24);
-                _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
-                _sum1 = _mm256_fmadd_ps(_vb0, _va1, _sum1);    // sum1 = (a00-a07) * k10
-                _sum2 = _mm256_fmadd_ps(_vb0, _va2, _sum2);    // sum2 = (a00-a07) * k20
-                _sum3 = _mm256_fmadd_ps(_vb0, _va3, _sum3);    // sum3 = (a00-a07) * k30
-                _va0 = _mm256_broadcast_ss(va + 4);
-                _va1 = _mm256_broadcast_ss(va + 5);
-                _va2 = _mm256_broadcast_ss(va + 6);
-                _va3 = _mm256_broadcast_ss(va + 7);
-                _sum4 = _mm256_fmadd_ps(_vb0, _va0, _sum4);    // sum4 = (a00-a07) * k40
-                _sum5 = _mm256_fmadd_ps(_vb0, _va1, _sum5);    // sum5 = (a00-a07) * k50
-                _sum6 = _mm256_fmadd_ps(_vb0, _va2, _sum6);    // sum6 = (a00-a07) * k60
-                _sum7 = _mm256_fmadd_ps(_vb0, _va3, _sum7);    // sum7 = (a00-a07) * k70
-
-                va += 8;
-
-                // k1
-                _va0 = _mm256_broadcast_ss(va);
-                _va1 = _mm256_broadcast_ss(va + 1);
-                _va2 = _mm256_broadcast_ss(va + 2);
-                _va3 = _mm256_broadcast_ss(va + 3);
-                _sum0 = _mm256_fmadd_ps(_vb1, _va0, _sum0);    // sum0 += (a10-a17) * k01
-                _sum1 = _mm256_fmadd_ps(_vb1, _va1, _sum1);    // sum1 += (a10-a17) * k11
-                _sum2 = _mm256_fmadd_ps(_vb1, _va2, _sum2);    // sum2 += (a10-a17) * k21
-                _sum3 = _mm256_fmadd_ps(_vb1, _va3, _sum3);    // sum3 += (a10-a17) * k31
-                _va0 = _mm256_broadcast_ss(va + 4);
-                _va1 = _mm256_broadcast_ss(va + 5);
-                _va2 = _mm256_broadcast_ss(va + 6);
-                _va3 = _mm256_broadcast_ss(va + 7);
-                _sum4 = _mm256_fmadd_ps(_vb1, _va0, _sum4);    // sum4 += (a10-a17) * k41
-                _sum5 = _mm256_fmadd_ps(_vb1, _va1, _sum5);    // sum5 += (a10-a17) * k51
-                _sum6 = _mm256_fmadd_ps(_vb1, _va2, _sum6);    // sum6 += (a10-a17) * k61
-                _sum7 = _mm256_fmadd_ps(_vb1, _va3, _sum7);    // sum7 += (a10-a17) * k71
-
-                va += 8;
-
-                // k2
-                _va0 = _mm256_broadcast_ss(va);
-                _va1 = _mm256_broadcast_ss(va + 1);
-                _va2 = _mm256_broadcast_ss(va + 2);
-                _va3 = _mm256_broadcast_ss(va + 3);
-                _sum0 = _mm256_fmadd_ps(_vb2, _va0, _sum0);    // sum0 += (a20-a27) * k02
-                _sum1 = _mm256_fmadd_ps(_vb2, _va1, _sum1);    // sum1 += (a20-a27) * k12
-                _sum2 = _mm256_fmadd_ps(_vb2, _va2, _sum2);    // sum2 += (a20-a27) * k22
-                _sum3 = _mm256_fmadd_ps(_vb2, _va3, _sum3);    // sum3 += (a20-a27) * k32
-                _va0 = _mm256_broadcast_ss(va + 4);
-                _va1 = _mm256_broadcast_ss(va + 5);
-                _va2 = _mm256_broadcast_ss(va + 6);
-                _va3 = _mm256_broadcast_ss(va + 7);
-                _sum4 = _mm256_fmadd_ps(_vb2, _va0, _sum4);    // sum4 += (a20-a27) * k42
-                _sum5 = _mm256_fmadd_ps(_vb2, _va1, _sum5);    // sum5 += (a20-a27) * k52
-                _sum6 = _mm256_fmadd_ps(_vb2, _va2, _sum6);    // sum6 += (a20-a27) * k62
-                _sum7 = _mm256_fmadd_ps(_vb2, _va3, _sum7);    // sum7 += (a20-a27) * k72
-
-                va += 8;
-
-                // k3
-                _va0 = _mm256_broadcast_ss(va);
-                _va1 = _mm256_broadcast_ss(va + 1);
-                _va2 = _mm256_broadcast_ss(va + 2);
-                _va3 = _mm256_broadcast_ss(va + 3);
-                _sum0 = _mm256_fmadd_ps(_vb3, _va0, _sum0);    // sum0 += (a30-a37) * k03
-                _sum1 = _mm256_fmadd_ps(_vb3, _va1, _sum1);    // sum1 += (a30-a37) * k13
-                _sum2 = _mm256_fmadd_ps(_vb3, _va2, _sum2);    // sum2 += (a30-a37) * k23
-                _sum3 = _mm256_fmadd_ps(_vb3, _va3, _sum3);    // sum3 += (a30-a37) * k33
-                _va0 = _mm256_broadcast_ss(va + 4);
-                _va1 = _mm256_broadcast_ss(va + 5);
-                _va2 = _mm256_broadcast_ss(va + 6);
-                _va3 = _mm256_broadcast_ss(va + 7);
-                _sum4 = _mm256_fmadd_ps(_vb3, _va0, _sum4);    // sum4 += (a30-a37) * k43
-                _sum5 = _mm256_fmadd_ps(_vb3, _va1, _sum5);    // sum5 += (a30-a37) * k53
-                _sum6 = _mm256_fmadd_ps(_vb3, _va2, _sum6);    // sum6 += (a30-a37) * k63
-                _sum7 = _mm256_fmadd_ps(_vb3, _va3, _sum7);    // sum7 += (a30-a37) * k73
-
-                va += 8;
-                vb += 32;
-            }
+        __m256 _sum0 = _mm256_set1_ps(0.0);
+        __m256 _sum1 = _mm256_set1_ps(0.0);
+        __m256 _sum2 = _mm256_set1_ps(0.0);
+        __m256 _sum3 = _mm256_set1_ps(0.0);
+        __m256 _sum4 = _mm256_set1_ps(0.0);
+        __m256 _sum5 = _mm256_set1_ps(0.0);
+        __m256 _sum6 = _mm256_set1_ps(0.0);
+        __m256 _sum7 = _mm256_set1_ps(0.0);
+
+        int k = 0;
+        for (; k + 3 < K; k = k + 4)
+        {
+            // k0
+            __m256 _va0 = _mm256_broadcast_ss(va);
+            __m256 _va1 = _mm256_broadcast_ss(va + 1);
+            __m256 _va2 = _mm256_broadcast_ss(va + 2);
+            __m256 _va3 = _mm256_broadcast_ss(va + 3);
+            __m256 _vb0 = _mm256_loadu_ps(vb);
+            __m256 _vb1 = _mm256_loadu_ps(vb + 8);
+            __m256 _vb2 = _mm256_loadu_ps(vb + 16);
+            __m256 _vb3 = _mm256_loadu_ps(vb + 24);
+            _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
+            _sum1 = _mm256_fmadd_ps(_vb0, _va1, _sum1);    // sum1 = (a00-a07) * k10
+            _sum2 = _mm256_fmadd_ps(_vb0, _va2, _sum2);    // sum2 = (a00-a07) * k20
+            _sum3 = _mm256_fmadd_ps(_vb0, _va3, _sum3);    // sum3 = (a00-a07) * k30
+            _va0 = _mm256_broadcast_ss(va + 4);
+            _va1 = _mm256_broadcast_ss(va + 5);
+            _va2 = _mm256_broadcast_ss(va + 6);
+            _va3 = _mm256_broadcast_ss(va + 7);
+            _sum4 = _mm256_fmadd_ps(_vb0, _va0, _sum4);    // sum4 = (a00-a07) * k40
+            _sum5 = _mm256_fmadd_ps(_vb0, _va1, _sum5);    // sum5 = (a00-a07) * k50
+            _sum6 = _mm256_fmadd_ps(_vb0, _va2, _sum6);    // sum6 = (a00-a07) * k60
+            _sum7 = _mm256_fmadd_ps(_vb0, _va3, _sum7);    // sum7 = (a00-a07) * k70
+
+            va += 8;
+
+            // k1
+            _va0 = _mm256_broadcast_ss(va);
+            _va1 = _mm256_broadcast_ss(va + 1);
+            _va2 = _mm256_broadcast_ss(va + 2);
+            _va3 = _mm256_broadcast_ss(va + 3);
+            _sum0 = _mm256_fmadd_ps(_vb1, _va0, _sum0);    // sum0 += (a10-a17) * k01
+            _sum1 = _mm256_fmadd_ps(_vb1, _va1, _sum1);    // sum1 += (a10-a17) * k11
+            _sum2 = _mm256_fmadd_ps(_vb1, _va2, _sum2);    // sum2 += (a10-a17) * k21
+            _sum3 = _mm256_fmadd_ps(_vb1, _va3, _sum3);    // sum3 += (a10-a17) * k31
+            _va0 = _mm256_broadcast_ss(va + 4);
+            _va1 = _mm256_broadcast_ss(va + 5);
+            _va2 = _mm256_broadcast_ss(va + 6);
+            _va3 = _mm256_broadcast_ss(va + 7);
+            _sum4 = _mm256_fmadd_ps(_vb1, _va0, _sum4);    // sum4 += (a10-a17) * k41
+            _sum5 = _mm256_fmadd_ps(_vb1, _va1, _sum5);    // sum5 += (a10-a17) * k51
+            _sum6 = _mm256_fmadd_ps(_vb1, _va2, _sum6);    // sum6 += (a10-a17) * k61
+            _sum7 = _mm256_fmadd_ps(_vb1, _va3, _sum7);    // sum7 += (a10-a17) * k71
+
+            va += 8;
+
+            // k2
+            _va0 = _mm256_broadcast_ss(va);
+            _va1 = _mm256_broadcast_ss(va + 1);
+            _va2 = _mm256_broadcast_ss(va + 2);
+            _va3 = _mm256_broadcast_ss(va + 3);
+            _sum0 = _mm256_fmadd_ps(_vb2, _va0, _sum0);    // sum0 += (a20-a27) * k02
+            _sum1 = _mm256_fmadd_ps(_vb2, _va1, _sum1);    // sum1 += (a20-a27) * k12
+            _sum2 = _mm256_fmadd_ps(_vb2, _va2, _sum2);    // sum2 += (a20-a27) * k22
+            _sum3 = _mm256_fmadd_ps(_vb2, _va3, _sum3);    // sum3 += (a20-a27) * k32
+            _va0 = _mm256_broadcast_ss(va + 4);
+            _va1 = _mm256_broadcast_ss(va + 5);
+            _va2 = _mm256_broadcast_ss(va + 6);
+            _va3 = _mm256_broadcast_ss(va + 7);
+            _sum4 = _mm256_fmadd_ps(_vb2, _va0, _sum4);    // sum4 += (a20-a27) * k42
+            _sum5 = _mm256_fmadd_ps(_vb2, _va1, _sum5);    // sum5 += (a20-a27) * k52
+            _sum6 = _mm256_fmadd_ps(_vb2, _va2, _sum6);    // sum6 += (a20-a27) * k62
+            _sum7 = _mm256_fmadd_ps(_vb2, _va3, _sum7);    // sum7 += (a20-a27) * k72
+
+            va += 8;
+
+            // k3
+            _va0 = _mm256_broadcast_ss(va);
+            _va1 = _mm256_broadcast_ss(va + 1);
+            _va2 = _mm256_broadcast_ss(va + 2);
+            _va3 = _mm256_broadcast_ss(va + 3);
+            _sum0 = _mm256_fmadd_ps(_vb3, _va0, _sum0);    // sum0 += (a30-a37) * k03
+            _sum1 = _mm256_fmadd_ps(_vb3, _va1, _sum1);    // sum1 += (a30-a37) * k13
+            _sum2 = _mm256_fmadd_ps(_vb3, _va2, _sum2);    // sum2 += (a30-a37) * k23
+            _sum3 = _mm256_fmadd_ps(_vb3, _va3, _sum3);    // sum3 += (a30-a37) * k33
+            _va0 = _mm256_broadcast_ss(va + 4);
+            _va1 = _mm256_broadcast_ss(va + 5);
+            _va2 = _mm256_broadcast_ss(va + 6);
+            _va3 = _mm256_broadcast_ss(va + 7);
+            _sum4 = _mm256_fmadd_ps(_vb3, _va0, _sum4);    // sum4 += (a30-a37) * k43
+            _sum5 = _mm256_fmadd_ps(_vb3, _va1, _sum5);    // sum5 += (a30-a37) * k53
+            _sum6 = _mm256_fmadd_ps(_vb3, _va2, _sum6);    // sum6 += (a30-a37) * k63
+            _sum7 = _mm256_fmadd_ps(_vb3, _va3, _sum7);    // sum7 += (a30-a37) * k73
+
+            va += 8;
+            vb += 32;
+        }
 
-            for (; k < K; k++)
-            {
-                // k0
-                __m256 _va0 = _mm256_broadcast_ss(va);
-                __m256 _va1 = _mm256_broadcast_ss(va + 1);
-                __m256 _va2 = _mm256_broadcast_ss(va + 2);
-                __m256 _va3 = _mm256_broadcast_ss(va + 3);
-                __m256 _va4 = _mm256_broadcast_ss(va + 4);
-                __m256 _va5 = _mm256_broadcast_ss(va + 5);
-                __m256 _va6 = _mm256_broadcast_ss(va + 6);
-                __m256 _va7 = _mm256_broadcast_ss(va + 7);
-                __m256 _vb0 = _mm256_loadu_ps(vb);
-                _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
-                _sum1 = _mm256_fmadd_ps(_vb0, _va1, _sum1);    // sum1 = (a00-a07) * k10
-                _sum2 = _mm256_fmadd_ps(_vb0, _va2, _sum2);    // sum2 = (a00-a07) * k20
-                _sum3 = _mm256_fmadd_ps(_vb0, _va3, _sum3);    // sum3 = (a00-a07) * k30
-                _sum4 = _mm256_fmadd_ps(_vb0, _va4, _sum4);    // sum4 = (a00-a07) * k40
-                _sum5 = _mm256_fmadd_ps(_vb0, _va5, _sum5);    // sum5 = (a00-a07) * k50
-                _sum6 = _mm256_fmadd_ps(_vb0, _va6, _sum6);    // sum6 = (a00-a07) * k60
-                _sum7 = _mm256_fmadd_ps(_vb0, _va7, _sum7);    // sum7 = (a00-a07) * k70
-
-                va += 8;
-                vb += 8;
-            }
+        for (; k < K; k++)
+        {
+            // k0
+            __m256 _va0 = _mm256_broadcast_ss(va);
+            __m256 _va1 = _mm256_broadcast_ss(va + 1);
+            __m256 _va2 = _mm256_broadcast_ss(va + 2);
+            __m256 _va3 = _mm256_broadcast_ss(va + 3);
+            __m256 _va4 = _mm256_broadcast_ss(va + 4);
+            __m256 _va5 = _mm256_broadcast_ss(va + 5);
+            __m256 _va6 = _mm256_broadcast_ss(va + 6);
+            __m256 _va7 = _mm256_broadcast_ss(va + 7);
+            __m256 _vb0 = _mm256_loadu_ps(vb);
+            _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
+            _sum1 = _mm256_fmadd_ps(_vb0, _va1, _sum1);    // sum1 = (a00-a07) * k10
+            _sum2 = _mm256_fmadd_ps(_vb0, _va2, _sum2);    // sum2 = (a00-a07) * k20
+            _sum3 = _mm256_fmadd_ps(_vb0, _va3, _sum3);    // sum3 = (a00-a07) * k30
+            _sum4 = _mm256_fmadd_ps(_vb0, _va4, _sum4);    // sum4 = (a00-a07) * k40
+            _sum5 = _mm256_fmadd_ps(_vb0, _va5, _sum5);    // sum5 = (a00-a07) * k50
+            _sum6 = _mm256_fmadd_ps(_vb0, _va6, _sum6);    // sum6 = (a00-a07) * k60
+            _sum7 = _mm256_fmadd_ps(_vb0, _va7, _sum7);    // sum7 = (a00-a07) * k70
+
+            va += 8;
+            vb += 8;
+        }
 
-            _mm256_storeu_ps(output0, _sum0);
-            _mm256_storeu_ps(output1, _sum1);
-            _mm256_storeu_ps(output2, _sum2);
-            _mm256_storeu_ps(output3, _sum3);
-            _mm256_storeu_ps(output4, _sum4);
-            _mm256_storeu_ps(output5, _sum5);
-            _mm256_storeu_ps(output6, _sum6);
-            _mm256_storeu_ps(output7, _sum7);
+        _mm256_storeu_ps(output0, epilogue_avx(_sum0, _mm256_set1_ps(bias0_7[0]), residual_at(residual, pC, output0), activation));
+        _mm256_storeu_ps(output1, epilogue_avx(_sum1, _mm256_set1_ps(bias0_7[1]), residual_at(residual, pC, output1), activation));
+        _mm256_storeu_ps(output2, epilogue_avx(_sum2, _mm256_set1_ps(bias0_7[2]), residual_at(residual, pC, output2), activation));
+        _mm256_storeu_ps(output3, epilogue_avx(_sum3, _mm256_set1_ps(bias0_7[3]), residual_at(residual, pC, output3), activation));
+        _mm256_storeu_ps(output4, epilogue_avx(_sum4, _mm256_set1_ps(bias0_7[4]), residual_at(residual, pC, output4), activation));
+        _mm256_storeu_ps(output5, epilogue_avx(_sum5, _mm256_set1_ps(bias0_7[5]), residual_at(residual, pC, output5), activation));
+        _mm256_storeu_ps(output6, epilogue_avx(_sum6, _mm256_set1_ps(bias0_7[6]), residual_at(residual, pC, output6), activation));
+        _mm256_storeu_ps(output7, epilogue_avx(_sum7, _mm256_set1_ps(bias0_7[7]), residual_at(residual, pC, output7), activation));
 #else
-            float sum0[8] = {0};
-            float sum1[8] = {0};
-            float sum2[8] = {0};
-            float sum3[8] = {0};
-            float sum4[8] = {0};
-            float sum5[8] = {0};
-            float sum6[8] = {0};
-            float sum7[8] = {0};
-
-            for (int k = 0; k < K; k++)
-            {
-                for (int n = 0; n < 8; n++)
-                {
-                    sum0[n] += va[0] * vb[n];
-                    sum1[n] += va[1] * vb[n];
-                    sum2[n] += va[2] * vb[n];
-                    sum3[n] += va[3] * vb[n];
-                    sum4[n] += va[4] * vb[n];
-                    sum5[n] += va[5] * vb[n];
-                    sum6[n] += va[6] * vb[n];
-                    sum7[n] += va[7] * vb[n];
-                }
-
-                va += 8;
-                vb += 8;
-            }
-
+        float sum0[8] = {0};
+        float sum1[8] = {0};
+        float sum2[8] = {0};
+        float sum3[8] = {0};
+        float sum4[8] = {0};
+        float sum5[8] = {0};
+        float sum6[8] = {0};
+        float sum7[8] = {0};
+
+        for (int k = 0; k < K; k++)
+        {
             for (int n = 0; n < 8; n++)
             {
-                output0[n] = sum0[n];
-                output1[n] = sum1[n];
-                output2[n] = sum2[n];
-                output3[n] = sum3[n];
-                output4[n] = sum4[n];
-                output5[n] = sum5[n];
-                output6[n] = sum6[n];
-                output7[n] = sum7[n];
+                sum0[n] += va[0] * vb[n];
+                sum1[n] += va[1] * vb[n];
+                sum2[n] += va[2] * vb[n];
+                sum3[n] += va[3] * vb[n];
+                sum4[n] += va[4] * vb[n];
+                sum5[n] += va[5] * vb[n];
+                sum6[n] += va[6] * vb[n];
+                sum7[n] += va[7] * vb[n];
             }
-#endif    // __AVX__
-            output0 += 8;
-            output1 += 8;
-            output2 += 8;
-            output3 += 8;
-            output4 += 8;
-            output5 += 8;
-            output6 += 8;
-            output7 += 8;
+
+            va += 8;
+            vb += 8;
         }
 
-        for (; j < N; j++)
+        for (int n = 0; n < 8; n++)
         {
-            float* va = pA_t + (i / 8) * 8 * K;
-            float* vb = pB_t + (j / 8 + j % 8) * 8 * K;
+            output0[n] = epilogue_fp32(sum0[n], bias0_7[0], residual_at(residual, pC, output0 + n), activation);
+            output1[n] = epilogue_fp32(sum1[n], bias0_7[1], residual_at(residual, pC, output1 + n), activation);
+            output2[n] = epilogue_fp32(sum2[n], bias0_7[2], residual_at(residual, pC, output2 + n), activation);
+            output3[n] = epilogue_fp32(sum3[n], bias0_7[3], residual_at(residual, pC, output3 + n), activation);
+            output4[n] = epilogue_fp32(sum4[n], bias0_7[4], residual_at(residual, pC, output4 + n), activation);
+            output5[n] = epilogue_fp32(sum5[n], bias0_7[5], residual_at(residual, pC, output5 + n), activation);
+            output6[n] = epilogue_fp32(sum6[n], bias0_7[6], residual_at(residual, pC, output6 + n), activation);
+            output7[n] = epilogue_fp32(sum7[n], bias0_7[7], residual_at(residual, pC, output7 + n), activation);
+        }
+#endif    // __AVX__
+        output0 += 8;
+        output1 += 8;
+        output2 += 8;
+        output3 += 8;
+        output4 += 8;
+        output5 += 8;
+        output6 += 8;
+        output7 += 8;
+    }
+
+    for (; j < N; j++)
+    {
+        float* va = pA_t + (i / 8) * 8 * K;
+        float* vb = pB_t + (j / 8 + j % 8) * 8 * K;
 
 #if __AVX__
-            __m256 _sum0_7 = _mm256_set1_ps(0.0);
-            __m256 _sum0 = _mm256_set1_ps(0.0);
-            __m256 _sum1 = _mm256_set1_ps(0.0);
-            __m256 _sum2 = _mm256_set1_ps(0.0);
-            __m256 _sum3 = _mm256_set1_ps(0.0);
-
-            int k = 0;
-            for (; k + 3 < K; k = k + 4)
-            {
-                __m256 _vb0 = _mm256_broadcast_ss(vb);
-                __m256 _vb1 = _mm256_broadcast_ss(vb + 1);
-                __m256 _vb2 = _mm256_broadcast_ss(vb + 2);
-                __m256 _vb3 = _mm256_broadcast_ss(vb + 3);
-                __m256 _va0 = _mm256_loadu_ps(va);
-                __m256 _va1 = _mm256_loadu_ps(va + 8);
-                __m256 _va2 = _mm256_loadu_ps(va + 16);
-                __m256 _va3 = _mm256_loadu_ps(va + 24);
-
-                _sum0 = _mm256_fmadd_ps(_va0, _vb0, _sum0);    // sum0 += (k00-k70) * a00
-                _sum1 = _mm256_fmadd_ps(_va1, _vb1, _sum1);    // sum1 += (k01-k71) * a10
-                _sum2 = _mm256_fmadd_ps(_va2, _vb2, _sum2);    // sum2 += (k02-k72) * a20
-                _sum3 = _mm256_fmadd_ps(_va3, _vb3, _sum3);    // sum3 += (k03-k73) * a30
-
-                va += 32;
-                vb += 4;
-            }
+        __m256 _sum0_7 = _mm256_set1_ps(0.0);
+        __m256 _sum0 = _mm256_set1_ps(0.0);
+        __m256 _sum1 = _mm256_set1_ps(0.0);
+        __m256 _sum2 = _mm256_set1_ps(0.0);
+        __m256 _sum3 = _mm256_set1_ps(0.0);
+
+        int k = 0;
+        for (; k + 3 < K; k = k + 4)
+        {
+            __m256 _vb0 = _mm256_broadcast_ss(vb);
+            __m256 _vb1 = _mm256_broadcast_ss(vb + 1);
+            __m256 _vb2 = _mm256_broadcast_ss(vb + 2);
+            __m256 _vb3 = _mm256_broadcast_ss(vb + 3);
+            __m256 _va0 = _mm256_loadu_ps(va);
+            __m256 _va1 = _mm256_loadu_ps(va + 8);
+            __m256 _va2 = _mm256_loadu_ps(va + 16);
+            __m256 _va3 = _mm256_loadu_ps(va + 24);
+
+            _sum0 = _mm256_fmadd_ps(_va0, _vb0, _sum0);    // sum0 += (k00-k70) * a00
+            _sum1 = _mm256_fmadd_ps(_va1, _vb1, _sum1);    // sum1 += (k01-k71) * a10
+            _sum2 = _mm256_fmadd_ps(_va2, _vb2, _sum2);    // sum2 += (k02-k72) * a20
+            _sum3 = _mm256_fmadd_ps(_va3, _vb3, _sum3);    // sum3 += (k03-k73) * a30
+
+            va += 32;
+            vb += 4;
+        }
 
-            _sum0 = _mm256_add_ps(_sum0, _sum1);
-            _sum2 = _mm256_add_ps(_sum2, _sum3);
-            _sum0_7 = _mm256_add_ps(_sum0_7, _sum0);
-            _sum0_7 = _mm256_add_ps(_sum0_7, _sum2);
+        _sum0 = _mm256_add_ps(_sum0, _sum1);
+        _sum2 = _mm256_add_ps(_sum2, _sum3);
+        _sum0_7 = _mm256_add_ps(_sum0_7, _sum0);
+        _sum0_7 = _mm256_add_ps(_sum0_7, _sum2);
 
-            for (; k < K; k++)
-            {
-                __m256 _vb0 = _mm256_broadcast_ss(vb);
-                __m256 _va = _mm256_loadu_ps(va);
+        for (; k < K; k++)
+        {
+            __m256 _vb0 = _mm256_broadcast_ss(vb);
+            __m256 _va = _mm256_loadu_ps(va);
 
-                _sum0_7 = _mm256_fmadd_ps(_va, _vb0, _sum0_7);    // sum0 += (k00-k70) * a00
+            _sum0_7 = _mm256_fmadd_ps(_va, _vb0, _sum0_7);    // sum0 += (k00-k70) * a00
 
-                va += 8;
-                vb += 1;
-            }
+            va += 8;
+            vb += 1;
+        }
 
-            float output_sum0_7[8] = {0.f};
-            _mm256_storeu_ps(output_sum0_7, _sum0_7);
-
-            output0[0] = output_sum0_7[0];
-            output1[0] = output_sum0_7[1];
-            output2[0] = output_sum0_7[2];
-            output3[0] = output_sum0_7[3];
-            output4[0] = output_sum0_7[4];
-            output5[0] = output_sum0_7[5];
-            output6[0] = output_sum0_7[6];
-            output7[0] = output_sum0_7[7];
+        float output_sum0_7[8] = {0.f};
+        _mm256_storeu_ps(output_sum0_7, _sum0_7);
+
+        output0[0] = epilogue_fp32(output_sum0_7[0], bias0_7[0], residual_at(residual, pC, output0), activation);
+        output1[0] = epilogue_fp32(output_sum0_7[1], bias0_7[1], residual_at(residual, pC, output1), activation);
+        output2[0] = epilogue_fp32(output_sum0_7[2], bias0_7[2], residual_at(residual, pC, output2), activation);
+        output3[0] = epilogue_fp32(output_sum0_7[3], bias0_7[3], residual_at(residual, pC, output3), activation);
+        output4[0] = epilogue_fp32(output_sum0_7[4], bias0_7[4], residual_at(residual, pC, output4), activation);
+        output5[0] = epilogue_fp32(output_sum0_7[5], bias0_7[5], residual_at(residual, pC, output5), activation);
+        output6[0] = epilogue_fp32(output_sum0_7[6], bias0_7[6], residual_at(residual, pC, output6), activation);
+        output7[0] = epilogue_fp32(output_sum0_7[7], bias0_7[7], residual_at(residual, pC, output7), activation);
 #else
-            float sum0 = 0;
-            float sum1 = 0;
-            float sum2 = 0;
-            float sum3 = 0;
-            float sum4 = 0;
-            float sum5 = 0;
-            float sum6 = 0;
-            float sum7 = 0;
-
-            for (int k = 0; k < K; k++)
-            {
-                sum0 += va[0] * vb[0];
-                sum1 += va[1] * vb[0];
-                sum2 += va[2] * vb[0];
-                sum3 += va[3] * vb[0];
-                sum4 += va[4] * vb[0];
-                sum5 += va[5] * vb[0];
-                sum6 += va[6] * vb[0];
-                sum7 += va[7] * vb[0];
-
-                va += 8;
-                vb += 1;
-            }
-            output0[0] = sum0;
-            output1[0] = sum1;
-            output2[0] = sum2;
-            output3[0] = sum3;
-            output4[0] = sum4;
-            output5[0] = sum5;
-            output6[0] = sum6;
-            output7[0] = sum7;
-#endif    // __AVX__
-            output0++;
-            output1++;
-            output2++;
-            output3++;
-            output4++;
-            output5++;
-            output6++;
-            output7++;
+        float sum0 = 0;
+        float sum1 = 0;
+        float sum2 = 0;
+        float sum3 = 0;
+        float sum4 = 0;
+        float sum5 = 0;
+        float sum6 = 0;
+        float sum7 = 0;
+
+        for (int k = 0; k < K; k++)
+        {
+            sum0 += va[0] * vb[0];
+            sum1 += va[1] * vb[0];
+            sum2 += va[2] * vb[0];
+            sum3 += va[3] * vb[0];
+            sum4 += va[4] * vb[0];
+            sum5 += va[5] * vb[0];
+            sum6 += va[6] * vb[0];
+            sum7 += va[7] * vb[0];
+
+            va += 8;
+            vb += 1;
         }
+        output0[0] = epilogue_fp32(sum0, bias0_7[0], residual_at(residual, pC, output0), activation);
+        output1[0] = epilogue_fp32(sum1, bias0_7[1], residual_at(residual, pC, output1), activation);
+        output2[0] = epilogue_fp32(sum2, bias0_7[2], residual_at(residual, pC, output2), activation);
+        output3[0] = epilogue_fp32(sum3, bias0_7[3], residual_at(residual, pC, output3), activation);
+        output4[0] = epilogue_fp32(sum4, bias0_7[4], residual_at(residual, pC, output4), activation);
+        output5[0] = epilogue_fp32(sum5, bias0_7[5], residual_at(residual, pC, output5), activation);
+        output6[0] = epilogue_fp32(sum6, bias0_7[6], residual_at(residual, pC, output6), activation);
+        output7[0] = epilogue_fp32(sum7, bias0_7[7], residual_at(residual, pC, output7), activation);
+#endif    // __AVX__
+        output0++;
+        output1++;
+        output2++;
+        output3++;
+        output4++;
+        output5++;
+        output6++;
+        output7++;
     }
+}
 
-    nn_outch = (M - remain_outch_start) >> 2;
-
-    for (int pp = 0; pp < nn_outch; pp++)
+static void sgemm_block4(void* arg, int pp)
+{
+    const struct sgemm_arg* a = ( const struct sgemm_arg* )arg;
+    int N = a->N;
+    int K = a->K;
+    float* pA_t = a->pA_t;
+    float* pB_t = a->pB_t;
+    float* pC = a->pC;
+    const float* bias = a->bias;
+    const float* residual = a->residual;
+    int activation = a->activation;
+
+    int i = a->remain_outch_start + pp * 4;
+
+    float* output0 = pC + ( i )*N;
+    float* output1 = pC + (i + 1) * N;
+    float* output2 = pC + (i + 2) * N;
+    float* output3 = pC + (i + 3) * N;
+
+    float bias0_3[4];
+    for (int n = 0; n < 4; n++)
+        bias0_3[n] = bias ? bias[i + n] : 0.f;
+
+    int j = 0;
+    for (; j + 7 < N; j += 8)
     {
-        int i = remain_outch_start + pp * 4;
-
-        float* output0 = pC + ( i )*N;
-        float* output1 = pC + (i + 1) * N;
-        float* output2 = pC + (i + 2) * N;
-        float* output3 = pC + (i + 3) * N;
-
-        int j = 0;
-        for (; j + 7 < N; j += 8)
-        {
-            float* va = pA_t + (i / 8 + (i % 8) / 4) * 8 * K;
-            float* vb = pB_t + (j / 8) * 8 * K;
+        float* va = pA_t + (i / 8 + (i % 8) / 4) * 8 * K;
+        float* vb = pB_t + (j / 8) * 8 * K;
 #if __AVX__
-            __m256 _sum0 = _mm256_set1_ps(0.0);
-            __m256 _sum1 = _mm256_set1_ps(0.0);
-            __m256 _sum2 = _mm256_set1_ps(0.0);
-            __m256 _sum3 = _mm256_set1_ps(0.0);
+        __m256 _sum0 = _mm256_set1_ps(0.0);
+        __m256 _sum1 = _mm256_set1_ps(0.0);
+        __m256 _sum2 = _mm256_set1_ps(0.0);
+        __m256 _sum3 = _mm256_set1_ps(0.0);
 
-            int k = 0;
-            for (; k + 3 < K; k = k + 4)
-            {
-                // k0
-                __m256 _va0 = _mm256_broadcast_ss(va);
-                __m256 _va1 = _mm256_broadcast_ss(va + 1);
-                __m256 _va2 = _mm256_broadcast_ss(va + 2);
-                __m256 _va3 = _mm256_broadcast_ss(va + 3);
-                __m256 _vb0 = _mm256_loadu_ps(vb);
-                __m256 _vb1 = _mm256_loadu_ps(vb + 8);
-                __m256 _vb2 = _mm256_loadu_ps(vb + 16);
-                __m256 _vb3 = _mm256_loadu_ps(vb + 24);
-                _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
-                _sum1 = _mm256_fmadd_ps(_vb0, _va1, _sum1);    // sum1 = (a00-a07) * k10
-                _sum2 = _mm256_fmadd_ps(_vb0, _va2, _sum2);    // sum2 = (a00-a07) * k20
-                _sum3 = _mm256_fmadd_ps(_vb0, _va3, _sum3);    // sum3 = (a00-a07) * k30
-
-                va += 4;
-
-                // k1
-                _va0 = _mm256_broadcast_ss(va);
-                _va1 = _mm256_broadcast_ss(va + 1);
-                _va2 = _mm256_broadcast_ss(va + 2);
-                _va3 = _mm256_broadcast_ss(va + 3);
-                _sum0 = _mm256_fmadd_ps(_vb1, _va0, _sum0);    // sum0 += (a10-a17) * k01
-                _sum1 = _mm256_fmadd_ps(_vb1, _va1, _sum1);    // sum1 += (a10-a17) * k11
-                _sum2 = _mm256_fmadd_ps(_vb1, _va2, _sum2);    // sum2 += (a10-a17) * k21
-                _sum3 = _mm256_fmadd_ps(_vb1, _va3, _sum3);    // sum3 += (a10-a17) * k31
-
-                va += 4;
-
-                // k2
-                _va0 = _mm256_broadcast_ss(va);
-                _va1 = _mm256_broadcast_ss(va + 1);
-                _va2 = _mm256_broadcast_ss(va + 2);
-                _va3 = _mm256_broadcast_ss(va + 3);
-                _sum0 = _mm256_fmadd_ps(_vb2, _va0, _sum0);    // sum0 += (a20-a27) * k02
-                _sum1 = _mm256_fmadd_ps(_vb2, _va1, _sum1);    // sum1 += (a20-a27) * k12
-                _sum2 = _mm256_fmadd_ps(_vb2, _va2, _sum2);    // sum2 += (a20-a27) * k22
-                _sum3 = _mm256_fmadd_ps(_vb2, _va3, _sum3);    // sum3 += (a20-a27) * k32
-
-                va += 4;
-
-                // k3
-                _va0 = _mm256_broadcast_ss(va);
-                _va1 = _mm256_broadcast_ss(va + 1);
-                _va2 = _mm256_broadcast_ss(va + 2);
-                _va3 = _mm256_broadcast_ss(va + 3);
-                _sum0 = _mm256_fmadd_ps(_vb3, _va0, _sum0);    // sum0 += (a30-a37) * k03
-                _sum1 = _mm256_fmadd_ps(_vb3, _va1, _sum1);    // sum1 += (a30-a37) * k13
-                _sum2 = _mm256_fmadd_ps(_vb3, _va2, _sum2);    // sum2 += (a30-a37) * k23
-                _sum3 = _mm256_fmadd_ps(_vb3, _va3, _sum3);    // sum3 += (a30-a37) * k33
-
-                va += 4;
-                vb += 32;
-            }
+        int k = 0;
+        for (; k + 3 < K; k = k + 4)
+        {
+            // k0
+            __m256 _va0 = _mm256_broadcast_ss(va);
+            __m256 _va1 = _mm256_broadcast_ss(va + 1);
+            __m256 _va2 = _mm256_broadcast_ss(va + 2);
+            __m256 _va3 = _mm256_broadcast_ss(va + 3);
+            __m256 _vb0 = _mm256_loadu_ps(vb);
+            __m256 _vb1 = _mm256_loadu_ps(vb + 8);
+            __m256 _vb2 = _mm256_loadu_ps(vb + 16);
+            __m256 _vb3 = _mm256_loadu_ps(vb + 24);
+            _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
+            _sum1 = _mm256_fmadd_ps(_vb0, _va1, _sum1);    // sum1 = (a00-a07) * k10
+            _sum2 = _mm256_fmadd_ps(_vb0, _va2, _sum2);    // sum2 = (a00-a07) * k20
+            _sum3 = _mm256_fmadd_ps(_vb0, _va3, _sum3);    // sum3 = (a00-a07) * k30
+
+            va += 4;
+
+            // k1
+            _va0 = _mm256_broadcast_ss(va);
+            _va1 = _mm256_broadcast_ss(va + 1);
+            _va2 = _mm256_broadcast_ss(va + 2);
+            _va3 = _mm256_broadcast_ss(va + 3);
+            _sum0 = _mm256_fmadd_ps(_vb1, _va0, _sum0);    // sum0 += (a10-a17) * k01
+            _sum1 = _mm256_fmadd_ps(_vb1, _va1, _sum1);    // sum1 += (a10-a17) * k11
+            _sum2 = _mm256_fmadd_ps(_vb1, _va2, _sum2);    // sum2 += (a10-a17) * k21
+            _sum3 = _mm256_fmadd_ps(_vb1, _va3, _sum3);    // sum3 += (a10-a17) * k31
+
+            va += 4;
+
+            // k2
+            _va0 = _mm256_broadcast_ss(va);
+            _va1 = _mm256_broadcast_ss(va + 1);
+            _va2 = _mm256_broadcast_ss(va + 2);
+            _va3 = _mm256_broadcast_ss(va + 3);
+            _sum0 = _mm256_fmadd_ps(_vb2, _va0, _sum0);    // sum0 += (a20-a27) * k02
+            _sum1 = _mm256_fmadd_ps(_vb2, _va1, _sum1);    // sum1 += (a20-a27) * k12
+            _sum2 = _mm256_fmadd_ps(_vb2, _va2, _sum2);    // sum2 += (a20-a27) * k22
+            _sum3 = _mm256_fmadd_ps(_vb2, _va3, _sum3);    // sum3 += (a20-a27) * k32
+
+            va += 4;
+
+            // k3
+            _va0 = _mm256_broadcast_ss(va);
+            _va1 = _mm256_broadcast_ss(va + 1);
+            _va2 = _mm256_broadcast_ss(va + 2);
+            _va3 = _mm256_broadcast_ss(va + 3);
+            _sum0 = _mm256_fmadd_ps(_vb3, _va0, _sum0);    // sum0 += (a30-a37) * k03
+            _sum1 = _mm256_fmadd_ps(_vb3, _va1, _sum1);    // sum1 += (a30-a37) * k13
+            _sum2 = _mm256_fmadd_ps(_vb3, _va2, _sum2);    // sum2 += (a30-a37) * k23
+            _sum3 = _mm256_fmadd_ps(_vb3, _va3, _sum3);    // sum3 += (a30-a37) * k33
+
+            va += 4;
+            vb += 32;
+        }
 
-            for (; k < K; k++)
-            {
-                // k0
-                __m256 _va0 = _mm256_broadcast_ss(va);
-                __m256 _va1 = _mm256_broadcast_ss(va + 1);
-                __m256 _va2 = _mm256_broadcast_ss(va + 2);
-                __m256 _va3 = _mm256_broadcast_ss(va + 3);
-                __m256 _vb0 = _mm256_loadu_ps(vb);
-                _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
-                _sum1 = _mm256_fmadd_ps(_vb0, _va1, _sum1);    // sum1 = (a00-a07) * k10
-                _sum2 = _mm256_fmadd_ps(_vb0, _va2, _sum2);    // sum2 = (a00-a07) * k20
-                _sum3 = _mm256_fmadd_ps(_vb0, _va3, _sum3);    // sum3 = (a00-a07) * k30
-
-                va += 4;
-                vb += 8;
-            }
+        for (; k < K; k++)
+        {
+            // k0
+            __m256 _va0 = _mm256_broadcast_ss(va);
+            __m256 _va1 = _mm256_broadcast_ss(va + 1);
+            __m256 _va2 = _mm256_broadcast_ss(va + 2);
+            __m256 _va3 = _mm256_broadcast_ss(va + 3);
+            __m256 _vb0 = _mm256_loadu_ps(vb);
+            _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
+            _sum1 = _mm256_fmadd_ps(_vb0, _va1, _sum1);    // sum1 = (a00-a07) * k10
+            _sum2 = _mm256_fmadd_ps(_vb0, _va2, _sum2);    // sum2 = (a00-a07) * k20
+            _sum3 = _mm256_fmadd_ps(_vb0, _va3, _sum3);    // sum3 = (a00-a07) * k30
+
+            va += 4;
+            vb += 8;
+        }
 
-            _mm256_storeu_ps(output0, _sum0);
-            _mm256_storeu_ps(output1, _sum1);
-            _mm256_storeu_ps(output2, _sum2);
-            _mm256_storeu_ps(output3, _sum3);
+        _mm256_storeu_ps(output0, epilogue_avx(_sum0, _mm256_set1_ps(bias0_3[0]), residual_at(residual, pC, output0), activation));
+        _mm256_storeu_ps(output1, epilogue_avx(_sum1, _mm256_set1_ps(bias0_3[1]), residual_at(residual, pC, output1), activation));
+        _mm256_storeu_ps(output2, epilogue_avx(_sum2, _mm256_set1_ps(bias0_3[2]), residual_at(residual, pC, output2), activation));
+        _mm256_storeu_ps(output3, epilogue_avx(_sum3, _mm256_set1_ps(bias0_3[3]), residual_at(residual, pC, output3), activation));
 #else
-            float sum0[8] = {0};
-            float sum1[8] = {0};
-            float sum2[8] = {0};
-            float sum3[8] = {0};
-
-            for (int k = 0; k < K; k++)
-            {
-                for (int n = 0; n < 8; n++)
-                {
-                    sum0[n] += va[0] * vb[n];
-                    sum1[n] += va[1] * vb[n];
-                    sum2[n] += va[2] * vb[n];
-                    sum3[n] += va[3] * vb[n];
-                }
-
-                va += 4;
-                vb += 8;
-            }
+        float sum0[8] = {0};
+        float sum1[8] = {0};
+        float sum2[8] = {0};
+        float sum3[8] = {0};
 
+        for (int k = 0; k < K; k++)
+        {
             for (int n = 0; n < 8; n++)
             {
-                output0[n] = sum0[n];
-                output1[n] = sum1[n];
-                output2[n] = sum2[n];
-                output3[n] = sum3[n];
+                sum0[n] += va[0] * vb[n];
+                sum1[n] += va[1] * vb[n];
+                sum2[n] += va[2] * vb[n];
+                sum3[n] += va[3] * vb[n];
             }
-#endif    // __AVX__
-            output0 += 8;
-            output1 += 8;
-            output2 += 8;
-            output3 += 8;
+
+            va += 4;
+            vb += 8;
         }
 
-        for (; j < N; j++)
+        for (int n = 0; n < 8; n++)
         {
-            float* va = pA_t + (i / 8 + (i % 8) / 4) * 8 * K;
-            float* vb = pB_t + (j / 8 + j % 8) * 8 * K;
+            output0[n] = epilogue_fp32(sum0[n], bias0_3[0], residual_at(residual, pC, output0 + n), activation);
+            output1[n] = epilogue_fp32(sum1[n], bias0_3[1], residual_at(residual, pC, output1 + n), activation);
+            output2[n] = epilogue_fp32(sum2[n], bias0_3[2], residual_at(residual, pC, output2 + n), activation);
+            output3[n] = epilogue_fp32(sum3[n], bias0_3[3], residual_at(residual, pC, output3 + n), activation);
+        }
+#endif    // __AVX__
+        output0 += 8;
+        output1 += 8;
+        output2 += 8;
+        output3 += 8;
+    }
+
+    for (; j < N; j++)
+    {
+        float* va = pA_t + (i / 8 + (i % 8) / 4) * 8 * K;
+        float* vb = pB_t + (j / 8 + j % 8) * 8 * K;
 #if __AVX__
-            __m128 _sum0_3 = _mm_set1_ps(0.0);
-            __m128 _sum0 = _mm_set1_ps(0.0);
-            __m128 _sum1 = _mm_set1_ps(0.0);
-            __m128 _sum2 = _mm_set1_ps(0.0);
-            __m128 _sum3 = _mm_set1_ps(0.0);
-
-            int k = 0;
-            for (; k + 3 < K; k = k + 4)
-            {
-                __m128 _vb0 = _mm_set1_ps(vb[0]);
-                __m128 _vb1 = _mm_set1_ps(vb[1]);
-                __m128 _vb2 = _mm_set1_ps(vb[2]);
-                __m128 _vb3 = _mm_set1_ps(vb[3]);
-                __m128 _va0 = _mm_loadu_ps(va);
-                __m128 _va1 = _mm_loadu_ps(va + 4);
-                __m128 _va2 = _mm_loadu_ps(va + 8);
-                __m128 _va3 = _mm_loadu_ps(va + 12);
-
-                _sum0 = _mm_fmadd_ps(_va0, _vb0, _sum0);    // sum0 += (k00-k30) * a00
-                _sum1 = _mm_fmadd_ps(_va1, _vb1, _sum1);    // sum1 += (k01-k31) * a10
-                _sum2 = _mm_fmadd_ps(_va2, _vb2, _sum2);    // sum2 += (k02-k32) * a20
-                _sum3 = _mm_fmadd_ps(_va3, _vb3, _sum3);    // sum3 += (k03-k33) * a30
-
-                va += 16;
-                vb += 4;
-            }
+        __m128 _sum0_3 = _mm_set1_ps(0.0);
+        __m128 _sum0 = _mm_set1_ps(0.0);
+        __m128 _sum1 = _mm_set1_ps(0.0);
+        __m128 _sum2 = _mm_set1_ps(0.0);
+        __m128 _sum3 = _mm_set1_ps(0.0);
+
+        int k = 0;
+        for (; k + 3 < K; k = k + 4)
+        {
+            __m128 _vb0 = _mm_set1_ps(vb[0]);
+            __m128 _vb1 = _mm_set1_ps(vb[1]);
+            __m128 _vb2 = _mm_set1_ps(vb[2]);
+            __m128 _vb3 = _mm_set1_ps(vb[3]);
+            __m128 _va0 = _mm_loadu_ps(va);
+            __m128 _va1 = _mm_loadu_ps(va + 4);
+            __m128 _va2 = _mm_loadu_ps(va + 8);
+            __m128 _va3 = _mm_loadu_ps(va + 12);
+
+            _sum0 = _mm_fmadd_ps(_va0, _vb0, _sum0);    // sum0 += (k00-k30) * a00
+            _sum1 = _mm_fmadd_ps(_va1, _vb1, _sum1);    // sum1 += (k01-k31) * a10
+            _sum2 = _mm_fmadd_ps(_va2, _vb2, _sum2);    // sum2 += (k02-k32) * a20
+            _sum3 = _mm_fmadd_ps(_va3, _vb3, _sum3);    // sum3 += (k03-k33) * a30
+
+            va += 16;
+            vb += 4;
+        }
 
-            _sum0 = _mm_add_ps(_sum0, _sum1);
-            _sum2 = _mm_add_ps(_sum2, _sum3);
-            _sum0_3 = _mm_add_ps(_sum0_3, _sum0);
-            _sum0_3 = _mm_add_ps(_sum0_3, _sum2);
+        _sum0 = _mm_add_ps(_sum0, _sum1);
+        _sum2 = _mm_add_ps(_sum2, _sum3);
+        _sum0_3 = _mm_add_ps(_sum0_3, _sum0);
+        _sum0_3 = _mm_add_ps(_sum0_3, _sum2);
 
-            for (; k < K; k++)
-            {
-                __m128 _vb0 = _mm_set1_ps(vb[0]);
-                __m128 _va = _mm_loadu_ps(va);
+        for (; k < K; k++)
+        {
+            __m128 _vb0 = _mm_set1_ps(vb[0]);
+            __m128 _va = _mm_loadu_ps(va);
 
-                _sum0_3 = _mm_fmadd_ps(_va, _vb0, _sum0_3);    // sum0 += (k00-k30) * a00
+            _sum0_3 = _mm_fmadd_ps(_va, _vb0, _sum0_3);    // sum0 += (k00-k30) * a00
 
-                va += 4;
-                vb += 1;
-            }
+            va += 4;
+            vb += 1;
+        }
 
-            float output_sum0_3[4] = {0.f};
-            _mm_storeu_ps(output_sum0_3, _sum0_3);
-            output0[0] = output_sum0_3[0];
-            output1[0] = output_sum0_3[1];
-            output2[0] = output_sum0_3[2];
-            output3[0] = output_sum0_3[3];
+        float output_sum0_3[4] = {0.f};
+        _mm_storeu_ps(output_sum0_3, _sum0_3);
+        output0[0] = epilogue_fp32(output_sum0_3[0], bias0_3[0], residual_at(residual, pC, output0), activation);
+        output1[0] = epilogue_fp32(output_sum0_3[1], bias0_3[1], residual_at(residual, pC, output1), activation);
+        output2[0] = epilogue_fp32(output_sum0_3[2], bias0_3[2], residual_at(residual, pC, output2), activation);
+        output3[0] = epilogue_fp32(output_sum0_3[3], bias0_3[3], residual_at(residual, pC, output3), activation);
 #else
-            float sum0 = 0;
-            float sum1 = 0;
-            float sum2 = 0;
-            float sum3 = 0;
+        float sum0 = 0;
+        float sum1 = 0;
+        float sum2 = 0;
+        float sum3 = 0;
 
-            for (int k = 0; k < K; k++)
-            {
-                sum0 += va[0] * vb[0];
-                sum1 += va[1] * vb[0];
-                sum2 += va[2] * vb[0];
-                sum3 += va[3] * vb[0];
+        for (int k = 0; k < K; k++)
+        {
+            sum0 += va[0] * vb[0];
+            sum1 += va[1] * vb[0];
+            sum2 += va[2] * vb[0];
+            sum3 += va[3] * vb[0];
 
-                va += 4;
-                vb += 1;
-            }
-            output0[0] = sum0;
-            output1[0] = sum1;
-            output2[0] = sum2;
-            output3[0] = sum3;
-#endif    // __AVX__
-            output0++;
-            output1++;
-            output2++;
-            output3++;
+            va += 4;
+            vb += 1;
         }
+        output0[0] = epilogue_fp32(sum0, bias0_3[0], residual_at(residual, pC, output0), activation);
+        output1[0] = epilogue_fp32(sum1, bias0_3[1], residual_at(residual, pC, output1), activation);
+        output2[0] = epilogue_fp32(sum2, bias0_3[2], residual_at(residual, pC, output2), activation);
+        output3[0] = epilogue_fp32(sum3, bias0_3[3], residual_at(residual, pC, output3), activation);
+#endif    // __AVX__
+        output0++;
+        output1++;
+        output2++;
+        output3++;
     }
+}
 
-    remain_outch_start += nn_outch << 2;
-
-    // output ch0
-    for (int i = remain_outch_start; i < M; i++)
+static void sgemm_block1(void* arg, int idx)
+{
+    const struct sgemm_arg* a = ( const struct sgemm_arg* )arg;
+    int N = a->N;
+    int K = a->K;
+    float* pA_t = a->pA_t;
+    float* pB_t = a->pB_t;
+    float* pC = a->pC;
+    const float* bias = a->bias;
+    const float* residual = a->residual;
+    int activation = a->activation;
+    int i = a->remain_outch_start + idx;
+
+    float* output = pC + i * N;
+    float bias0 = bias ? bias[i] : 0.f;
+
+    int j = 0;
+    for (; j + 7 < N; j += 8)
     {
-        float* output = pC + i * N;
-
-        int j = 0;
-        for (; j + 7 < N; j += 8)
-        {
-            float* va = pA_t + (i / 8 + (i % 8) / 4 + i % 4) * 8 * K;
-            float* vb = pB_t + (j / 8) * 8 * K;
+        float* va = pA_t + (i / 8 + (i % 8) / 4 + i % 4) * 8 * K;
+        float* vb = pB_t + (j / 8) * 8 * K;
 #if __AVX__
-            __m256 _sum0 = _mm256_set1_ps(0.0);
+        __m256 _sum0 = _mm256_set1_ps(0.0);
 
-            int k = 0;
-            for (; k + 3 < K; k = k + 4)
-            {
-                // k0
-                __m256 _va0 = _mm256_broadcast_ss(va);
-                __m256 _va1 = _mm256_broadcast_ss(va + 1);
-                __m256 _va2 = _mm256_broadcast_ss(va + 2);
-                __m256 _va3 = _mm256_broadcast_ss(va + 3);
-                __m256 _vb0 = _mm256_loadu_ps(vb);
-                __m256 _vb1 = _mm256_loadu_ps(vb + 8);
-                __m256 _vb2 = _mm256_loadu_ps(vb + 16);
-                __m256 _vb3 = _mm256_loadu_ps(vb + 24);
-
-                _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
-                _sum0 = _mm256_fmadd_ps(_vb1, _va1, _sum0);    // sum0 += (a10-a17) * k01
-                _sum0 = _mm256_fmadd_ps(_vb2, _va2, _sum0);    // sum0 += (a20-a27) * k02
-                _sum0 = _mm256_fmadd_ps(_vb3, _va3, _sum0);    // sum0 += (a30-a37) * k03
-
-                va += 4;
-                vb += 32;
-            }
+        int k = 0;
+        for (; k + 3 < K; k = k + 4)
+        {
+            // k0
+            __m256 _va0 = _mm256_broadcast_ss(va);
+            __m256 _va1 = _mm256_broadcast_ss(va + 1);
+            __m256 _va2 = _mm256_broadcast_ss(va + 2);
+            __m256 _va3 = _mm256_broadcast_ss(va + 3);
+            __m256 _vb0 = _mm256_loadu_ps(vb);
+            __m256 _vb1 = _mm256_loadu_ps(vb + 8);
+            __m256 _vb2 = _mm256_loadu_ps(vb + 16);
+            __m256 _vb3 = _mm256_loadu_ps(vb + 24);
+
+            _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
+            _sum0 = _mm256_fmadd_ps(_vb1, _va1, _sum0);    // sum0 += (a10-a17) * k01
+            _sum0 = _mm256_fmadd_ps(_vb2, _va2, _sum0);    // sum0 += (a20-a27) * k02
+            _sum0 = _mm256_fmadd_ps(_vb3, _va3, _sum0);    // sum0 += (a30-a37) * k03
+
+            va += 4;
+            vb += 32;
+        }
 
-            for (; k < K; k++)
-            {
-                // k0
-                __m256 _va0 = _mm256_broadcast_ss(va);
-                __m256 _vb0 = _mm256_loadu_ps(vb);
+        for (; k < K; k++)
+        {
+            // k0
+            __m256 _va0 = _mm256_broadcast_ss(va);
+            __m256 _vb0 = _mm256_loadu_ps(vb);
 
-                _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
+            _sum0 = _mm256_fmadd_ps(_vb0, _va0, _sum0);    // sum0 = (a00-a07) * k00
 
-                va += 1;
-                vb += 8;
-            }
+            va += 1;
+            vb += 8;
+        }
 
-            _mm256_storeu_ps(output, _sum0);
+        _mm256_storeu_ps(output, epilogue_avx(_sum0, _mm256_set1_ps(bias0), residual_at(residual, pC, output), activation));
 #else
-            float sum[8] = {0};
-
-            for (int k = 0; k < K; k++)
-            {
-                for (int n = 0; n < 8; n++)
-                {
-                    sum[n] += va[0] * vb[n];
-                }
-
-                va += 1;
-                vb += 8;
-            }
+        float sum[8] = {0};
 
+        for (int k = 0; k < K; k++)
+        {
             for (int n = 0; n < 8; n++)
             {
-                output[n] = sum[n];
+                sum[n] += va[0] * vb[n];
             }
-#endif    // __AVX__
-            output += 8;
+
+            va += 1;
+            vb += 8;
         }
 
-        for (; j < N; j++)
+        for (int n = 0; n < 8; n++)
         {
-            float* va = pA_t + (i / 8 + (i % 8) / 4 + i % 4) * 8 * K;
-            float* vb = pB_t + (j / 8 + j % 8) * 8 * K;
+            output[n] = epilogue_fp32(sum[n], bias0, residual_at(residual, pC, output + n), activation);
+        }
+#endif    // __AVX__
+        output += 8;
+    }
+
+    for (; j < N; j++)
+    {
+        float* va = pA_t + (i / 8 + (i % 8) / 4 + i % 4) * 8 * K;
+        float* vb = pB_t + (j / 8 + j % 8) * 8 * K;
 
-            int k = 0;
+        int k = 0;
 #if __AVX__
-            __m128 _sum0 = _mm_set1_ps(0.f);
+        __m128 _sum0 = _mm_set1_ps(0.f);
 
-            for (; k + 3 < K; k += 4)
-            {
-                __m128 _p0 = _mm_loadu_ps(vb);
-                __m128 _k0 = _mm_loadu_ps(va);
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_p0, _k0));
+        for (; k + 3 < K; k += 4)
+        {
+            __m128 _p0 = _mm_loadu_ps(vb);
+            __m128 _k0 = _mm_loadu_ps(va);
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_p0, _k0));
 
-                va += 4;
-                vb += 4;
-            }
-            float sum0 = _sum0[0] + _sum0[1] + _sum0[2] + _sum0[3];
+            va += 4;
+            vb += 4;
+        }
+        float sum0 = _sum0[0] + _sum0[1] + _sum0[2] + _sum0[3];
 #else
-            float sum0 = 0.f;
+        float sum0 = 0.f;
 #endif    // __AVX__
-            for (; k < K; k++)
-            {
-                sum0 += va[0] * vb[0];
-
-                va += 1;
-                vb += 1;
-            }
-            output[0] = sum0;
+        for (; k < K; k++)
+        {
+            sum0 += va[0] * vb[0];
 
-            output++;
+            va += 1;
+            vb += 1;
         }
+        output[0] = epilogue_fp32(sum0, bias0, residual_at(residual, pC, output), activation);
+
+        output++;
     }
 }
-#else    // SSE2
-void input_pack4(int K, int N, float* pB, float* pB_t, int num_thread)
+
+static void sgemm(int M, int N, int K, float* pA_t, float* pB_t, float* pC, const float* bias,
+                  const float* residual, int activation, struct thread_pool* thread_pool)
 {
-    int nn_size = N >> 2;
-    int remian_size_start = nn_size << 2;
+    struct sgemm_arg arg = {N, K, pA_t, pB_t, pC, bias, residual, activation, 0};
+    int nn_outch = M >> 3;
+
+    thread_pool_parallel_for(thread_pool, nn_outch, sgemm_block8, &arg);
+
+    arg.remain_outch_start = nn_outch << 3;
+    nn_outch = (M - arg.remain_outch_start) >> 2;
+
+    thread_pool_parallel_for(thread_pool, nn_outch, sgemm_block4, &arg);
+
+    arg.remain_outch_start += nn_outch << 2;
 
+    thread_pool_parallel_for(thread_pool, M - arg.remain_outch_start, sgemm_block1, &arg);
+}
+#else    // SSE2
 // [ch00, ch10, ch20, ch30, ch01, ch11, ch21, ch31, ch02, ch12, ch22, ch32, ch03, ch13, ch23, ch33 ....]
-#pragma omp parallel for num_threads(num_thread)
-    for (int ii = 0; ii < nn_size; ii++)
-    {
-        int i = ii * 4;
-        const float* img = pB + i;
-        float* tmp = pB_t + (i / 4) * 4 * K;
+static void input_pack4_block(void* arg, int ii)
+{
+    const struct input_pack4_arg* a = ( const struct input_pack4_arg* )arg;
+    int K = a->K;
+    int N = a->N;
+    float* pB = a->pB;
+    float* pB_t = a->pB_t;
 
-        for (int j = 0; j < K; j++)
-        {
+    int i = ii * 4;
+    const float* img = pB + i;
+    float* tmp = pB_t + (i / 4) * 4 * K;
+
+    for (int j = 0; j < K; j++)
+    {
 #if __SSE__
-            _mm_storeu_ps(tmp, _mm_loadu_ps(img));
+        _mm_storeu_ps(tmp, _mm_loadu_ps(img));
 #else
-            tmp[0] = img[0];
-            tmp[1] = img[1];
-            tmp[2] = img[2];
-            tmp[3] = img[3];
+        tmp[0] = img[0];
+        tmp[1] = img[1];
+        tmp[2] = img[2];
+        tmp[3] = img[3];
 #endif    // __SSE__
-            tmp += 4;
-            img += N;
-        }
+        tmp += 4;
+        img += N;
     }
+}
 
 // [ch00, ch01, ch02, ch03 ....]
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = remian_size_start; i < N; i++)
-    {
-        const float* img = pB + i;
-        float* tmp = pB_t + (i / 4 + i % 4) * 4 * K;
+static void input_pack4_remain(void* arg, int idx)
+{
+    const struct input_pack4_arg* a = ( const struct input_pack4_arg* )arg;
+    int K = a->K;
+    int N = a->N;
+    float* pB = a->pB;
+    float* pB_t = a->pB_t;
+    int i = (a->N >> 2 << 2) + idx;
 
-        for (int j = 0; j < K; j++)
-        {
-            tmp[0] = img[0];
+    const float* img = pB + i;
+    float* tmp = pB_t + (i / 4 + i % 4) * 4 * K;
 
-            tmp += 1;
-            img += N;
-        }
+    for (int j = 0; j < K; j++)
+    {
+        tmp[0] = img[0];
+
+        tmp += 1;
+        img += N;
     }
 }
-// unloop output M, unloop N, packet 4x4, using intrinsic
-static void sgemm(int M, int N, int K, float* pA_t, float* pB_t, float* pC, int num_thread)
+
+void input_pack4(int K, int N, float* pB, float* pB_t, struct thread_pool* thread_pool)
 {
-    int nn_outch = 0;
-    int remain_outch_start = 0;
+    struct input_pack4_arg arg = {K, N, pB, pB_t};
+    int nn_size = N >> 2;
 
-    nn_outch = M >> 2;
-    remain_outch_start = nn_outch << 2;
+    thread_pool_parallel_for(thread_pool, nn_size, input_pack4_block, &arg);
+    thread_pool_parallel_for(thread_pool, N - (nn_size << 2), input_pack4_remain, &arg);
+}
 
-// output ch0 - ch3
-#pragma omp parallel for num_threads(num_thread)
-    for (int pp = 0; pp < nn_outch; pp++)
+// unloop output M, unloop N, packet 4x4, using intrinsic
+/* output ch0 - ch3 */
+static void sgemm_block4(void* arg, int pp)
+{
+    const struct sgemm_arg* a = ( const struct sgemm_arg* )arg;
+    int N = a->N;
+    int K = a->K;
+    float* pA_t = a->pA_t;
+    float* pB_t = a->pB_t;
+    float* pC = a->pC;
+    const float* bias = a->bias;
+    const float* residual = a->residual;
+    int activation = a->activation;
+
+    int i = pp * 4;
+
+    float* output0 = pC + ( i )*N;
+    float* output1 = pC + (i + 1) * N;
+    float* output2 = pC + (i + 2) * N;
+    float* output3 = pC + (i + 3) * N;
+
+    float bias0_3[4];
+    for (int n = 0; n < 4; n++)
+        bias0_3[n] = bias ? bias[i + n] : 0.f;
+
+    int j = 0;
+    for (; j + 3 < N; j += 4)
     {
-        int i = pp * 4;
-
-        float* output0 = pC + ( i )*N;
-        float* output1 = pC + (i + 1) * N;
-        float* output2 = pC + (i + 2) * N;
-        float* output3 = pC + (i + 3) * N;
-
-        int j = 0;
-        for (; j + 3 < N; j += 4)
-        {
-            float* va = pA_t + (i / 4) * 4 * K;
-            float* vb = pB_t + (j / 4) * 4 * K;
+        float* va = pA_t + (i / 4) * 4 * K;
+        float* vb = pB_t + (j / 4) * 4 * K;
 #if __SSE__
-            __m128 _sum0 = _mm_set1_ps(0.f);
-            __m128 _sum1 = _mm_set1_ps(0.f);
-            __m128 _sum2 = _mm_set1_ps(0.f);
-            __m128 _sum3 = _mm_set1_ps(0.f);
+        __m128 _sum0 = _mm_set1_ps(0.f);
+        __m128 _sum1 = _mm_set1_ps(0.f);
+        __m128 _sum2 = _mm_set1_ps(0.f);
+        __m128 _sum3 = _mm_set1_ps(0.f);
 
-            int k = 0;
-            for (; k + 3 < K; k = k + 4)
-            {
-                // k0
-                __m128 _vb = _mm_loadu_ps(vb);
-                __m128 _va0 = _mm_set1_ps(va[0]);
-                __m128 _va1 = _mm_set1_ps(va[1]);
-                __m128 _va2 = _mm_set1_ps(va[2]);
-                __m128 _va3 = _mm_set1_ps(va[3]);
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb, _va0));    // sum0 = (a00-a03) * k00
-                _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_vb, _va1));    // sum1 = (a00-a03) * k10
-                _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_vb, _va2));    // sum2 = (a00-a03) * k20
-                _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_vb, _va3));    // sum3 = (a00-a03) * k30
-
-                // k1
-                _vb = _mm_loadu_ps(vb + 4);
-                _va0 = _mm_set1_ps(va[4]);
-                _va1 = _mm_set1_ps(va[5]);
-                _va2 = _mm_set1_ps(va[6]);
-                _va3 = _mm_set1_ps(va[7]);
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb, _va0));    // sum0 = (a10-a13) * k01
-                _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_vb, _va1));    // sum1 = (a10-a13) * k11
-                _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_vb, _va2));    // sum2 = (a10-a13) * k21
-                _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_vb, _va3));    // sum3 = (a10-a13) * k31
-
-                // k2
-                _vb = _mm_loadu_ps(vb + 8);
-                _va0 = _mm_set1_ps(va[8]);
-                _va1 = _mm_set1_ps(va[9]);
-                _va2 = _mm_set1_ps(va[10]);
-                _va3 = _mm_set1_ps(va[11]);
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb, _va0));    // sum0 = (a20-a23) * k02
-                _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_vb, _va1));    // sum1 = (a20-a23) * k12
-                _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_vb, _va2));    // sum2 = (a20-a23) * k22
-                _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_vb, _va3));    // sum3 = (a20-a23) * k32
-
-                // k3
-                _vb = _mm_loadu_ps(vb + 12);
-                _va0 = _mm_set1_ps(va[12]);
-                _va1 = _mm_set1_ps(va[13]);
-                _va2 = _mm_set1_ps(va[14]);
-                _va3 = _mm_set1_ps(va[15]);
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb, _va0));    // sum0 = (a30-a33) * k03
-                _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_vb, _va1));    // sum1 = (a30-a33) * k13
-                _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_vb, _va2));    // sum2 = (a30-a33) * k23
-                _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_vb, _va3));    // sum3 = (a30-a33) * k33
-
-                va += 16;
-                vb += 16;
-            }
+        int k = 0;
+        for (; k + 3 < K; k = k + 4)
+        {
+            // k0
+            __m128 _vb = _mm_loadu_ps(vb);
+            __m128 _va0 = _mm_set1_ps(va[0]);
+            __m128 _va1 = _mm_set1_ps(va[1]);
+            __m128 _va2 = _mm_set1_ps(va[2]);
+            __m128 _va3 = _mm_set1_ps(va[3]);
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb, _va0));    // sum0 = (a00-a03) * k00
+            _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_vb, _va1));    // sum1 = (a00-a03) * k10
+            _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_vb, _va2));    // sum2 = (a00-a03) * k20
+            _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_vb, _va3));    // sum3 = (a00-a03) * k30
+
+            // k1
+            _vb = _mm_loadu_ps(vb + 4);
+            _va0 = _mm_set1_ps(va[4]);
+            _va1 = _mm_set1_ps(va[5]);
+            _va2 = _mm_set1_ps(va[6]);
+            _va3 = _mm_set1_ps(va[7]);
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb, _va0));    // sum0 = (a10-a13) * k01
+            _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_vb, _va1));    // sum1 = (a10-a13) * k11
+            _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_vb, _va2));    // sum2 = (a10-a13) * k21
+            _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_vb, _va3));    // sum3 = (a10-a13) * k31
+
+            // k2
+            _vb = _mm_loadu_ps(vb + 8);
+            _va0 = _mm_set1_ps(va[8]);
+            _va1 = _mm_set1_ps(va[9]);
+            _va2 = _mm_set1_ps(va[10]);
+            _va3 = _mm_set1_ps(va[11]);
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb, _va0));    // sum0 = (a20-a23) * k02
+            _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_vb, _va1));    // sum1 = (a20-a23) * k12
+            _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_vb, _va2));    // sum2 = (a20-a23) * k22
+            _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_vb, _va3));    // sum3 = (a20-a23) * k32
+
+            // k3
+            _vb = _mm_loadu_ps(vb + 12);
+            _va0 = _mm_set1_ps(va[12]);
+            _va1 = _mm_set1_ps(va[13]);
+            _va2 = _mm_set1_ps(va[14]);
+            _va3 = _mm_set1_ps(va[15]);
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb, _va0));    // sum0 = (a30-a33) * k03
+            _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_vb, _va1));    // sum1 = (a30-a33) * k13
+            _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_vb, _va2));    // sum2 = (a30-a33) * k23
+            _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_vb, _va3));    // sum3 = (a30-a33) * k33
+
+            va += 16;
+            vb += 16;
+        }
 
-            for (; k < K; k++)
-            {
-                // k0
-                __m128 _vb = _mm_loadu_ps(vb);
-                __m128 _va0 = _mm_set1_ps(va[0]);
-                __m128 _va1 = _mm_set1_ps(va[1]);
-                __m128 _va2 = _mm_set1_ps(va[2]);
-                __m128 _va3 = _mm_set1_ps(va[3]);
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb, _va0));    // sum0 = (a00-a03) * k00
-                _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_vb, _va1));    // sum1 = (a00-a03) * k10
-                _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_vb, _va2));    // sum2 = (a00-a03) * k20
-                _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_vb, _va3));    // sum3 = (a00-a03) * k30
-
-                va += 4;
-                vb += 4;
-            }
-            _mm_storeu_ps(output0, _sum0);
-            _mm_storeu_ps(output1, _sum1);
-            _mm_storeu_ps(output2, _sum2);
-            _mm_storeu_ps(output3, _sum3);
+        for (; k < K; k++)
+        {
+            // k0
+            __m128 _vb = _mm_loadu_ps(vb);
+            __m128 _va0 = _mm_set1_ps(va[0]);
+            __m128 _va1 = _mm_set1_ps(va[1]);
+            __m128 _va2 = _mm_set1_ps(va[2]);
+            __m128 _va3 = _mm_set1_ps(va[3]);
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb, _va0));    // sum0 = (a00-a03) * k00
+            _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_vb, _va1));    // sum1 = (a00-a03) * k10
+            _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_vb, _va2));    // sum2 = (a00-a03) * k20
+            _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_vb, _va3));    // sum3 = (a00-a03) * k30
+
+            va += 4;
+            vb += 4;
+        }
+        _mm_storeu_ps(output0, epilogue_sse(_sum0, _mm_set1_ps(bias0_3[0]), residual_at(residual, pC, output0), activation));
+        _mm_storeu_ps(output1, epilogue_sse(_sum1, _mm_set1_ps(bias0_3[1]), residual_at(residual, pC, output1), activation));
+        _mm_storeu_ps(output2, epilogue_sse(_sum2, _mm_set1_ps(bias0_3[2]), residual_at(residual, pC, output2), activation));
+        _mm_storeu_ps(output3, epilogue_sse(_sum3, _mm_set1_ps(bias0_3[3]), residual_at(residual, pC, output3), activation));
 #else
-            float sum0[4] = {0};
-            float sum1[4] = {0};
-            float sum2[4] = {0};
-            float sum3[4] = {0};
-
-            for (int k = 0; k < K; k++)
-            {
-                for (int n = 0; n < 4; n++)
-                {
-                    sum0[n] += va[0] * vb[n];
-                    sum1[n] += va[1] * vb[n];
-                    sum2[n] += va[2] * vb[n];
-                    sum3[n] += va[3] * vb[n];
-                }
-
-                va += 4;
-                vb += 4;
-            }
+        float sum0[4] = {0};
+        float sum1[4] = {0};
+        float sum2[4] = {0};
+        float sum3[4] = {0};
 
+        for (int k = 0; k < K; k++)
+        {
             for (int n = 0; n < 4; n++)
             {
-                output0[n] = sum0[n];
-                output1[n] = sum1[n];
-                output2[n] = sum2[n];
-                output3[n] = sum3[n];
+                sum0[n] += va[0] * vb[n];
+                sum1[n] += va[1] * vb[n];
+                sum2[n] += va[2] * vb[n];
+                sum3[n] += va[3] * vb[n];
             }
-#endif    // __SSE__
-            output0 += 4;
-            output1 += 4;
-            output2 += 4;
-            output3 += 4;
+
+            va += 4;
+            vb += 4;
         }
 
-        for (; j < N; j++)
+        for (int n = 0; n < 4; n++)
         {
-            float* va = pA_t + (i / 4) * 4 * K;
-            float* vb = pB_t + (j / 4 + j % 4) * 4 * K;
+            output0[n] = epilogue_fp32(sum0[n], bias0_3[0], residual_at(residual, pC, output0 + n), activation);
+            output1[n] = epilogue_fp32(sum1[n], bias0_3[1], residual_at(residual, pC, output1 + n), activation);
+            output2[n] = epilogue_fp32(sum2[n], bias0_3[2], residual_at(residual, pC, output2 + n), activation);
+            output3[n] = epilogue_fp32(sum3[n], bias0_3[3], residual_at(residual, pC, output3 + n), activation);
+        }
+#endif    // __SSE__
+        output0 += 4;
+        output1 += 4;
+        output2 += 4;
+        output3 += 4;
+    }
+
+    for (; j < N; j++)
+    {
+        float* va = pA_t + (i / 4) * 4 * K;
+        float* vb = pB_t + (j / 4 + j % 4) * 4 * K;
 
 #if __SSE__
-            __m128 _sum0_3 = _mm_set1_ps(0.f);
-            __m128 _sum0 = _mm_set1_ps(0.f);
-            __m128 _sum1 = _mm_set1_ps(0.f);
-            __m128 _sum2 = _mm_set1_ps(0.f);
-            __m128 _sum3 = _mm_set1_ps(0.f);
-
-            int k = 0;
-            for (; k + 3 < K; k = k + 4)
-            {
-                __m128 _vb0 = _mm_set1_ps(vb[0]);
-                __m128 _vb1 = _mm_set1_ps(vb[1]);
-                __m128 _vb2 = _mm_set1_ps(vb[2]);
-                __m128 _vb3 = _mm_set1_ps(vb[3]);
-                __m128 _va0 = _mm_loadu_ps(va);
-                __m128 _va1 = _mm_loadu_ps(va + 4);
-                __m128 _va2 = _mm_loadu_ps(va + 8);
-                __m128 _va3 = _mm_loadu_ps(va + 12);
-
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_va0, _vb0));    // sum0 += (k00-k30) * a00
-                _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_va1, _vb1));    // sum1 += (k01-k31) * a10
-                _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_va2, _vb2));    // sum2 += (k02-k32) * a20
-                _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_va3, _vb3));    // sum3 += (k03-k33) * a30
-
-                va += 16;
-                vb += 4;
-            }
+        __m128 _sum0_3 = _mm_set1_ps(0.f);
+        __m128 _sum0 = _mm_set1_ps(0.f);
+        __m128 _sum1 = _mm_set1_ps(0.f);
+        __m128 _sum2 = _mm_set1_ps(0.f);
+        __m128 _sum3 = _mm_set1_ps(0.f);
+
+        int k = 0;
+        for (; k + 3 < K; k = k + 4)
+        {
+            __m128 _vb0 = _mm_set1_ps(vb[0]);
+            __m128 _vb1 = _mm_set1_ps(vb[1]);
+            __m128 _vb2 = _mm_set1_ps(vb[2]);
+            __m128 _vb3 = _mm_set1_ps(vb[3]);
+            __m128 _va0 = _mm_loadu_ps(va);
+            __m128 _va1 = _mm_loadu_ps(va + 4);
+            __m128 _va2 = _mm_loadu_ps(va + 8);
+            __m128 _va3 = _mm_loadu_ps(va + 12);
+
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_va0, _vb0));    // sum0 += (k00-k30) * a00
+            _sum1 = _mm_add_ps(_sum1, _mm_mul_ps(_va1, _vb1));    // sum1 += (k01-k31) * a10
+            _sum2 = _mm_add_ps(_sum2, _mm_mul_ps(_va2, _vb2));    // sum2 += (k02-k32) * a20
+            _sum3 = _mm_add_ps(_sum3, _mm_mul_ps(_va3, _vb3));    // sum3 += (k03-k33) * a30
+
+            va += 16;
+            vb += 4;
+        }
 
-            _sum0 = _mm_add_ps(_sum0, _sum1);
-            _sum2 = _mm_add_ps(_sum2, _sum3);
-            _sum0_3 = _mm_add_ps(_sum0_3, _sum0);
-            _sum0_3 = _mm_add_ps(_sum0_3, _sum2);
+        _sum0 = _mm_add_ps(_sum0, _sum1);
+        _sum2 = _mm_add_ps(_sum2, _sum3);
+        _sum0_3 = _mm_add_ps(_sum0_3, _sum0);
+        _sum0_3 = _mm_add_ps(_sum0_3, _sum2);
 
-            for (; k < K; k++)
-            {
-                __m128 _vb0 = _mm_set1_ps(vb[0]);
-                __m128 _va = _mm_loadu_ps(va);
+        for (; k < K; k++)
+        {
+            __m128 _vb0 = _mm_set1_ps(vb[0]);
+            __m128 _va = _mm_loadu_ps(va);
 
-                _sum0_3 = _mm_add_ps(_sum0_3, _mm_mul_ps(_va, _vb0));    // sum0 += (k00-k30) * a00
+            _sum0_3 = _mm_add_ps(_sum0_3, _mm_mul_ps(_va, _vb0));    // sum0 += (k00-k30) * a00
 
-                va += 4;
-                vb += 1;
-            }
-            output0[0] = _sum0_3[0];
-            output1[0] = _sum0_3[1];
-            output2[0] = _sum0_3[2];
-            output3[0] = _sum0_3[3];
+            va += 4;
+            vb += 1;
+        }
+        output0[0] = epilogue_fp32(_sum0_3[0], bias0_3[0], residual_at(residual, pC, output0), activation);
+        output1[0] = epilogue_fp32(_sum0_3[1], bias0_3[1], residual_at(residual, pC, output1), activation);
+        output2[0] = epilogue_fp32(_sum0_3[2], bias0_3[2], residual_at(residual, pC, output2), activation);
+        output3[0] = epilogue_fp32(_sum0_3[3], bias0_3[3], residual_at(residual, pC, output3), activation);
 #else
-            float sum0 = 0;
-            float sum1 = 0;
-            float sum2 = 0;
-            float sum3 = 0;
+        float sum0 = 0;
+        float sum1 = 0;
+        float sum2 = 0;
+        float sum3 = 0;
 
-            for (int k = 0; k < K; k++)
-            {
-                sum0 += va[0] * vb[0];
-                sum1 += va[1] * vb[0];
-                sum2 += va[2] * vb[0];
-                sum3 += va[3] * vb[0];
+        for (int k = 0; k < K; k++)
+        {
+            sum0 += va[0] * vb[0];
+            sum1 += va[1] * vb[0];
+            sum2 += va[2] * vb[0];
+            sum3 += va[3] * vb[0];
 
-                va += 4;
-                vb += 1;
-            }
-            output0[0] = sum0;
-            output1[0] = sum1;
-            output2[0] = sum2;
-            output3[0] = sum3;
-#endif    // __SSE__
-            output0++;
-            output1++;
-            output2++;
-            output3++;
+            va += 4;
+            vb += 1;
         }
+        output0[0] = epilogue_fp32(sum0, bias0_3[0], residual_at(residual, pC, output0), activation);
+        output1[0] = epilogue_fp32(sum1, bias0_3[1], residual_at(residual, pC, output1), activation);
+        output2[0] = epilogue_fp32(sum2, bias0_3[2], residual_at(residual, pC, output2), activation);
+        output3[0] = epilogue_fp32(sum3, bias0_3[3], residual_at(residual, pC, output3), activation);
+#endif    // __SSE__
+        output0++;
+        output1++;
+        output2++;
+        output3++;
     }
+}
 
-// output ch0
-#pragma omp parallel for num_threads(num_thread)
-    for (int i = remain_outch_start; i < M; i++)
+/* output ch0 */
+static void sgemm_block1(void* arg, int idx)
+{
+    const struct sgemm_arg* a = ( const struct sgemm_arg* )arg;
+    int N = a->N;
+    int K = a->K;
+    float* pA_t = a->pA_t;
+    float* pB_t = a->pB_t;
+    float* pC = a->pC;
+    const float* bias = a->bias;
+    const float* residual = a->residual;
+    int activation = a->activation;
+    int i = a->remain_outch_start + idx;
+
+    float* output = pC + i * N;
+    float bias0 = bias ? bias[i] : 0.f;
+
+    int j = 0;
+    for (; j + 3 < N; j += 4)
     {
-        float* output = pC + i * N;
-
-        int j = 0;
-        for (; j + 3 < N; j += 4)
-        {
-            float* va = pA_t + (i / 4 + i % 4) * 4 * K;
-            float* vb = pB_t + (j / 4) * 4 * K;
+        float* va = pA_t + (i / 4 + i % 4) * 4 * K;
+        float* vb = pB_t + (j / 4) * 4 * K;
 #if __SSE__
-            __m128 _sum0 = _mm_set1_ps(0.f);
+        __m128 _sum0 = _mm_set1_ps(0.f);
 
-            int k = 0;
-            for (; k + 3 < K; k = k + 4)
-            {
-                // k0
-                __m128 _va0 = _mm_set1_ps(va[0]);
-                __m128 _va1 = _mm_set1_ps(va[1]);
-                __m128 _va2 = _mm_set1_ps(va[2]);
-                __m128 _va3 = _mm_set1_ps(va[3]);
-                __m128 _vb0 = _mm_loadu_ps(vb);
-                __m128 _vb1 = _mm_loadu_ps(vb + 4);
-                __m128 _vb2 = _mm_loadu_ps(vb + 8);
-                __m128 _vb3 = _mm_loadu_ps(vb + 12);
-
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb0, _va0));    // sum0 = (a00-a03) * k00
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb1, _va1));    // sum0 += (a10-a13) * k01
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb2, _va2));    // sum0 += (a20-a23) * k02
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb3, _va3));    // sum0 += (a30-a33) * k03
-
-                va += 4;
-                vb += 16;
-            }
+        int k = 0;
+        for (; k + 3 < K; k = k + 4)
+        {
+            // k0
+            __m128 _va0 = _mm_set1_ps(va[0]);
+            __m128 _va1 = _mm_set1_ps(va[1]);
+            __m128 _va2 = _mm_set1_ps(va[2]);
+            __m128 _va3 = _mm_set1_ps(va[3]);
+            __m128 _vb0 = _mm_loadu_ps(vb);
+            __m128 _vb1 = _mm_loadu_ps(vb + 4);
+            __m128 _vb2 = _mm_loadu_ps(vb + 8);
+            __m128 _vb3 = _mm_loadu_ps(vb + 12);
+
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb0, _va0));    // sum0 = (a00-a03) * k00
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb1, _va1));    // sum0 += (a10-a13) * k01
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb2, _va2));    // sum0 += (a20-a23) * k02
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb3, _va3));    // sum0 += (a30-a33) * k03
+
+            va += 4;
+            vb += 16;
+        }
 
-            for (; k < K; k++)
-            {
-                // k0
-                __m128 _va0 = _mm_set1_ps(va[0]);
-                __m128 _vb0 = _mm_loadu_ps(vb);
+        for (; k < K; k++)
+        {
+            // k0
+            __m128 _va0 = _mm_set1_ps(va[0]);
+            __m128 _vb0 = _mm_loadu_ps(vb);
 
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb0, _va0));    // sum0 = (a00-a03) * k00
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_vb0, _va0));    // sum0 = (a00-a03) * k00
 
-                va += 1;
-                vb += 4;
-            }
-            _mm_storeu_ps(output, _sum0);
+            va += 1;
+            vb += 4;
+        }
+        _mm_storeu_ps(output, epilogue_sse(_sum0, _mm_set1_ps(bias0), residual_at(residual, pC, output), activation));
 #else
-            float sum[4] = {0};
-
-            for (int k = 0; k < K; k++)
-            {
-                for (int n = 0; n < 4; n++)
-                {
-                    sum[n] += va[0] * vb[n];
-                }
-
-                va += 1;
-                vb += 4;
-            }
+        float sum[4] = {0};
 
+        for (int k = 0; k < K; k++)
+        {
             for (int n = 0; n < 4; n++)
             {
-                output[n] = sum[n];
+                sum[n] += va[0] * vb[n];
             }
-#endif    // __SSE__
-            output += 4;
+
+            va += 1;
+            vb += 4;
         }
 
-        for (; j < N; j++)
+        for (int n = 0; n < 4; n++)
         {
-            float* va = pA_t + (i / 4 + i % 4) * 4 * K;
-            float* vb = pB_t + (j / 4 + j % 4) * 4 * K;
+            output[n] = epilogue_fp32(sum[n], bias0, residual_at(residual, pC, output + n), activation);
+        }
+#endif    // __SSE__
+        output += 4;
+    }
+
+    for (; j < N; j++)
+    {
+        float* va = pA_t + (i / 4 + i % 4) * 4 * K;
+        float* vb = pB_t + (j / 4 + j % 4) * 4 * K;
 
-            int k = 0;
+        int k = 0;
 #if __SSE__
-            __m128 _sum0 = _mm_set1_ps(0.f);
+        __m128 _sum0 = _mm_set1_ps(0.f);
 
-            for (; k + 3 < K; k += 4)
-            {
-                __m128 _p0 = _mm_loadu_ps(vb);
-                __m128 _k0 = _mm_loadu_ps(va);
-                _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_p0, _k0));
+        for (; k + 3 < K; k += 4)
+        {
+            __m128 _p0 = _mm_loadu_ps(vb);
+            __m128 _k0 = _mm_loadu_ps(va);
+            _sum0 = _mm_add_ps(_sum0, _mm_mul_ps(_p0, _k0));
 
-                va += 4;
-                vb += 4;
-            }
-            float sum0 = _sum0[0] + _sum0[1] + _sum0[2] + _sum0[3];
+            va += 4;
+            vb += 4;
+        }
+        float sum0 = _sum0[0] + _sum0[1] + _sum0[2] + _sum0[3];
 #else
-            float sum0 = 0.f;
+        float sum0 = 0.f;
 #endif    // __SSE__
-            for (; k < K; k++)
-            {
-                sum0 += va[0] * vb[0];
-
-                va += 1;
-                vb += 1;
-            }
-            output[0] = sum0;
+        for (; k < K; k++)
+        {
+            sum0 += va[0] * vb[0];
 
-            output++;
+            va += 1;
+            vb += 1;
         }
+        output[0] = epilogue_fp32(sum0, bias0, residual_at(residual, pC, output), activation);
+
+        output++;
     }
 }
+
+static void sgemm(int M, int N, int K, float* pA_t, float* pB_t, float* pC, const float* bias,
+                  const float* residual, int activation, struct thread_pool* thread_pool)
+{
+    struct sgemm_arg arg = {N, K, pA_t, pB_t, pC, bias, residual, activation, 0};
+    int nn_outch = M >> 2;
+
+    thread_pool_parallel_for(thread_pool, nn_outch, sgemm_block4, &arg);
+
+    arg.remain_outch_start = nn_outch << 2;
+
+    thread_pool_parallel_for(thread_pool, M - arg.remain_outch_start, sgemm_block1, &arg);
+}
 #endif    // __AVX2__
 static void sgemm_fp32(struct ir_tensor* input, struct ir_tensor* filter, struct ir_tensor* bias,
-                       struct ir_tensor* output, struct conv_priv_info* priv_info, struct conv_param* param, int n,
-                       int group, int num_thread)
+                       struct ir_tensor* residual, struct ir_tensor* output, struct conv_priv_info* priv_info,
+                       struct conv_param* param, int n, int group, struct thread_pool* thread_pool)
 {
     int kernel_size = param->kernel_h * param->kernel_w * param->input_channel / param->group;
     int outchan_g = param->output_channel / param->group;
@@ -1263,61 +1449,24 @@ static void sgemm_fp32(struct ir_tensor* input, struct ir_tensor* filter, struct
     if (bias)
         bias_fp32 = ( float* )bias->data + outchan_g * group;
 
+    /* the residual add fused, with the same layout as the output */
+    float* residual_fp32 = NULL;
+
+    if (residual)
+        residual_fp32 = ( float* )residual->data + n * out_image_size + outchan_g * group * out_h * out_w;
+
     float* filter_sgemm = interleave_fp32;
     float* input_sgemm_pack4 = im2col_pack4_fp32;
     float* output_sgemm = output_fp32;
 
-    sgemm(outchan_g, out_h * out_w, kernel_size, filter_sgemm, input_sgemm_pack4, output_sgemm, num_thread);
-
-    // process bias
-    if (bias)
-    {
-        for (int i = 0; i < outchan_g; i++)
-        {
-            for (int j = 0; j < out_h * out_w; j++)
-            {
-                int output_off = i * (out_h * out_w) + j;
-                output_fp32[output_off] += bias_fp32[i];
-            }
-        }
-    }
-
-    // process activation relu
-    if (param->activation == 0)
-    {
-        for (int i = 0; i < outchan_g; i++)
-        {
-            for (int j = 0; j < out_h * out_w; j++)
-            {
-                int output_off = i * (out_h * out_w) + j;
-
-                if (output_fp32[output_off] < 0)
-                    output_fp32[output_off] = 0;
-            }
-        }
-    }
-
-    // process activation relu6
-    if (param->activation > 0)
-    {
-        for (int i = 0; i < outchan_g; i++)
-        {
-            for (int j = 0; j < out_h * out_w; j++)
-            {
-                int output_off = i * (out_h * out_w) + j;
-
-                if (output_fp32[output_off] < 0)
-                    output_fp32[output_off] = 0;
-                if (output_fp32[output_off] > 6)
-                    output_fp32[output_off] = 6;
-            }
-        }
-    }
+    /* the bias, the residual and the activation are fused into the gemm output */
+    sgemm(outchan_g, out_h * out_w, kernel_size, filter_sgemm, input_sgemm_pack4, output_sgemm, bias_fp32,
+          residual_fp32, param->activation, thread_pool);
 }
 
 static void sgemm_uint8(struct ir_tensor* input, struct ir_tensor* filter, struct ir_tensor* bias,
                         struct ir_tensor* output, struct conv_priv_info* priv_info, struct conv_param* param, int n,
-                        int group, int num_thread)
+                        int group, struct thread_pool* thread_pool)
 {
     int kernel_size = param->kernel_h * param->kernel_w * param->input_channel / param->group;
     int outchan_g = param->output_channel / param->group;
@@ -1329,65 +1478,25 @@ static void sgemm_uint8(struct ir_tensor* input, struct ir_tensor* filter, struc
     float* interleave_fp32 = ( float* )priv_info->interleave_buffer_pack4 + outchan_g * group * kernel_size;
     float* im2col_pack4_fp32 = priv_info->im2col_buffer_pack4;
     uint8_t * output_uint8 = ( uint8_t* )output->data + n * out_image_size + outchan_g * group * out_h * out_w;
-    int* bias_int32 = NULL;
-    float bias_scale = 0.f;
+    float* bias_fp32 = NULL;
 
+    /* dequant the bias, it is added in the gemm output */
     if (bias)
     {
-        bias_int32 = ( int* )bias->data + outchan_g * group;
-        bias_scale = input->scale * filter->scale;
+        int* bias_int32 = ( int* )bias->data + outchan_g * group;
+        float bias_scale = input->scale * filter->scale;
+
+        bias_fp32 = ( float* )sys_malloc(outchan_g * sizeof(float));
+        for (int i = 0; i < outchan_g; i++)
+            bias_fp32[i] = ( float )bias_int32[i] * bias_scale;
     }
 
     float* filter_sgemm = interleave_fp32;
     float* input_sgemm_pack4 = im2col_pack4_fp32;
     float* output_sgemm = (float*)sys_malloc(outchan_g * out_h * out_w * sizeof(float));
 
-    sgemm(outchan_g, out_h * out_w, kernel_size, filter_sgemm, input_sgemm_pack4, output_sgemm, num_thread);
-
-    /* process bias */
-    if (bias)
-    {
-        for (int i = 0; i < outchan_g; i++)
-        {
-            for (int j = 0; j < out_h * out_w; j++)
-            {
-                int output_off = i * (out_h * out_w) + j;
-                output_sgemm[output_off] += (float )bias_int32[i] * bias_scale;
-            }
-        }
-    }
-
-    /* process activation relu */
-    if (param->activation == 0)
-    {
-        for (int i = 0; i < outchan_g; i++)
-        {
-            for (int j = 0; j < out_h * out_w; j++)
-            {
-                int output_off = i * (out_h * out_w) + j;
-
-                if (output_sgemm[output_off] < 0)
-                    output_sgemm[output_off] = 0;
-            }
-        }
-    }
-
-    /* process activation relu6 */
-    if (param->activation > 0)
-    {
-        for (int i = 0; i < outchan_g; i++)
-        {
-            for (int j = 0; j < out_h * out_w; j++)
-            {
-                int output_off = i * (out_h * out_w) + j;
-
-                if (output_sgemm[output_off] < 0)
-                    output_sgemm[output_off] = 0;
-                if (output_sgemm[output_off] > 6)
-                    output_sgemm[output_off] = 6;
-            }
-        }
-    }
+    sgemm(outchan_g, out_h * out_w, kernel_size, filter_sgemm, input_sgemm_pack4, output_sgemm, bias_fp32, NULL,
+          param->activation, thread_pool);
 
     /* quant from fp32 to uint8 */
     for (int i = 0; i < outchan_g; i++)
@@ -1406,6 +1515,8 @@ static void sgemm_uint8(struct ir_tensor* input, struct ir_tensor* filter, struc
     }
 
     sys_free(output_sgemm);
+    if (bias_fp32)
+        sys_free(bias_fp32);
 }
 
 /* check the conv wheather need to be using winograd */
@@ -1632,6 +1743,55 @@ void conv_hcl_interleave_pack4(int M, int K, struct conv_priv_info* priv_info)
     }
 }
 #endif
+struct pack_arg
+{
+    struct ir_tensor* input_tensor;
+    struct ir_tensor* filter_tensor;
+    struct conv_priv_info* priv_info;
+};
+
+/* interleave the kernel into mem, and pack4 it if needed */
+static int pack_kernel(void* mem, void* pack_arg)
+{
+    struct pack_arg* arg = ( struct pack_arg* )pack_arg;
+    struct ir_tensor* filter_tensor = arg->filter_tensor;
+    struct conv_priv_info* priv_info = arg->priv_info;
+    void* interleave_mem = mem;
+
+    if (priv_info->external_interleave_pack4_mem)
+    {
+        interleave_mem = sys_malloc(get_private_mem_size(filter_tensor));
+
+        if (interleave_mem == NULL)
+        {
+            set_tengine_errno(ENOMEM);
+            return -1;
+        }
+    }
+
+    priv_info->interleave_buffer = interleave_mem;
+
+    if (arg->input_tensor->data_type == TENGINE_DT_UINT8)
+        interleave_uint8(filter_tensor, priv_info);
+    else
+        interleave(filter_tensor, priv_info);
+
+    if (priv_info->external_interleave_pack4_mem)
+    {
+        int M = filter_tensor->dims[0];
+        int K = filter_tensor->elem_num / filter_tensor->dims[0];
+
+        priv_info->interleave_buffer_pack4 = mem;
+        conv_hcl_interleave_pack4(M, K, priv_info);
+
+        sys_free(interleave_mem);
+    }
+
+    priv_info->interleave_buffer = NULL;
+
+    return 0;
+}
+
 int conv_hcl_prerun(struct ir_tensor* input_tensor, struct ir_tensor* filter_tensor, struct ir_tensor* output_tensor,
                     struct conv_priv_info* priv_info, struct conv_param* param)
 {
@@ -1663,6 +1823,35 @@ int conv_hcl_prerun(struct ir_tensor* input_tensor, struct ir_tensor* filter_ten
         priv_info->im2col_buffer_pack4_size = mem_size;
     }
 
+    /* the packed kernel of the graphs loaded from the same model */
+    if (priv_info->weight_key != NULL && !priv_info->external_interleave_mem)
+    {
+        struct pack_arg arg;
+        int mem_size;
+
+        arg.input_tensor = input_tensor;
+        arg.filter_tensor = filter_tensor;
+        arg.priv_info = priv_info;
+
+        if (priv_info->external_interleave_pack4_mem)
+            mem_size = conv_hcl_get_interleave_pack4_size(filter_tensor->dims[0],
+                                                          filter_tensor->elem_num / filter_tensor->dims[0], filter_tensor);
+        else
+            mem_size = get_private_mem_size(filter_tensor);
+
+        void* mem = get_persist_weight(priv_info->weight_cache_dir, priv_info->weight_key, filter_tensor->idx,
+                                       WEIGHT_CACHE_CONV_GEMM, mem_size, filter_tensor, pack_kernel, &arg);
+
+        if (mem == NULL)
+            return -1;
+
+        priv_info->interleave_buffer_pack4 = mem;
+        priv_info->interleave_buffer_pack4_size = mem_size;
+        priv_info->shared_interleave_mem = 1;
+
+        return 0;
+    }
+
     if (!priv_info->external_interleave_mem)
     {
         int mem_size = get_private_mem_size(filter_tensor);
@@ -1710,6 +1899,13 @@ int conv_hcl_postrun(struct conv_priv_info* priv_info)
         return wino_conv_hcl_postrun(priv_info);
     }
 
+    if (priv_info->shared_interleave_mem)
+    {
+        put_shared_weight(priv_info->interleave_buffer_pack4);
+        priv_info->interleave_buffer_pack4 = NULL;
+        priv_info->shared_interleave_mem = 0;
+    }
+
     if (priv_info->external_interleave_pack4_mem && !priv_info->external_interleave_mem &&
         priv_info->interleave_buffer != NULL)
     {
@@ -1737,16 +1933,16 @@ int conv_hcl_postrun(struct conv_priv_info* priv_info)
 }
 
 int conv_hcl_run(struct ir_tensor* input_tensor, struct ir_tensor* filter_tensor, struct ir_tensor* bias_tensor,
-                 struct ir_tensor* output_tensor, struct conv_priv_info* priv_info, struct conv_param* param,
-                 int num_thread, int cpu_affinity)
+                 struct ir_tensor* residual_tensor, struct ir_tensor* output_tensor, struct conv_priv_info* priv_info,
+                 struct conv_param* param, struct thread_pool* thread_pool, int num_thread, int cpu_affinity)
 {
     int group = param->group;
     int type = input_tensor->data_type;
 
     if (priv_info->winograd)
     {
-        return wino_conv_hcl_run(input_tensor, filter_tensor, bias_tensor, output_tensor, priv_info, param, num_thread,
-                                 cpu_affinity);
+        return wino_conv_hcl_run(input_tensor, filter_tensor, bias_tensor, residual_tensor, output_tensor, priv_info,
+                                 param, num_thread, cpu_affinity);
     }
 
     for (int i = 0; i < input_tensor->dims[0]; i++)    // batch size
@@ -1762,16 +1958,17 @@ int conv_hcl_run(struct ir_tensor* input_tensor, struct ir_tensor* filter_tensor
 
             if (priv_info->external_interleave_pack4_mem)
             {
-                input_pack4(K, N, im2col_fp32, ( float* )priv_info->im2col_buffer_pack4, num_thread);
+                input_pack4(K, N, im2col_fp32, ( float* )priv_info->im2col_buffer_pack4, thread_pool);
             }
             else
             {
                 priv_info->im2col_buffer_pack4 = im2col_fp32;
             }
             if (type == TENGINE_DT_UINT8)
-                sgemm_uint8(input_tensor, filter_tensor, bias_tensor, output_tensor, priv_info, param, i, j, num_thread);
+                sgemm_uint8(input_tensor, filter_tensor, bias_tensor, output_tensor, priv_info, param, i, j, thread_pool);
             else
-                sgemm_fp32(input_tensor, filter_tensor, bias_tensor, output_tensor, priv_info, param, i, j, num_thread);
+                sgemm_fp32(input_tensor, filter_tensor, bias_tensor, residual_tensor, output_tensor, priv_info, param, i,
+                           j, thread_pool);
         }
     }
 
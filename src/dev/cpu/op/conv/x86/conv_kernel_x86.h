@@ -48,6 +48,9 @@ struct conv_priv_info
     int external_interleave_pack4_mem;    // flag
     int cpu_type;
     int winograd;
+    const char* weight_key;    // share the packed kernel in the weight cache, if set
+    const char* weight_cache_dir;    // and persist it in this directory, if set
+    int shared_interleave_mem;    // flag
 
     /* hybrid int8 params */
     void* p_input_max;
@@ -60,9 +63,14 @@ int conv_hcl_prerun(struct ir_tensor* input_tensor, struct ir_tensor* filter_ten
 
 int conv_hcl_postrun(struct conv_priv_info* info) __attribute__((weak));
 
+struct thread_pool;
+
+/* residual_tensor, if not NULL, is added to the output before the activation.
+   the gemm runs on thread_pool, the winograd on num_thread openmp threads */
 int conv_hcl_run(struct ir_tensor* input_tensor, struct ir_tensor* filter_tensor, struct ir_tensor* bias_tensor,
-                 struct ir_tensor* output_tensor, struct conv_priv_info* conv_info, struct conv_param* param,
-                 int num_thread, int cpu_affinity) __attribute__((weak));
+                 struct ir_tensor* residual_tensor, struct ir_tensor* output_tensor, struct conv_priv_info* conv_info,
+                 struct conv_param* param, struct thread_pool* thread_pool, int num_thread,
+                 int cpu_affinity) __attribute__((weak));
 
 int conv_hcl_get_shared_mem_size(struct ir_tensor* input_tensor, struct ir_tensor* output_tensor,
                                  struct conv_param* param) __attribute__((weak));
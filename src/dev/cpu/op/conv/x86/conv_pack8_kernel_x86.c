@@ -0,0 +1,405 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+#include <string.h>
+
+#include "conv_pack8_kernel_x86.h"
+#include "thread_pool.h"
+
+#if __AVX__
+#include <immintrin.h>
+
+#define PACK 8
+
+#if __FMA__
+#define fmadd8(a, b, c) _mm256_fmadd_ps(a, b, c)
+#else
+#define fmadd8(a, b, c) _mm256_add_ps(_mm256_mul_ps(a, b), c)
+#endif
+
+#define ALWAYS_INLINE inline __attribute__((always_inline))
+
+struct pack8_conv_arg
+{
+    int inc;
+    int inh;
+    int inw;
+    int outh;
+    int outw;
+    int kernel_h;
+    int kernel_w;
+    int stride_h;
+    int stride_w;
+    int dilation_h;
+    int dilation_w;
+    int pad_h;
+    int pad_w;
+    int activation;
+
+    /* the columns [ox_begin, ox_end) read no pad */
+    int ox_begin;
+    int ox_end;
+};
+
+static ALWAYS_INLINE __m256 epilogue_pack8(__m256 data, const float* residual, int activation)
+{
+    if (residual)
+        data = _mm256_add_ps(data, _mm256_loadu_ps(residual));
+
+    if (activation >= 0)
+    {
+        data = _mm256_max_ps(data, _mm256_setzero_ps());
+
+        if (activation > 0)
+            data = _mm256_min_ps(data, _mm256_set1_ps(( float )activation));
+    }
+
+    return data;
+}
+
+/* the columns [t0, t1) of the tile reading the input column ix + t * stride_w inside the input */
+static ALWAYS_INLINE int get_valid_tile(const struct pack8_conv_arg* a, int ix, int tile, int* t0, int* t1)
+{
+    *t0 = 0;
+    *t1 = tile;
+
+    while (*t0 < tile && ix + *t0 * a->stride_w < 0)
+        (*t0)++;
+    while (*t1 > *t0 && ix + (*t1 - 1) * a->stride_w >= a->inw)
+        (*t1)--;
+
+    return *t0 < *t1;
+}
+
+/* tile columns from ox of block_num output channel blocks. each input value is broadcast to the 8 output
+   channels of a block, so tile * block_num accumulators are independent. the taps in the pads are skipped
+   if check */
+static ALWAYS_INLINE void conv_tile(const float* input, const float* kernel, const float* bias,
+                                    const float* residual, float* output, const struct pack8_conv_arg* a, int oy,
+                                    int ox, const int tile, const int block_num, const int check)
+{
+    __m256 acc[2][4];
+    int kernel_step = a->kernel_h * a->kernel_w * a->inc * PACK;
+    int output_step = a->outh * a->outw * PACK;
+    int input_step = a->inh * a->inw * PACK;
+    int iy0 = oy * a->stride_h - a->pad_h;
+    int ix0 = ox * a->stride_w - a->pad_w;
+
+    for (int b = 0; b < block_num; b++)
+    {
+        __m256 init = bias ? _mm256_loadu_ps(bias + b * PACK) : _mm256_setzero_ps();
+
+        for (int t = 0; t < tile; t++)
+            acc[b][t] = init;
+    }
+
+    for (int ky = 0; ky < a->kernel_h; ky++)
+    {
+        int iy = iy0 + ky * a->dilation_h;
+
+        if (iy < 0 || iy >= a->inh)
+            continue;
+
+        for (int kx = 0; kx < a->kernel_w; kx++)
+        {
+            int ix = ix0 + kx * a->dilation_w;
+            int t0 = 0;
+            int t1 = tile;
+
+            if (check && !get_valid_tile(a, ix, tile, &t0, &t1))
+                continue;
+
+            const float* in = input + (iy * a->inw + ix) * PACK;
+            const float* k = kernel + (ky * a->kernel_w + kx) * a->inc * PACK;
+
+            for (int c = 0; c < a->inc; c += PACK)
+            {
+                for (int l = 0; l < PACK; l++)
+                {
+                    __m256 w0 = _mm256_loadu_ps(k + l * PACK);
+                    __m256 w1 = block_num > 1 ? _mm256_loadu_ps(k + kernel_step + l * PACK) : w0;
+
+                    for (int t = 0; t < tile; t++)
+                    {
+                        if (check && (t < t0 || t >= t1))
+                            continue;
+
+                        __m256 x = _mm256_broadcast_ss(in + t * a->stride_w * PACK + l);
+
+                        acc[0][t] = fmadd8(x, w0, acc[0][t]);
+                        if (block_num > 1)
+                            acc[1][t] = fmadd8(x, w1, acc[1][t]);
+                    }
+                }
+
+                in += input_step;
+                k += PACK * PACK;
+            }
+        }
+    }
+
+    for (int b = 0; b < block_num; b++)
+    {
+        for (int t = 0; t < tile; t++)
+        {
+            const float* r = residual ? residual + b * output_step + t * PACK : NULL;
+
+            _mm256_storeu_ps(output + b * output_step + t * PACK, epilogue_pack8(acc[b][t], r, a->activation));
+        }
+    }
+}
+
+static ALWAYS_INLINE void conv_row(const float* input, const float* kernel, const float* bias, const float* residual,
+                                   float* output, const struct pack8_conv_arg* a, int oy, const int block_num)
+{
+    int ox = 0;
+
+#define CONV_TILE(tile, check)                                                                                   \
+    conv_tile(input, kernel, bias, residual ? residual + ox * PACK : NULL, output + ox * PACK, a, oy, ox, tile, \
+              block_num, check)
+
+    for (; ox + 4 <= a->outw; ox += 4)
+    {
+        if (ox < a->ox_begin || ox + 4 > a->ox_end)
+            CONV_TILE(4, 1);
+        else
+            CONV_TILE(4, 0);
+    }
+
+    /* a short tile still has independent accumulators */
+    if (a->outw - ox == 3)
+        CONV_TILE(3, 1);
+    else if (a->outw - ox == 2)
+        CONV_TILE(2, 1);
+    else if (a->outw - ox == 1)
+        CONV_TILE(1, 1);
+
+#undef CONV_TILE
+}
+
+static ALWAYS_INLINE void conv_dw_tile(const float* input, const float* kernel, const float* bias,
+                                       const float* residual, float* output, const struct pack8_conv_arg* a, int oy,
+                                       int ox, const int tile, const int check)
+{
+    __m256 acc[8];
+    int iy0 = oy * a->stride_h - a->pad_h;
+    int ix0 = ox * a->stride_w - a->pad_w;
+    __m256 init = bias ? _mm256_loadu_ps(bias) : _mm256_setzero_ps();
+
+    for (int t = 0; t < tile; t++)
+        acc[t] = init;
+
+    for (int ky = 0; ky < a->kernel_h; ky++)
+    {
+        int iy = iy0 + ky * a->dilation_h;
+
+        if (iy < 0 || iy >= a->inh)
+            continue;
+
+        for (int kx = 0; kx < a->kernel_w; kx++)
+        {
+            int ix = ix0 + kx * a->dilation_w;
+            int t0 = 0;
+            int t1 = tile;
+
+            if (check && !get_valid_tile(a, ix, tile, &t0, &t1))
+                continue;
+
+            const float* in = input + (iy * a->inw + ix) * PACK;
+            __m256 w = _mm256_loadu_ps(kernel + (ky * a->kernel_w + kx) * PACK);
+
+            for (int t = 0; t < tile; t++)
+            {
+                if (check && (t < t0 || t >= t1))
+                    continue;
+
+                acc[t] = fmadd8(_mm256_loadu_ps(in + t * a->stride_w * PACK), w, acc[t]);
+            }
+        }
+    }
+
+    for (int t = 0; t < tile; t++)
+    {
+        const float* r = residual ? residual + t * PACK : NULL;
+
+        _mm256_storeu_ps(output + t * PACK, epilogue_pack8(acc[t], r, a->activation));
+    }
+}
+
+static void conv_dw_row(const float* input, const float* kernel, const float* bias, const float* residual,
+                        float* output, const struct pack8_conv_arg* a, int oy)
+{
+    int ox = 0;
+
+#define CONV_DW_TILE(tile, check)                                                                                  \
+    conv_dw_tile(input, kernel, bias, residual ? residual + ox * PACK : NULL, output + ox * PACK, a, oy, ox, tile, \
+                 check)
+
+    for (; ox + 8 <= a->outw; ox += 8)
+    {
+        if (ox < a->ox_begin || ox + 8 > a->ox_end)
+            CONV_DW_TILE(8, 1);
+        else
+            CONV_DW_TILE(8, 0);
+    }
+    for (; ox + 4 <= a->outw; ox += 4)
+        CONV_DW_TILE(4, 1);
+    for (; ox < a->outw; ox++)
+        CONV_DW_TILE(1, 1);
+
+#undef CONV_DW_TILE
+}
+
+int conv_pack8_get_kernel_size(struct ir_tensor* filter_tensor, struct conv_param* param)
+{
+    return filter_tensor->elem_num * sizeof(float);
+}
+
+void conv_pack8_pack_kernel(struct ir_tensor* filter_tensor, float* kernel, struct conv_param* param)
+{
+    const float* weight = ( const float* )filter_tensor->data;
+    int outc = filter_tensor->dims[0];
+    int inc = filter_tensor->dims[1];
+    int kernel_size = param->kernel_h * param->kernel_w;
+
+    /* the depthwise one is the same with inc 1 */
+    for (int oc = 0; oc < outc; oc++)
+    {
+        float* k = kernel + (oc / PACK) * kernel_size * inc * PACK + oc % PACK;
+
+        for (int ic = 0; ic < inc; ic++)
+        {
+            for (int i = 0; i < kernel_size; i++)
+                k[(i * inc + ic) * PACK] = weight[(oc * inc + ic) * kernel_size + i];
+        }
+    }
+}
+
+/* the rows of one batch, run on the thread pool */
+struct pack8_conv_task
+{
+    const struct pack8_conv_arg* a;
+    const float* input;
+    const float* kernel;
+    const float* bias;
+    const float* residual;
+    float* output;
+    int block_num;
+    int input_size;
+    int output_size;
+    int kernel_step;
+};
+
+static void conv_dw_task(void* arg, int i)
+{
+    const struct pack8_conv_task* t = ( const struct pack8_conv_task* )arg;
+    const struct pack8_conv_arg* a = t->a;
+    int b = i / a->outh;
+    int oy = i % a->outh;
+    int offset = b * t->output_size + oy * a->outw * PACK;
+
+    conv_dw_row(t->input + b * t->input_size, t->kernel + b * t->kernel_step, t->bias ? t->bias + b * PACK : NULL,
+                t->residual ? t->residual + offset : NULL, t->output + offset, a, oy);
+}
+
+/* two blocks of output channels at once */
+static void conv_pair_task(void* arg, int i)
+{
+    const struct pack8_conv_task* t = ( const struct pack8_conv_task* )arg;
+    const struct pack8_conv_arg* a = t->a;
+    int b = i / a->outh * 2;
+    int oy = i % a->outh;
+    int offset = b * t->output_size + oy * a->outw * PACK;
+    const float* k = t->kernel + b * t->kernel_step;
+    const float* bs = t->bias ? t->bias + b * PACK : NULL;
+    const float* r = t->residual ? t->residual + offset : NULL;
+
+    if (b + 1 < t->block_num)
+        conv_row(t->input, k, bs, r, t->output + offset, a, oy, 2);
+    else
+        conv_row(t->input, k, bs, r, t->output + offset, a, oy, 1);
+}
+
+int conv_pack8_run(struct ir_tensor* input_tensor, const float* kernel, struct ir_tensor* bias_tensor,
+                   struct ir_tensor* residual_tensor, struct ir_tensor* output_tensor, struct conv_param* param,
+                   struct thread_pool* thread_pool)
+{
+    struct pack8_conv_arg a;
+    int batch = input_tensor->dims[0];
+    int outc = output_tensor->dims[1];
+    int depthwise = param->group > 1;
+
+    a.inc = input_tensor->dims[1];
+    a.inh = input_tensor->dims[2];
+    a.inw = input_tensor->dims[3];
+    a.outh = output_tensor->dims[2];
+    a.outw = output_tensor->dims[3];
+    a.kernel_h = param->kernel_h;
+    a.kernel_w = param->kernel_w;
+    a.stride_h = param->stride_h;
+    a.stride_w = param->stride_w;
+    a.dilation_h = param->dilation_h;
+    a.dilation_w = param->dilation_w;
+    a.pad_h = param->pad_h0;
+    a.pad_w = param->pad_w0;
+    a.activation = param->activation;
+
+    /* the pads at the end are only the columns the input runs out */
+    a.ox_begin = (a.pad_w + a.stride_w - 1) / a.stride_w;
+    a.ox_end = a.inw - 1 - (a.kernel_w - 1) * a.dilation_w + a.pad_w;
+    a.ox_end = a.ox_end < 0 ? 0 : a.ox_end / a.stride_w + 1;
+
+    if (a.ox_begin > a.outw)
+        a.ox_begin = a.outw;
+    if (a.ox_end > a.outw)
+        a.ox_end = a.outw;
+    if (a.ox_end < a.ox_begin)
+        a.ox_end = a.ox_begin;
+
+    struct pack8_conv_task t;
+
+    t.a = &a;
+    t.kernel = kernel;
+    t.bias = bias_tensor ? ( const float* )bias_tensor->data : NULL;
+    t.block_num = outc / PACK;
+    t.input_size = a.inh * a.inw * PACK;
+    t.output_size = a.outh * a.outw * PACK;
+    t.kernel_step = a.kernel_h * a.kernel_w * (depthwise ? 1 : a.inc) * PACK;
+
+    for (int n = 0; n < batch; n++)
+    {
+        t.input = ( const float* )input_tensor->data + n * a.inc * a.inh * a.inw;
+        t.output = ( float* )output_tensor->data + n * outc * a.outh * a.outw;
+        t.residual = residual_tensor ? ( const float* )residual_tensor->data + n * outc * a.outh * a.outw : NULL;
+
+        if (depthwise)
+            thread_pool_parallel_for(thread_pool, t.block_num * a.outh, conv_dw_task, &t);
+        else
+            thread_pool_parallel_for(thread_pool, (t.block_num + 1) / 2 * a.outh, conv_pair_task, &t);
+    }
+
+    return 0;
+}
+
+#endif
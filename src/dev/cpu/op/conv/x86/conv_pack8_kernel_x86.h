@@ -0,0 +1,45 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+#ifndef __CONV_PACK8_KERNEL_X86_H_
+#define __CONV_PACK8_KERNEL_X86_H_
+
+#include "tengine_ir.h"
+#include "convolution_param.h"
+
+/* the convolution and the depthwise convolution of the fp32 nchw8 tensors, with avx.
+   the kernel is packed as [oc / 8][kernel_h][kernel_w][ic][8], or [c / 8][kernel_h][kernel_w][8] if depthwise */
+
+int conv_pack8_get_kernel_size(struct ir_tensor* filter_tensor, struct conv_param* param) __attribute__((weak));
+
+void conv_pack8_pack_kernel(struct ir_tensor* filter_tensor, float* kernel, struct conv_param* param)
+    __attribute__((weak));
+
+struct thread_pool;
+
+int conv_pack8_run(struct ir_tensor* input_tensor, const float* kernel, struct ir_tensor* bias_tensor,
+                   struct ir_tensor* residual_tensor, struct ir_tensor* output_tensor, struct conv_param* param,
+                   struct thread_pool* thread_pool) __attribute__((weak));
+
+#endif
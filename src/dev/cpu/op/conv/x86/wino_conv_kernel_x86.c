@@ -26,6 +26,7 @@
 #include <math.h>
 
 #include "wino_conv_kernel_x86.h"
+#include "weight_cache.h"
 
 #define TILE 4
 #define ELEM_SIZE ((TILE + 2) * (TILE + 2))
@@ -33,18 +34,26 @@
 #define WINO_MAX(a, b) ((a) > (b) ? (a) : (b))
 #define WINO_MIN(a, b) ((a) < (b) ? (a) : (b))
 
-static void relu(float* data, int size, int activation)
+/* applied to the output tile, -1: none, 0: relu, n > 0: relu clipped at n */
+static inline float activation_fp32(float data, int activation)
 {
-    for (int i = 0; i < size; i++)
+    if (activation >= 0)
     {
-        data[i] = WINO_MAX(data[i], ( float )0);
+        data = WINO_MAX(data, ( float )0);
 
         if (activation > 0)
-        {
-            data[i] = WINO_MIN(data[i], ( float )activation);
-        }
+            data = WINO_MIN(data, ( float )activation);
     }
+
+    return data;
+}
+
+/* the fused residual at an output position, zero in the border of the aligned output */
+static inline float residual_fp32(const float* residual, int outw, int outh, int row, int col)
+{
+    return (residual != NULL && row < outh && col < outw) ? residual[row * outw + col] : 0.f;
 }
+
 static int get_private_mem_size(struct ir_tensor* filter, struct conv_param* param)
 {
     int output_c = filter->dims[0];
@@ -112,8 +121,8 @@ void delete_0_3D(float* dst, float* src, int m_align, int n_align, int m, int n,
 }
 
 void conv3x3s1_winograd43_sse(float* bottom_blob, float* top_blob, float* kernel_tm_test, float* dot_block,
-                              float* transform_input, float* output_bordered, float* _bias, int w, int h, int inch,
-                              int outw, int outh, int outch, int num_thread)
+                              float* transform_input, float* output_bordered, float* _bias, float* residual, int w,
+                              int h, int inch, int outw, int outh, int outch, int activation, int num_thread)
 {
     size_t elemsize = sizeof(float);
     const float* bias = _bias;
@@ -1008,6 +1017,7 @@ void conv3x3s1_winograd43_sse(float* bottom_blob, float* top_blob, float* kernel
             float* outRow3 = outRow0 + outw_align * 3;
 
             const float bias0 = bias ? bias[p] : 0.f;
+            const float* residual0 = residual ? residual + outw * outh * p : NULL;
 
             for (int j = 0; j < nColBlocks; j++)
             {
@@ -1072,13 +1082,20 @@ void conv3x3s1_winograd43_sse(float* bottom_blob, float* top_blob, float* kernel
                         o2[n] = d1[n] + d2[n] + 4 * d3[n] + 4 * d4[n];
                         o3[n] = d1[n] - d2[n] + 8 * d3[n] - 8 * d4[n] + d5[n];
                     }
-                    // save to top blob tm
+                    // save to top blob tm, with bias, residual and activation
                     for (int n = 0; n < 4; n++)
                     {
-                        outRow0[n] = o0[n] + bias0;
-                        outRow1[n] = o1[n] + bias0;
-                        outRow2[n] = o2[n] + bias0;
-                        outRow3[n] = o3[n] + bias0;
+                        int row = j * 4;
+                        int col = i * 4 + n;
+
+                        outRow0[n] = activation_fp32(o0[n] + bias0 + residual_fp32(residual0, outw, outh, row, col),
+                                                     activation);
+                        outRow1[n] = activation_fp32(o1[n] + bias0 + residual_fp32(residual0, outw, outh, row + 1, col),
+                                                     activation);
+                        outRow2[n] = activation_fp32(o2[n] + bias0 + residual_fp32(residual0, outw, outh, row + 2, col),
+                                                     activation);
+                        outRow3[n] = activation_fp32(o3[n] + bias0 + residual_fp32(residual0, outw, outh, row + 3, col),
+                                                     activation);
                     }
 
                     out_tile += 36;
@@ -1098,7 +1115,7 @@ void conv3x3s1_winograd43_sse(float* bottom_blob, float* top_blob, float* kernel
     }
 
     // END transform output
-    if (outw_align != outw || outh_align != outw)
+    if (outw_align != outw || outh_align != outh)
     {
         delete_0_3D(top_blob, top_blob_bordered, outh_align, outw_align, outh, outw, outch, 0, 0);
     }
@@ -1278,6 +1295,21 @@ void conv3x3s1_winograd43_transform_kernel_sse(const float* kernel, float* kerne
     free(kernel_tm);
 }
 
+struct transform_arg
+{
+    struct ir_tensor* filter_tensor;
+};
+
+static int transform_shared_kernel(void* mem, void* arg)
+{
+    struct ir_tensor* filter_tensor = (( struct transform_arg* )arg)->filter_tensor;
+
+    conv3x3s1_winograd43_transform_kernel_sse(( float* )filter_tensor->data, ( float* )mem, filter_tensor->dims[1],
+                                              filter_tensor->dims[0]);
+
+    return 0;
+}
+
 int wino_conv_hcl_prerun(struct ir_tensor* input_tensor, struct ir_tensor* filter_tensor,
                          struct ir_tensor* output_tensor, struct conv_priv_info* priv_info, struct conv_param* param)
 {
@@ -1295,7 +1327,25 @@ int wino_conv_hcl_prerun(struct ir_tensor* input_tensor, struct ir_tensor* filte
 
     float* kernel = ( float* )filter_tensor->data;
 
-    if (!priv_info->external_interleave_mem)
+    /* the transformed kernel of the graphs loaded from the same model */
+    if (priv_info->weight_key != NULL && !priv_info->external_interleave_mem)
+    {
+        struct transform_arg arg;
+        int mem_size = get_private_mem_size(filter_tensor, param);
+
+        arg.filter_tensor = filter_tensor;
+
+        void* mem = get_persist_weight(priv_info->weight_cache_dir, priv_info->weight_key, filter_tensor->idx,
+                                       WEIGHT_CACHE_CONV_WINO, mem_size, filter_tensor, transform_shared_kernel, &arg);
+
+        if (mem == NULL)
+            return -1;
+
+        priv_info->interleave_buffer = mem;
+        priv_info->interleave_buffer_size = mem_size;
+        priv_info->shared_interleave_mem = 1;
+    }
+    else if (!priv_info->external_interleave_mem)
     {
         int mem_size = get_private_mem_size(filter_tensor, param);
         void* mem = sys_malloc(mem_size);
@@ -1323,14 +1373,21 @@ int wino_conv_hcl_prerun(struct ir_tensor* input_tensor, struct ir_tensor* filte
         priv_info->output_bordered = ( float* )sys_malloc(outw * outh * output_c * sizeof(float));
     }
 
-    conv3x3s1_winograd43_transform_kernel_sse(kernel, ( float* )priv_info->interleave_buffer, input_c, output_c);
+    if (!priv_info->shared_interleave_mem)
+        conv3x3s1_winograd43_transform_kernel_sse(kernel, ( float* )priv_info->interleave_buffer, input_c, output_c);
 
     return 0;
 }
 
 int wino_conv_hcl_postrun(struct conv_priv_info* priv_info)
 {
-    if (!priv_info->external_interleave_mem && priv_info->interleave_buffer != NULL)
+    if (priv_info->shared_interleave_mem)
+    {
+        put_shared_weight(priv_info->interleave_buffer);
+        priv_info->interleave_buffer = NULL;
+        priv_info->shared_interleave_mem = 0;
+    }
+    else if (!priv_info->external_interleave_mem && priv_info->interleave_buffer != NULL)
     {
         sys_free(priv_info->interleave_buffer);
         priv_info->interleave_buffer = NULL;
@@ -1360,8 +1417,8 @@ int wino_conv_hcl_postrun(struct conv_priv_info* priv_info)
 }
 
 int wino_conv_hcl_run(struct ir_tensor* input_tensor, struct ir_tensor* filter_tensor, struct ir_tensor* bias_tensor,
-                      struct ir_tensor* output_tensor, struct conv_priv_info* priv_info, struct conv_param* param,
-                      int num_thread, int cpu_affinity)
+                      struct ir_tensor* residual_tensor, struct ir_tensor* output_tensor,
+                      struct conv_priv_info* priv_info, struct conv_param* param, int num_thread, int cpu_affinity)
 {
     /* param */
     int kernel_h = param->kernel_h;
@@ -1405,6 +1462,9 @@ int wino_conv_hcl_run(struct ir_tensor* input_tensor, struct ir_tensor* filter_t
     float* biases = NULL;
     if (bias_tensor != NULL)
         biases = ( float* )bias_tensor->data;
+    float* residual = NULL;
+    if (residual_tensor != NULL)
+        residual = ( float* )residual_tensor->data;
 
     for (int i = 0; i < batch; i++)
     {
@@ -1415,12 +1475,10 @@ int wino_conv_hcl_run(struct ir_tensor* input_tensor, struct ir_tensor* filter_t
             conv3x3s1_winograd43_sse(priv_info->input_pad + i * in_c * padded_in_h * padded_in_w + g * input_size_g,
                                      output + i * out_c * out_h * out_w, priv_info->interleave_buffer,
                                      priv_info->dot_block, priv_info->transform_input, priv_info->output_bordered,
-                                     biases, padded_in_w, padded_in_h, in_c, out_w, out_h, out_c, num_thread);
+                                     biases, residual ? residual + i * output_size : NULL, padded_in_w, padded_in_h, in_c,
+                                     out_w, out_h, out_c, act_type, num_thread);
         }
     }
-    if (act_type >= 0)
-    {
-        relu(output, batch * output_size, act_type);
-    }
+
     return 0;
 }
\ No newline at end of file
@@ -42,7 +42,8 @@ int wino_conv_hcl_prerun(struct ir_tensor* input_tensor, struct ir_tensor* filte
 int wino_conv_hcl_postrun(struct conv_priv_info* info) __attribute__((weak));
 
 int wino_conv_hcl_run(struct ir_tensor* input_tensor, struct ir_tensor* filter_tensor, struct ir_tensor* bias_tensor,
-                      struct ir_tensor* output_tensor, struct conv_priv_info* conv_info, struct conv_param* param,
-                      int num_thread, int affinity) __attribute__((weak));
+                      struct ir_tensor* residual_tensor, struct ir_tensor* output_tensor,
+                      struct conv_priv_info* conv_info, struct conv_param* param, int num_thread,
+                      int affinity) __attribute__((weak));
 
 #endif
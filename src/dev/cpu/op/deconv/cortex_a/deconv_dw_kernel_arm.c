@@ -38,7 +38,7 @@
 
 inline static float do_activation(float input, int activation)
 {
-    if (activation == 0)
+    if (activation >= 0)
     {
         input = DECONV_DW_MAX(input, 0);
 
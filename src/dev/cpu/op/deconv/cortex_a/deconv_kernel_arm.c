@@ -535,6 +535,17 @@ int deconv_hcl_run(struct ir_tensor* input_tensor , \
             float* cur_bias = biases_buf? (biases_buf + g * out_c) : NULL;
 			col2im(col_buf, cur_output, cur_bias, out_c, out_w, out_h, ksize, ksize, stride,
                            stride, dilation, dilation, pad, pad, in_w, in_h);
+
+            /* the outputs are complete only after col2im, the activation runs on the group still in cache */
+            if (act_type >= 0)
+            {
+                for (int i = 0; i < output_size; i++)
+                {
+                    float val = cur_output[i] > 0 ? cur_output[i] : 0;
+
+                    cur_output[i] = (act_type == 6 && val > 6) ? 6 : val;
+                }
+            }
         }
     }
 
@@ -55,7 +55,7 @@ static inline float activation(float input, int activation)
             input = 0;
         if (activation == 1 && input > 1)
             input = 1;
-        if (activation == 2 && input > 6)
+        if ((activation == 2 || activation == 6) && input > 6)
             input = 6;
     }
 
@@ -185,18 +185,20 @@ static int ref_deconv_fp32(const float* input, float* output, const float* kerne
                                 output_offset = n * output_c * group * output_w * output_h +
                                                 h * output_c * group * output_w + w * output_c * group + c;
                             }
-                            output[output_offset] += bias_val;
+                            output[output_offset] =
+                                activation(output[output_offset] + bias_val, param->activation);
                         }
                     }
                 }
             }
         }
     }
-
-    // activation
-    for (n = 0; n < batch * group * output_c * output_w * output_h; n++)
+    else if (param->activation >= 0)
     {
-        output[n] = activation(output[n], param->activation);
+        for (n = 0; n < batch * group * output_c * output_w * output_h; n++)
+        {
+            output[n] = activation(output[n], param->activation);
+        }
     }
 
     return 0;
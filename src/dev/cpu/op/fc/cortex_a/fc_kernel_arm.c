@@ -40,8 +40,23 @@ void sgemv_1x2_a17(float* biases, float* input, float* kernel, int kernel_size,
 
 typedef void (*kernel_t)(float* biases, float* input, float* kernel, int kernel_size, float* output);
 
+/* applied to the outputs of a kernel call while they are in cache */
+static inline void activation(float* output, int size, int activation)
+{
+    if (activation < 0)
+        return;
+
+    for (int i = 0; i < size; i++)
+    {
+        if (output[i] < 0)
+            output[i] = 0;
+        if (activation > 0 && output[i] > activation)
+            output[i] = activation;
+    }
+}
+
 static void sgemv1x8(float* input, float* output, float* kernel, float* bias, int kernel_size, int start_ch, int end_ch,
-                     int num_thread, kernel_t kernel_1x8)
+                     int act_type, int num_thread, kernel_t kernel_1x8)
 {
     #pragma omp parallel for num_threads(num_thread)
     for (int ch = start_ch; ch < end_ch; ch += 8)
@@ -52,11 +67,12 @@ static void sgemv1x8(float* input, float* output, float* kernel, float* bias, in
         float* cur_bias = bias ? bias + ch : zeros;
 
         kernel_1x8(cur_bias, input, cur_kernel, kernel_size, cur_output);
+        activation(cur_output, 8, act_type);
     }
 }
 
 static void sgemv1x2(float* input, float* output, float* kernel, float* bias, int kernel_size, int start_ch, int end_ch,
-                     int num_thread, kernel_t kernel_1x2)
+                     int act_type, int num_thread, kernel_t kernel_1x2)
 {
     int end_ch2 = end_ch & -2;
 
@@ -69,6 +85,7 @@ static void sgemv1x2(float* input, float* output, float* kernel, float* bias, in
         float* cur_bias = bias ? bias + ch : zeros;
 
         kernel_1x2(cur_bias, input, cur_kernel, kernel_size, cur_output);
+        activation(cur_output, 2, act_type);
     }
     int ch = end_ch2;
     if (end_ch & 0x1)
@@ -80,6 +97,7 @@ static void sgemv1x2(float* input, float* output, float* kernel, float* bias, in
             sum += input[i] * cur_kernel[i];
 
         *cur_output = sum;
+        activation(cur_output, 1, act_type);
     }
 }
 
@@ -192,9 +210,11 @@ int fc_kernel_run(struct ir_tensor* input_tensor, struct ir_tensor* filter_tenso
         float* cur_input = input + i * kernel_size;
         float* cur_output = output + i * out_num;
 
-        sgemv1x8(cur_input, cur_output, weight, biases, kernel_size, 0, remain_out_start, num_thread, kernel_1x8);
+        sgemv1x8(cur_input, cur_output, weight, biases, kernel_size, 0, remain_out_start, param->activation, num_thread,
+                 kernel_1x8);
         if (out_num & 0x7)
-            sgemv1x2(cur_input, cur_output, weight, biases, kernel_size, remain_out_start, out_num, num_thread, kernel_1x2);
+            sgemv1x2(cur_input, cur_output, weight, biases, kernel_size, remain_out_start, out_num, param->activation,
+                     num_thread, kernel_1x2);
     }
 
     return 0;
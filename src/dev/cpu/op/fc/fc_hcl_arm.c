@@ -253,6 +253,10 @@ static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struc
         return 0;
 #endif
 
+    /* nor the per output scale */
+    if (ir_node->input_num > 3)
+        return 0;
+
     return OPS_SCORE_BEST;
 }
 
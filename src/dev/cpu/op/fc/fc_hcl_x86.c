@@ -29,6 +29,7 @@
 #include "tengine_ir.h"
 #include "../../cpu_node_ops.h"
 #include "tengine_op.h"
+#include "thread_pool.h"
 #include "fc_param.h"
 #include <math.h>
 
@@ -49,49 +50,98 @@ struct fc_data
     float scale[3];    // input, kernel, output
 };
 
-static int innerproduct(int inn, int inc, int inh, int inw, int outc, const float* weight, const float* input, float* output,
-                        const float* _bias, int num_thread, int cpu_affinity)
+static inline float activation(float input, int activation)
 {
-    size_t elemsize = sizeof(float);
-    int size = inw * inh;
-
-    for (int n = 0; n < inn; n++)
+    if (activation >= 0)
     {
-#pragma omp parallel for num_threads(num_thread)
-        for (int p = 0; p < outc; p++)
-        {
-            int q = 0;
-            float sum = _bias ? _bias[p] : 0.f;
-            const float* weight1 = weight + p * inc * size;
-            const float* input1 = input + n * inc * size;
+        input = input < 0 ? 0 : input;
+        if (activation > 0 && input > activation)
+            input = activation;
+    }
+
+    return input;
+}
+
+struct innerproduct_arg
+{
+    int inn;
+    int inc;
+    int size;
+    int outc;
+    const float* weight;
+    const float* input;
+    float* output;
+    const float* bias;
+    const float* scale;
+    int act_type;
+};
+
+/* one output of one batch */
+static void innerproduct_task(void* arg, int idx)
+{
+    const struct innerproduct_arg* a = ( const struct innerproduct_arg* )arg;
+    const float* _bias = a->bias;
+    const float* _scale = a->scale;
+    int inc = a->inc;
+    int size = a->size;
+    int outc = a->outc;
+    int n = idx / outc;
+    int p = idx % outc;
+
+    int q = 0;
+    float sum = (_bias && !_scale) ? _bias[p] : 0.f;
+    const float* weight1 = a->weight + p * inc * size;
+    const float* input1 = a->input + n * inc * size;
 #if __AVX__ || __SSE__
 #if __SSE__
-            float _sum[4] = {0.f};
-            __m128 _sum0 = _mm_set1_ps(0.f);
-            for (; q + 3 < inc * size; q = q + 4)
-            {
-                __m128 _input = _mm_loadu_ps(input1 + q);
-                __m128 _weight = _mm_loadu_ps(weight1 + q);
-                __m128 _sum1 = _mm_mul_ps(_input, _weight);
-                _sum0 = _mm_add_ps(_sum0, _sum1);
-            }
-            _mm_storeu_ps(_sum, _sum0);
-            float tmp = _sum[0] + _sum[1] + _sum[2] + _sum[3];
-            sum = sum + tmp;
+    float _sum[4] = {0.f};
+    __m128 _sum0 = _mm_set1_ps(0.f);
+    for (; q + 3 < inc * size; q = q + 4)
+    {
+        __m128 _input = _mm_loadu_ps(input1 + q);
+        __m128 _weight = _mm_loadu_ps(weight1 + q);
+        __m128 _sum1 = _mm_mul_ps(_input, _weight);
+        _sum0 = _mm_add_ps(_sum0, _sum1);
+    }
+    _mm_storeu_ps(_sum, _sum0);
+    float tmp = _sum[0] + _sum[1] + _sum[2] + _sum[3];
+    sum = sum + tmp;
 #else    //__AVX__
          // TODO
 #endif
 #endif
-            for (; q < inc * size; q++)
-            {
-                float tmp = input1[q] * weight1[q];
-                sum = sum + tmp;
-            }
-
-            output[n * outc + p] = sum;
-        }
+    for (; q < inc * size; q++)
+    {
+        float tmp = input1[q] * weight1[q];
+        sum = sum + tmp;
     }
 
+    /* the per output scale, if any, is applied before the bias */
+    if (_scale)
+        sum = sum * _scale[p] + (_bias ? _bias[p] : 0.f);
+
+    /* the activation is applied while the sum is still in register */
+    a->output[n * outc + p] = activation(sum, a->act_type);
+}
+
+static int innerproduct(int inn, int inc, int inh, int inw, int outc, const float* weight, const float* input, float* output,
+                        const float* _bias, const float* _scale, int act_type, struct thread_pool* thread_pool)
+{
+    struct innerproduct_arg arg;
+
+    arg.inn = inn;
+    arg.inc = inc;
+    arg.size = inw * inh;
+    arg.outc = outc;
+    arg.weight = weight;
+    arg.input = input;
+    arg.output = output;
+    arg.bias = _bias;
+    arg.scale = _scale;
+    arg.act_type = act_type;
+
+    thread_pool_parallel_for(thread_pool, inn * outc, innerproduct_task, &arg);
+
     return 0;
 }
 
@@ -165,8 +215,6 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct ir_tensor* weight_tensor;
     struct ir_tensor* bias_tensor;
     struct ir_tensor* output_tensor;
-    int num_thread = exec_graph->num_thread;
-    int cpu_affinity = exec_graph->cpu_affinity;    
 
     input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
     weight_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[1]);
@@ -191,7 +239,13 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
         bias_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[2]);
         bias_data = bias_tensor->data;
     }
-    if (innerproduct(batch_number, inc, inh, inw, outc, weight_data, input_data, output_data, bias_data, num_thread, cpu_affinity) < 0)
+
+    void* scale_data = NULL;
+    if (ir_node->input_num > 3)
+        scale_data = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[3])->data;
+
+    if (innerproduct(batch_number, inc, inh, inw, outc, weight_data, input_data, output_data, bias_data, scale_data,
+                     param->activation, exec_graph->thread_pool) < 0)
         return -1;
 
     return 0;
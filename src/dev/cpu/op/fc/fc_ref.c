@@ -41,9 +41,24 @@ struct fc_data
     int hidden;    // hidden
     int zero[3];    // input, kernel, output
     float scale[3];    // input, kernel, output
+    int activation;
 };
 
-static int ref_fc_fp32(struct ir_tensor* input_tensor, struct ir_tensor* output_tensor, struct ir_tensor* weight_tensor, struct ir_tensor* bias_tensor, struct fc_data* param)
+static inline float activation(float input, int activation)
+{
+    if (activation >= 0)
+    {
+        if (input < 0)
+            input = 0;
+        if (activation > 0 && input > activation)
+            input = activation;
+    }
+
+    return input;
+}
+
+static int ref_fc_fp32(struct ir_tensor* input_tensor, struct ir_tensor* output_tensor, struct ir_tensor* weight_tensor, struct ir_tensor* bias_tensor,
+                       struct ir_tensor* scale_tensor, struct fc_data* param)
 {
     int batch = param->batch;
     int hidden = param->hidden;
@@ -55,13 +70,16 @@ static int ref_fc_fp32(struct ir_tensor* input_tensor, struct ir_tensor* output_
     float* bias = NULL;
     if (bias_tensor)
         bias = bias_tensor->data;
+    float* scale = NULL;
+    if (scale_tensor)
+        scale = scale_tensor->data;
 
     int n, i, j;
     for (n = 0; n < batch; n++)
     {
         for (i = 0; i < out_number; i++)
         {
-            float tmp = bias ? bias[i] : 0.f;
+            float tmp = (bias && !scale) ? bias[i] : 0.f;
             for (j = 0; j < hidden; j++)
             {
                 if (param->need_trans == 0)
@@ -69,7 +87,10 @@ static int ref_fc_fp32(struct ir_tensor* input_tensor, struct ir_tensor* output_
                 else
                     tmp += input[n * hidden + j] * weight[i + j * out_number];
             }
-            output[n * out_number + i] = tmp;
+            /* the per output scale, if any, is applied before the bias */
+            if (scale)
+                tmp = tmp * scale[i] + (bias ? bias[i] : 0.f);
+            output[n * out_number + i] = activation(tmp, param->activation);
         }
     }
 
@@ -103,7 +124,7 @@ static int ref_fc_fp16(struct ir_tensor* input_tensor, struct ir_tensor* output_
                 else
                     tmp += fp16_to_fp32(input[n * hidden + j]) * fp16_to_fp32(weight[i + j * out_number]);
             }
-            output[n * out_number + i] = fp32_to_fp16(tmp);
+            output[n * out_number + i] = fp32_to_fp16(activation(tmp, param->activation));
         }
     }
 
@@ -153,6 +174,7 @@ static int ref_fc_uint8(struct ir_tensor* input_tensor, struct ir_tensor* output
                         data += input_fp32 * weight_fp32;
                     }
                 }
+                data = activation(data, param->activation);
                 int udata = round(data / output_scale) + output_zero;
                 if (udata > 255)
                     udata = 255;
@@ -185,6 +207,7 @@ static int ref_fc_uint8(struct ir_tensor* input_tensor, struct ir_tensor* output
                         data += input_fp32 * weight_fp32;
                     }
                 }
+                data = activation(data, param->activation);
                 int udata = round(data / output_scale) + output_zero;
                 if (udata > 255)
                     udata = 255;
@@ -249,6 +272,7 @@ static int prerun(struct node_ops* node_ops, struct exec_node* exec_node, struct
     }
     op_param->batch = input_tensor->dims[0];
     op_param->out_number = param->num_output;
+    op_param->activation = param->activation;
 
     int weight_out = weight_tensor->dims[0];
 
@@ -267,6 +291,7 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     struct ir_tensor* input_tensor;
     struct ir_tensor* weight_tensor;
     struct ir_tensor* bias_tensor = NULL;
+    struct ir_tensor* scale_tensor = NULL;
     struct ir_tensor* output_tensor;
 
     input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
@@ -278,10 +303,12 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
 
     if (ir_node->input_num > 2)
         bias_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[2]);
+    if (ir_node->input_num > 3)
+        scale_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[3]);
 
     int ret = -1;
     if (input_tensor->data_type == TENGINE_DT_FP32)
-        ret = ref_fc_fp32(input_tensor, output_tensor, weight_tensor, bias_tensor, op_param);
+        ret = ref_fc_fp32(input_tensor, output_tensor, weight_tensor, bias_tensor, scale_tensor, op_param);
     else if (input_tensor->data_type == TENGINE_DT_FP16)
         ret = ref_fc_fp16(input_tensor, output_tensor, weight_tensor, bias_tensor, op_param);
     else if (input_tensor->data_type == TENGINE_DT_UINT8)
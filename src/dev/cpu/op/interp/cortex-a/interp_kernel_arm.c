@@ -448,7 +448,8 @@ int interp_run(struct ir_tensor* output_tensor, struct ir_tensor* input_tensor,
     float width_scale = interp_param->width_scale;
     float height_scale = interp_param->height_scale;
 
-    int in_c = input_tensor->dims[1];
+    /* the channels of all the images of the batch */
+    int in_c = input_tensor->dims[0] * input_tensor->dims[1];
     int in_h = input_tensor->dims[2];
     int in_w = input_tensor->dims[3];
 
@@ -189,7 +189,8 @@ int ref_interp_fp32(struct ir_tensor* input_tensor, struct ir_tensor* output_ten
     linear_coeffs(in_w, out_w, xofs, alpha);
     linear_coeffs(in_h, out_h, yofs, beta);
 
-    for (int q = 0; q < channel; ++q)
+    /* the images of the batch follow each other */
+    for (int q = 0; q < batch * channel; ++q)
     {
         resize_bilinear_image(input+in_channel_size*q, output+out_channel_size*q, alpha, xofs, beta, yofs, out_h, out_w, in_h, in_w);
     }
@@ -24,6 +24,7 @@
  */
 
 #include <math.h>
+#include <string.h>
 #include "sys_port.h"
 #include "module.h"
 #include "tengine_errno.h"
@@ -76,12 +77,8 @@ static void ref_pad_fp32(float* input, float* output, int in_h, int in_w, int ou
         }
         else
         {
-            //            memcpy(outptr + left, ptr, in_w * sizeof(float));
-            //            x += in_w;
-            for (; x < in_w; x++)
-            {
-                outptr[left + x] = ptr[x];
-            }
+            memcpy(outptr + left, ptr, in_w * sizeof(float));
+            x += in_w;
         }
         for (; x < out_w; x++)
         {
@@ -135,12 +132,8 @@ static void ref_pad_uint8(uint8_t* input, uint8_t* output, int in_h, int in_w, i
         }
         else
         {
-            //            memcpy(outptr + left, ptr, in_w * sizeof(float));
-            //            x += in_w;
-            for (; x < in_w; x++)
-            {
-                outptr[left + x] = ptr[x];
-            }
+            memcpy(outptr + left, ptr, in_w * sizeof(uint8_t));
+            x += in_w;
         }
         for (; x < out_w; x++)
         {
@@ -0,0 +1,197 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+#include "sys_port.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "tengine_ir.h"
+#include "../../cpu_node_ops.h"
+#include "tengine_op.h"
+#include "thread_pool.h"
+#include "pooling_param.h"
+
+/* the pooling of the nchw8 tensors, which only the blocked_layout pass makes. the windows and the average
+   are those of the reference kernel, for the 8 channels of a block at once */
+
+#if __AVX__
+#include <immintrin.h>
+
+#define PACK 8
+
+struct pooling_pack8_arg
+{
+    struct ir_tensor* input_tensor;
+    struct ir_tensor* output_tensor;
+    struct pool_param* param;
+};
+
+/* one output row of one block */
+static void pooling_pack8_row(void* arg, int i)
+{
+    const struct pooling_pack8_arg* a = ( const struct pooling_pack8_arg* )arg;
+    struct ir_tensor* input_tensor = a->input_tensor;
+    struct ir_tensor* output_tensor = a->output_tensor;
+    struct pool_param* param = a->param;
+    int in_h = input_tensor->dims[2];
+    int in_w = input_tensor->dims[3];
+    int out_h = output_tensor->dims[2];
+    int out_w = output_tensor->dims[3];
+    int stride_h = param->stride_h;
+    int stride_w = param->stride_w;
+    int pad_h = param->pad_h0;
+    int pad_w = param->pad_w0;
+    int kernel_h = param->kernel_h;
+    int kernel_w = param->kernel_w;
+    int caffe_flavor = param->caffe_flavor;
+    int method = param->pool_method;
+
+    int b = i / out_h;
+    int ph = i % out_h;
+    const float* input = ( const float* )input_tensor->data + b * in_h * in_w * PACK;
+    float* output = ( float* )output_tensor->data + (b * out_h + ph) * out_w * PACK;
+
+    for (int pw = 0; pw < out_w; pw++)
+    {
+        int pool_size = 1;
+        int h_start = ph * stride_h - pad_h;
+        int h_end = h_start + kernel_h;
+        if (h_end > in_h + pad_h)
+            h_end = in_h + pad_h;
+        int w_start = pw * stride_w - pad_w;
+        int w_end = w_start + kernel_w;
+        if (w_end > in_w + pad_w)
+            w_end = in_w + pad_w;
+
+        if (caffe_flavor)
+            pool_size = (h_end - h_start) * (w_end - w_start);
+
+        h_start = h_start > 0 ? h_start : 0;
+        w_start = w_start > 0 ? w_start : 0;
+        h_end = h_end < in_h ? h_end : in_h;
+        w_end = w_end < in_w ? w_end : in_w;
+
+        if (!caffe_flavor)
+            pool_size = (h_end - h_start) * (w_end - w_start);
+
+        __m256 result;
+
+        if (method == POOL_MAX)
+        {
+            result = _mm256_loadu_ps(input + (h_start * in_w + w_start) * PACK);
+
+            for (int y = h_start; y < h_end; y++)
+            {
+                for (int x = w_start; x < w_end; x++)
+                    result = _mm256_max_ps(result, _mm256_loadu_ps(input + (y * in_w + x) * PACK));
+            }
+        }
+        else
+        {
+            result = _mm256_setzero_ps();
+
+            for (int y = h_start; y < h_end; y++)
+            {
+                for (int x = w_start; x < w_end; x++)
+                    result = _mm256_add_ps(result, _mm256_loadu_ps(input + (y * in_w + x) * PACK));
+            }
+
+            result = _mm256_div_ps(result, _mm256_set1_ps(( float )pool_size));
+        }
+
+        _mm256_storeu_ps(output + pw * PACK, result);
+    }
+}
+
+static void pooling_pack8_run(struct ir_tensor* input_tensor, struct ir_tensor* output_tensor,
+                              struct pool_param* param, struct thread_pool* thread_pool)
+{
+    struct pooling_pack8_arg arg = {input_tensor, output_tensor, param};
+    int block_num = input_tensor->dims[0] * input_tensor->dims[1] / PACK;
+
+    thread_pool_parallel_for(thread_pool, block_num * output_tensor->dims[2], pooling_pack8_row, &arg);
+}
+#endif
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+#if __AVX__
+    struct ir_node* ir_node = exec_node->ir_node;
+    struct ir_graph* ir_graph = ir_node->graph;
+    struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct ir_tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+    struct pool_param* pool_param = ( struct pool_param* )ir_node->op.param_mem;
+
+    pooling_pack8_run(input_tensor, output_tensor, pool_param, exec_graph->thread_pool);
+
+    return 0;
+#else
+    set_tengine_errno(ENOTSUP);
+    return -1;
+#endif
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct ir_node* exec_node)
+{
+    struct ir_node* ir_node = exec_node;
+    struct ir_graph* ir_graph = ir_node->graph;
+    struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+
+    /* no other kernel reads it */
+    if (input_tensor->layout == TENGINE_LAYOUT_NCHW8)
+        return OPS_SCORE_STATIC;
+
+    return 0;
+}
+
+static struct node_ops hcl_node_ops = {.prerun = NULL,
+                                       .run = run,
+                                       .reshape = NULL,
+                                       .postrun = NULL,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score};
+
+static int reg_pooling_pack8_ops(void* arg)
+{
+    return register_builtin_node_ops(OP_POOL, &hcl_node_ops);
+}
+
+static int unreg_pooling_pack8_ops(void* arg)
+{
+    return unregister_builtin_node_ops(OP_POOL, &hcl_node_ops);
+}
+
+AUTO_REGISTER_OPS(reg_pooling_pack8_ops);
+AUTO_UNREGISTER_OPS(unreg_pooling_pack8_ops);
@@ -63,7 +63,7 @@ static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct ex
     input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
     output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
 
-    pooling_kernel_perf_run(input_tensor, output_tensor, pool_param, exec_graph->num_thread);
+    pooling_kernel_perf_run(input_tensor, output_tensor, pool_param, exec_graph->thread_pool);
 
     return 0;
 }
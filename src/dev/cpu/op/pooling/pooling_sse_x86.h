@@ -2,6 +2,7 @@
 #include <stdio.h>
 #include <assert.h>
 #include "pooling_param.h"
+#include "thread_pool.h"
 
 #define POOL_GENERIC 0
 #define POOL_K2S2 1
@@ -1784,38 +1785,41 @@ int pooling_kernel_perf_prerun(struct ir_tensor* input, struct ir_tensor* out, s
     return -1;
 }
 
-int pooling_kernel_perf_run(struct ir_tensor* input, struct ir_tensor* output, struct pool_param* param, int num_thread)
+struct pooling_perf_arg
 {
-    // fprintf(stderr, "perf pooling_kernel_run\n");
-    int is_caffe = param->caffe_flavor;
+    struct ir_tensor* input;
+    struct ir_tensor* output;
+    struct pool_param* param;
+};
+
+/* one channel of one frame */
+static void pooling_perf_channel(void* arg, int idx)
+{
+    const struct pooling_perf_arg* a = ( const struct pooling_perf_arg* )arg;
+    struct ir_tensor* input = a->input;
+    struct ir_tensor* output = a->output;
+    struct pool_param* param = a->param;
     pooling_kernel_t kernel = (pooling_kernel_t)(param->funct);
 
-    int batch = input->dims[0];
-    int c = input->dims[1];
     int in_h = input->dims[2];
     int in_w = input->dims[3];
-
     int out_h = output->dims[2];
     int out_w = output->dims[3];
 
-    int img_size = c * in_h * in_w;
-    int feature_size = c * out_h * out_w;
+    void* cur_input = input->data + idx * in_h * in_w * input->elem_size;
+    void* cur_output = output->data + idx * out_h * out_w * output->elem_size;
+    kernel(cur_input, cur_output, 1, in_h, in_w, out_h, out_w, param->kernel_h, param->kernel_w,
+           param->stride_h, param->stride_w, param->pad_h0, param->pad_w0, param->pad_h1, param->pad_w1,
+           param->caffe_flavor);
+}
 
-    for (int n = 0; n < batch; n++)
-    {
-        void* input_frame = input->data + n * img_size * input->elem_size;
-        void* output_frame = output->data + n * feature_size * output->elem_size;
+int pooling_kernel_perf_run(struct ir_tensor* input, struct ir_tensor* output, struct pool_param* param,
+                            struct thread_pool* thread_pool)
+{
+    struct pooling_perf_arg arg = {input, output, param};
 
-#pragma omp parallel for num_threads(num_thread)
-        for (int ch = 0; ch < c; ch++)
-        {
-            void* cur_input = input_frame + ch * in_h * in_w * input->elem_size;
-            void* cur_output = output_frame + ch * out_h * out_w * output->elem_size;
-            kernel(cur_input, cur_output, 1, in_h, in_w, out_h, out_w, param->kernel_h, param->kernel_w,
-                   param->stride_h, param->stride_w, param->pad_h0, param->pad_w0, param->pad_h1, param->pad_w1,
-                   is_caffe);
-        }
-    }
+    /* the frames are contiguous, so are their channels */
+    thread_pool_parallel_for(thread_pool, input->dims[0] * input->dims[1], pooling_perf_channel, &arg);
 
     return 0;
-}
\ No newline at end of file
+}
@@ -0,0 +1,141 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+#include <string.h>
+
+#include "sys_port.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "tengine_ir.h"
+#include "../../cpu_node_ops.h"
+#include "tengine_op.h"
+#include "reorder_param.h"
+
+#define PACK 8
+
+/* nchw <-> nchw8, the channels are a multiple of 8 */
+static void ref_reorder_fp32(const float* input, float* output, int batch, int channel, int size, int to_blocked,
+                             int num_thread)
+{
+    int block_num = batch * channel / PACK;
+
+#pragma omp parallel for num_threads(num_thread)
+    for (int b = 0; b < block_num; b++)
+    {
+        const float* in = input + b * PACK * size;
+        float* out = output + b * PACK * size;
+
+        for (int i = 0; i < size; i++)
+        {
+            for (int k = 0; k < PACK; k++)
+            {
+                if (to_blocked)
+                    out[i * PACK + k] = in[k * size + i];
+                else
+                    out[k * size + i] = in[i * PACK + k];
+            }
+        }
+    }
+}
+
+static int init_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int release_node(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    return 0;
+}
+
+static int run(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct ir_node* ir_node = exec_node->ir_node;
+    struct ir_graph* ir_graph = ir_node->graph;
+    struct ir_tensor* input_tensor = get_ir_graph_tensor(ir_graph, ir_node->input_tensors[0]);
+    struct ir_tensor* output_tensor = get_ir_graph_tensor(ir_graph, ir_node->output_tensors[0]);
+
+    if (input_tensor->layout == output_tensor->layout)
+    {
+        if (output_tensor->data != input_tensor->data)
+            memcpy(output_tensor->data, input_tensor->data, input_tensor->elem_num * input_tensor->elem_size);
+
+        return 0;
+    }
+
+    int batch = input_tensor->dims[0];
+    int channel = input_tensor->dims[1];
+    int size = input_tensor->elem_num / (batch * channel);
+
+    if (input_tensor->data_type != TENGINE_DT_FP32 || channel % PACK != 0 ||
+        (input_tensor->layout != TENGINE_LAYOUT_NCHW8 && output_tensor->layout != TENGINE_LAYOUT_NCHW8))
+    {
+        TLOG_ERR("reorder: layout %d to %d not supported\n", input_tensor->layout, output_tensor->layout);
+        set_tengine_errno(ENOTSUP);
+        return -1;
+    }
+
+    ref_reorder_fp32(input_tensor->data, output_tensor->data, batch, channel, size,
+                     output_tensor->layout == TENGINE_LAYOUT_NCHW8, exec_graph->num_thread);
+
+    return 0;
+}
+
+static int reshape(struct node_ops* node_ops, struct exec_node* exec_node, struct exec_graph* exec_graph)
+{
+    struct ir_node* node = exec_node->ir_node;
+    struct ir_graph* ir_graph = node->graph;
+    struct ir_tensor* input = get_ir_graph_tensor(ir_graph, node->input_tensors[0]);
+    struct ir_tensor* output = get_ir_graph_tensor(ir_graph, node->output_tensors[0]);
+
+    int ret = set_ir_tensor_shape(output, input->dims, input->dim_num);
+    return ret;
+}
+
+static int score(struct node_ops* node_ops, struct exec_graph* exec_graph, struct ir_node* exec_node)
+{
+    return OPS_SCORE_CANDO;
+}
+
+static struct node_ops ref_node_ops = {.prerun = NULL,
+                                       .run = run,
+                                       .reshape = reshape,
+                                       .postrun = NULL,
+                                       .init_node = init_node,
+                                       .release_node = release_node,
+                                       .score = score};
+
+static int reg_reorder_ref_ops(void* arg)
+{
+    return register_builtin_node_ops(OP_REORDER, &ref_node_ops);
+}
+
+static int unreg_reorder_ref_ops(void* arg)
+{
+    return unregister_builtin_node_ops(OP_REORDER, &ref_node_ops);
+}
+
+AUTO_REGISTER_OPS(reg_reorder_ref_ops);
+AUTO_UNREGISTER_OPS(unreg_reorder_ref_ops);
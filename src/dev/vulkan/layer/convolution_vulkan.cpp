@@ -97,7 +97,7 @@ Convolution_vulkan::Convolution_vulkan(ir_graph* ir_graph, ir_node* ir_node)
     dilation_h = param->dilation_h;
     kernel_w = param->kernel_w;
     kernel_h = param->kernel_h;
-    activation = param->activation == 0 ? 1 : -1;
+    activation = param->activation == 0 ? 1 : (param->activation > 0 ? 3 : -1);    /* relu, or clip for relu6 */
     output_c = output->dims[1];  // param->output_channel;
     output_h = output->dims[2];
     output_w = output->dims[3];
@@ -244,8 +244,8 @@ int Convolution_vulkan::create_pipeline(const Option& _opt)
     specializations[5].i = stride_h;	// stride_h;
     specializations[6].i = node->input_num>2 ? 1 : 0; // bias_term;
     specializations[7].i = activation;	// activation_type;
-    specializations[8].f = 0;//param->activation;	// activation_params.w >= 1 ? activation_params[0] : 0.f;
-    specializations[9].f = 0;//param->activation; 	// activation_params.w == 2 ? activation_params[1] : 0.f;
+    specializations[8].f = 0;	// activation_params.w >= 1 ? activation_params[0] : 0.f;
+    specializations[9].f = activation == 3 ? (float)((struct conv_param*)node->op.param_mem)->activation : 0.f;	// activation_params.w == 2 ? activation_params[1] : 0.f;
     specializations[10 + 0].i = 0;//3;	// shape_bordered_packed.dims;
     specializations[10 + 1].i = 0;//input_w + pad_w0 + pad_w1;	// shape_bordered_packed.w;
     specializations[10 + 2].i = 0;//input_h + pad_h0 + pad_h1;	// shape_bordered_packed.h;
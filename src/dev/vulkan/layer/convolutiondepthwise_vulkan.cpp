@@ -149,9 +149,10 @@ int ConvolutionDepthWise_vulkan::create_pipeline(const Option& _opt)
     specializations[5].i = stride_h;	// stride_h;
     specializations[6].i = node->input_num >2 ? 1 : 0; // bias_term;
     specializations[7].i = group;
-    specializations[8].i = 1;//param->activation;	// activation_type;
-    specializations[9].f = 0;//param->activation;	// activation_params.w >= 1 ? activation_params[0] : 0.f;
-    specializations[10].f = 0;//param->activation; 	// activation_params.w == 2 ? activation_params[1] : 0.f;
+    int act = ((struct conv_param*)node->op.param_mem)->activation;
+    specializations[8].i = act == 0 ? 1 : (act > 0 ? 3 : -1);	// activation_type;
+    specializations[9].f = 0;	// activation_params.w >= 1 ? activation_params[0] : 0.f;
+    specializations[10].f = act > 0 ? (float)act : 0.f;	// activation_params.w == 2 ? activation_params[1] : 0.f;
     specializations[11 + 0].i = 0;  // 3;	// shape_bordered_packed.dims;
     specializations[11 + 1].i = 0;  // input_w + pad_w0 + pad_w1;	// shape_bordered_packed.w;
     specializations[11 + 2].i = 0;  // input_h + pad_h0 + pad_h1;	// shape_bordered_packed.h;
@@ -101,7 +101,8 @@ InnerProduct_vulkan::InnerProduct_vulkan(ir_graph* ir_graph, ir_node* ir_node)
     struct ir_tensor *weight = get_ir_graph_tensor(graph, ir_node->input_tensors[1]);
     weight_data_size = weight->elem_num;
 
-    activation_type = -1;
+    /* relu, or clip for relu6 */
+    activation_type = param->activation == 0 ? 1 : (param->activation > 0 ? 3 : -1);
 
 }
 
@@ -171,7 +172,7 @@ int InnerProduct_vulkan::create_pipeline(const Option& _opt)
     specializations[0].i = bias_term;
     specializations[1].i = activation_type;
     specializations[2].f = 0.f; // activation_params.w >= 1 ? activation_params[0] : 0.f;
-    specializations[3].f = 0.f; // activation_params.w == 2 ? activation_params[1] : 0.f;
+    specializations[3].f = activation_type == 3 ? (float)((struct fc_param*)node->op.param_mem)->activation : 0.f;
     specializations[4 + 0].i = 0;   // shape_flatten_packed.dims;
     specializations[4 + 1].i = 0;   // shape_flatten_packed.w;
     specializations[4 + 2].i = 0;   // shape_flatten_packed.h;
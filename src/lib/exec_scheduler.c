@@ -28,9 +28,58 @@
 #include "tengine_ir.h"
 #include "tengine_errno.h"
 #include "tengine_log.h"
+#include "tengine_exec.h"
 #include "exec_scheduler.h"
 #include "nn_device.h"
 
+#ifndef CONFIG_BAREMETAL_BUILD
+#include <pthread.h>
+
+/* a graph run with block 0 is queued to its own thread, started with the first of these runs and
+   parked between them. the status of the graph tells the callers when it is done */
+struct async_run
+{
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    int pending; /* a run is queued or running */
+    int result;
+    int stop;
+
+    /* a run is done when its hook of done returns, the hook may queue the next one */
+    unsigned int queued_num;
+    unsigned int done_num;
+    int hook_running;
+};
+#endif
+
+int get_graph_status(struct ir_graph* ir_graph)
+{
+#ifndef CONFIG_BAREMETAL_BUILD
+    return __atomic_load_n(&ir_graph->status, __ATOMIC_ACQUIRE);
+#else
+    return ir_graph->status;
+#endif
+}
+
+void set_graph_status(struct ir_graph* ir_graph, int status)
+{
+#ifndef CONFIG_BAREMETAL_BUILD
+    __atomic_store_n(&ir_graph->status, status, __ATOMIC_RELEASE);
+#else
+    ir_graph->status = status;
+#endif
+}
+
+static void call_event_hook(struct ir_graph* ir_graph, int event)
+{
+    struct exec_attr* exec_attr = ir_graph->exec_attr;
+
+    if (exec_attr->event_hook[event] != NULL)
+        exec_attr->event_hook[event](( graph_t )ir_graph, event, exec_attr->event_arg[event]);
+}
+
 static int sched_prerun(struct exec_scheduler* scheduler, struct ir_graph* ir_graph, int num_thread, int cpu_affinity, int mode)
 {
     int subgraph_num = get_vector_num(ir_graph->subgraph_list);
@@ -54,15 +103,8 @@ static int sched_prerun(struct exec_scheduler* scheduler, struct ir_graph* ir_gr
     return 0;
 }
 
-static int sched_run(struct exec_scheduler* scheduler, struct ir_graph* ir_graph, int block)
+static int run_subgraph_list(struct ir_graph* ir_graph)
 {
-    if (block == 0)
-    {
-        TLOG_DEBUG("sync scheduler does not support non block run\n");
-        set_tengine_errno(ENOTSUP);
-        return -1;
-    }
-
     struct vector* wait_list = create_vector(sizeof(struct subgraph*), NULL);
 
     if (wait_list == NULL)
@@ -175,14 +217,305 @@ static int sched_run(struct exec_scheduler* scheduler, struct ir_graph* ir_graph
     return 0;
 }
 
-static int sched_wait(struct exec_scheduler* scheduler, struct ir_graph* ir_graph)
+static int run_graph_once(struct ir_graph* ir_graph)
 {
+    call_event_hook(ir_graph, GRAPH_EXEC_START);
+
+    return run_subgraph_list(ir_graph);
+}
+
+#ifndef CONFIG_BAREMETAL_BUILD
+
+/* call a hook in the thread of the graph, with the mutex held. the hook is read under the mutex and
+   set_graph_event_hook waits for it to return, so cb_arg may be released once the hook is changed */
+static void call_async_hook(struct ir_graph* ir_graph, struct async_run* async_run, int event)
+{
+    struct exec_attr* exec_attr = ir_graph->exec_attr;
+    event_handler_t hook = exec_attr->event_hook[event];
+    void* hook_arg = exec_attr->event_arg[event];
+
+    if (hook == NULL)
+        return;
+
+    async_run->hook_running = 1;
+    pthread_mutex_unlock(&async_run->mutex);
+
+    hook(( graph_t )ir_graph, event, hook_arg);
+
+    pthread_mutex_lock(&async_run->mutex);
+    async_run->hook_running = 0;
+    pthread_cond_broadcast(&async_run->cond);
+}
+
+static void* async_run_main(void* arg)
+{
+    struct ir_graph* ir_graph = ( struct ir_graph* )arg;
+    struct async_run* async_run = ( struct async_run* )ir_graph->exec_attr->sched_priv;
+
+    pthread_mutex_lock(&async_run->mutex);
+
+    while (1)
+    {
+        while (!async_run->pending && !async_run->stop)
+            pthread_cond_wait(&async_run->cond, &async_run->mutex);
+
+        if (!async_run->pending)
+            break;
+
+        call_async_hook(ir_graph, async_run, GRAPH_EXEC_START);
+
+        pthread_mutex_unlock(&async_run->mutex);
+
+        int ret = run_subgraph_list(ir_graph);
+
+        pthread_mutex_lock(&async_run->mutex);
+
+        /* the graph is ready for the next run before the hook of done is called, so the hook may queue it */
+        set_graph_status(ir_graph, ret < 0 ? GRAPH_STAT_ERROR : GRAPH_STAT_READY);
+
+        async_run->result = ret;
+        async_run->pending = 0;
+
+        call_async_hook(ir_graph, async_run, ret < 0 ? GRAPH_EXEC_ABORT : GRAPH_EXEC_DONE);
+
+        async_run->done_num++;
+        pthread_cond_broadcast(&async_run->cond);
+    }
+
+    pthread_mutex_unlock(&async_run->mutex);
+
+    return NULL;
+}
+
+static struct async_run* get_async_run(struct ir_graph* ir_graph)
+{
+    struct exec_attr* exec_attr = ir_graph->exec_attr;
+
+    if (exec_attr->sched_priv != NULL)
+        return ( struct async_run* )exec_attr->sched_priv;
+
+    struct async_run* async_run = ( struct async_run* )sys_malloc(sizeof(struct async_run));
+
+    if (async_run == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    async_run->pending = 0;
+    async_run->result = 0;
+    async_run->stop = 0;
+    async_run->queued_num = 0;
+    async_run->done_num = 0;
+    async_run->hook_running = 0;
+
+    pthread_mutex_init(&async_run->mutex, NULL);
+    pthread_cond_init(&async_run->cond, NULL);
+
+    exec_attr->sched_priv = async_run;
+
+    /* the thread inherits the cpu affinity set in prerun */
+    if (pthread_create(&async_run->thread, NULL, async_run_main, ir_graph) != 0)
+    {
+        TLOG_ERR("failed to start the thread of async run\n");
+        pthread_mutex_destroy(&async_run->mutex);
+        pthread_cond_destroy(&async_run->cond);
+        sys_free(async_run);
+        exec_attr->sched_priv = NULL;
+        set_tengine_errno(EAGAIN);
+        return NULL;
+    }
+
+    return async_run;
+}
+
+static int queue_async_run(struct ir_graph* ir_graph)
+{
+    struct async_run* async_run = get_async_run(ir_graph);
+
+    if (async_run == NULL)
+        return -1;
+
+    pthread_mutex_lock(&async_run->mutex);
+
+    if (async_run->pending)
+    {
+        pthread_mutex_unlock(&async_run->mutex);
+        set_tengine_errno(EBUSY);
+        return -1;
+    }
+
+    set_graph_status(ir_graph, GRAPH_STAT_RUNNING);
+
+    async_run->pending = 1;
+    async_run->queued_num++;
+
+    pthread_cond_broadcast(&async_run->cond);
+    pthread_mutex_unlock(&async_run->mutex);
+
+    return 0;
+}
+
+static int is_async_thread(struct async_run* async_run)
+{
+    return pthread_equal(pthread_self(), async_run->thread);
+}
+
+/* wait for the runs queued before, and their hooks of done. a hook waiting for its own run gets its result */
+static int sched_wait(struct exec_scheduler* scheduler, struct ir_graph* ir_graph, int try_wait)
+{
+    struct async_run* async_run = ( struct async_run* )ir_graph->exec_attr->sched_priv;
+
+    if (async_run == NULL)
+    {
+        int status = get_graph_status(ir_graph);
+
+        if (status == GRAPH_STAT_RUNNING && try_wait)
+            return 0;
+
+        return status == GRAPH_STAT_ERROR ? -1 : 1;
+    }
+
+    pthread_mutex_lock(&async_run->mutex);
+
+    unsigned int queued_num = async_run->queued_num;
+
+    while (async_run->done_num != queued_num && !is_async_thread(async_run))
+    {
+        if (try_wait)
+        {
+            pthread_mutex_unlock(&async_run->mutex);
+            return 0;
+        }
+
+        pthread_cond_wait(&async_run->cond, &async_run->mutex);
+    }
+
+    int ret = async_run->result < 0 ? -1 : 1;
+
+    pthread_mutex_unlock(&async_run->mutex);
+
+    return ret;
+}
+
+static int sched_set_hook(struct exec_scheduler* scheduler, struct ir_graph* ir_graph, int event,
+                          event_handler_t func, void* arg)
+{
+    struct exec_attr* exec_attr = ir_graph->exec_attr;
+    struct async_run* async_run = ( struct async_run* )exec_attr->sched_priv;
+
+    if (async_run == NULL)
+    {
+        exec_attr->event_hook[event] = func;
+        exec_attr->event_arg[event] = arg;
+        return 0;
+    }
+
+    pthread_mutex_lock(&async_run->mutex);
+
+    /* the hook running may be the one changed, but a hook may change the hooks itself */
+    while (async_run->hook_running && !is_async_thread(async_run))
+        pthread_cond_wait(&async_run->cond, &async_run->mutex);
+
+    exec_attr->event_hook[event] = func;
+    exec_attr->event_arg[event] = arg;
+
+    pthread_mutex_unlock(&async_run->mutex);
+
+    return 0;
+}
+
+/* wait for the run in flight and its hooks, and stop the thread */
+static void sched_release_graph(struct exec_scheduler* scheduler, struct ir_graph* ir_graph)
+{
+    struct async_run* async_run = ( struct async_run* )ir_graph->exec_attr->sched_priv;
+
+    if (async_run == NULL)
+        return;
+
+    /* the thread can not join itself */
+    if (is_async_thread(async_run))
+    {
+        TLOG_ERR("the graph can not be released by its own event hook\n");
+        return;
+    }
+
+    pthread_mutex_lock(&async_run->mutex);
+    async_run->stop = 1;
+    pthread_cond_broadcast(&async_run->cond);
+    pthread_mutex_unlock(&async_run->mutex);
+
+    pthread_join(async_run->thread, NULL);
+
+    pthread_mutex_destroy(&async_run->mutex);
+    pthread_cond_destroy(&async_run->cond);
+
+    sys_free(async_run);
+
+    ir_graph->exec_attr->sched_priv = NULL;
+}
+
+#else
+
+/* no threads on bare metal, only the blocking run */
+
+static int queue_async_run(struct ir_graph* ir_graph)
+{
+    TLOG_DEBUG("sync scheduler does not support non block run\n");
     set_tengine_errno(ENOTSUP);
     return -1;
 }
 
+static int sched_wait(struct exec_scheduler* scheduler, struct ir_graph* ir_graph, int try_wait)
+{
+    return get_graph_status(ir_graph) == GRAPH_STAT_ERROR ? -1 : 1;
+}
+
+static int sched_set_hook(struct exec_scheduler* scheduler, struct ir_graph* ir_graph, int event,
+                          event_handler_t func, void* arg)
+{
+    ir_graph->exec_attr->event_hook[event] = func;
+    ir_graph->exec_attr->event_arg[event] = arg;
+
+    return 0;
+}
+
+static void sched_release_graph(struct exec_scheduler* scheduler, struct ir_graph* ir_graph) {}
+
+#endif
+
+static int sched_run(struct exec_scheduler* scheduler, struct ir_graph* ir_graph, int block)
+{
+    if (block == 0)
+        return queue_async_run(ir_graph);
+
+    set_graph_status(ir_graph, GRAPH_STAT_RUNNING);
+
+    int ret = run_graph_once(ir_graph);
+
+    set_graph_status(ir_graph, ret < 0 ? GRAPH_STAT_ERROR : GRAPH_STAT_READY);
+
+#ifndef CONFIG_BAREMETAL_BUILD
+    /* wait_graph tells the result of the last run */
+    struct async_run* async_run = ( struct async_run* )ir_graph->exec_attr->sched_priv;
+
+    if (async_run != NULL)
+    {
+        pthread_mutex_lock(&async_run->mutex);
+        async_run->result = ret;
+        pthread_mutex_unlock(&async_run->mutex);
+    }
+#endif
+
+    call_event_hook(ir_graph, ret < 0 ? GRAPH_EXEC_ABORT : GRAPH_EXEC_DONE);
+
+    return ret;
+}
+
 static int sched_postrun(struct exec_scheduler* scheduler, struct ir_graph* ir_graph)
 {
+    sched_release_graph(scheduler, ir_graph);
+
     int subgraph_num = get_vector_num(ir_graph->subgraph_list);
     int has_error = 0;
 
@@ -212,8 +545,10 @@ static struct exec_scheduler sync_scheduler = {
     .prerun = sched_prerun,
     .run = sched_run,
     .wait = sched_wait,
+    .set_hook = sched_set_hook,
     .postrun = sched_postrun,
     .release = NULL,
+    .release_graph = sched_release_graph,
 };
 
 struct exec_scheduler* get_default_scheduler(void)
@@ -0,0 +1,667 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+
+#ifndef CONFIG_BAREMETAL_BUILD
+#include <pthread.h>
+
+/* the batches of 1, 2, 4 ... 32 and 64 requests */
+#define BATCHER_SESSION_NUM 8
+
+/* the requests are queued by the callers, and taken by the thread of the batcher in batches. a batch runs
+   on the smallest session holding it, the sessions share the weights of the graph, and only one batch
+   runs at a time, as the requests queued meanwhile make the next batch fuller */
+
+struct batch_request
+{
+    void** input_data;
+    void** output_data;
+    batch_done_t cb_func;
+    void* cb_arg;
+    int64_t queue_time; /* us, when it is queued */
+    int posted; /* allocated by post_batched_request(), freed when done */
+    int done;
+    int ret;
+    struct batch_request* next;
+};
+
+struct batch_session
+{
+    graph_t graph;
+    int prerun; /* to be postrun */
+    int batch; /* the requests it holds */
+    void** input_data; /* the batched inputs, bound to the input tensors */
+    struct ir_tensor** output_tensor;
+};
+
+struct graph_batcher
+{
+    struct ir_graph* graph;
+    int max_batch;
+    int64_t max_delay; /* us */
+
+    int input_num;
+    int output_num;
+    int* input_size; /* bytes of one request */
+    int* output_size;
+
+    int session_num;
+    struct batch_session session[BATCHER_SESSION_NUM];
+
+    pthread_t thread;
+    pthread_mutex_t mutex;
+    pthread_cond_t cond; /* the thread waits for the requests */
+    pthread_cond_t done_cond; /* run_batched_request() waits for its request */
+
+    struct batch_request* queue_head;
+    struct batch_request* queue_tail;
+    int queue_num;
+    int stop;
+
+    struct batch_request* batch[BATCHER_MAX_BATCH]; /* the requests of the running batch */
+    struct batcher_stat stat;
+};
+
+static int64_t get_cur_time_us(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return ( int64_t )tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/* the tensors of the input or the output nodes, by node then tensor */
+static int get_io_tensor(struct ir_graph* graph, int is_output, struct ir_tensor** tensors)
+{
+    int node_num = is_output ? graph->output_num : graph->input_num;
+    int16_t* nodes = is_output ? graph->output_nodes : graph->input_nodes;
+    int tensor_num = 0;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, nodes[i]);
+
+        for (int j = 0; j < node->output_num; j++)
+        {
+            if (tensors != NULL)
+                tensors[tensor_num] = get_ir_graph_tensor(graph, node->output_tensors[j]);
+
+            tensor_num++;
+        }
+    }
+
+    return tensor_num;
+}
+
+static int get_tensor_size(struct ir_tensor* tensor)
+{
+    return tensor->elem_num * tensor->elem_size;
+}
+
+static void release_batch_session(struct graph_batcher* batcher, struct batch_session* session)
+{
+    if (session->graph != NULL)
+    {
+        if (session->prerun)
+            postrun_graph(session->graph);
+
+        destroy_graph(session->graph);
+    }
+
+    if (session->input_data != NULL)
+    {
+        for (int i = 0; i < batcher->input_num; i++)
+            sys_free(session->input_data[i]);
+    }
+
+    sys_free(session->input_data);
+    sys_free(session->output_tensor);
+}
+
+static int init_batch_session(struct graph_batcher* batcher, struct batch_session* session, int batch,
+                              struct options* opt)
+{
+    int input_num = batcher->input_num;
+
+    session->batch = batch;
+    session->graph = create_graph_session(batcher->graph);
+    session->input_data = ( void** )sys_malloc(sizeof(void*) * input_num);
+    session->output_tensor = ( struct ir_tensor** )sys_malloc(sizeof(struct ir_tensor*) * batcher->output_num);
+
+    if (session->graph == NULL || session->input_data == NULL || session->output_tensor == NULL)
+        return -1;
+
+    memset(session->input_data, 0, sizeof(void*) * input_num);
+
+    struct ir_graph* graph = ( struct ir_graph* )session->graph;
+    struct ir_tensor** inputs = ( struct ir_tensor** )sys_malloc(sizeof(struct ir_tensor*) * input_num);
+
+    if (inputs == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    get_io_tensor(graph, 0, inputs);
+
+    for (int i = 0; i < input_num; i++)
+    {
+        int dims[MAX_SHAPE_DIM_NUM];
+
+        memcpy(dims, inputs[i]->dims, sizeof(int) * inputs[i]->dim_num);
+        dims[0] *= batch;
+
+        if (set_tensor_shape(inputs[i], dims, inputs[i]->dim_num) < 0)
+        {
+            sys_free(inputs);
+            return -1;
+        }
+    }
+
+    if (prerun_graph_multithread(session->graph, *opt) < 0)
+    {
+        sys_free(inputs);
+        return -1;
+    }
+
+    session->prerun = 1;
+
+    for (int i = 0; i < input_num; i++)
+    {
+        int size = get_tensor_size(inputs[i]);
+
+        if (size != batch * batcher->input_size[i])
+        {
+            TLOG_ERR("batcher: input %s of batch %d takes %d bytes, not %d\n", inputs[i]->name, batch, size,
+                     batch * batcher->input_size[i]);
+            sys_free(inputs);
+            set_tengine_errno(ENOTSUP);
+            return -1;
+        }
+
+        /* the slots no request fills run zeros or an earlier batch */
+        session->input_data[i] = sys_malloc(size);
+
+        if (session->input_data[i] == NULL)
+        {
+            sys_free(inputs);
+            set_tengine_errno(ENOMEM);
+            return -1;
+        }
+
+        memset(session->input_data[i], 0, size);
+        set_tensor_buffer(inputs[i], session->input_data[i], size);
+    }
+
+    sys_free(inputs);
+
+    struct ir_tensor** outputs = session->output_tensor;
+
+    get_io_tensor(graph, 1, outputs);
+
+    for (int i = 0; i < batcher->output_num; i++)
+    {
+        int size = get_tensor_size(outputs[i]);
+
+        if (size != batch * batcher->output_size[i])
+        {
+            TLOG_ERR("batcher: output %s of batch %d takes %d bytes, not %d\n", outputs[i]->name, batch, size,
+                     batch * batcher->output_size[i]);
+            set_tengine_errno(ENOTSUP);
+            return -1;
+        }
+    }
+
+    return 0;
+}
+
+static void run_batch(struct graph_batcher* batcher, int num)
+{
+    struct batch_request** batch = batcher->batch;
+    struct batch_session* session = &batcher->session[0];
+    int64_t start = get_cur_time_us();
+
+    for (int i = 0; i < batcher->session_num; i++)
+    {
+        session = &batcher->session[i];
+
+        if (session->batch >= num)
+            break;
+    }
+
+    for (int i = 0; i < batcher->input_num; i++)
+    {
+        int size = batcher->input_size[i];
+
+        for (int j = 0; j < num; j++)
+            memcpy(( char* )session->input_data[i] + size * j, batch[j]->input_data[i], size);
+    }
+
+    int ret = run_graph(session->graph, 1);
+
+    if (ret == 0)
+    {
+        for (int i = 0; i < batcher->output_num; i++)
+        {
+            int size = batcher->output_size[i];
+            char* data = ( char* )session->output_tensor[i]->data;
+
+            for (int j = 0; j < num; j++)
+                memcpy(batch[j]->output_data[i], data + size * j, size);
+        }
+    }
+
+    int64_t end = get_cur_time_us();
+    struct batcher_stat* stat = &batcher->stat;
+
+    pthread_mutex_lock(&batcher->mutex);
+
+    stat->request_num += num;
+    stat->batch_num++;
+    stat->batch_size_hist[num - 1]++;
+    stat->run_time += end - start;
+
+    if (ret < 0)
+        stat->fail_num += num;
+
+    for (int i = 0; i < num; i++)
+    {
+        int64_t wait = start - batch[i]->queue_time;
+        int bucket = 0;
+
+        while (bucket < BATCHER_TIME_BUCKET_NUM - 1 && wait >= (( int64_t )2 << bucket))
+            bucket++;
+
+        stat->queue_time_hist[bucket]++;
+        stat->queue_time += wait;
+    }
+
+    /* the waiting callers own their requests, which are gone once done is seen */
+    int posted_num = 0;
+
+    for (int i = 0; i < num; i++)
+    {
+        if (batch[i]->posted)
+            batch[posted_num++] = batch[i];
+        else
+        {
+            batch[i]->ret = ret;
+            batch[i]->done = 1;
+        }
+    }
+
+    pthread_cond_broadcast(&batcher->done_cond);
+    pthread_mutex_unlock(&batcher->mutex);
+
+    for (int i = 0; i < posted_num; i++)
+    {
+        if (batch[i]->cb_func != NULL)
+            batch[i]->cb_func(( batcher_t )batcher, ret, batch[i]->cb_arg);
+
+        sys_free(batch[i]);
+    }
+}
+
+static void* batcher_main(void* arg)
+{
+    struct graph_batcher* batcher = ( struct graph_batcher* )arg;
+
+    pthread_mutex_lock(&batcher->mutex);
+
+    while (1)
+    {
+        while (batcher->queue_num == 0 && !batcher->stop)
+            pthread_cond_wait(&batcher->cond, &batcher->mutex);
+
+        /* the requests queued are run before stopping */
+        if (batcher->queue_num == 0)
+            break;
+
+        while (batcher->queue_num < batcher->max_batch && !batcher->stop)
+        {
+            int64_t deadline = batcher->queue_head->queue_time + batcher->max_delay;
+
+            if (get_cur_time_us() >= deadline)
+                break;
+
+            struct timespec ts;
+
+            ts.tv_sec = deadline / 1000000;
+            ts.tv_nsec = (deadline % 1000000) * 1000;
+
+            pthread_cond_timedwait(&batcher->cond, &batcher->mutex, &ts);
+        }
+
+        int num = batcher->queue_num < batcher->max_batch ? batcher->queue_num : batcher->max_batch;
+
+        for (int i = 0; i < num; i++)
+        {
+            batcher->batch[i] = batcher->queue_head;
+            batcher->queue_head = batcher->queue_head->next;
+        }
+
+        if (batcher->queue_head == NULL)
+            batcher->queue_tail = NULL;
+
+        batcher->queue_num -= num;
+
+        pthread_mutex_unlock(&batcher->mutex);
+
+        run_batch(batcher, num);
+
+        pthread_mutex_lock(&batcher->mutex);
+    }
+
+    pthread_mutex_unlock(&batcher->mutex);
+
+    return NULL;
+}
+
+static int queue_request(struct graph_batcher* batcher, struct batch_request* request)
+{
+    request->queue_time = get_cur_time_us();
+    request->done = 0;
+    request->ret = 0;
+    request->next = NULL;
+
+    pthread_mutex_lock(&batcher->mutex);
+
+    if (batcher->stop)
+    {
+        pthread_mutex_unlock(&batcher->mutex);
+        set_tengine_errno(EINVAL);
+        return -1;
+    }
+
+    if (batcher->queue_tail != NULL)
+        batcher->queue_tail->next = request;
+    else
+        batcher->queue_head = request;
+
+    batcher->queue_tail = request;
+    batcher->queue_num++;
+
+    /* the thread waits for the first request, or for a full batch */
+    if (batcher->queue_num == 1 || batcher->queue_num == batcher->max_batch)
+        pthread_cond_signal(&batcher->cond);
+
+    pthread_mutex_unlock(&batcher->mutex);
+
+    return 0;
+}
+
+static void free_batcher(struct graph_batcher* batcher)
+{
+    for (int i = 0; i < batcher->session_num; i++)
+        release_batch_session(batcher, &batcher->session[i]);
+
+    sys_free(batcher->input_size);
+    sys_free(batcher->output_size);
+    sys_free(batcher);
+}
+
+batcher_t DLLEXPORT create_graph_batcher(graph_t graph, int max_batch, int max_delay_us, struct options* opt)
+{
+    struct ir_graph* ir_graph = ( struct ir_graph* )graph;
+    struct options def_opt;
+
+    if (max_batch < 1 || max_batch > BATCHER_MAX_BATCH || max_delay_us < 0)
+    {
+        set_tengine_errno(EINVAL);
+        return NULL;
+    }
+
+    if (opt == NULL)
+    {
+        def_opt.num_thread = 1;
+        def_opt.cluster = TENGINE_CLUSTER_BIG;
+        def_opt.precision = TENGINE_MODE_FP32;
+        opt = &def_opt;
+    }
+
+    struct graph_batcher* batcher = ( struct graph_batcher* )sys_malloc(sizeof(struct graph_batcher));
+
+    if (batcher == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    memset(batcher, 0, sizeof(struct graph_batcher));
+
+    batcher->graph = ir_graph;
+    batcher->max_batch = max_batch;
+    batcher->max_delay = max_delay_us;
+    batcher->input_num = get_io_tensor(ir_graph, 0, NULL);
+    batcher->output_num = get_io_tensor(ir_graph, 1, NULL);
+    batcher->input_size = ( int* )sys_malloc(sizeof(int) * batcher->input_num);
+    batcher->output_size = ( int* )sys_malloc(sizeof(int) * batcher->output_num);
+
+    struct ir_tensor** tensors =
+        ( struct ir_tensor** )sys_malloc(sizeof(struct ir_tensor*) * (batcher->input_num + batcher->output_num));
+
+    if (batcher->input_size == NULL || batcher->output_size == NULL || tensors == NULL)
+    {
+        sys_free(tensors);
+        free_batcher(batcher);
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    get_io_tensor(ir_graph, 0, tensors);
+    get_io_tensor(ir_graph, 1, tensors + batcher->input_num);
+
+    for (int i = 0; i < batcher->input_num; i++)
+        batcher->input_size[i] = get_tensor_size(tensors[i]);
+
+    for (int i = 0; i < batcher->output_num; i++)
+        batcher->output_size[i] = get_tensor_size(tensors[batcher->input_num + i]);
+
+    /* e.g. the detections, whose number is known by the run */
+    for (int i = 0; i < batcher->output_num; i++)
+    {
+        if (batcher->output_size[i] == 0)
+        {
+            TLOG_ERR("batcher: output %s is sized by the run\n", tensors[batcher->input_num + i]->name);
+            sys_free(tensors);
+            free_batcher(batcher);
+            set_tengine_errno(ENOTSUP);
+            return NULL;
+        }
+    }
+
+    sys_free(tensors);
+
+    for (int batch = 1;; batch *= 2)
+    {
+        if (batch > max_batch)
+            batch = max_batch;
+
+        struct batch_session* session = &batcher->session[batcher->session_num++];
+
+        if (init_batch_session(batcher, session, batch, opt) < 0)
+        {
+            TLOG_ERR("batcher: failed to prerun the session of batch %d\n", batch);
+            free_batcher(batcher);
+            return NULL;
+        }
+
+        if (batch == max_batch)
+            break;
+    }
+
+    pthread_mutex_init(&batcher->mutex, NULL);
+    pthread_cond_init(&batcher->cond, NULL);
+    pthread_cond_init(&batcher->done_cond, NULL);
+
+    if (pthread_create(&batcher->thread, NULL, batcher_main, batcher) != 0)
+    {
+        TLOG_ERR("failed to start the thread of batcher\n");
+        pthread_mutex_destroy(&batcher->mutex);
+        pthread_cond_destroy(&batcher->cond);
+        pthread_cond_destroy(&batcher->done_cond);
+        free_batcher(batcher);
+        set_tengine_errno(EAGAIN);
+        return NULL;
+    }
+
+    return batcher;
+}
+
+int DLLEXPORT destroy_graph_batcher(batcher_t batcher)
+{
+    struct graph_batcher* graph_batcher = ( struct graph_batcher* )batcher;
+
+    pthread_mutex_lock(&graph_batcher->mutex);
+    graph_batcher->stop = 1;
+    pthread_cond_signal(&graph_batcher->cond);
+    pthread_mutex_unlock(&graph_batcher->mutex);
+
+    pthread_join(graph_batcher->thread, NULL);
+
+    pthread_mutex_destroy(&graph_batcher->mutex);
+    pthread_cond_destroy(&graph_batcher->cond);
+    pthread_cond_destroy(&graph_batcher->done_cond);
+
+    free_batcher(graph_batcher);
+
+    return 0;
+}
+
+int DLLEXPORT run_batched_request(batcher_t batcher, void* input_data[], void* output_data[])
+{
+    struct graph_batcher* graph_batcher = ( struct graph_batcher* )batcher;
+    struct batch_request request;
+
+    request.input_data = input_data;
+    request.output_data = output_data;
+    request.cb_func = NULL;
+    request.cb_arg = NULL;
+    request.posted = 0;
+
+    if (queue_request(graph_batcher, &request) < 0)
+        return -1;
+
+    pthread_mutex_lock(&graph_batcher->mutex);
+
+    while (!request.done)
+        pthread_cond_wait(&graph_batcher->done_cond, &graph_batcher->mutex);
+
+    pthread_mutex_unlock(&graph_batcher->mutex);
+
+    return request.ret;
+}
+
+int DLLEXPORT post_batched_request(batcher_t batcher, void* input_data[], void* output_data[], batch_done_t cb_func,
+                                   void* cb_arg)
+{
+    struct graph_batcher* graph_batcher = ( struct graph_batcher* )batcher;
+    int data_num = graph_batcher->input_num + graph_batcher->output_num;
+
+    /* the pointer arrays of the caller are copied with the request */
+    struct batch_request* request =
+        ( struct batch_request* )sys_malloc(sizeof(struct batch_request) + sizeof(void*) * data_num);
+
+    if (request == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    request->input_data = ( void** )(request + 1);
+    request->output_data = request->input_data + graph_batcher->input_num;
+    request->cb_func = cb_func;
+    request->cb_arg = cb_arg;
+    request->posted = 1;
+
+    memcpy(request->input_data, input_data, sizeof(void*) * graph_batcher->input_num);
+    memcpy(request->output_data, output_data, sizeof(void*) * graph_batcher->output_num);
+
+    if (queue_request(graph_batcher, request) < 0)
+    {
+        sys_free(request);
+        return -1;
+    }
+
+    return 0;
+}
+
+int DLLEXPORT get_graph_batcher_stat(batcher_t batcher, struct batcher_stat* stat)
+{
+    struct graph_batcher* graph_batcher = ( struct graph_batcher* )batcher;
+
+    pthread_mutex_lock(&graph_batcher->mutex);
+    memcpy(stat, &graph_batcher->stat, sizeof(struct batcher_stat));
+    pthread_mutex_unlock(&graph_batcher->mutex);
+
+    return 0;
+}
+
+#else
+
+/* no threads on bare metal to batch the requests */
+
+batcher_t DLLEXPORT create_graph_batcher(graph_t graph, int max_batch, int max_delay_us, struct options* opt)
+{
+    set_tengine_errno(ENOTSUP);
+    return NULL;
+}
+
+int DLLEXPORT destroy_graph_batcher(batcher_t batcher)
+{
+    set_tengine_errno(ENOTSUP);
+    return -1;
+}
+
+int DLLEXPORT run_batched_request(batcher_t batcher, void* input_data[], void* output_data[])
+{
+    set_tengine_errno(ENOTSUP);
+    return -1;
+}
+
+int DLLEXPORT post_batched_request(batcher_t batcher, void* input_data[], void* output_data[], batch_done_t cb_func,
+                                   void* cb_arg)
+{
+    set_tengine_errno(ENOTSUP);
+    return -1;
+}
+
+int DLLEXPORT get_graph_batcher_stat(batcher_t batcher, struct batcher_stat* stat)
+{
+    set_tengine_errno(ENOTSUP);
+    return -1;
+}
+
+#endif
@@ -0,0 +1,1101 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/time.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_op.h"
+#include "vector.h"
+#include "lock.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "graph_pass.h"
+
+struct graph_pass_entry
+{
+    const char* name;
+    int level;
+    int priority;
+    int enabled;
+    graph_pass_t pass;
+};
+
+static struct vector* pass_list;
+static lock_t pass_lock;
+
+static int64_t get_cur_time_us(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return ( int64_t )tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+/* the graph before a pass, to restore it if the pass fails, even after the commit. the ops replaced and
+   the data made private by the pass are kept in the retired lists, and the nodes and the tensors removed
+   by the commit in the dropped lists, they are released when the pass succeeds */
+struct graph_checkpoint
+{
+    int node_num;
+    int tensor_num;
+    int16_t* input_nodes;
+    int16_t* output_nodes;
+    struct ir_node** node_list; /* in the order before the pass */
+    struct ir_tensor** tensor_list;
+    struct ir_node* nodes; /* the tensor lists of a node are copies */
+    struct ir_tensor* tensors;
+    void** params; /* the copies of the op params */
+    struct vector* retired_op; /* struct ir_op */
+    struct vector* retired_data; /* void* */
+
+    /* set when the pass returns */
+    int created_node_num;
+    int created_tensor_num;
+    struct ir_node** created_node;
+    struct ir_tensor** created_tensor;
+    int dropped_node_num;
+    int dropped_tensor_num;
+    struct ir_node** dropped_node;
+    struct ir_tensor** dropped_tensor;
+};
+
+static void release_op(struct ir_op* op)
+{
+    struct op_method* m = find_op_method(op->op_type, op->op_version);
+
+    if (m && m->release_op)
+        m->release_op(op);
+}
+
+static int16_t* copy_index_list(const int16_t* list, int num)
+{
+    if (num == 0)
+        return NULL;
+
+    int16_t* copy = ( int16_t* )sys_malloc(sizeof(int16_t) * num);
+
+    if (copy != NULL)
+        memcpy(copy, list, sizeof(int16_t) * num);
+
+    return copy;
+}
+
+/* release what the graph did not take back */
+static void release_graph_checkpoint(struct ir_graph* graph, struct graph_checkpoint* cp)
+{
+    if (cp->nodes != NULL)
+    {
+        for (int i = 0; i < cp->node_num; i++)
+        {
+            sys_free(cp->nodes[i].input_tensors);
+            sys_free(cp->nodes[i].output_tensors);
+        }
+    }
+
+    if (cp->params != NULL)
+    {
+        for (int i = 0; i < cp->node_num; i++)
+            sys_free(cp->params[i]);
+    }
+
+    if (cp->retired_op != NULL)
+    {
+        for (int i = 0; i < get_vector_num(cp->retired_op); i++)
+            release_op(( struct ir_op* )get_vector_data(cp->retired_op, i));
+
+        release_vector(cp->retired_op);
+    }
+
+    if (cp->retired_data != NULL)
+    {
+        for (int i = 0; i < get_vector_num(cp->retired_data); i++)
+            sys_free(*( void** )get_vector_data(cp->retired_data, i));
+
+        release_vector(cp->retired_data);
+    }
+
+    /* the tensors must be destroyed before the nodes */
+    for (int i = 0; i < cp->dropped_tensor_num; i++)
+        destroy_ir_tensor(graph, cp->dropped_tensor[i]);
+
+    for (int i = 0; i < cp->dropped_node_num; i++)
+        destroy_ir_node(graph, cp->dropped_node[i]);
+
+    sys_free(cp->input_nodes);
+    sys_free(cp->output_nodes);
+    sys_free(cp->node_list);
+    sys_free(cp->tensor_list);
+    sys_free(cp->nodes);
+    sys_free(cp->tensors);
+    sys_free(cp->params);
+    sys_free(cp->created_node);
+    sys_free(cp->created_tensor);
+    sys_free(cp->dropped_node);
+    sys_free(cp->dropped_tensor);
+    sys_free(cp);
+}
+
+static struct graph_checkpoint* create_graph_checkpoint(struct ir_graph* graph)
+{
+    struct graph_checkpoint* cp = ( struct graph_checkpoint* )sys_malloc(sizeof(struct graph_checkpoint));
+
+    if (cp == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    memset(cp, 0, sizeof(struct graph_checkpoint));
+
+    int node_num = graph->node_num;
+    int tensor_num = graph->tensor_num;
+
+    cp->node_num = node_num;
+    cp->tensor_num = tensor_num;
+    cp->input_nodes = copy_index_list(graph->input_nodes, graph->input_num);
+    cp->output_nodes = copy_index_list(graph->output_nodes, graph->output_num);
+    cp->node_list = ( struct ir_node** )sys_malloc(sizeof(struct ir_node*) * (node_num + 1));
+    cp->tensor_list = ( struct ir_tensor** )sys_malloc(sizeof(struct ir_tensor*) * (tensor_num + 1));
+    cp->nodes = ( struct ir_node* )sys_malloc(sizeof(struct ir_node) * (node_num + 1));
+    cp->tensors = ( struct ir_tensor* )sys_malloc(sizeof(struct ir_tensor) * (tensor_num + 1));
+    cp->params = ( void** )sys_malloc(sizeof(void*) * (node_num + 1));
+    cp->retired_op = create_vector(sizeof(struct ir_op), NULL);
+    cp->retired_data = create_vector(sizeof(void*), NULL);
+
+    if (cp->nodes != NULL)
+        memset(cp->nodes, 0, sizeof(struct ir_node) * node_num);
+
+    if (cp->params != NULL)
+        memset(cp->params, 0, sizeof(void*) * node_num);
+
+    if ((graph->input_num > 0 && cp->input_nodes == NULL) || (graph->output_num > 0 && cp->output_nodes == NULL) ||
+        cp->node_list == NULL || cp->tensor_list == NULL || cp->nodes == NULL || cp->tensors == NULL ||
+        cp->params == NULL || cp->retired_op == NULL || cp->retired_data == NULL)
+        goto error;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = graph->node_list[i];
+        struct ir_node* saved = &cp->nodes[i];
+
+        *saved = *node;
+        saved->input_tensors = copy_index_list(node->input_tensors, node->input_num);
+        saved->output_tensors = copy_index_list(node->output_tensors, node->output_num);
+
+        if ((node->input_num > 0 && saved->input_tensors == NULL) ||
+            (node->output_num > 0 && saved->output_tensors == NULL))
+            goto error;
+
+        if (node->op.param_size > 0 && node->op.param_mem != NULL)
+        {
+            cp->params[i] = sys_malloc(node->op.param_size);
+
+            if (cp->params[i] == NULL)
+                goto error;
+
+            memcpy(cp->params[i], node->op.param_mem, node->op.param_size);
+        }
+
+        cp->node_list[i] = node;
+    }
+
+    for (int i = 0; i < tensor_num; i++)
+    {
+        cp->tensors[i] = *graph->tensor_list[i];
+        cp->tensor_list[i] = graph->tensor_list[i];
+    }
+
+    return cp;
+
+error:
+    release_graph_checkpoint(graph, cp);
+    set_tengine_errno(ENOMEM);
+    return NULL;
+}
+
+/* the nodes and the tensors the pass created are after the ones in the checkpoint, till the commit sorts them */
+static int track_graph_checkpoint(struct ir_graph* graph, struct graph_checkpoint* cp)
+{
+    int node_num = graph->node_num;
+    int tensor_num = graph->tensor_num;
+
+    cp->created_node = ( struct ir_node** )sys_malloc(sizeof(struct ir_node*) * (node_num + 1));
+    cp->created_tensor = ( struct ir_tensor** )sys_malloc(sizeof(struct ir_tensor*) * (tensor_num + 1));
+    cp->dropped_node = ( struct ir_node** )sys_malloc(sizeof(struct ir_node*) * (node_num + 1));
+    cp->dropped_tensor = ( struct ir_tensor** )sys_malloc(sizeof(struct ir_tensor*) * (tensor_num + 1));
+
+    if (cp->created_node == NULL || cp->created_tensor == NULL || cp->dropped_node == NULL ||
+        cp->dropped_tensor == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    for (int i = cp->node_num; i < node_num; i++)
+        cp->created_node[cp->created_node_num++] = graph->node_list[i];
+
+    for (int i = cp->tensor_num; i < tensor_num; i++)
+        cp->created_tensor[cp->created_tensor_num++] = graph->tensor_list[i];
+
+    return 0;
+}
+
+/* drop what the pass created, and put back what it changed */
+static void restore_graph_checkpoint(struct ir_graph* graph, struct graph_checkpoint* cp)
+{
+    /* not tracked only if the lists are not committed */
+    if (cp->created_node == NULL || cp->created_tensor == NULL)
+    {
+        cp->created_node_num = 0;
+        cp->created_tensor_num = 0;
+
+        for (int i = cp->tensor_num; i < graph->tensor_num; i++)
+            destroy_ir_tensor(graph, graph->tensor_list[i]);
+
+        for (int i = cp->node_num; i < graph->node_num; i++)
+            destroy_ir_node(graph, graph->node_list[i]);
+    }
+
+    for (int i = 0; i < cp->created_tensor_num; i++)
+        destroy_ir_tensor(graph, cp->created_tensor[i]);
+
+    for (int i = 0; i < cp->created_node_num; i++)
+        destroy_ir_node(graph, cp->created_node[i]);
+
+    /* the lists only grow, so they hold the ones before the pass */
+    memcpy(graph->node_list, cp->node_list, sizeof(struct ir_node*) * cp->node_num);
+    memcpy(graph->tensor_list, cp->tensor_list, sizeof(struct ir_tensor*) * cp->tensor_num);
+
+    for (int i = 0; i < cp->tensor_num; i++)
+    {
+        struct ir_tensor* tensor = graph->tensor_list[i];
+
+        if (tensor->data != cp->tensors[i].data && tensor->free_host_mem)
+            sys_free(tensor->data);
+
+        *tensor = cp->tensors[i];
+    }
+
+    for (int i = 0; i < cp->node_num; i++)
+    {
+        struct ir_node* node = graph->node_list[i];
+        struct ir_node* saved = &cp->nodes[i];
+
+        /* the op set by the pass, the saved one is in the retired list */
+        if (node->op.param_mem != saved->op.param_mem)
+            release_op(&node->op);
+        else if (cp->params[i] != NULL)
+            memcpy(node->op.param_mem, cp->params[i], node->op.param_size);
+
+        sys_free(node->input_tensors);
+        sys_free(node->output_tensors);
+
+        *node = *saved;
+
+        /* the node takes the copies */
+        saved->input_tensors = NULL;
+        saved->output_tensors = NULL;
+    }
+
+    if (graph->input_num > 0)
+        memcpy(graph->input_nodes, cp->input_nodes, sizeof(int16_t) * graph->input_num);
+
+    if (graph->output_num > 0)
+        memcpy(graph->output_nodes, cp->output_nodes, sizeof(int16_t) * graph->output_num);
+
+    graph->node_num = cp->node_num;
+    graph->tensor_num = cp->tensor_num;
+
+    /* they are used by the graph again, or destroyed above */
+    while (get_vector_num(cp->retired_op) > 0)
+        remove_vector_by_idx(cp->retired_op, get_vector_num(cp->retired_op) - 1);
+
+    while (get_vector_num(cp->retired_data) > 0)
+        remove_vector_by_idx(cp->retired_data, get_vector_num(cp->retired_data) - 1);
+
+    cp->dropped_node_num = 0;
+    cp->dropped_tensor_num = 0;
+}
+
+static int find_graph_pass(const char* name)
+{
+    int pass_num = get_vector_num(pass_list);
+
+    for (int i = 0; i < pass_num; i++)
+    {
+        struct graph_pass_entry* e = ( struct graph_pass_entry* )get_vector_data(pass_list, i);
+
+        if (!strcmp(e->name, name))
+            return i;
+    }
+
+    return -1;
+}
+
+int register_graph_pass(const char* name, int level, int priority, graph_pass_t pass)
+{
+    struct graph_pass_entry e;
+
+    e.name = name;
+    e.level = level;
+    e.priority = priority;
+    e.enabled = 1;
+    e.pass = pass;
+
+    lock(&pass_lock);
+
+    if (find_graph_pass(name) >= 0)
+    {
+        unlock(&pass_lock);
+        TLOG_ERR("graph pass %s is registered already\n", name);
+        set_tengine_errno(EEXIST);
+        return -1;
+    }
+
+    /* keep the list sorted by priority, the same priority in the order registered */
+    int pass_num = get_vector_num(pass_list);
+    int idx = pass_num;
+
+    for (int i = 0; i < pass_num; i++)
+    {
+        struct graph_pass_entry* p = ( struct graph_pass_entry* )get_vector_data(pass_list, i);
+
+        if (p->priority > priority)
+        {
+            idx = i;
+            break;
+        }
+    }
+
+    int ret = push_vector_data(pass_list, &e);
+
+    if (ret == 0)
+    {
+        for (int i = pass_num; i > idx; i--)
+            set_vector_data(pass_list, i, get_vector_data(pass_list, i - 1));
+
+        set_vector_data(pass_list, idx, &e);
+    }
+
+    unlock(&pass_lock);
+
+    return ret;
+}
+
+int unregister_graph_pass(const char* name)
+{
+    lock(&pass_lock);
+
+    int idx = find_graph_pass(name);
+
+    if (idx >= 0)
+        remove_vector_by_idx(pass_list, idx);
+
+    unlock(&pass_lock);
+
+    if (idx < 0)
+    {
+        set_tengine_errno(ENOENT);
+        return -1;
+    }
+
+    return 0;
+}
+
+int DLLEXPORT enable_graph_pass(const char* name, int enable)
+{
+    lock(&pass_lock);
+
+    int idx = find_graph_pass(name);
+
+    if (idx >= 0)
+    {
+        struct graph_pass_entry* e = ( struct graph_pass_entry* )get_vector_data(pass_list, idx);
+
+        e->enabled = enable;
+    }
+
+    unlock(&pass_lock);
+
+    if (idx < 0)
+    {
+        set_tengine_errno(ENOENT);
+        return -1;
+    }
+
+    return 0;
+}
+
+int is_graph_input_node(struct ir_graph* graph, struct ir_node* node)
+{
+    for (int i = 0; i < graph->input_num; i++)
+    {
+        if (graph->input_nodes[i] == node->idx)
+            return 1;
+    }
+
+    return 0;
+}
+
+int is_graph_output_node(struct ir_graph* graph, struct ir_node* node)
+{
+    for (int i = 0; i < graph->output_num; i++)
+    {
+        if (graph->output_nodes[i] == node->idx)
+            return 1;
+    }
+
+    return 0;
+}
+
+static void remove_tensor_consumer(struct ir_tensor* tensor, int node_idx)
+{
+    int k = 0;
+
+    for (int i = 0; i < tensor->consumer_num; i++)
+    {
+        if (tensor->consumer[i] != node_idx)
+            tensor->consumer[k++] = tensor->consumer[i];
+    }
+
+    for (int i = k; i < tensor->consumer_num; i++)
+        tensor->consumer[i] = -1;
+
+    tensor->consumer_num = k;
+}
+
+/* a const tensor nobody reads any more, and its const node if that produces nothing else */
+static void remove_unused_const(struct ir_graph* graph, struct ir_tensor* tensor)
+{
+    if (tensor->removed || tensor->consumer_num > 0 || tensor->tensor_type != TENSOR_TYPE_CONST)
+        return;
+
+    if (tensor->producer < 0)
+    {
+        tensor->removed = 1;
+        return;
+    }
+
+    struct ir_node* producer = get_ir_graph_node(graph, tensor->producer);
+
+    if (producer->op.op_type != OP_CONST || producer->output_num != 1 || is_graph_output_node(graph, producer))
+        return;
+
+    tensor->removed = 1;
+    producer->removed = 1;
+}
+
+int remove_graph_node(struct ir_graph* graph, struct ir_node* node)
+{
+    if (node->removed)
+        return 0;
+
+    if (is_graph_input_node(graph, node) || is_graph_output_node(graph, node))
+    {
+        TLOG_ERR("graph pass: cannot remove the input or output node %s\n", node->name);
+        set_tengine_errno(EINVAL);
+        return -1;
+    }
+
+    for (int i = 0; i < node->output_num; i++)
+    {
+        struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->output_tensors[i]);
+
+        /* the node itself is the only consumer allowed, fuse_graph_node() links it so */
+        if (tensor->consumer_num > 1 || (tensor->consumer_num == 1 && tensor->consumer[0] != node->idx))
+        {
+            TLOG_ERR("graph pass: the output %s of node %s is still used\n", tensor->name, node->name);
+            set_tengine_errno(EBUSY);
+            return -1;
+        }
+    }
+
+    for (int i = 0; i < node->input_num; i++)
+    {
+        if (node->input_tensors[i] < 0)
+            continue;
+
+        struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->input_tensors[i]);
+
+        remove_tensor_consumer(tensor, node->idx);
+        remove_unused_const(graph, tensor);
+    }
+
+    for (int i = 0; i < node->output_num; i++)
+    {
+        struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->output_tensors[i]);
+
+        tensor->removed = 1;
+    }
+
+    node->removed = 1;
+
+    return 0;
+}
+
+int replace_graph_tensor(struct ir_graph* graph, struct ir_tensor* old_tensor, struct ir_tensor* new_tensor)
+{
+    if (old_tensor == new_tensor)
+        return 0;
+
+    if (new_tensor->consumer_num + old_tensor->consumer_num > MAX_CONSUMER_NUM)
+    {
+        set_tengine_errno(ENOSPC);
+        return -1;
+    }
+
+    for (int i = 0; i < old_tensor->consumer_num; i++)
+    {
+        struct ir_node* consumer = get_ir_graph_node(graph, old_tensor->consumer[i]);
+
+        for (int j = 0; j < consumer->input_num; j++)
+        {
+            if (consumer->input_tensors[j] == old_tensor->idx)
+                consumer->input_tensors[j] = new_tensor->idx;
+        }
+
+        new_tensor->consumer[new_tensor->consumer_num++] = consumer->idx;
+        old_tensor->consumer[i] = -1;
+    }
+
+    old_tensor->consumer_num = 0;
+
+    return 0;
+}
+
+int replace_node_input_tensor(struct ir_graph* graph, struct ir_node* node, int input_idx, struct ir_tensor* tensor)
+{
+    struct ir_tensor* old_tensor = get_ir_graph_tensor(graph, node->input_tensors[input_idx]);
+
+    if (old_tensor == tensor)
+        return 0;
+
+    int consumed = 0;
+
+    for (int i = 0; i < tensor->consumer_num; i++)
+    {
+        if (tensor->consumer[i] == node->idx)
+            consumed = 1;
+    }
+
+    if (!consumed && tensor->consumer_num >= MAX_CONSUMER_NUM)
+    {
+        set_tengine_errno(ENOSPC);
+        return -1;
+    }
+
+    node->input_tensors[input_idx] = tensor->idx;
+
+    if (!consumed)
+        tensor->consumer[tensor->consumer_num++] = node->idx;
+
+    /* the node may read the old tensor by another input as well */
+    for (int i = 0; i < node->input_num; i++)
+    {
+        if (node->input_tensors[i] == old_tensor->idx)
+            return 0;
+    }
+
+    remove_tensor_consumer(old_tensor, node->idx);
+    remove_unused_const(graph, old_tensor);
+
+    return 0;
+}
+
+int set_graph_node_op(struct ir_graph* graph, struct ir_node* node, int op_type, int op_version)
+{
+    struct op_method* m = find_op_method(op_type, op_version);
+
+    if (m == NULL)
+    {
+        set_tengine_errno(ENOENT);
+        return -1;
+    }
+
+    struct ir_op op;
+
+    op.op_type = op_type;
+    op.op_version = op_version;
+    op.same_shape = 1;
+    op.param_size = 0;
+    op.param_mem = NULL;
+    op.infer_shape = NULL;
+
+    if (m->init_op && m->init_op(&op) < 0)
+        return -1;
+
+    struct ir_op old_op = node->op;
+
+    /* the pass may fail, the old op is released when it returns */
+    if (graph->pass_checkpoint != NULL)
+    {
+        if (push_vector_data(graph->pass_checkpoint->retired_op, &old_op) < 0)
+        {
+            release_op(&op);
+            set_tengine_errno(ENOMEM);
+            return -1;
+        }
+    }
+    else
+        release_op(&old_op);
+
+    node->op = op;
+
+    return 0;
+}
+
+int fuse_graph_node(struct ir_graph* graph, struct ir_node* node, struct ir_node* next)
+{
+    if (node->output_num != 1 || next->output_num != 1 || is_graph_output_node(graph, node) ||
+        is_graph_input_node(graph, next))
+    {
+        set_tengine_errno(EINVAL);
+        return -1;
+    }
+
+    struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->output_tensors[0]);
+    struct ir_tensor* next_output = get_ir_graph_tensor(graph, next->output_tensors[0]);
+
+    if (tensor->consumer_num != 1 || tensor->consumer[0] != next->idx)
+    {
+        set_tengine_errno(EINVAL);
+        return -1;
+    }
+
+    /* swap the outputs, then next is a dead node reading its own output */
+    node->output_tensors[0] = next_output->idx;
+    next_output->producer = node->idx;
+    next->output_tensors[0] = tensor->idx;
+    tensor->producer = next->idx;
+
+    for (int i = 0; i < graph->output_num; i++)
+    {
+        if (graph->output_nodes[i] == next->idx)
+        {
+            graph->output_nodes[i] = node->idx;
+            node->node_type = TENGINE_NODE_TYPE_OUTPUT;
+        }
+    }
+
+    return remove_graph_node(graph, next);
+}
+
+struct ir_tensor* create_graph_const_tensor(struct ir_graph* graph, const char* name, int data_type, const int dims[],
+                                            int dim_num)
+{
+    struct ir_tensor* tensor = create_ir_tensor(graph, name, data_type);
+
+    if (tensor == NULL)
+        return NULL;
+
+    /* dropped with the pass if anything below fails */
+    tensor->removed = 1;
+    tensor->tensor_type = TENSOR_TYPE_CONST;
+
+    if (set_ir_tensor_shape(tensor, dims, dim_num) < 0)
+        return NULL;
+
+    int size = tensor->elem_num * tensor->elem_size;
+
+    tensor->data = sys_malloc(size);
+
+    if (tensor->data == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    memset(tensor->data, 0, size);
+    tensor->free_host_mem = 1;
+    tensor->internal_allocated = 0;
+
+    struct ir_node* node = create_ir_node(graph, name, OP_CONST, 1);
+
+    if (node == NULL)
+        return NULL;
+
+    node->removed = 1;
+
+    if (set_ir_node_output_tensor(node, 0, tensor) < 0)
+        return NULL;
+
+    node->removed = 0;
+    tensor->removed = 0;
+
+    return tensor;
+}
+
+void* get_tensor_private_data(struct ir_graph* graph, struct ir_tensor* tensor)
+{
+    struct graph_checkpoint* cp = graph->pass_checkpoint;
+    int owned = tensor->free_host_mem;
+
+    /* the data owned before the pass is written in a copy, and kept to be restored */
+    if (owned && (cp == NULL || tensor->idx >= cp->tensor_num || cp->tensors[tensor->idx].data != tensor->data))
+        return tensor->data;
+
+    int size = tensor->elem_num * tensor->elem_size;
+    void* data = sys_malloc(size);
+
+    if (data == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    if (owned && push_vector_data(cp->retired_data, &tensor->data) < 0)
+    {
+        sys_free(data);
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    memcpy(data, tensor->data, size);
+
+    tensor->data = data;
+    tensor->free_host_mem = 1;
+    tensor->internal_allocated = 0;
+
+    return data;
+}
+
+/* post order from the producers, so that the nodes already sorted keep their order */
+static int sort_node(struct ir_graph* graph, int node_idx, int8_t* state, int16_t* order, int* order_num)
+{
+    struct ir_node* node = get_ir_graph_node(graph, node_idx);
+
+    state[node_idx] = 1;
+
+    for (int i = 0; i < node->input_num; i++)
+    {
+        if (node->input_tensors[i] < 0)
+            continue;
+
+        struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->input_tensors[i]);
+        int producer = tensor->producer;
+
+        if (producer < 0 || graph->node_list[producer]->removed || state[producer] == 2)
+            continue;
+
+        if (state[producer] == 1)
+        {
+            TLOG_ERR("graph pass: node %s is in a cycle\n", node->name);
+            set_tengine_errno(EINVAL);
+            return -1;
+        }
+
+        if (sort_node(graph, producer, state, order, order_num) < 0)
+            return -1;
+    }
+
+    state[node_idx] = 2;
+    order[(*order_num)++] = node_idx;
+
+    return 0;
+}
+
+/* drop the removed nodes and tensors, sort the nodes and renumber all of them. it fails before changing
+   anything, or not at all */
+static int commit_graph(struct ir_graph* graph)
+{
+    int node_num = graph->node_num;
+    int tensor_num = graph->tensor_num;
+    int8_t* state = ( int8_t* )sys_malloc(node_num);
+    int16_t* order = ( int16_t* )sys_malloc(sizeof(int16_t) * node_num);
+    int16_t* node_map = ( int16_t* )sys_malloc(sizeof(int16_t) * node_num);
+    int16_t* tensor_map = ( int16_t* )sys_malloc(sizeof(int16_t) * tensor_num);
+    struct ir_node** sorted = ( struct ir_node** )sys_malloc(sizeof(struct ir_node*) * node_num);
+    int order_num = 0;
+    int ret = -1;
+
+    if (state == NULL || order == NULL || node_map == NULL || tensor_map == NULL || sorted == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        goto out;
+    }
+
+    memset(state, 0, node_num);
+
+    for (int i = 0; i < node_num; i++)
+    {
+        if (!graph->node_list[i]->removed && state[i] == 0 && sort_node(graph, i, state, order, &order_num) < 0)
+            goto out;
+    }
+
+    for (int i = 0; i < node_num; i++)
+        node_map[i] = -1;
+
+    for (int i = 0; i < order_num; i++)
+    {
+        node_map[order[i]] = i;
+        sorted[i] = graph->node_list[order[i]];
+    }
+
+    int new_tensor_num = 0;
+
+    for (int i = 0; i < tensor_num; i++)
+        tensor_map[i] = graph->tensor_list[i]->removed ? -1 : new_tensor_num++;
+
+    /* renumber the references */
+    for (int i = 0; i < tensor_num; i++)
+    {
+        struct ir_tensor* tensor = graph->tensor_list[i];
+
+        if (tensor->removed)
+            continue;
+
+        int k = 0;
+
+        for (int j = 0; j < tensor->consumer_num; j++)
+        {
+            if (node_map[tensor->consumer[j]] >= 0)
+                tensor->consumer[k++] = node_map[tensor->consumer[j]];
+        }
+
+        for (int j = k; j < MAX_CONSUMER_NUM; j++)
+            tensor->consumer[j] = -1;
+
+        tensor->consumer_num = k;
+        tensor->producer = tensor->producer >= 0 ? node_map[tensor->producer] : -1;
+        tensor->idx = tensor_map[i];
+    }
+
+    for (int i = 0; i < order_num; i++)
+    {
+        struct ir_node* node = sorted[i];
+
+        for (int j = 0; j < node->input_num; j++)
+        {
+            if (node->input_tensors[j] >= 0)
+                node->input_tensors[j] = tensor_map[node->input_tensors[j]];
+        }
+
+        for (int j = 0; j < node->output_num; j++)
+        {
+            if (node->output_tensors[j] >= 0)
+                node->output_tensors[j] = tensor_map[node->output_tensors[j]];
+        }
+
+        node->idx = i;
+    }
+
+    for (int i = 0; i < graph->input_num; i++)
+        graph->input_nodes[i] = node_map[graph->input_nodes[i]];
+
+    for (int i = 0; i < graph->output_num; i++)
+        graph->output_nodes[i] = node_map[graph->output_nodes[i]];
+
+    /* the removed ones are destroyed with the checkpoint, so the pass can still be undone */
+    struct graph_checkpoint* cp = graph->pass_checkpoint;
+
+    for (int i = 0; i < tensor_num; i++)
+    {
+        struct ir_tensor* tensor = graph->tensor_list[i];
+
+        if (tensor->removed)
+            cp->dropped_tensor[cp->dropped_tensor_num++] = tensor;
+        else
+            graph->tensor_list[tensor->idx] = tensor;
+    }
+
+    for (int i = 0; i < node_num; i++)
+    {
+        if (graph->node_list[i]->removed)
+            cp->dropped_node[cp->dropped_node_num++] = graph->node_list[i];
+    }
+
+    memcpy(graph->node_list, sorted, sizeof(struct ir_node*) * order_num);
+
+    graph->tensor_num = new_tensor_num;
+    graph->node_num = order_num;
+
+    ret = 0;
+
+out:
+    sys_free(state);
+    sys_free(order);
+    sys_free(node_map);
+    sys_free(tensor_map);
+    sys_free(sorted);
+
+    return ret;
+}
+
+static int has_removed(struct ir_graph* graph, int node_num, int tensor_num)
+{
+    if (graph->node_num != node_num || graph->tensor_num != tensor_num)
+        return 1;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        if (graph->node_list[i]->removed)
+            return 1;
+    }
+
+    for (int i = 0; i < tensor_num; i++)
+    {
+        if (graph->tensor_list[i]->removed)
+            return 1;
+    }
+
+    return 0;
+}
+
+static int get_opt_level(struct ir_graph* graph)
+{
+    int opt_level = GRAPH_OPT_DEFAULT;
+
+    get_attr_val(graph->attr_mem, graph->attr_num, GRAPH_ATTR_OPT_LEVEL, NULL, &opt_level, sizeof(int));
+
+    if (opt_level < GRAPH_OPT_NONE || opt_level > GRAPH_OPT_ALL)
+        return GRAPH_OPT_ALL;
+
+    return opt_level;
+}
+
+int run_graph_passes(struct ir_graph* graph, const struct options* opt)
+{
+    int opt_level = get_opt_level(graph);
+
+    /* the graph was optimized and allocated by an earlier prerun, or it is a session of an optimized graph */
+    if (graph->pass_stat_list != NULL || get_vector_num(graph->subgraph_list) > 0 || graph->parent != NULL)
+        return 0;
+
+    graph->pass_stat_list = create_vector(sizeof(struct graph_pass_stat), NULL);
+
+    if (graph->pass_stat_list == NULL)
+        return -1;
+
+    /* copy the list, so that the passes can run without the lock */
+    lock(&pass_lock);
+
+    int pass_num = get_vector_num(pass_list);
+    struct graph_pass_entry* passes = ( struct graph_pass_entry* )sys_malloc(sizeof(struct graph_pass_entry) * (pass_num + 1));
+
+    if (passes == NULL)
+    {
+        unlock(&pass_lock);
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    for (int i = 0; i < pass_num; i++)
+        passes[i] = *( struct graph_pass_entry* )get_vector_data(pass_list, i);
+
+    unlock(&pass_lock);
+
+    for (int i = 0; i < pass_num; i++)
+    {
+        struct graph_pass_entry* e = &passes[i];
+        struct graph_pass_stat stat;
+
+        stat.name = e->name;
+        stat.level = e->level;
+        stat.enabled = e->enabled && opt_level >= e->level;
+        stat.change_num = 0;
+        stat.time = 0;
+
+        if (stat.enabled)
+        {
+            int node_num = graph->node_num;
+            int tensor_num = graph->tensor_num;
+            int64_t start = get_cur_time_us();
+            struct graph_checkpoint* cp = create_graph_checkpoint(graph);
+
+            if (cp == NULL)
+                stat.change_num = -1;
+            else
+            {
+                graph->pass_checkpoint = cp;
+                stat.change_num = e->pass(graph, opt);
+
+                if (stat.change_num >= 0 && track_graph_checkpoint(graph, cp) < 0)
+                    stat.change_num = -1;
+
+                if (stat.change_num >= 0 && has_removed(graph, node_num, tensor_num) && commit_graph(graph) < 0)
+                    stat.change_num = -1;
+
+                /* the passes set the shapes of what they create, infer again to keep all consistent */
+                if (stat.change_num > 0 && infer_shape_graph(graph) < 0)
+                    stat.change_num = -1;
+
+                if (stat.change_num < 0)
+                    restore_graph_checkpoint(graph, cp);
+
+                graph->pass_checkpoint = NULL;
+                release_graph_checkpoint(graph, cp);
+            }
+
+            stat.time = get_cur_time_us() - start;
+
+            TLOG_DEBUG("graph pass %s: %d changes, %lld us\n", e->name, stat.change_num, ( long long )stat.time);
+
+            if (stat.change_num < 0)
+                TLOG_ERR("graph pass %s failed, the graph is kept as before it\n", e->name);
+        }
+
+        push_vector_data(graph->pass_stat_list, &stat);
+    }
+
+    sys_free(passes);
+
+    return 0;
+}
+
+int DLLEXPORT get_graph_pass_stat(graph_t graph, struct graph_pass_stat* stat, int max_num)
+{
+    struct ir_graph* ir_graph = ( struct ir_graph* )graph;
+
+    if (ir_graph->pass_stat_list == NULL)
+        return 0;
+
+    int stat_num = get_vector_num(ir_graph->pass_stat_list);
+
+    for (int i = 0; i < stat_num && i < max_num; i++)
+        stat[i] = *( struct graph_pass_stat* )get_vector_data(ir_graph->pass_stat_list, i);
+
+    return stat_num;
+}
+
+static int init_graph_pass(void* arg)
+{
+    init_lock(&pass_lock);
+
+    pass_list = create_vector(sizeof(struct graph_pass_entry), NULL);
+
+    if (pass_list == NULL)
+        return -1;
+
+    return 0;
+}
+
+REGISTER_MODULE_INIT(MOD_CORE_LEVEL, "init_graph_pass", init_graph_pass);
@@ -0,0 +1,224 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_op.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "graph_pass.h"
+
+/* merge the nodes computing the same op with the same param on the same inputs, e.g. the permutes and
+   the reshapes of one feature map repeated by each head of a detector. the nodes are hashed by op type,
+   param and input tensors. they are sorted, so the consumers of a merged node read the kept outputs
+   before they are hashed themselves, and a chain of duplicated nodes merges in one sweep.
+   the params are compared byte by byte, the ones with pointers only match if the pointers do */
+
+static uint32_t hash_bytes(uint32_t h, const void* data, int size)
+{
+    const uint8_t* p = ( const uint8_t* )data;
+
+    for (int i = 0; i < size; i++)
+        h = (h ^ p[i]) * 16777619u;
+
+    return h;
+}
+
+static uint32_t hash_node(struct ir_node* node)
+{
+    uint32_t h = 2166136261u;
+
+    h = hash_bytes(h, &node->op.op_type, sizeof(node->op.op_type));
+    h = hash_bytes(h, node->input_tensors, sizeof(int16_t) * node->input_num);
+
+    if (node->op.param_mem != NULL)
+        h = hash_bytes(h, node->op.param_mem, node->op.param_size);
+
+    return h;
+}
+
+static int is_mergeable_node(struct ir_graph* graph, struct ir_node* node)
+{
+    int op_type = node->op.op_type;
+
+    if (node->removed || op_type == OP_CONST || op_type == OP_INPUT || node->input_num == 0 ||
+        node->output_num == 0 || node->attr_num > 0 || is_graph_input_node(graph, node))
+        return 0;
+
+    for (int i = 0; i < node->input_num; i++)
+    {
+        if (node->input_tensors[i] < 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+/* the outputs of an int8 graph carry their own quant params */
+static int is_same_quant(struct ir_tensor* a, struct ir_tensor* b)
+{
+    if (a->quant_param_num == 0 && b->quant_param_num == 0)
+        return 1;
+
+    return a->quant_param_num == 1 && b->quant_param_num == 1 && a->scale == b->scale &&
+           a->zero_point == b->zero_point;
+}
+
+static int is_same_node(struct ir_graph* graph, struct ir_node* a, struct ir_node* b)
+{
+    if (a->op.op_type != b->op.op_type || a->op.op_version != b->op.op_version ||
+        a->op.param_size != b->op.param_size || a->input_num != b->input_num || a->output_num != b->output_num)
+        return 0;
+
+    if (memcmp(a->input_tensors, b->input_tensors, sizeof(int16_t) * a->input_num) != 0)
+        return 0;
+
+    if (a->op.param_size > 0 && memcmp(a->op.param_mem, b->op.param_mem, a->op.param_size) != 0)
+        return 0;
+
+    for (int i = 0; i < a->output_num; i++)
+    {
+        struct ir_tensor* ta = get_ir_graph_tensor(graph, a->output_tensors[i]);
+        struct ir_tensor* tb = get_ir_graph_tensor(graph, b->output_tensors[i]);
+
+        if (ta->data_type != tb->data_type || !is_same_quant(ta, tb))
+            return 0;
+    }
+
+    return 1;
+}
+
+/* the consumers of the outputs of node move to the ones of kept */
+static int merge_node(struct ir_graph* graph, struct ir_node* kept, struct ir_node* node)
+{
+    for (int i = 0; i < node->output_num; i++)
+    {
+        struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->output_tensors[i]);
+        struct ir_tensor* kept_tensor = get_ir_graph_tensor(graph, kept->output_tensors[i]);
+
+        if (tensor->consumer_num + kept_tensor->consumer_num > MAX_CONSUMER_NUM)
+            return 0;
+    }
+
+    for (int i = 0; i < node->output_num; i++)
+    {
+        struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->output_tensors[i]);
+        struct ir_tensor* kept_tensor = get_ir_graph_tensor(graph, kept->output_tensors[i]);
+
+        if (replace_graph_tensor(graph, tensor, kept_tensor) < 0)
+            return -1;
+    }
+
+    if (remove_graph_node(graph, node) < 0)
+        return -1;
+
+    return 1;
+}
+
+static int eliminate_common(struct ir_graph* graph, const struct options* opt)
+{
+    int node_num = graph->node_num;
+    int bucket_num = node_num;
+    int merge_num = 0;
+
+    if (node_num == 0)
+        return 0;
+
+    /* the heads of the buckets, then the next node in the bucket of each node */
+    int* bucket = ( int* )sys_malloc(sizeof(int) * (bucket_num + node_num));
+
+    if (bucket == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    int* next = bucket + bucket_num;
+
+    for (int i = 0; i < bucket_num; i++)
+        bucket[i] = -1;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, i);
+
+        if (!is_mergeable_node(graph, node))
+            continue;
+
+        int b = hash_node(node) % bucket_num;
+        int ret = 0;
+
+        for (int j = bucket[b]; j >= 0; j = next[j])
+        {
+            struct ir_node* kept = get_ir_graph_node(graph, j);
+
+            /* an output node is never removed */
+            if (is_same_node(graph, kept, node) && !is_graph_output_node(graph, node))
+            {
+                ret = merge_node(graph, kept, node);
+                break;
+            }
+        }
+
+        if (ret < 0)
+        {
+            sys_free(bucket);
+            return -1;
+        }
+
+        if (ret > 0)
+        {
+            merge_num++;
+            continue;
+        }
+
+        next[i] = bucket[b];
+        bucket[b] = i;
+    }
+
+    sys_free(bucket);
+
+    TLOG_INFO("eliminate_common: %d nodes merged\n", merge_num);
+
+    return merge_num;
+}
+
+static int reg_eliminate_common(void* arg)
+{
+    return register_graph_pass("eliminate_common", GRAPH_OPT_BASIC, GRAPH_PASS_ELIMINATE_COMMON, eliminate_common);
+}
+
+static int unreg_eliminate_common(void* arg)
+{
+    return unregister_graph_pass("eliminate_common");
+}
+
+REGISTER_MODULE_INIT(MOD_FUNC_LEVEL, "reg_eliminate_common", reg_eliminate_common);
+REGISTER_MODULE_EXIT(MOD_FUNC_LEVEL, "unreg_eliminate_common", unreg_eliminate_common);
@@ -0,0 +1,265 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_op.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "graph_pass.h"
+#include "cast_param.h"
+#include "permute_param.h"
+#include "transpose_param.h"
+
+/* remove the nodes which do not change their input: dropout, noop, the reshapes keeping the shape,
+   the casts to the same type and the pairs of permutes or transposes undoing each other.
+   then prune the nodes none of the graph outputs depends on */
+
+static int is_same_shape(struct ir_tensor* a, struct ir_tensor* b)
+{
+    if (a->dim_num != b->dim_num || a->elem_num != b->elem_num || a->data_type != b->data_type)
+        return 0;
+
+    for (int i = 0; i < a->dim_num; i++)
+    {
+        if (a->dims[i] != b->dims[i])
+            return 0;
+    }
+
+    return 1;
+}
+
+/* the order of the axes, -1 if the node is not a permute or a transpose */
+static int get_permute_order(struct ir_graph* graph, struct ir_node* node, int* order)
+{
+    struct ir_tensor* input = get_ir_graph_tensor(graph, node->input_tensors[0]);
+    int dim_num = input->dim_num;
+
+    if (node->op.op_type == OP_PERMUTE)
+    {
+        struct permute_param* param = ( struct permute_param* )node->op.param_mem;
+
+        if (dim_num > 4)
+            return -1;
+
+        order[0] = param->order0;
+        order[1] = param->order1;
+        order[2] = param->order2;
+        order[3] = param->order3;
+    }
+    else if (node->op.op_type == OP_TRANSPOSE)
+    {
+        struct transpose_param* param = ( struct transpose_param* )node->op.param_mem;
+
+        if (param->tr_shape == NULL || param->tr_shape_size != dim_num)
+            return -1;
+
+        for (int i = 0; i < dim_num; i++)
+            order[i] = param->tr_shape[i];
+    }
+    else
+        return -1;
+
+    for (int i = 0; i < dim_num; i++)
+    {
+        if (order[i] < 0 || order[i] >= dim_num)
+            return -1;
+    }
+
+    return dim_num;
+}
+
+/* the input the output of the node is equal to, NULL if there is none */
+static struct ir_tensor* get_identity_input(struct ir_graph* graph, struct ir_node* node)
+{
+    struct ir_tensor* input = get_ir_graph_tensor(graph, node->input_tensors[0]);
+    struct ir_tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+    switch (node->op.op_type)
+    {
+        case OP_DROPOUT:
+        case OP_NOOP:
+        case OP_RESHAPE:
+        case OP_FLATTEN:
+        case OP_SQUEEZE:
+        case OP_UNSQUEEZE:
+        case OP_EXPANDDIMS:
+            return is_same_shape(input, output) ? input : NULL;
+        case OP_CAST:
+        {
+            struct cast_param* param = ( struct cast_param* )node->op.param_mem;
+
+            return (param->type_from == param->type_to && is_same_shape(input, output)) ? input : NULL;
+        }
+        case OP_PERMUTE:
+        case OP_TRANSPOSE:
+        {
+            int order[MAX_SHAPE_DIM_NUM];
+            int dim_num = get_permute_order(graph, node, order);
+
+            if (dim_num < 0)
+                return NULL;
+
+            int identity = is_same_shape(input, output);
+
+            for (int i = 0; i < dim_num; i++)
+            {
+                if (order[i] != i)
+                    identity = 0;
+            }
+
+            if (identity)
+                return input;
+
+            /* or it undoes the permute producing its input */
+            if (input->producer < 0)
+                return NULL;
+
+            struct ir_node* prev = get_ir_graph_node(graph, input->producer);
+            int prev_order[MAX_SHAPE_DIM_NUM];
+
+            if (prev->removed || prev->output_num != 1 || prev->input_num < 1 ||
+                get_permute_order(graph, prev, prev_order) != dim_num)
+                return NULL;
+
+            struct ir_tensor* prev_input = get_ir_graph_tensor(graph, prev->input_tensors[0]);
+
+            if (!is_same_shape(prev_input, output))
+                return NULL;
+
+            for (int i = 0; i < dim_num; i++)
+            {
+                if (prev_order[order[i]] != i)
+                    return NULL;
+            }
+
+            return prev_input;
+        }
+        default:
+            return NULL;
+    }
+}
+
+static int eliminate_identity(struct ir_graph* graph)
+{
+    int node_num = graph->node_num;
+    int remove_num = 0;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, i);
+
+        if (node->removed || node->input_num < 1 || node->output_num != 1 || is_graph_input_node(graph, node) ||
+            is_graph_output_node(graph, node))
+            continue;
+
+        struct ir_tensor* input = get_identity_input(graph, node);
+
+        if (input == NULL)
+            continue;
+
+        struct ir_tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+        if (input->consumer_num + output->consumer_num > MAX_CONSUMER_NUM)
+            continue;
+
+        if (replace_graph_tensor(graph, output, input) < 0 || remove_graph_node(graph, node) < 0)
+            return -1;
+
+        remove_num++;
+    }
+
+    return remove_num;
+}
+
+static int is_dead_node(struct ir_graph* graph, struct ir_node* node)
+{
+    for (int i = 0; i < node->output_num; i++)
+    {
+        struct ir_tensor* tensor = get_ir_graph_tensor(graph, node->output_tensors[i]);
+
+        if (tensor->consumer_num > 0)
+            return 0;
+    }
+
+    return 1;
+}
+
+/* the nodes are sorted, removing from the last one leaves the producers of a dead node dead as well */
+static int prune_dead_node(struct ir_graph* graph)
+{
+    int remove_num = 0;
+
+    for (int i = graph->node_num - 1; i >= 0; i--)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, i);
+
+        if (node->removed || node->op.op_type == OP_CONST || node->op.op_type == OP_INPUT ||
+            is_graph_input_node(graph, node) || is_graph_output_node(graph, node) || !is_dead_node(graph, node))
+            continue;
+
+        if (remove_graph_node(graph, node) < 0)
+            return -1;
+
+        remove_num++;
+    }
+
+    return remove_num;
+}
+
+static int eliminate_node(struct ir_graph* graph, const struct options* opt)
+{
+    int identity_num = eliminate_identity(graph);
+
+    if (identity_num < 0)
+        return -1;
+
+    int dead_num = prune_dead_node(graph);
+
+    if (dead_num < 0)
+        return -1;
+
+    TLOG_INFO("eliminate_node: %d identity nodes and %d dead nodes removed\n", identity_num, dead_num);
+
+    return identity_num + dead_num;
+}
+
+static int reg_eliminate_node(void* arg)
+{
+    return register_graph_pass("eliminate_node", GRAPH_OPT_BASIC, GRAPH_PASS_ELIMINATE_NODE, eliminate_node);
+}
+
+static int unreg_eliminate_node(void* arg)
+{
+    return unregister_graph_pass("eliminate_node");
+}
+
+REGISTER_MODULE_INIT(MOD_FUNC_LEVEL, "reg_eliminate_node", reg_eliminate_node);
+REGISTER_MODULE_EXIT(MOD_FUNC_LEVEL, "unreg_eliminate_node", unreg_eliminate_node);
@@ -0,0 +1,409 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_op.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "nn_device.h"
+#include "graph_pass.h"
+#include "convolution_param.h"
+#include "fc_param.h"
+#include "batchnorm_param.h"
+#include "eltwise_param.h"
+
+/* fold the batchnorm and the scale nodes following a convolution or a fc into its weight and bias:
+   y = (w * x + b) * k + c = (w * k) * x + (b * k + c), k and c per output channel.
+   the add, the sub or the mul by a const following a fc folds the same way. if the weight of the fc
+   cannot be written, e.g. it is shared, the cpu fc kernels take k as a per output scale instead:
+   y = (w * x) * s + b, with s = s * k and b = b * k + c */
+
+static int is_fp32_const(struct ir_tensor* tensor, int elem_num)
+{
+    return tensor->tensor_type == TENSOR_TYPE_CONST && tensor->data_type == TENGINE_DT_FP32 &&
+           tensor->data != NULL && (elem_num < 0 || tensor->elem_num == elem_num);
+}
+
+static struct ir_tensor* get_input_tensor(struct ir_graph* graph, struct ir_node* node, int idx)
+{
+    if (idx >= node->input_num || node->input_tensors[idx] < 0)
+        return NULL;
+
+    return get_ir_graph_tensor(graph, node->input_tensors[idx]);
+}
+
+/* the same math as the batchnorm ref kernel */
+static int get_batchnorm_affine(struct ir_graph* graph, struct ir_node* node, int channel, float* k, float* c)
+{
+    struct batchnorm_param* param = ( struct batchnorm_param* )node->op.param_mem;
+    struct ir_tensor* gamma = get_input_tensor(graph, node, 1);
+    struct ir_tensor* beta = get_input_tensor(graph, node, 2);
+    struct ir_tensor* mean = get_input_tensor(graph, node, 3);
+    struct ir_tensor* var = get_input_tensor(graph, node, 4);
+
+    if (mean == NULL || var == NULL || !is_fp32_const(mean, channel) || !is_fp32_const(var, channel))
+        return -1;
+
+    if (!param->caffe_flavor &&
+        (gamma == NULL || beta == NULL || !is_fp32_const(gamma, channel) || !is_fp32_const(beta, channel)))
+        return -1;
+
+    float rescale_factor = param->rescale_factor ? 1 / param->rescale_factor : 0;
+
+    for (int i = 0; i < channel; i++)
+    {
+        float var_inv = ( float )(1.f / sqrt(var->f32[i] * rescale_factor + param->eps));
+        float scale_mean = ( float )(-mean->f32[i] * (rescale_factor * var_inv));
+
+        if (param->caffe_flavor)
+        {
+            k[i] = var_inv;
+            c[i] = scale_mean;
+        }
+        else
+        {
+            k[i] = gamma->f32[i] * var_inv;
+            c[i] = beta->f32[i] + gamma->f32[i] * scale_mean;
+        }
+    }
+
+    return 0;
+}
+
+static int get_scale_affine(struct ir_graph* graph, struct ir_node* node, int channel, float* k, float* c)
+{
+    struct ir_tensor* gamma = get_input_tensor(graph, node, 1);
+    struct ir_tensor* beta = get_input_tensor(graph, node, 2);
+
+    if (gamma == NULL || !is_fp32_const(gamma, channel) || (beta != NULL && !is_fp32_const(beta, channel)))
+        return -1;
+
+    for (int i = 0; i < channel; i++)
+    {
+        k[i] = gamma->f32[i];
+        c[i] = beta ? beta->f32[i] : 0.f;
+    }
+
+    return 0;
+}
+
+/* the kernels broadcast a const of neither one nor the output size in their own ways, skip it */
+static int get_eltwise_affine(struct ir_graph* graph, struct ir_node* node, struct ir_tensor* input, int channel,
+                              float* k, float* c)
+{
+    struct eltwise_param* param = ( struct eltwise_param* )node->op.param_mem;
+
+    if (node->input_num != 2)
+        return -1;
+
+    int idx = node->input_tensors[0] == input->idx ? 1 : 0;
+    struct ir_tensor* other = get_input_tensor(graph, node, idx);
+    struct ir_tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+    if (other == NULL || other == input || !is_fp32_const(other, -1) || output->elem_num != input->elem_num)
+        return -1;
+
+    if (other->elem_num == 1 ? idx != 1 : (other->elem_num != channel || input->elem_num != channel))
+        return -1;
+
+    for (int i = 0; i < channel; i++)
+    {
+        float v = other->f32[other->elem_num == 1 ? 0 : i];
+
+        switch (param->type)
+        {
+            case ELT_SUM:
+                k[i] = 1.f;
+                c[i] = v;
+                break;
+            case ELT_SUB:
+                if (idx != 1)
+                    return -1;
+                k[i] = 1.f;
+                c[i] = -v;
+                break;
+            case ELT_PROD:
+                k[i] = v;
+                c[i] = 0.f;
+                break;
+            default:
+                return -1;
+        }
+    }
+
+    return 0;
+}
+
+/* a const tensor named after the node, filled with data, or value if data is NULL */
+static struct ir_tensor* create_channel_tensor(struct ir_graph* graph, struct ir_node* node, const char* suffix,
+                                               int channel, const float* data, float value)
+{
+    char* name = ( char* )sys_malloc((node->name ? strlen(node->name) : 16) + 16);
+    struct ir_tensor* tensor = NULL;
+
+    if (name == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    if (node->name)
+        sprintf(name, "%s/%s", node->name, suffix);
+    else
+        sprintf(name, "node_%d/%s", node->idx, suffix);
+
+    tensor = create_graph_const_tensor(graph, name, TENGINE_DT_FP32, &channel, 1);
+    sys_free(name);
+
+    if (tensor == NULL)
+        return NULL;
+
+    for (int i = 0; i < channel; i++)
+        tensor->f32[i] = data ? data[i] : value;
+
+    return tensor;
+}
+
+static int fold_node(struct ir_graph* graph, struct ir_node* node, struct ir_node* next, int scalable)
+{
+    struct ir_tensor* weight = get_input_tensor(graph, node, 1);
+    struct ir_tensor* bias = get_input_tensor(graph, node, 2);
+    struct ir_tensor* scale = NULL;
+    int channel;
+    int trans = 0;
+
+    if (node->op.op_type == OP_CONV)
+    {
+        struct conv_param* param = ( struct conv_param* )node->op.param_mem;
+
+        /* the activation is applied before the affine */
+        if (param->activation >= 0)
+            return 0;
+
+        channel = param->output_channel;
+
+        if (weight == NULL || weight->dims[0] != channel)
+            return 0;
+    }
+    else
+    {
+        struct fc_param* param = ( struct fc_param* )node->op.param_mem;
+
+        if (param->activation >= 0)
+            return 0;
+
+        channel = param->num_output;
+        scale = get_input_tensor(graph, node, 3);
+
+        if (weight == NULL || weight->dim_num != 2)
+            return 0;
+
+        /* the fc kernels take the weight as [k, n] if it is not [n, k] */
+        trans = weight->dims[0] != channel;
+
+        if (trans && weight->dims[1] != channel)
+            return 0;
+    }
+
+    int fold_weight = scale == NULL && is_fp32_const(weight, -1) && weight->consumer_num == 1;
+
+    if (channel <= 0 || (!fold_weight && (!scalable || node->op.op_type != OP_FC)))
+        return 0;
+
+    if (bias != NULL && !is_fp32_const(bias, channel))
+        return 0;
+
+    if (scale != NULL && (!is_fp32_const(scale, channel) || scale->consumer_num != 1))
+        return 0;
+
+    float* k = ( float* )sys_malloc(sizeof(float) * channel * 2);
+    float* c = k + channel;
+
+    if (k == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    int ret;
+
+    if (next->op.op_type == OP_BATCHNORM)
+        ret = get_batchnorm_affine(graph, next, channel, k, c);
+    else if (next->op.op_type == OP_SCALE)
+        ret = get_scale_affine(graph, next, channel, k, c);
+    else
+        ret = get_eltwise_affine(graph, next, get_ir_graph_tensor(graph, node->output_tensors[0]), channel, k, c);
+
+    if (ret < 0)
+    {
+        sys_free(k);
+        return 0;
+    }
+
+    /* a bias shared with the other nodes is copied */
+    if (bias == NULL || bias->consumer_num != 1)
+    {
+        struct ir_tensor* new_bias = create_channel_tensor(graph, node, "bias", channel, bias ? bias->f32 : NULL, 0.f);
+
+        if (new_bias == NULL)
+            ret = -1;
+        else if (bias == NULL)
+            ret = set_ir_node_input_tensor(node, 2, new_bias);
+        else
+            ret = replace_node_input_tensor(graph, node, 2, new_bias);
+
+        if (ret < 0)
+        {
+            sys_free(k);
+            return -1;
+        }
+
+        bias = new_bias;
+    }
+
+    if (!fold_weight && scale == NULL)
+    {
+        scale = create_channel_tensor(graph, node, "scale", channel, NULL, 1.f);
+
+        if (scale == NULL || set_ir_node_input_tensor(node, 3, scale) < 0)
+        {
+            sys_free(k);
+            return -1;
+        }
+    }
+
+    /* the loaded weights may be mapped or shared, never written in place */
+    float* w = fold_weight ? ( float* )get_tensor_private_data(graph, weight)
+                           : ( float* )get_tensor_private_data(graph, scale);
+    float* b = ( float* )get_tensor_private_data(graph, bias);
+
+    if (w == NULL || b == NULL)
+    {
+        sys_free(k);
+        return -1;
+    }
+
+    if (fold_weight)
+    {
+        int weight_num = weight->elem_num;
+        int channel_size = weight_num / channel;
+
+        for (int i = 0; i < weight_num; i++)
+            w[i] *= k[trans ? i % channel : i / channel_size];
+    }
+    else
+    {
+        for (int i = 0; i < channel; i++)
+            w[i] *= k[i];
+    }
+
+    for (int i = 0; i < channel; i++)
+        b[i] = b[i] * k[i] + c[i];
+
+    sys_free(k);
+
+    if (fuse_graph_node(graph, node, next) < 0)
+        return -1;
+
+    return 1;
+}
+
+static int fold_bn_scale(struct ir_graph* graph, const struct options* opt)
+{
+    int node_num = graph->node_num;
+    int fold_num = 0;
+
+    /* only the cpu fc kernels take the scale */
+    int scalable = opt->precision == TENGINE_MODE_FP32 &&
+                   (graph->nn_dev == NULL || strcmp(graph->nn_dev->name, "cpu_dev") == 0);
+
+    /* the quantized weights carry their own scales */
+    if (graph->graph_layout != TENGINE_LAYOUT_NCHW ||
+        (opt->precision != TENGINE_MODE_FP32 && opt->precision != TENGINE_MODE_FP16 &&
+         opt->precision != TENGINE_MODE_HYBRID_INT8))
+        return 0;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, i);
+
+        if (node->removed || (node->op.op_type != OP_CONV && node->op.op_type != OP_FC) || node->output_num != 1)
+            continue;
+
+        /* conv -> batchnorm -> scale, or fc -> add -> mul, folds one by one */
+        while (1)
+        {
+            struct ir_tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+            if (output->consumer_num != 1 || is_graph_output_node(graph, node))
+                break;
+
+            struct ir_node* next = get_ir_graph_node(graph, output->consumer[0]);
+
+            int op_type = next->op.op_type;
+            int foldable;
+
+            if (op_type == OP_BATCHNORM || op_type == OP_SCALE)
+                foldable = next->input_tensors[0] == output->idx;
+            else
+                foldable = op_type == OP_ELTWISE && node->op.op_type == OP_FC;
+
+            if (!foldable || next->output_num != 1)
+                break;
+
+            int ret = fold_node(graph, node, next, scalable);
+
+            if (ret < 0)
+                return -1;
+
+            if (ret == 0)
+                break;
+
+            fold_num++;
+        }
+    }
+
+    return fold_num;
+}
+
+static int reg_fold_bn_scale(void* arg)
+{
+    return register_graph_pass("fold_bn_scale", GRAPH_OPT_ALL, GRAPH_PASS_FOLD_BN_SCALE, fold_bn_scale);
+}
+
+static int unreg_fold_bn_scale(void* arg)
+{
+    return unregister_graph_pass("fold_bn_scale");
+}
+
+REGISTER_MODULE_INIT(MOD_FUNC_LEVEL, "reg_fold_bn_scale", reg_fold_bn_scale);
+REGISTER_MODULE_EXIT(MOD_FUNC_LEVEL, "unreg_fold_bn_scale", unreg_fold_bn_scale);
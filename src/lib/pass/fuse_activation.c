@@ -0,0 +1,140 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_op.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "graph_pass.h"
+#include "convolution_param.h"
+#include "fc_param.h"
+#include "deconv_param.h"
+#include "relu_param.h"
+#include "clip_param.h"
+
+/* fuse the activation node following a convolution, a deconvolution or a fc into its activation param,
+   which the kernels apply to the output before it is stored. only relu and relu6 have the same meaning
+   in all kernels */
+
+static int get_activation(struct ir_node* node)
+{
+    switch (node->op.op_type)
+    {
+        case OP_RELU:
+        {
+            struct relu_param* param = ( struct relu_param* )node->op.param_mem;
+
+            return param->negative_slope == 0.f ? 0 : -1;
+        }
+        case OP_RELU6:
+            return 6;
+        case OP_CLIP:
+        {
+            struct clip_param* param = ( struct clip_param* )node->op.param_mem;
+
+            return (param->min == 0.f && param->max == 6.f) ? 6 : -1;
+        }
+        default:
+            return -1;
+    }
+}
+
+static int* get_activation_param(struct ir_node* node, const struct options* opt)
+{
+    /* the int8 conv of cmsis does not apply it */
+    if (node->op.op_type == OP_CONV && opt->precision != TENGINE_MODE_INT8)
+        return &(( struct conv_param* )node->op.param_mem)->activation;
+
+    /* nor the fc kernels of the other precisions */
+    if (node->op.op_type == OP_FC && opt->precision == TENGINE_MODE_FP32)
+        return &(( struct fc_param* )node->op.param_mem)->activation;
+
+    /* the deconv kernels are fp32 only */
+    if (node->op.op_type == OP_DECONV && opt->precision == TENGINE_MODE_FP32)
+        return &(( struct deconv_param* )node->op.param_mem)->activation;
+
+    return NULL;
+}
+
+static int fuse_activation(struct ir_graph* graph, const struct options* opt)
+{
+    int node_num = graph->node_num;
+    int fuse_num = 0;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, i);
+
+        if (node->removed || node->output_num != 1)
+            continue;
+
+        int* activation = get_activation_param(node, opt);
+
+        if (activation == NULL || *activation >= 0 || is_graph_output_node(graph, node))
+            continue;
+
+        struct ir_tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+        if (output->consumer_num != 1)
+            continue;
+
+        struct ir_node* next = get_ir_graph_node(graph, output->consumer[0]);
+
+        if (next->input_num != 1 || next->output_num != 1 || next->input_tensors[0] != output->idx)
+            continue;
+
+        int act_type = get_activation(next);
+
+        if (act_type < 0)
+            continue;
+
+        *activation = act_type;
+
+        if (fuse_graph_node(graph, node, next) < 0)
+            return -1;
+
+        fuse_num++;
+    }
+
+    return fuse_num;
+}
+
+static int reg_fuse_activation(void* arg)
+{
+    return register_graph_pass("fuse_activation", GRAPH_OPT_ALL, GRAPH_PASS_FUSE_ACTIVATION, fuse_activation);
+}
+
+static int unreg_fuse_activation(void* arg)
+{
+    return unregister_graph_pass("fuse_activation");
+}
+
+REGISTER_MODULE_INIT(MOD_FUNC_LEVEL, "reg_fuse_activation", reg_fuse_activation);
+REGISTER_MODULE_EXIT(MOD_FUNC_LEVEL, "unreg_fuse_activation", unreg_fuse_activation);
@@ -0,0 +1,182 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_op.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "nn_device.h"
+#include "graph_pass.h"
+#include "convolution_param.h"
+#include "pooling_param.h"
+#include "pad_param.h"
+#include "relu_param.h"
+#include "clip_param.h"
+
+/* fuse the constant zero pad of h and w before a convolution or a pooling into its pad fields, so that the
+   padded copy of the feature map is not made. the convolution takes any pads. the pooling skips its pads,
+   so only a max pooling of a non negative input, whose windows are never all pad, takes them. the cpu conv
+   kernels handle the asymmetric pads, the other devices may not, so the pass only runs on the cpu */
+
+static int is_zero_pad(struct pad_param* param)
+{
+    return param->mode == 0 && param->value == 0.f && param->pad_0_h == 0 && param->pad_0_w == 0 &&
+           param->pad_1_h == 0 && param->pad_1_w == 0 && param->pad_2_h >= 0 && param->pad_2_w >= 0 &&
+           param->pad_3_h >= 0 && param->pad_3_w >= 0;
+}
+
+/* the output of the producer is never negative */
+static int is_non_negative(struct ir_graph* graph, struct ir_tensor* tensor)
+{
+    if (tensor->producer < 0)
+        return 0;
+
+    struct ir_node* node = get_ir_graph_node(graph, tensor->producer);
+
+    switch (node->op.op_type)
+    {
+        case OP_RELU:
+            return (( struct relu_param* )node->op.param_mem)->negative_slope == 0.f;
+        case OP_RELU6:
+            return 1;
+        case OP_CLIP:
+            return (( struct clip_param* )node->op.param_mem)->min >= 0.f;
+        case OP_CONV:
+            return (( struct conv_param* )node->op.param_mem)->activation >= 0;
+        default:
+            return 0;
+    }
+}
+
+static int fuse_conv(struct conv_param* param, struct pad_param* pad)
+{
+    if (param->pad_h0 < 0 || param->pad_h1 < 0 || param->pad_w0 < 0 || param->pad_w1 < 0)
+        return 0;
+
+    param->pad_h0 += pad->pad_2_h;
+    param->pad_h1 += pad->pad_2_w;
+    param->pad_w0 += pad->pad_3_h;
+    param->pad_w1 += pad->pad_3_w;
+
+    return 1;
+}
+
+/* the pads of the pooling are inferred from pad_h0_org and pad_w0_org, which keep the output shape
+   only if the pads added are the same on both sides */
+static int fuse_pool(struct ir_graph* graph, struct pool_param* param, struct pad_param* pad, struct ir_tensor* input)
+{
+    if (param->pool_method != POOL_MAX || param->global || param->caffe_flavor != 0 ||
+        pad->pad_2_h != pad->pad_2_w || pad->pad_3_h != pad->pad_3_w || !is_non_negative(graph, input))
+        return 0;
+
+    int pad_h0 = param->pad_h0 + pad->pad_2_h;
+    int pad_h1 = param->pad_h1 + pad->pad_2_w;
+    int pad_w0 = param->pad_w0 + pad->pad_3_h;
+    int pad_w1 = param->pad_w1 + pad->pad_3_w;
+
+    /* a window all in the pads is zero before, and is not after */
+    if (param->pad_h0_org < 0 || param->pad_w0_org < 0 || pad_h0 >= param->kernel_h || pad_h1 >= param->kernel_h ||
+        pad_w0 >= param->kernel_w || pad_w1 >= param->kernel_w)
+        return 0;
+
+    param->pad_h0_org += pad->pad_2_h;
+    param->pad_w0_org += pad->pad_3_h;
+    param->pad_h0 = pad_h0;
+    param->pad_h1 = pad_h1;
+    param->pad_w0 = pad_w0;
+    param->pad_w1 = pad_w1;
+
+    return 1;
+}
+
+static int fuse_pad(struct ir_graph* graph, const struct options* opt)
+{
+    int node_num = graph->node_num;
+    int fuse_num = 0;
+
+    if (graph->nn_dev != NULL && strcmp(graph->nn_dev->name, "cpu_dev") != 0)
+        return 0;
+
+    if (graph->graph_layout != TENGINE_LAYOUT_NCHW)
+        return 0;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, i);
+
+        if (node->removed || node->op.op_type != OP_PAD || node->input_num != 1 || node->output_num != 1 ||
+            is_graph_output_node(graph, node) || !is_zero_pad(( struct pad_param* )node->op.param_mem))
+            continue;
+
+        struct ir_tensor* input = get_ir_graph_tensor(graph, node->input_tensors[0]);
+        struct ir_tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+        /* the quantized zero is the zero point */
+        if (input->data_type != TENGINE_DT_FP32 || input->dim_num != 4 || output->consumer_num != 1)
+            continue;
+
+        struct ir_node* next = get_ir_graph_node(graph, output->consumer[0]);
+
+        if (next->input_tensors[0] != output->idx)
+            continue;
+
+        struct pad_param* pad = ( struct pad_param* )node->op.param_mem;
+        int fused = 0;
+
+        if (next->op.op_type == OP_CONV)
+            fused = fuse_conv(( struct conv_param* )next->op.param_mem, pad);
+        else if (next->op.op_type == OP_POOL)
+            fused = fuse_pool(graph, ( struct pool_param* )next->op.param_mem, pad, input);
+
+        if (!fused)
+            continue;
+
+        if (replace_graph_tensor(graph, output, input) < 0 || remove_graph_node(graph, node) < 0)
+            return -1;
+
+        fuse_num++;
+    }
+
+    return fuse_num;
+}
+
+static int reg_fuse_pad(void* arg)
+{
+    return register_graph_pass("fuse_pad", GRAPH_OPT_BASIC, GRAPH_PASS_FUSE_PAD, fuse_pad);
+}
+
+static int unreg_fuse_pad(void* arg)
+{
+    return unregister_graph_pass("fuse_pad");
+}
+
+REGISTER_MODULE_INIT(MOD_FUNC_LEVEL, "reg_fuse_pad", reg_fuse_pad);
+REGISTER_MODULE_EXIT(MOD_FUNC_LEVEL, "unreg_fuse_pad", unreg_fuse_pad);
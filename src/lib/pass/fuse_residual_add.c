@@ -0,0 +1,180 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_op.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "nn_device.h"
+#include "graph_pass.h"
+#include "convolution_param.h"
+#include "eltwise_param.h"
+
+/* fuse the eltwise sum of a residual block into the convolution producing one of its inputs:
+   the other input becomes the 4th input of the convolution, added to the output before the activation.
+   the activation following the sum is fused by fuse_activation afterwards.
+   only the x86 fp32 and the reference conv kernels support it, the arm ones apply the activation inside
+   the sgemm tiles */
+
+#if defined(__x86_64__) || defined(__i386__)
+
+static int is_same_shape(struct ir_tensor* a, struct ir_tensor* b)
+{
+    if (a->dim_num != b->dim_num || a->elem_num != b->elem_num)
+        return 0;
+
+    for (int i = 0; i < a->dim_num; i++)
+    {
+        if (a->dims[i] != b->dims[i])
+            return 0;
+    }
+
+    return 1;
+}
+
+static int is_fusable_conv(struct ir_graph* graph, struct ir_tensor* tensor, struct ir_node* eltwise)
+{
+    if (tensor->producer < 0)
+        return 0;
+
+    struct ir_node* node = get_ir_graph_node(graph, tensor->producer);
+
+    if (node->removed || node->op.op_type != OP_CONV || node->input_num > 3 || node->output_num != 1 ||
+        is_graph_output_node(graph, node))
+        return 0;
+
+    struct conv_param* param = ( struct conv_param* )node->op.param_mem;
+
+    /* the activation must apply after the sum */
+    if (param->group != 1 || param->activation >= 0)
+        return 0;
+
+    struct ir_tensor* output = get_ir_graph_tensor(graph, node->output_tensors[0]);
+
+    return output->consumer_num == 1 && output->consumer[0] == eltwise->idx;
+}
+
+static int ensure_bias(struct ir_graph* graph, struct ir_node* node)
+{
+    if (node->input_num > 2 && node->input_tensors[2] >= 0)
+        return 0;
+
+    struct conv_param* param = ( struct conv_param* )node->op.param_mem;
+    int channel = param->output_channel;
+    char* name = ( char* )sys_malloc((node->name ? strlen(node->name) : 16) + 16);
+    struct ir_tensor* bias = NULL;
+
+    if (name != NULL)
+    {
+        if (node->name)
+            sprintf(name, "%s/bias", node->name);
+        else
+            sprintf(name, "node_%d/bias", node->idx);
+
+        bias = create_graph_const_tensor(graph, name, TENGINE_DT_FP32, &channel, 1);
+        sys_free(name);
+    }
+
+    if (bias == NULL || set_ir_node_input_tensor(node, 2, bias) < 0)
+        return -1;
+
+    return 0;
+}
+
+static int fuse_residual_add(struct ir_graph* graph, const struct options* opt)
+{
+    int node_num = graph->node_num;
+    int fuse_num = 0;
+
+    if (graph->nn_dev != NULL && strcmp(graph->nn_dev->name, "cpu_dev") != 0)
+        return 0;
+
+    if (graph->graph_layout != TENGINE_LAYOUT_NCHW || opt->precision != TENGINE_MODE_FP32)
+        return 0;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, i);
+
+        if (node->removed || node->op.op_type != OP_ELTWISE || node->input_num != 2 || node->output_num != 1)
+            continue;
+
+        struct eltwise_param* param = ( struct eltwise_param* )node->op.param_mem;
+
+        if (param->type != ELT_SUM || node->input_tensors[0] == node->input_tensors[1])
+            continue;
+
+        struct ir_tensor* input0 = get_ir_graph_tensor(graph, node->input_tensors[0]);
+        struct ir_tensor* input1 = get_ir_graph_tensor(graph, node->input_tensors[1]);
+
+        if (input0->data_type != TENGINE_DT_FP32 || input1->data_type != TENGINE_DT_FP32 ||
+            !is_same_shape(input0, input1))
+            continue;
+
+        /* either input may come from the conv, the sum is the same */
+        struct ir_tensor* residual = input1;
+
+        if (!is_fusable_conv(graph, input0, node))
+        {
+            residual = input0;
+
+            if (!is_fusable_conv(graph, input1, node))
+                continue;
+        }
+
+        struct ir_node* conv = get_ir_graph_node(graph, residual == input1 ? input0->producer : input1->producer);
+
+        if (ensure_bias(graph, conv) < 0 || set_ir_node_input_tensor(conv, 3, residual) < 0)
+            return -1;
+
+        if (fuse_graph_node(graph, conv, node) < 0)
+            return -1;
+
+        fuse_num++;
+    }
+
+    return fuse_num;
+}
+
+static int reg_fuse_residual_add(void* arg)
+{
+    return register_graph_pass("fuse_residual_add", GRAPH_OPT_ALL, GRAPH_PASS_FUSE_RESIDUAL_ADD, fuse_residual_add);
+}
+
+static int unreg_fuse_residual_add(void* arg)
+{
+    return unregister_graph_pass("fuse_residual_add");
+}
+
+REGISTER_MODULE_INIT(MOD_FUNC_LEVEL, "reg_fuse_residual_add", reg_fuse_residual_add);
+REGISTER_MODULE_EXIT(MOD_FUNC_LEVEL, "unreg_fuse_residual_add", unreg_fuse_residual_add);
+
+#endif
@@ -0,0 +1,139 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "tengine_op.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "graph_pass.h"
+#include "fc_param.h"
+
+/* turn the matmul of a 2d input and a const 2d matrix, a[m, k] x b[k, n], into a fc with the weight
+   b transposed to [n, k]. the fc kernels are faster, take the bias, and the add or the mul by a const
+   following it is then folded into the weight and the bias by fold_bn_scale */
+
+static int is_matmul_fc(struct ir_graph* graph, struct ir_node* node)
+{
+    if (node->removed || node->op.op_type != OP_MATMUL || node->input_num != 2 || node->output_num != 1)
+        return 0;
+
+    struct ir_tensor* input = get_ir_graph_tensor(graph, node->input_tensors[0]);
+    struct ir_tensor* matrix = get_ir_graph_tensor(graph, node->input_tensors[1]);
+
+    return input->data_type == TENGINE_DT_FP32 && input->dim_num == 2 && matrix->tensor_type == TENSOR_TYPE_CONST &&
+           matrix->data_type == TENGINE_DT_FP32 && matrix->data != NULL && matrix->dim_num == 2 &&
+           matrix->dims[0] == input->dims[1] && matrix->dims[1] > 0;
+}
+
+static int convert_node(struct ir_graph* graph, struct ir_node* node)
+{
+    struct ir_tensor* matrix = get_ir_graph_tensor(graph, node->input_tensors[1]);
+    int k = matrix->dims[0];
+    int n = matrix->dims[1];
+    int dims[2] = {n, k};
+
+    char* name = ( char* )sys_malloc((node->name ? strlen(node->name) : 16) + 16);
+
+    if (name == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    if (node->name)
+        sprintf(name, "%s/weight", node->name);
+    else
+        sprintf(name, "node_%d/weight", node->idx);
+
+    struct ir_tensor* weight = create_graph_const_tensor(graph, name, TENGINE_DT_FP32, dims, 2);
+
+    sys_free(name);
+
+    if (weight == NULL)
+        return -1;
+
+    const float* b = matrix->f32;
+    float* w = weight->f32;
+
+    for (int i = 0; i < n; i++)
+    {
+        for (int j = 0; j < k; j++)
+            w[i * k + j] = b[j * n + i];
+    }
+
+    if (replace_node_input_tensor(graph, node, 1, weight) < 0 || set_graph_node_op(graph, node, OP_FC, 1) < 0)
+        return -1;
+
+    struct fc_param* param = ( struct fc_param* )node->op.param_mem;
+
+    param->num_output = n;
+    param->activation = -1;
+
+    /* the passes after read the output shape, which the matmul does not infer right unless k == n */
+    return node->op.infer_shape(node) < 0 ? -1 : 1;
+}
+
+static int matmul_to_fc(struct ir_graph* graph, const struct options* opt)
+{
+    int node_num = graph->node_num;
+    int convert_num = 0;
+
+    if (opt->precision != TENGINE_MODE_FP32)
+        return 0;
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* node = get_ir_graph_node(graph, i);
+
+        if (!is_matmul_fc(graph, node))
+            continue;
+
+        if (convert_node(graph, node) < 0)
+            return -1;
+
+        convert_num++;
+    }
+
+    return convert_num;
+}
+
+static int reg_matmul_to_fc(void* arg)
+{
+    return register_graph_pass("matmul_to_fc", GRAPH_OPT_ALL, GRAPH_PASS_MATMUL_TO_FC, matmul_to_fc);
+}
+
+static int unreg_matmul_to_fc(void* arg)
+{
+    return unregister_graph_pass("matmul_to_fc");
+}
+
+REGISTER_MODULE_INIT(MOD_FUNC_LEVEL, "reg_matmul_to_fc", reg_matmul_to_fc);
+REGISTER_MODULE_EXIT(MOD_FUNC_LEVEL, "unreg_matmul_to_fc", unreg_matmul_to_fc);
@@ -42,6 +42,8 @@
 #include "nn_device.h"
 #include "tengine_utils.h"
 #include "tengine_serializer.h"
+#include "weight_cache.h"
+#include "graph_pass.h"
 
 typedef const char* const_char_t;
 typedef void* void_ptr_t;
@@ -232,11 +234,132 @@ error:
     return NULL;
 }
 
+/* the context of a session has the devices of the context of the graph, and never shares the memory arena
+   with the other graphs, so that the sessions could run at the same time */
+static struct exec_context* create_session_context(struct exec_context* context)
+{
+    struct exec_context* session_context = ( struct exec_context* )create_context(NULL, 1);
+
+    if (session_context == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    session_context->scheduler = context->scheduler;
+    session_context->dev_allocator = context->dev_allocator;
+    session_context->def_dev = context->def_dev;
+
+    for (int i = 0; i < get_vector_num(context->dev_list); i++)
+        push_vector_data(session_context->dev_list, get_vector_data(context->dev_list, i));
+
+    return session_context;
+}
+
+/* the sessions share their packed weights. they share them with the graph as well if it shares its own,
+   or else under a key of the graph, as the passes could make its weights differ from the other graphs
+   loaded from the model */
+static int share_session_weights(struct ir_graph* session, struct ir_graph* graph)
+{
+    const char* dir = NULL;
+    int share = 0;
+
+    if (graph->model_key != NULL &&
+        ((get_attr_val(graph->attr_mem, graph->attr_num, GRAPH_ATTR_SHARE_WEIGHTS, NULL, &share, sizeof(int)) == 0 &&
+          share) ||
+         (get_attr_val(graph->attr_mem, graph->attr_num, GRAPH_ATTR_WEIGHT_CACHE_DIR, NULL, &dir,
+                       sizeof(const char*)) == 0 &&
+          dir != NULL)))
+    {
+        session->model_key = strdup(graph->model_key);
+    }
+    else
+    {
+        char key[64];
+
+        snprintf(key, sizeof(key), "graph:%p", graph);
+        session->model_key = strdup(key);
+    }
+
+    if (session->model_key == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    share = 1;
+
+    return set_graph_attr(session, GRAPH_ATTR_SHARE_WEIGHTS, &share, sizeof(int));
+}
+
+graph_t DLLEXPORT create_graph_session(graph_t graph)
+{
+    struct ir_graph* ir_graph = ( struct ir_graph* )graph;
+
+    if (ir_graph->parent != NULL)
+        ir_graph = ir_graph->parent;
+
+    /* the sessions take the nodes optimized by the prerun */
+    int status = get_graph_status(ir_graph);
+
+    if (status == GRAPH_STAT_CREATED || status == GRAPH_STAT_ERROR)
+    {
+        TLOG_ERR("create_graph_session: the graph is not prerun\n");
+        set_tengine_errno(EINVAL);
+        return NULL;
+    }
+
+    struct exec_context* context = create_session_context(get_ir_graph_context(ir_graph));
+
+    if (context == NULL)
+        return NULL;
+
+    struct ir_graph* session = create_ir_graph_session(ir_graph, context);
+
+    if (session == NULL)
+    {
+        destroy_context(context);
+        return NULL;
+    }
+
+    session->exec_attr->priv_context = 1;
+
+    if (share_session_weights(session, ir_graph) < 0)
+    {
+        destroy_graph(session);
+        return NULL;
+    }
+
+    return session;
+}
+
 int DLLEXPORT save_graph(graph_t graph, const char* model_format, const char* fname, ...)
 {
-    // TODO: save graph as tengine model
-    set_tengine_errno(ENOTSUP);
-    return -1;
+    struct ir_graph* ir_graph = ( struct ir_graph* )graph;
+    struct serializer* saver = find_serializer(model_format);
+
+    if (saver == NULL)
+    {
+        TLOG_ERR("no serializer found for %s\n", model_format);
+        set_tengine_errno(ENOENT);
+        return -1;
+    }
+
+    if (saver->save_model == NULL)
+    {
+        TLOG_ERR("%s serializer does not support save model\n", saver->get_name(saver));
+        set_tengine_errno(ENOTSUP);
+        return -1;
+    }
+
+    va_list ap;
+    va_start(ap, fname);
+
+    int ret = saver->save_model(saver, ir_graph, fname, ap);
+
+    va_end(ap);
+
+    return ret;
 }
 
 int DLLEXPORT set_graph_layout(graph_t graph, int layout_type)
@@ -333,6 +456,25 @@ graph_t DLLEXPORT merge_graph(int graph_num, graph_t graph0, graph_t graph1, ...
 int DLLEXPORT destroy_graph(graph_t graph)
 {
     struct ir_graph* ir_graph = ( struct ir_graph* )graph;
+    struct exec_scheduler* scheduler = get_ir_graph_context(ir_graph)->scheduler;
+
+    /* the sessions still use the nodes and the weights */
+#ifndef CONFIG_BAREMETAL_BUILD
+    int session_num = __atomic_load_n(&ir_graph->session_num, __ATOMIC_ACQUIRE);
+#else
+    int session_num = ir_graph->session_num;
+#endif
+
+    if (session_num > 0)
+    {
+        TLOG_ERR("destroy_graph: %d sessions of the graph are not destroyed\n", session_num);
+        set_tengine_errno(EBUSY);
+        return -1;
+    }
+
+    /* the run in flight still uses the graph */
+    if (scheduler->release_graph)
+        scheduler->release_graph(scheduler, ir_graph);
 
     if (ir_graph->exec_attr->priv_context)
         destroy_context(ir_graph->exec_attr->exec_context);
@@ -973,6 +1115,11 @@ int set_graph_thread_mask(graph_t graph, size_t cpu_mask)
 int DLLEXPORT prerun_graph(graph_t graph)
 {
     struct ir_graph* ir_graph = ( struct ir_graph* )graph;
+    struct options opt;
+
+    opt.num_thread = 1;
+    opt.cluster = TENGINE_CLUSTER_BIG;
+    opt.precision = TENGINE_MODE_FP32;
 
     if (infer_shape_graph(ir_graph) < 0)
     {
@@ -981,6 +1128,13 @@ int DLLEXPORT prerun_graph(graph_t graph)
         return -1;
     }
 
+    if (run_graph_passes(ir_graph, &opt) < 0)
+    {
+        ir_graph->status = GRAPH_STAT_ERROR;
+        fprintf(stderr, "run_graph_passes failed\n");
+        return -1;
+    }
+
     struct exec_context* context = get_ir_graph_context(ir_graph);
 
     struct dev_allocator* allocator = context->dev_allocator;
@@ -994,7 +1148,7 @@ int DLLEXPORT prerun_graph(graph_t graph)
 
     struct exec_scheduler* scheduler = context->scheduler;
 
-    if (scheduler->prerun(scheduler, ir_graph, 1, TENGINE_CLUSTER_BIG, TENGINE_MODE_FP32) < 0)
+    if (scheduler->prerun(scheduler, ir_graph, opt.num_thread, opt.cluster, opt.precision) < 0)
     {
         ir_graph->status = GRAPH_STAT_ERROR;
         fprintf(stderr, "scheduler->prerun failed\n");
@@ -1023,6 +1177,13 @@ int DLLEXPORT prerun_graph_multithread(graph_t graph, struct options opt)
         return -1;
     }
 
+    if (run_graph_passes(ir_graph, &opt) < 0)
+    {
+        ir_graph->status = GRAPH_STAT_ERROR;
+        fprintf(stderr, "run_graph_passes failed\n");
+        return -1;
+    }
+
     struct exec_context* context = get_ir_graph_context(ir_graph);
     struct dev_allocator* allocator = context->dev_allocator;
     if (allocator->allocate(allocator, ir_graph) < 0)
@@ -1052,20 +1213,14 @@ int DLLEXPORT run_graph(graph_t graph, int block)
     struct exec_context* context = get_ir_graph_context(ir_graph);
     struct exec_scheduler* scheduler = context->scheduler;
 
-    ir_graph->status = GRAPH_STAT_RUNNING;
-
-    if (scheduler->run(scheduler, ir_graph, block) < 0)
+    /* the scheduler sets the status, a run with block 0 is still running when it returns */
+    if (get_graph_status(ir_graph) == GRAPH_STAT_RUNNING)
     {
-        ir_graph->status = GRAPH_STAT_ERROR;
+        set_tengine_errno(EBUSY);
         return -1;
     }
-    else
-    {
-        if (block)
-            ir_graph->status = GRAPH_STAT_READY;
-    }
 
-    return 0;
+    return scheduler->run(scheduler, ir_graph, block);
 }
 
 int DLLEXPORT wait_graph(graph_t graph, int try_wait)
@@ -1073,23 +1228,44 @@ int DLLEXPORT wait_graph(graph_t graph, int try_wait)
     struct ir_graph* ir_graph = ( struct ir_graph* )graph;
     struct exec_context* context = get_ir_graph_context(ir_graph);
     struct exec_scheduler* scheduler = context->scheduler;
+    int status = get_graph_status(ir_graph);
 
-    if (ir_graph->status != GRAPH_STAT_RUNNING || ir_graph->status != GRAPH_STAT_READY)
+    if (status != GRAPH_STAT_READY && status != GRAPH_STAT_ERROR && status != GRAPH_STAT_RUNNING)
     {
         set_tengine_errno(EINVAL);
         return -1;
     }
 
-    if (ir_graph->status == GRAPH_STAT_READY)
-        return 0;
+    /* the graph is ready before the hook of done returns, the scheduler waits for the hook too */
+    return scheduler->wait(scheduler, ir_graph, try_wait);
+}
+
+int DLLEXPORT get_graph_exec_status(graph_t graph)
+{
+    struct ir_graph* ir_graph = ( struct ir_graph* )graph;
+
+    return get_graph_status(ir_graph);
+}
+
+int DLLEXPORT set_graph_event_hook(graph_t graph, int event, event_handler_t cb_func, void* cb_arg)
+{
+    struct ir_graph* ir_graph = ( struct ir_graph* )graph;
+    struct exec_context* context = get_ir_graph_context(ir_graph);
+
+    /* a run is never suspended */
+    if (event != GRAPH_EXEC_START && event != GRAPH_EXEC_DONE && event != GRAPH_EXEC_ABORT)
+    {
+        set_tengine_errno(ENOTSUP);
+        return -1;
+    }
 
-    if (!try_wait)
+    if (get_graph_status(ir_graph) == GRAPH_STAT_RUNNING)
     {
-        set_tengine_errno(EAGAIN);
+        set_tengine_errno(EBUSY);
         return -1;
     }
 
-    return scheduler->wait(scheduler, ir_graph);
+    return context->scheduler->set_hook(context->scheduler, ir_graph, event, cb_func, cb_arg);
 }
 
 int DLLEXPORT postrun_graph(graph_t graph)
@@ -1114,6 +1290,76 @@ void DLLEXPORT dump_graph(graph_t graph)
     dump_ir_graph(graph);
 }
 
+int DLLEXPORT get_graph_mem_plan(graph_t graph, struct mem_plan_summary* summary, struct mem_plan_tensor* tensors,
+                                 int max_num)
+{
+    struct ir_graph* ir_graph = ( struct ir_graph* )graph;
+    int subgraph_num = get_vector_num(ir_graph->subgraph_list);
+    int total_num = 0;
+
+    if (summary)
+        memset(summary, 0, sizeof(struct mem_plan_summary));
+
+    if (tensors == NULL || max_num < 0)
+        max_num = 0;
+
+    for (int i = 0; i < subgraph_num; i++)
+    {
+        struct subgraph* subgraph = get_ir_graph_subgraph(ir_graph, i);
+        struct nn_device* nn_dev = subgraph->nn_dev;
+        struct mem_plan_summary sub_summary;
+
+        if (nn_dev == NULL || nn_dev->get_mem_plan == NULL)
+            continue;
+
+        if (subgraph->exec_graph == NULL)
+        {
+            TLOG_ERR("get memory plan: graph is not prerun\n");
+            set_tengine_errno(EINVAL);
+            return -1;
+        }
+
+        int left = max_num > total_num ? max_num - total_num : 0;
+        int num = nn_dev->get_mem_plan(nn_dev, subgraph, &sub_summary, left > 0 ? tensors + total_num : NULL, left);
+
+        if (num < 0)
+            return -1;
+
+        total_num += num;
+
+        if (summary)
+        {
+            summary->tensor_num += sub_summary.tensor_num;
+            summary->block_num += sub_summary.block_num;
+            summary->arena_size += sub_summary.arena_size;
+            summary->private_size += sub_summary.private_size;
+            summary->shared_mem_size += sub_summary.shared_mem_size;
+            summary->shared_pack4_mem_size += sub_summary.shared_pack4_mem_size;
+            summary->total_size += sub_summary.total_size;
+        }
+    }
+
+    return total_num;
+}
+
+int DLLEXPORT get_weight_cache_stat(struct weight_cache_stat* stat)
+{
+    int hit_num, miss_num;
+
+    if (stat == NULL)
+    {
+        set_tengine_errno(EINVAL);
+        return -1;
+    }
+
+    get_persist_weight_stat(&hit_num, &miss_num, &stat->saved_time, &stat->fill_time);
+
+    stat->hit_num = hit_num;
+    stat->miss_num = miss_num;
+
+    return 0;
+}
+
 const_char_t DLLEXPORT get_node_device(node_t node)
 {
     struct ir_node* ir_node = ( struct ir_node* )node;
@@ -1142,6 +1388,8 @@ context_t DLLEXPORT create_context(const char* context_name, int empty_context)
     context->dev_allocator = get_default_dev_allocator();
     context->def_dev = get_default_nn_device();
     context->dev_list = create_vector(sizeof(struct nn_device*), NULL);
+    context->share_mem_arena = 0;
+    context->mem_arena = NULL;
 
     if (!empty_context)
     {
@@ -1166,6 +1414,16 @@ void DLLEXPORT destroy_context(context_t context)
     if (exec_context->name)
         sys_free(exec_context->name);
 
+    /* the arena memory is released by the device with its last graph */
+    if (exec_context->mem_arena)
+    {
+        if (exec_context->mem_arena->ref_count > 0)
+            TLOG_ERR("context destroyed while %d graphs still use its memory arena\n",
+                     exec_context->mem_arena->ref_count);
+        else
+            sys_free(exec_context->mem_arena);
+    }
+
     sys_free(exec_context);
 }
 
@@ -1269,14 +1527,65 @@ int DLLEXPORT remove_context_device(context_t context, const char* dev_name)
 
 int DLLEXPORT set_context_attr(context_t context, const char* attr_name, const void* val, int val_size)
 {
-    set_tengine_errno(ENOTSUP);
-    return -1;
+    struct exec_context* exec_context = ( struct exec_context* )context;
+
+    if (attr_name == NULL || strcmp(attr_name, CONTEXT_ATTR_SHARE_MEM_ARENA) != 0)
+    {
+        set_tengine_errno(ENOTSUP);
+        return -1;
+    }
+
+    if (val == NULL || val_size != sizeof(int))
+    {
+        set_tengine_errno(EINVAL);
+        return -1;
+    }
+
+    int share = *( const int* )val;
+
+    if (share && exec_context->mem_arena == NULL)
+    {
+        struct shared_mem_arena* arena = ( struct shared_mem_arena* )sys_malloc(sizeof(struct shared_mem_arena));
+
+        if (arena == NULL)
+        {
+            set_tengine_errno(ENOMEM);
+            return -1;
+        }
+
+        arena->mem = NULL;
+        arena->mem_size = 0;
+        arena->ref_count = 0;
+        arena->generation = 0;
+
+        exec_context->mem_arena = arena;
+    }
+
+    /* graphs already prerun keep the arena they got */
+    exec_context->share_mem_arena = share ? 1 : 0;
+
+    return 0;
 }
 
 int DLLEXPORT get_context_attr(context_t context, const char* attr_name, void* val, int val_size)
 {
-    set_tengine_errno(ENOTSUP);
-    return -1;
+    struct exec_context* exec_context = ( struct exec_context* )context;
+
+    if (attr_name == NULL || strcmp(attr_name, CONTEXT_ATTR_SHARE_MEM_ARENA) != 0)
+    {
+        set_tengine_errno(ENOTSUP);
+        return -1;
+    }
+
+    if (val == NULL || val_size != sizeof(int))
+    {
+        set_tengine_errno(EINVAL);
+        return -1;
+    }
+
+    *( int* )val = exec_context->share_mem_arena;
+
+    return 0;
 }
 
 int DLLEXPORT clr_tengine_errno()
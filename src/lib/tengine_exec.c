@@ -38,6 +38,14 @@ void init_exec_attr(struct exec_attr* attr, struct exec_context* context)
     attr->fc_mt = 0;
     attr->pool_mt = 0;
     attr->exec_context = context;
+    attr->sched_priv = NULL;
+    attr->allocator_priv = NULL;
+
+    for (int i = 0; i <= GRAPH_EXEC_DONE; i++)
+    {
+        attr->event_hook[i] = NULL;
+        attr->event_arg[i] = NULL;
+    }
 }
 
 void destroy_exec_attr(struct ir_graph* g, struct exec_attr* attr)
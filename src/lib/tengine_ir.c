@@ -74,6 +74,8 @@ void init_ir_graph(struct ir_graph* g, struct exec_context* context)
     g->output_num = 0;
 
     g->subgraph_list = create_vector(sizeof(struct subgraph*), NULL);
+    g->pass_stat_list = NULL;
+    g->pass_checkpoint = NULL;
 
     g->attr_num = 0;
     g->attr_mem = NULL;
@@ -86,7 +88,10 @@ void init_ir_graph(struct ir_graph* g, struct exec_context* context)
     g->dev_priv = NULL;
     g->serializer_priv = NULL;
     g->serializer = NULL;
+    g->model_key = NULL;
     g->status = GRAPH_STAT_CREATED;
+    g->parent = NULL;
+    g->session_num = 0;
 
     init_exec_attr(g->exec_attr, context);
 }
@@ -103,6 +108,9 @@ void destroy_ir_graph(struct ir_graph* g)
 
     release_vector(g->subgraph_list);
 
+    if (g->pass_stat_list)
+        release_vector(g->pass_stat_list);
+
     if (serializer && serializer->unload_graph)
         serializer->unload_graph(serializer, g, g->serializer_priv, g->dev_priv);
 
@@ -125,9 +133,190 @@ void destroy_ir_graph(struct ir_graph* g)
     if (g->exec_attr)
         destroy_exec_attr(g, g->exec_attr);
 
+    free(g->model_key);
+
+    if (g->parent)
+    {
+#ifndef CONFIG_BAREMETAL_BUILD
+        __atomic_fetch_sub(&g->parent->session_num, 1, __ATOMIC_ACQ_REL);
+#else
+        g->parent->session_num--;
+#endif
+    }
+
     sys_free(g);
 }
 
+static int copy_session_node(struct ir_graph* session, struct ir_node* node)
+{
+    struct ir_node* new_node = ( struct ir_node* )sys_malloc(sizeof(struct ir_node));
+
+    if (new_node == NULL)
+        return -1;
+
+    /* the node is complete enough to be destroyed with the session on error */
+    *new_node = *node;
+    new_node->graph = session;
+    new_node->name = NULL;
+    new_node->input_tensors = NULL;
+    new_node->output_tensors = NULL;
+    new_node->attr_mem = NULL;
+    new_node->op.param_mem = NULL;
+
+    session->node_list[session->node_num++] = new_node;
+
+    if (node->name && (new_node->name = strdup(node->name)) == NULL)
+        return -1;
+
+    if (node->input_num)
+    {
+        new_node->input_tensors = ( int16_t* )sys_malloc(sizeof(int16_t) * node->input_num);
+
+        if (new_node->input_tensors == NULL)
+            return -1;
+
+        memcpy(new_node->input_tensors, node->input_tensors, sizeof(int16_t) * node->input_num);
+    }
+
+    if (node->output_num)
+    {
+        new_node->output_tensors = ( int16_t* )sys_malloc(sizeof(int16_t) * node->output_num);
+
+        if (new_node->output_tensors == NULL)
+            return -1;
+
+        memcpy(new_node->output_tensors, node->output_tensors, sizeof(int16_t) * node->output_num);
+    }
+
+    if (node->attr_num && (new_node->attr_mem = copy_all_attr(node->attr_mem, node->attr_num)) == NULL)
+        return -1;
+
+    if (node->op.param_mem)
+    {
+        new_node->op.param_mem = sys_malloc(node->op.param_size);
+
+        if (new_node->op.param_mem == NULL)
+            return -1;
+
+        memcpy(new_node->op.param_mem, node->op.param_mem, node->op.param_size);
+    }
+
+    return 0;
+}
+
+static int copy_session_tensor(struct ir_graph* session, struct ir_tensor* tensor)
+{
+    struct ir_tensor* new_tensor = ( struct ir_tensor* )sys_malloc(sizeof(struct ir_tensor));
+
+    if (new_tensor == NULL)
+        return -1;
+
+    *new_tensor = *tensor;
+    new_tensor->name = NULL;
+    new_tensor->subgraph_num = 0;
+    new_tensor->subgraph_list = NULL;
+    new_tensor->dev_mem = NULL;
+    new_tensor->free_host_mem = 0;
+
+    /* only the const data is shared, the others are bound by the prerun of the session */
+    if (tensor->tensor_type != TENSOR_TYPE_CONST)
+    {
+        new_tensor->data = NULL;
+        new_tensor->internal_allocated = 1;
+    }
+
+    if (tensor->quant_param_num > 1)
+    {
+        new_tensor->scale_list = NULL;
+        new_tensor->zp_list = NULL;
+    }
+
+    session->tensor_list[session->tensor_num++] = new_tensor;
+
+    if (tensor->name && (new_tensor->name = strdup(tensor->name)) == NULL)
+        return -1;
+
+    if (tensor->quant_param_num > 1)
+    {
+        new_tensor->scale_list = ( float* )sys_malloc(sizeof(float) * tensor->quant_param_num);
+        new_tensor->zp_list = ( int* )sys_malloc(sizeof(int) * tensor->quant_param_num);
+
+        if (new_tensor->scale_list == NULL || new_tensor->zp_list == NULL)
+            return -1;
+
+        memcpy(new_tensor->scale_list, tensor->scale_list, sizeof(float) * tensor->quant_param_num);
+        memcpy(new_tensor->zp_list, tensor->zp_list, sizeof(int) * tensor->quant_param_num);
+    }
+
+    return 0;
+}
+
+struct ir_graph* create_ir_graph_session(struct ir_graph* graph, struct exec_context* context)
+{
+    struct ir_graph* session = create_ir_graph(context);
+
+    if (session == NULL)
+        return NULL;
+
+    session->parent = graph;
+    session->graph_layout = graph->graph_layout;
+    session->model_layout = graph->model_layout;
+    session->model_format = graph->model_format;
+    session->nn_dev = graph->nn_dev;
+    session->dev_priv = graph->dev_priv;
+
+    /* counted from here, as the session is destroyed as one on error */
+#ifndef CONFIG_BAREMETAL_BUILD
+    __atomic_fetch_add(&graph->session_num, 1, __ATOMIC_ACQ_REL);
+#else
+    graph->session_num++;
+#endif
+
+    session->node_list = ( struct ir_node** )sys_malloc(sizeof(struct ir_node*) * (graph->node_num + 1));
+    session->tensor_list = ( struct ir_tensor** )sys_malloc(sizeof(struct ir_tensor*) * (graph->tensor_num + 1));
+    session->input_nodes = ( int16_t* )sys_malloc(sizeof(int16_t) * (graph->input_num + 1));
+    session->output_nodes = ( int16_t* )sys_malloc(sizeof(int16_t) * (graph->output_num + 1));
+
+    if (session->node_list == NULL || session->tensor_list == NULL || session->input_nodes == NULL ||
+        session->output_nodes == NULL)
+        goto error;
+
+    for (int i = 0; i < graph->node_num; i++)
+    {
+        if (copy_session_node(session, get_ir_graph_node(graph, i)) < 0)
+            goto error;
+    }
+
+    for (int i = 0; i < graph->tensor_num; i++)
+    {
+        if (copy_session_tensor(session, get_ir_graph_tensor(graph, i)) < 0)
+            goto error;
+    }
+
+    memcpy(session->input_nodes, graph->input_nodes, sizeof(int16_t) * graph->input_num);
+    memcpy(session->output_nodes, graph->output_nodes, sizeof(int16_t) * graph->output_num);
+    session->input_num = graph->input_num;
+    session->output_num = graph->output_num;
+
+    if (graph->attr_num)
+    {
+        session->attr_mem = copy_all_attr(graph->attr_mem, graph->attr_num);
+
+        if (session->attr_mem == NULL)
+            goto error;
+
+        session->attr_num = graph->attr_num;
+    }
+
+    return session;
+
+error:
+    set_tengine_errno(ENOMEM);
+    destroy_ir_graph(session);
+
+    return NULL;
+}
+
 int set_ir_graph_input_node(struct ir_graph* ir_graph, int16_t input_nodes[], int input_number)
 {
     int16_t* new_input_nodes = ( int16_t* )sys_malloc(input_number * sizeof(int16_t));
@@ -339,6 +528,7 @@ static void init_ir_node(struct ir_node* node, int op_type, int op_version, int
     node->op.infer_shape = NULL;
     node->attr_mem = NULL;
     node->subgraph_idx = -1;
+    node->removed = 0;
 }
 
 struct ir_node* create_ir_node(struct ir_graph* ir_graph, const char* node_name, int op_type, int op_version)
@@ -402,6 +592,14 @@ void destroy_ir_node(struct ir_graph* ir_graph, struct ir_node* node)
     if (node->output_num)
         sys_free(node->output_tensors);
 
+    /* the buffers the params of a session point to belong to its graph */
+    if (ir_graph->parent)
+    {
+        sys_free(node->op.param_mem);
+        sys_free(node);
+        return;
+    }
+
     struct op_method* m = find_op_method(node->op.op_type, node->op.op_version);
 
     if (m && m->release_op)
@@ -561,6 +759,7 @@ void init_ir_tensor(struct ir_tensor* tensor, int tensor_idx, int data_type)
     tensor->subgraph_num = 0;
     tensor->free_host_mem = 0;
     tensor->internal_allocated = 1;
+    tensor->removed = 0;
     tensor->quant_param_num = 0;
     tensor->elem_num = 0;
 
@@ -839,6 +1038,25 @@ struct ir_attr* add_new_attr(struct ir_attr* attr_mem, int attr_num, const char*
 
     struct ir_attr* new_attr = sys_realloc(attr_mem, mem_size + new_attr_size);
 
+    if (new_attr == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    /* the names point into the block, which may have moved */
+    p_attr = new_attr;
+
+    for (int i = 0; i < attr_num; i++)
+    {
+        p_attr->attr_name = ( char* )(p_attr + 1) + p_attr->data_size;
+
+        if (p_attr->type_name != NULL)
+            p_attr->type_name = p_attr->attr_name + strlen(p_attr->attr_name) + 1;
+
+        p_attr = get_next_attr(p_attr);
+    }
+
     p_attr = ( struct ir_attr* )(( char* )new_attr + mem_size);
 
     char* mem_block = ( char* )(p_attr + 1);
@@ -963,3 +1181,28 @@ void remove_all_attr(struct ir_attr* attr_mem, int attr_num)
 {
     sys_free(attr_mem);
 }
+
+struct ir_attr* copy_all_attr(struct ir_attr* attr_mem, int attr_num)
+{
+    struct ir_attr* p_attr = attr_mem;
+    struct ir_attr* new_attr_mem = NULL;
+
+    for (int i = 0; i < attr_num; i++)
+    {
+        struct ir_attr* new_mem = add_new_attr(new_attr_mem, i, p_attr->attr_name, p_attr->type_name, p_attr->data_size);
+
+        if (new_mem == NULL)
+        {
+            sys_free(new_attr_mem);
+            return NULL;
+        }
+
+        new_attr_mem = new_mem;
+
+        set_attr_val(new_attr_mem, i + 1, p_attr->attr_name, p_attr->type_name, p_attr + 1, p_attr->data_size);
+
+        p_attr = get_next_attr(p_attr);
+    }
+
+    return new_attr_mem;
+}
@@ -0,0 +1,311 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+#include <string.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "cpu.h"
+#include "thread_pool.h"
+
+#ifndef CONFIG_BAREMETAL_BUILD
+
+#include <pthread.h>
+#include <sched.h>
+
+#if defined(__i386__) || defined(__x86_64__)
+#define cpu_relax() __builtin_ia32_pause()
+#elif defined(__aarch64__) || defined(__arm__)
+#define cpu_relax() __asm__ __volatile__("yield" ::: "memory")
+#else
+#define cpu_relax()
+#endif
+
+/* about a millisecond, the gap between two nodes is far shorter */
+#define THREAD_POOL_SPIN_COUNT 20000
+
+struct pool_worker
+{
+    struct thread_pool* pool;
+    int idx;
+    pthread_t thread;
+};
+
+struct thread_pool
+{
+    int num_thread;
+    int worker_num;
+    int spin_count;
+    size_t cpu_mask;
+
+    /* the current loop, published to the workers by a new generation */
+    thread_pool_func_t func;
+    void* arg;
+    int task_num;
+
+    int generation;
+    int pending;
+    int stop;
+
+    pthread_mutex_t mutex;
+    pthread_cond_t cond;
+
+    struct pool_worker* workers;
+};
+
+/* set in the workers, and in the caller while it runs its part */
+static __thread int in_pool_task;
+
+static void run_range(struct thread_pool* pool, int thread_idx)
+{
+    int start = ( int )(( long )pool->task_num * thread_idx / pool->num_thread);
+    int end = ( int )(( long )pool->task_num * (thread_idx + 1) / pool->num_thread);
+
+    for (int i = start; i < end; i++)
+        pool->func(pool->arg, i);
+}
+
+static int wait_generation(struct thread_pool* pool, int seen)
+{
+    for (int i = 0; i < pool->spin_count; i++)
+    {
+        int generation = __atomic_load_n(&pool->generation, __ATOMIC_ACQUIRE);
+
+        if (generation != seen)
+            return generation;
+
+        cpu_relax();
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+
+    while (pool->generation == seen)
+        pthread_cond_wait(&pool->cond, &pool->mutex);
+
+    int generation = pool->generation;
+
+    pthread_mutex_unlock(&pool->mutex);
+
+    return generation;
+}
+
+static void* worker_main(void* arg)
+{
+    struct pool_worker* worker = ( struct pool_worker* )arg;
+    struct thread_pool* pool = worker->pool;
+    int seen = 0;
+
+    set_cpu_affine(pool->cpu_mask);
+
+    in_pool_task = 1;
+
+    while (1)
+    {
+        seen = wait_generation(pool, seen);
+
+        if (__atomic_load_n(&pool->stop, __ATOMIC_ACQUIRE))
+            break;
+
+        run_range(pool, worker->idx);
+
+        __atomic_fetch_sub(&pool->pending, 1, __ATOMIC_RELEASE);
+    }
+
+    return NULL;
+}
+
+static void publish_generation(struct thread_pool* pool)
+{
+    pthread_mutex_lock(&pool->mutex);
+    __atomic_store_n(&pool->generation, pool->generation + 1, __ATOMIC_RELEASE);
+    pthread_cond_broadcast(&pool->cond);
+    pthread_mutex_unlock(&pool->mutex);
+}
+
+static void stop_workers(struct thread_pool* pool)
+{
+    __atomic_store_n(&pool->stop, 1, __ATOMIC_RELEASE);
+    publish_generation(pool);
+
+    for (int i = 0; i < pool->worker_num; i++)
+        pthread_join(pool->workers[i].thread, NULL);
+
+    pool->worker_num = 0;
+}
+
+struct thread_pool* create_thread_pool(int num_thread, int cluster)
+{
+    struct thread_pool* pool = ( struct thread_pool* )sys_malloc(sizeof(struct thread_pool));
+
+    if (pool == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    memset(pool, 0, sizeof(struct thread_pool));
+
+    if (num_thread < 1)
+        num_thread = 1;
+
+    pool->num_thread = num_thread;
+    pool->cpu_mask = get_cluster_mask(cluster);
+
+    /* the spinning workers would take the cpus from the caller */
+    pool->spin_count = num_thread <= get_mask_count(pool->cpu_mask) ? THREAD_POOL_SPIN_COUNT : 0;
+
+    pthread_mutex_init(&pool->mutex, NULL);
+    pthread_cond_init(&pool->cond, NULL);
+
+    if (num_thread == 1)
+        return pool;
+
+    pool->workers = ( struct pool_worker* )sys_malloc(sizeof(struct pool_worker) * (num_thread - 1));
+
+    if (pool->workers == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        destroy_thread_pool(pool);
+        return NULL;
+    }
+
+    for (int i = 0; i < num_thread - 1; i++)
+    {
+        struct pool_worker* worker = pool->workers + i;
+
+        worker->pool = pool;
+        worker->idx = i + 1;
+
+        if (pthread_create(&worker->thread, NULL, worker_main, worker) != 0)
+        {
+            TLOG_ERR("thread pool: failed to start worker %d of %d\n", i + 1, num_thread);
+            set_tengine_errno(EAGAIN);
+            destroy_thread_pool(pool);
+            return NULL;
+        }
+
+        pool->worker_num++;
+    }
+
+    return pool;
+}
+
+void destroy_thread_pool(struct thread_pool* pool)
+{
+    if (pool == NULL)
+        return;
+
+    stop_workers(pool);
+
+    pthread_mutex_destroy(&pool->mutex);
+    pthread_cond_destroy(&pool->cond);
+
+    sys_free(pool->workers);
+    sys_free(pool);
+}
+
+int get_thread_pool_size(struct thread_pool* pool)
+{
+    return pool ? pool->num_thread : 1;
+}
+
+void thread_pool_parallel_for(struct thread_pool* pool, int num, thread_pool_func_t func, void* arg)
+{
+    if (num <= 0)
+        return;
+
+    if (pool == NULL || pool->worker_num == 0 || num == 1 || in_pool_task)
+    {
+        for (int i = 0; i < num; i++)
+            func(arg, i);
+
+        return;
+    }
+
+    pool->func = func;
+    pool->arg = arg;
+    pool->task_num = num;
+
+    __atomic_store_n(&pool->pending, pool->worker_num, __ATOMIC_RELAXED);
+
+    publish_generation(pool);
+
+    in_pool_task = 1;
+    run_range(pool, 0);
+    in_pool_task = 0;
+
+    for (int i = 0; __atomic_load_n(&pool->pending, __ATOMIC_ACQUIRE) > 0; i++)
+    {
+        if (i < pool->spin_count)
+            cpu_relax();
+        else
+            sched_yield();
+    }
+}
+
+#else
+
+/* no threads on bare metal, the loops run in the caller */
+
+struct thread_pool
+{
+    int num_thread;
+};
+
+struct thread_pool* create_thread_pool(int num_thread, int cluster)
+{
+    struct thread_pool* pool = ( struct thread_pool* )sys_malloc(sizeof(struct thread_pool));
+
+    if (pool == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    pool->num_thread = 1;
+
+    return pool;
+}
+
+void destroy_thread_pool(struct thread_pool* pool)
+{
+    sys_free(pool);
+}
+
+int get_thread_pool_size(struct thread_pool* pool)
+{
+    return 1;
+}
+
+void thread_pool_parallel_for(struct thread_pool* pool, int num, thread_pool_func_t func, void* arg)
+{
+    for (int i = 0; i < num; i++)
+        func(arg, i);
+}
+
+#endif
@@ -0,0 +1,544 @@
+/*
+ * Licensed to the Apache Software Foundation (ASF) under one
+ * or more contributor license agreements.  See the NOTICE file
+ * distributed with this work for additional information
+ * regarding copyright ownership.  The ASF licenses this file
+ * to you under the Apache License, Version 2.0 (the
+ * License); you may not use this file except in compliance
+ * with the License.  You may obtain a copy of the License at
+ *
+ *   http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing,
+ * software distributed under the License is distributed on an
+ * AS IS BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY
+ * KIND, either express or implied.  See the License for the
+ * specific language governing permissions and limitations
+ * under the License.
+ */
+
+/*
+ * Copyright (c) 2020, OPEN AI LAB
+ * Author: haitao@openailab.com
+ */
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <sys/time.h>
+
+#include "tengine_c_api.h"
+#include "sys_port.h"
+#include "tengine_ir.h"
+#include "vector.h"
+#include "lock.h"
+#include "module.h"
+#include "tengine_errno.h"
+#include "tengine_log.h"
+#include "weight_cache.h"
+
+struct weight_entry
+{
+    char* model_key;
+    int tensor_idx;
+    int kind;
+    int size;
+    uint64_t fingerprint; /* of the source tensor, 0 if not given */
+    int ref_count;
+    void* mem;
+    void* map_base; /* the file mapping mem is in, or NULL */
+    size_t map_len;
+    int filling; /* mem is being filled out of the lock, the others finding the entry wait for it */
+};
+
+/* the entries kept in files, see get_persist_weight() */
+
+#define WEIGHT_FILE_MAGIC 0x43574d54 /* "TMWC" */
+#define WEIGHT_FILE_VERSION 1
+#define WEIGHT_FILE_ALIGN 64
+
+/* the filled data depends on the instructions the kernels are built for */
+#if defined(__aarch64__)
+#define WEIGHT_FILE_ISA "arm64"
+#elif defined(__arm__)
+#define WEIGHT_FILE_ISA "arm32"
+#elif defined(__x86_64__) && defined(__AVX2__)
+#define WEIGHT_FILE_ISA "x86_64_avx2"
+#elif defined(__x86_64__)
+#define WEIGHT_FILE_ISA "x86_64"
+#elif defined(__i386__)
+#define WEIGHT_FILE_ISA "x86"
+#else
+#define WEIGHT_FILE_ISA "generic"
+#endif
+
+struct weight_file_header
+{
+    uint32_t magic;
+    uint32_t version;
+    int32_t kind;
+    int32_t size;
+    uint64_t fingerprint; /* of the source tensor */
+    int64_t fill_time; /* us, how long the fill took */
+    int32_t key_len; /* the model key and the isa follow the header */
+    int32_t data_offset;
+};
+
+static struct vector* weight_list; /* struct weight_entry* */
+static lock_t weight_lock;
+
+#ifndef CONFIG_BAREMETAL_BUILD
+static pthread_cond_t weight_filled = PTHREAD_COND_INITIALIZER;
+#endif
+
+static int persist_hit_num;
+static int persist_miss_num;
+static int64_t persist_saved_time;
+static int64_t persist_fill_time;
+
+static int64_t get_cur_time_us(void)
+{
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+
+    return ( int64_t )tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static uint64_t hash_bytes(uint64_t h, const void* data, int size)
+{
+    const uint8_t* p = ( const uint8_t* )data;
+
+    for (int i = 0; i < size; i++)
+        h = (h ^ p[i]) * 0x100000001b3ULL;
+
+    return h;
+}
+
+/* a hash of all the source data, as the graph passes or the user may have changed any of the weights.
+   four words are hashed at a time in separate lanes, so that it runs at about the speed of memory */
+static uint64_t get_weight_fingerprint(struct ir_tensor* src)
+{
+    uint64_t h = 0xcbf29ce484222325ULL;
+    uint64_t lane[4] = {h, h ^ 1, h ^ 2, h ^ 3};
+    int size = src->elem_num * src->elem_size;
+    int num = size / sizeof(uint64_t) / 4 * 4;
+    const uint8_t* data = ( const uint8_t* )src->data;
+
+    h = hash_bytes(h, &size, sizeof(int));
+    h = hash_bytes(h, src->dims, sizeof(int) * src->dim_num);
+
+    for (int i = 0; i < num; i += 4)
+    {
+        for (int k = 0; k < 4; k++)
+        {
+            uint64_t w;
+
+            memcpy(&w, data + (i + k) * sizeof(uint64_t), sizeof(uint64_t));
+
+            lane[k] = (lane[k] ^ w) * 0x9e3779b97f4a7c15ULL;
+            lane[k] ^= lane[k] >> 29;
+        }
+    }
+
+    h = hash_bytes(h, lane, sizeof(lane));
+    h = hash_bytes(h, data + num * sizeof(uint64_t), size - num * sizeof(uint64_t));
+
+    return h;
+}
+
+static void get_weight_file_name(char* buf, int buf_size, const char* dir, const char* file_key, int tensor_idx,
+                                 int kind)
+{
+    uint64_t h = hash_bytes(0xcbf29ce484222325ULL, file_key, strlen(file_key));
+
+    snprintf(buf, buf_size, "%s/%016llx_%d_%d.tmw", dir, ( unsigned long long )h, tensor_idx, kind);
+}
+
+/* map the file and check it is made from the same source, return the data or NULL */
+static void* map_weight_file(const char* fname, const char* file_key, int kind, int size, uint64_t fingerprint,
+                             struct weight_entry* e, int64_t* fill_time)
+{
+    int fd = open(fname, O_RDONLY);
+
+    if (fd < 0)
+        return NULL;
+
+    struct stat st;
+
+    if (fstat(fd, &st) < 0 || st.st_size < sizeof(struct weight_file_header))
+    {
+        close(fd);
+        return NULL;
+    }
+
+    void* base = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    close(fd);
+
+    if (base == MAP_FAILED)
+        return NULL;
+
+    const struct weight_file_header* header = ( const struct weight_file_header* )base;
+    int key_len = strlen(file_key);
+
+    if (header->magic != WEIGHT_FILE_MAGIC || header->version != WEIGHT_FILE_VERSION || header->kind != kind ||
+        header->size != size || header->fingerprint != fingerprint || header->key_len != key_len ||
+        header->data_offset < sizeof(struct weight_file_header) + key_len ||
+        header->data_offset + ( off_t )size > st.st_size ||
+        memcmp(( char* )base + sizeof(struct weight_file_header), file_key, key_len))
+    {
+        munmap(base, st.st_size);
+        return NULL;
+    }
+
+    e->map_base = base;
+    e->map_len = st.st_size;
+    *fill_time = header->fill_time;
+
+    return ( char* )base + header->data_offset;
+}
+
+/* written to a temporary file and renamed, so that the readers never see a partial file */
+static int write_weight_file(const char* fname, const char* file_key, struct weight_file_header* header,
+                             const void* data)
+{
+    char tmp_name[1024];
+    char zero[WEIGHT_FILE_ALIGN] = {0};
+    int key_len = header->key_len;
+    int pad = header->data_offset - sizeof(struct weight_file_header) - key_len;
+
+    snprintf(tmp_name, sizeof(tmp_name), "%s.%d.tmp", fname, ( int )getpid());
+
+    FILE* fp = fopen(tmp_name, "wb");
+
+    if (fp == NULL)
+        return -1;
+
+    int ret = 0;
+
+    if (fwrite(header, sizeof(struct weight_file_header), 1, fp) != 1 || fwrite(file_key, 1, key_len, fp) != key_len ||
+        fwrite(zero, 1, pad, fp) != pad || fwrite(data, 1, header->size, fp) != header->size)
+        ret = -1;
+
+    if (fclose(fp) != 0)
+        ret = -1;
+
+    if (ret == 0 && rename(tmp_name, fname) < 0)
+        ret = -1;
+
+    if (ret < 0)
+        unlink(tmp_name);
+
+    return ret;
+}
+
+static struct weight_entry* find_weight_entry(const char* model_key, int tensor_idx, int kind, int size,
+                                              uint64_t fingerprint)
+{
+    int entry_num = get_vector_num(weight_list);
+
+    for (int i = 0; i < entry_num; i++)
+    {
+        struct weight_entry* e = *( struct weight_entry** )get_vector_data(weight_list, i);
+
+        /* the entries failed to fill are dropped by the last one waiting for them */
+        if (!e->filling && e->mem == NULL)
+            continue;
+
+        if (e->tensor_idx == tensor_idx && e->kind == kind && e->size == size && e->fingerprint == fingerprint &&
+            !strcmp(e->model_key, model_key))
+            return e;
+    }
+
+    return NULL;
+}
+
+/* drop one reference under the lock, and the entry with the last one */
+static void put_weight_entry(struct weight_entry* e)
+{
+    if (--e->ref_count > 0)
+        return;
+
+    int entry_num = get_vector_num(weight_list);
+
+    for (int i = 0; i < entry_num; i++)
+    {
+        if (*( struct weight_entry** )get_vector_data(weight_list, i) == e)
+        {
+            remove_vector_by_idx(weight_list, i);
+            break;
+        }
+    }
+
+    if (e->map_base != NULL)
+        munmap(e->map_base, e->map_len);
+    else
+        sys_free(e->mem);
+
+    free(e->model_key);
+    sys_free(e);
+}
+
+static void wait_weight_filled(void)
+{
+#ifndef CONFIG_BAREMETAL_BUILD
+    pthread_cond_wait(&weight_filled, &weight_lock);
+#endif
+}
+
+static void wake_weight_filled(void)
+{
+#ifndef CONFIG_BAREMETAL_BUILD
+    pthread_cond_broadcast(&weight_filled);
+#endif
+}
+
+void* get_shared_weight(const char* model_key, int tensor_idx, int kind, int size, weight_fill_t fill, void* arg)
+{
+    return get_persist_weight(NULL, model_key, tensor_idx, kind, size, NULL, fill, arg);
+}
+
+void* get_persist_weight(const char* dir, const char* model_key, int tensor_idx, int kind, int size,
+                         struct ir_tensor* src, weight_fill_t fill, void* arg)
+{
+    char file_key[512];
+    char fname[1024];
+    uint64_t fingerprint = 0;
+
+    /* the keys of the models loaded from memory are addresses, which mean nothing to other processes */
+    if (dir != NULL && (src == NULL || strncmp(model_key, "file:", 5) != 0))
+        dir = NULL;
+
+    /* the graph passes may have rewritten the weights, so the source is a part of the key */
+    if (src != NULL)
+        fingerprint = get_weight_fingerprint(src);
+
+    lock(&weight_lock);
+
+    struct weight_entry* e = find_weight_entry(model_key, tensor_idx, kind, size, fingerprint);
+
+    if (e != NULL)
+    {
+        e->ref_count++;
+
+        while (e->filling)
+            wait_weight_filled();
+
+        void* mem = e->mem;
+
+        if (mem == NULL)
+            put_weight_entry(e);
+
+        unlock(&weight_lock);
+
+        return mem;
+    }
+
+    /* the entry is added before it is filled, so that the others wait for it instead of filling it again */
+    e = ( struct weight_entry* )sys_malloc(sizeof(struct weight_entry));
+
+    if (e == NULL)
+    {
+        unlock(&weight_lock);
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    e->model_key = strdup(model_key);
+    e->tensor_idx = tensor_idx;
+    e->kind = kind;
+    e->size = size;
+    e->fingerprint = fingerprint;
+    e->ref_count = 1;
+    e->mem = NULL;
+    e->map_base = NULL;
+    e->map_len = 0;
+    e->filling = 1;
+
+    if (e->model_key == NULL || push_vector_data(weight_list, &e) < 0)
+    {
+        free(e->model_key);
+        sys_free(e);
+        unlock(&weight_lock);
+        set_tengine_errno(ENOMEM);
+        return NULL;
+    }
+
+    unlock(&weight_lock);
+
+    /* filled out of the lock, the other entries are not held up by it */
+    void* mem = NULL;
+    int hit = 0;
+    int64_t saved_time = 0;
+    int64_t fill_time = 0;
+
+    if (dir != NULL)
+    {
+        int64_t start = get_cur_time_us();
+
+        snprintf(file_key, sizeof(file_key), "%s:%s", model_key, WEIGHT_FILE_ISA);
+        get_weight_file_name(fname, sizeof(fname), dir, file_key, tensor_idx, kind);
+
+        mem = map_weight_file(fname, file_key, kind, size, fingerprint, e, &fill_time);
+
+        if (mem != NULL)
+        {
+            hit = 1;
+            saved_time = fill_time - (get_cur_time_us() - start);
+        }
+    }
+
+    if (mem == NULL)
+    {
+        mem = sys_malloc(size);
+
+        if (mem == NULL)
+            set_tengine_errno(ENOMEM);
+    }
+
+    if (mem != NULL && !hit)
+    {
+        int64_t start = get_cur_time_us();
+
+        if (fill(mem, arg) < 0)
+        {
+            sys_free(mem);
+            mem = NULL;
+        }
+
+        fill_time = get_cur_time_us() - start;
+    }
+
+    if (mem != NULL && !hit && dir != NULL)
+    {
+        struct weight_file_header header;
+        int key_len = strlen(file_key);
+
+        header.magic = WEIGHT_FILE_MAGIC;
+        header.version = WEIGHT_FILE_VERSION;
+        header.kind = kind;
+        header.size = size;
+        header.fingerprint = fingerprint;
+        header.fill_time = fill_time;
+        header.key_len = key_len;
+        header.data_offset = (sizeof(struct weight_file_header) + key_len + WEIGHT_FILE_ALIGN - 1) &
+                             ~(WEIGHT_FILE_ALIGN - 1);
+
+        /* the cache is best effort, the entry is still good without the file */
+        mkdir(dir, 0755);
+
+        if (write_weight_file(fname, file_key, &header, mem) < 0)
+            TLOG_DEBUG("weight cache: failed to write %s\n", fname);
+    }
+
+    lock(&weight_lock);
+
+    e->mem = mem;
+    e->filling = 0;
+
+    if (mem == NULL)
+        put_weight_entry(e);
+    else if (hit)
+    {
+        persist_hit_num++;
+        persist_saved_time += saved_time;
+    }
+    else if (dir != NULL)
+    {
+        persist_miss_num++;
+        persist_fill_time += fill_time;
+    }
+
+    wake_weight_filled();
+    unlock(&weight_lock);
+
+    return mem;
+}
+
+void put_shared_weight(void* mem)
+{
+    lock(&weight_lock);
+
+    int entry_num = get_vector_num(weight_list);
+
+    for (int i = 0; i < entry_num; i++)
+    {
+        struct weight_entry* e = *( struct weight_entry** )get_vector_data(weight_list, i);
+
+        if (e->mem != mem || e->filling)
+            continue;
+
+        put_weight_entry(e);
+
+        unlock(&weight_lock);
+        return;
+    }
+
+    unlock(&weight_lock);
+
+    TLOG_ERR("weight cache: put %p, which is not in the cache\n", mem);
+}
+
+void get_shared_weight_stat(int* entry_num, int* mem_size)
+{
+    lock(&weight_lock);
+
+    *entry_num = get_vector_num(weight_list);
+    *mem_size = 0;
+
+    for (int i = 0; i < *entry_num; i++)
+    {
+        struct weight_entry* e = *( struct weight_entry** )get_vector_data(weight_list, i);
+
+        *mem_size += e->size;
+    }
+
+    unlock(&weight_lock);
+}
+
+void get_persist_weight_stat(int* hit_num, int* miss_num, int64_t* saved_time, int64_t* fill_time)
+{
+    lock(&weight_lock);
+
+    *hit_num = persist_hit_num;
+    *miss_num = persist_miss_num;
+    *saved_time = persist_saved_time;
+    *fill_time = persist_fill_time;
+
+    unlock(&weight_lock);
+}
+
+static int init_weight_cache(void* arg)
+{
+    init_lock(&weight_lock);
+
+    weight_list = create_vector(sizeof(struct weight_entry*), NULL);
+
+    if (weight_list == NULL)
+        return -1;
+
+    return 0;
+}
+
+static int release_weight_cache(void* arg)
+{
+    int entry_num = get_vector_num(weight_list);
+
+    if (entry_num > 0)
+        TLOG_ERR("weight cache: %d entries are still used at exit\n", entry_num);
+
+    release_vector(weight_list);
+    weight_list = NULL;
+
+    return 0;
+}
+
+REGISTER_MODULE_INIT(MOD_CORE_LEVEL, "init_weight_cache", init_weight_cache);
+REGISTER_MODULE_EXIT(MOD_CORE_LEVEL, "release_weight_cache", release_weight_cache);
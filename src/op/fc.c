@@ -117,6 +117,7 @@ static int init_op(struct ir_op* op)
 
     /*set the param default value */
     fc_param->num_output = 1;
+    fc_param->activation = -1;
 
     op->param_mem = fc_param;
     op->param_size = sizeof(struct fc_param);
@@ -28,6 +28,7 @@
 struct fc_param
 {
     int num_output;
+    int activation;    /* -1: none, 0: relu, 6: relu6 */
 };
 
 #endif
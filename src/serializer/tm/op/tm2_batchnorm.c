@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -55,6 +56,20 @@ static int tm2_load_batchnorm(struct ir_graph* ir_graph, struct ir_node* ir_node
     return 0;
 }
 
+static tm_uoffset_t tm2_save_batchnorm(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct batchnorm_param* batchnorm_param = ( struct batchnorm_param* )ir_node->op.param_mem;
+    TM2_BatchNormParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_BatchNormParam));
+
+    tm_param.rescale_factor = batchnorm_param->rescale_factor;
+    tm_param.eps = batchnorm_param->eps;
+    tm_param.caffe_flavor = batchnorm_param->caffe_flavor;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_BatchNormParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -66,6 +81,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_BATCHNORMALIZATION, 1, tm2_load_batchnorm, batchnorm_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_BATCHNORMALIZATION, 1, tm2_save_batchnorm);
 
     return 0;
 }
@@ -74,6 +90,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_BATCHNORMALIZATION, 1, tm2_save_batchnorm);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_BATCHNORMALIZATION, 1, tm2_load_batchnorm);
 
     return 0;
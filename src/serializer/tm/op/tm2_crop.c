@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -61,6 +62,26 @@ static int tm2_load_crop(struct ir_graph* ir_graph, struct ir_node* ir_node, con
     return 0;
 }
 
+static tm_uoffset_t tm2_save_crop(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct crop_param* crop_param = ( struct crop_param* )ir_node->op.param_mem;
+    TM2_CropParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_CropParam));
+
+    tm_param.num_args = crop_param->num_args;
+    tm_param.offset_c = crop_param->offset_c;
+    tm_param.offset_h = crop_param->offset_h;
+    tm_param.offset_w = crop_param->offset_w;
+    tm_param.crop_h = crop_param->crop_h;
+    tm_param.crop_w = crop_param->crop_w;
+    tm_param.center_crop = crop_param->center_crop;
+    tm_param.axis = crop_param->axis;
+    tm_param.flag = crop_param->flag;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_CropParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -72,6 +93,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_CROP, 1, tm2_load_crop, crop_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_CROP, 1, tm2_save_crop);
 
     return 0;
 }
@@ -80,6 +102,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_CROP, 1, tm2_save_crop);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_CROP, 1, tm2_load_crop);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -53,6 +54,18 @@ static int tm2_load_depthtospace(struct ir_graph* ir_graph, struct ir_node* ir_n
     return 0;
 }
 
+static tm_uoffset_t tm2_save_depthtospace(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct depthtospace_param* depthtospace_param = ( struct depthtospace_param* )ir_node->op.param_mem;
+    TM2_DepthToSpaceParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_DepthToSpaceParam));
+
+    tm_param.block_size = depthtospace_param->block_size;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_DepthToSpaceParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -64,6 +77,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_DEPTHTOSPACE, 1, tm2_load_depthtospace, depthtospace_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_DEPTHTOSPACE, 1, tm2_save_depthtospace);
 
     return 0;
 }
@@ -72,6 +86,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_DEPTHTOSPACE, 1, tm2_save_depthtospace);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_DEPTHTOSPACE, 1, tm2_load_depthtospace);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -66,6 +67,27 @@ static int tm2_load_detection_postprocess(struct ir_graph* ir_graph, struct ir_n
     return 0;
 }
 
+static tm_uoffset_t tm2_save_detection_postprocess(struct tm2_writer* w, struct ir_graph* ir_graph,
+                                                   struct ir_node* ir_node)
+{
+    struct detection_postprocess_param* detection_postprocess_param =
+        ( struct detection_postprocess_param* )ir_node->op.param_mem;
+    TM2_DetectionPostProcessParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_DetectionPostProcessParam));
+
+    tm_param.max_detections = detection_postprocess_param->max_detections;
+    tm_param.max_classes_per_detection = detection_postprocess_param->max_classes_per_detection;
+    tm_param.nms_score_threshold = detection_postprocess_param->nms_score_threshold;
+    tm_param.nms_iou_threshold = detection_postprocess_param->nms_iou_threshold;
+    tm_param.num_classes = detection_postprocess_param->num_classes;
+
+    /* y_scale, x_scale, h_scale, w_scale */
+    tm_param.offset_vf_scales = tm2_write_vector(w, detection_postprocess_param->scales, 4);
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_DetectionPostProcessParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -78,6 +100,7 @@ static int reg_tm2_ops(void* arg)
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_DETECTIONPOSTPROCESS, 1, tm2_load_detection_postprocess,
                               detection_postprocess_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_DETECTIONPOSTPROCESS, 1, tm2_save_detection_postprocess);
 
     return 0;
 }
@@ -86,6 +109,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_DETECTIONPOSTPROCESS, 1, tm2_save_detection_postprocess);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_DETECTIONPOSTPROCESS, 1, tm2_load_detection_postprocess);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -57,6 +58,22 @@ static int tm2_load_eltwise(struct ir_graph* ir_graph, struct ir_node* ir_node,
     return 0;
 }
 
+static tm_uoffset_t tm2_save_eltwise(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct eltwise_param* eltwise_param = ( struct eltwise_param* )ir_node->op.param_mem;
+    TM2_EltwiseParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_EltwiseParam));
+
+    tm_param.type = eltwise_param->type;
+    tm_param.caffe_flavor = eltwise_param->caffe_flavor;
+    tm_param.shift = eltwise_param->shift;
+    tm_param.power = eltwise_param->power;
+    tm_param.scale = eltwise_param->scale;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_EltwiseParam));
+}
+
 /* the auto register functions */
 
 static int reg_tm2_ops(void* arg)
@@ -70,6 +87,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_ELTWISE, 1, tm2_load_eltwise, eltwise_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_ELTWISE, 1, tm2_save_eltwise);
 
     return 0;
 }
@@ -78,6 +96,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_ELTWISE, 1, tm2_save_eltwise);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_ELTWISE, 1, tm2_load_eltwise);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -35,11 +36,20 @@
 #include "tengine_op.h"
 #include "fc_param.h"
 
+/* version 3 adds the activation fused into the fc, the ir op is still version 1. the models converted
+   by the tools are version 2 and earlier, without it */
+#define TM2_FC_VERSION 3
+
 static int fc_op_map(int op)
 {
     return OP_FC;
 }
 
+static int fc_ver_map(int ver)
+{
+    return 1;
+}
+
 static int tm2_load_fc(struct ir_graph* ir_graph, struct ir_node* ir_node, const TM2_Node* tm_node,
                        const TM2_Operator* tm_op)
 {
@@ -51,10 +61,24 @@ static int tm2_load_fc(struct ir_graph* ir_graph, struct ir_node* ir_node, const
     const TM2_FCParam* tm_param = ( TM2_FCParam* )(mem_base + tm_op->offset_t_param);
 
     fc_param->num_output = tm_param->num_output;
+    fc_param->activation = tm_op->op_ver >= 3 ? tm_param->activation : -1;
 
     return 0;
 }
 
+static tm_uoffset_t tm2_save_fc(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct fc_param* fc_param = ( struct fc_param* )ir_node->op.param_mem;
+    TM2_FCParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_FCParam));
+
+    tm_param.num_output = fc_param->num_output;
+    tm_param.activation = fc_param->activation;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_FCParam));
+}
+
 /* the auto register functions */
 
 static int reg_tm2_ops(void* arg)
@@ -67,7 +91,8 @@ static int reg_tm2_ops(void* arg)
         return -1;
     }
 
-    tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_FULLYCONNECTED, 1, tm2_load_fc, fc_op_map, NULL);
+    tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_FULLYCONNECTED, TM2_FC_VERSION, tm2_load_fc, fc_op_map, fc_ver_map);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_FULLYCONNECTED, TM2_FC_VERSION, tm2_save_fc);
 
     return 0;
 }
@@ -76,7 +101,8 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
-    tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_FULLYCONNECTED, 1, tm2_load_fc);
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_FULLYCONNECTED, TM2_FC_VERSION, tm2_save_fc);
+    tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_FULLYCONNECTED, TM2_FC_VERSION, tm2_load_fc);
 
     return 0;
 }
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -56,6 +57,21 @@ static int tm2_load_gemm(struct ir_graph* ir_graph, struct ir_node* ir_node, con
     return 0;
 }
 
+static tm_uoffset_t tm2_save_gemm(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct gemm_param* gemm_param = ( struct gemm_param* )ir_node->op.param_mem;
+    TM2_GemmParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_GemmParam));
+
+    tm_param.alpha = gemm_param->alpha;
+    tm_param.beta = gemm_param->beta;
+    tm_param.transA = gemm_param->transA;
+    tm_param.transB = gemm_param->transB;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_GemmParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -67,6 +83,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_GEMM, 1, tm2_load_gemm, gemm_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_GEMM, 1, tm2_save_gemm);
 
     return 0;
 }
@@ -75,6 +92,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_GEMM, 1, tm2_save_gemm);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_GEMM, 1, tm2_load_gemm);
 
     return 0;
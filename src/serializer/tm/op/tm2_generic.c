@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -55,6 +56,21 @@ static int tm2_load_generic(struct ir_graph* ir_graph, struct ir_node* ir_node,
     return 0;
 }
 
+static tm_uoffset_t tm2_save_generic(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct generic_param* generic_param = ( struct generic_param* )ir_node->op.param_mem;
+    TM2_GenericParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_GenericParam));
+
+    /* op_name is not read back as a string by the loader, so it is left unset */
+    tm_param.max_input_num = generic_param->max_input_num;
+    tm_param.max_output_num = generic_param->max_output_num;
+    tm_param.offset_s_opname = TM2_NOT_SET;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_GenericParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -66,6 +82,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_GENERIC, 1, tm2_load_generic, generic_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_GENERIC, 1, tm2_save_generic);
 
     return 0;
 }
@@ -74,6 +91,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_GENERIC, 1, tm2_save_generic);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_GENERIC, 1, tm2_load_generic);
 
     return 0;
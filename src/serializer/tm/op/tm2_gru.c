@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -62,6 +63,27 @@ static int tm2_load_gru(struct ir_graph* ir_graph, struct ir_node* ir_node, cons
     return 0;
 }
 
+static tm_uoffset_t tm2_save_gru(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct gru_param* gru_param = ( struct gru_param* )ir_node->op.param_mem;
+    TM2_GRUParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_GRUParam));
+
+    tm_param.clip = gru_param->clip;
+    tm_param.output_len = gru_param->output_len;
+    tm_param.sequence_len = gru_param->sequence_len;
+    tm_param.input_size = gru_param->input_size;
+    tm_param.hidden_size = gru_param->hidden_size;
+    tm_param.has_clip = gru_param->has_clip;
+    tm_param.has_gate_bias = gru_param->has_gate_bias;
+    tm_param.has_candidate_bias = gru_param->has_candidate_bias;
+    tm_param.has_init_state = gru_param->has_init_state;
+    tm_param.mxnet_flag = gru_param->mxnet_flag;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_GRUParam));
+}
+
 /* the auto register functions */
 
 static int reg_tm2_ops(void* arg)
@@ -75,6 +97,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_GRU, 1, tm2_load_gru, gru_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_GRU, 1, tm2_save_gru);
 
     return 0;
 }
@@ -83,6 +106,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_GRU, 1, tm2_save_gru);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_GRU, 1, tm2_load_gru);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -54,6 +55,19 @@ static int tm2_load_hardswish(struct ir_graph* ir_graph, struct ir_node* ir_node
     return 0;
 }
 
+static tm_uoffset_t tm2_save_hardswish(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct hardswish_param* gather_param = ( struct hardswish_param* )ir_node->op.param_mem;
+    TM2_HardSwishParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_HardSwishParam));
+
+    tm_param.alpha = gather_param->alpha;
+    tm_param.beta = gather_param->beta;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_HardSwishParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -65,6 +79,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_HARDSWISH, 1, tm2_load_hardswish, gather_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_HARDSWISH, 1, tm2_save_hardswish);
 
     return 0;
 }
@@ -73,6 +88,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_HARDSWISH, 1, tm2_save_hardswish);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_HARDSWISH, 1, tm2_load_hardswish);
 
     return 0;
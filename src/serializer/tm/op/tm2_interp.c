@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -57,6 +58,22 @@ static int tm2_load_interp(struct ir_graph* ir_graph, struct ir_node* ir_node, c
     return 0;
 }
 
+static tm_uoffset_t tm2_save_interp(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct interp_param* param = ( struct interp_param* )ir_node->op.param_mem;
+    TM2_InterpParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_InterpParam));
+
+    tm_param.resize_type = param->resize_type;
+    tm_param.width_scale = param->width_scale;
+    tm_param.height_scale = param->height_scale;
+    tm_param.output_width = param->output_width;
+    tm_param.output_height = param->output_height;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_InterpParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -68,6 +85,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_INTERP, 1, tm2_load_interp, interp_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_INTERP, 1, tm2_save_interp);
 
     return 0;
 }
@@ -76,6 +94,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_INTERP, 1, tm2_save_interp);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_INTERP, 1, tm2_load_interp);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -57,6 +58,22 @@ static int tm2_load_lrn(struct ir_graph* ir_graph, struct ir_node* ir_node, cons
     return 0;
 }
 
+static tm_uoffset_t tm2_save_lrn(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct lrn_param* lrn_param = ( struct lrn_param* )ir_node->op.param_mem;
+    TM2_LRNParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_LRNParam));
+
+    tm_param.local_size = lrn_param->local_size;
+    tm_param.alpha = lrn_param->alpha;
+    tm_param.beta = lrn_param->beta;
+    tm_param.norm_region = lrn_param->norm_region;
+    tm_param.k = lrn_param->k;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_LRNParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -68,6 +85,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_LRN, 1, tm2_load_lrn, lrn_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_LRN, 1, tm2_save_lrn);
 
     return 0;
 }
@@ -76,6 +94,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_LRN, 1, tm2_save_lrn);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_LRN, 1, tm2_load_lrn);
 
     return 0;
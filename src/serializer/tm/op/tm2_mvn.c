@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -55,6 +56,20 @@ static int tm2_load_mvn(struct ir_graph* ir_graph, struct ir_node* ir_node, cons
     return 0;
 }
 
+static tm_uoffset_t tm2_save_mvn(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct mvn_param* gather_param = ( struct mvn_param* )ir_node->op.param_mem;
+    TM2_MVNParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_MVNParam));
+
+    tm_param.across_channels = gather_param->across_channels;
+    tm_param.eps = gather_param->eps;
+    tm_param.normalize_variance = gather_param->normalize_variance;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_MVNParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -66,6 +81,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_MVN, 1, tm2_load_mvn, mvn_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_MVN, 1, tm2_save_mvn);
 
     return 0;
 }
@@ -74,6 +90,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_MVN, 1, tm2_save_mvn);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_MVN, 1, tm2_load_mvn);
 
     return 0;
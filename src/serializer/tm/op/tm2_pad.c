@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -62,6 +63,27 @@ static int tm2_load_pad(struct ir_graph* ir_graph, struct ir_node* ir_node, cons
     return 0;
 }
 
+static tm_uoffset_t tm2_save_pad(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct pad_param* pad_param = ( struct pad_param* )ir_node->op.param_mem;
+    TM2_PadParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_PadParam));
+
+    tm_param.mode = pad_param->mode;
+    tm_param.value = pad_param->value;
+    tm_param.pad_n_0 = pad_param->pad_0_h;
+    tm_param.pad_n_1 = pad_param->pad_0_w;
+    tm_param.pad_c_0 = pad_param->pad_1_h;
+    tm_param.pad_c_1 = pad_param->pad_1_w;
+    tm_param.pad_h_0 = pad_param->pad_2_h;
+    tm_param.pad_h_1 = pad_param->pad_2_w;
+    tm_param.pad_w_0 = pad_param->pad_3_h;
+    tm_param.pad_w_1 = pad_param->pad_3_w;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_PadParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -73,6 +95,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_PAD, 1, tm2_load_pad, pad_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_PAD, 1, tm2_save_pad);
 
     return 0;
 }
@@ -81,6 +104,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_PAD, 1, tm2_save_pad);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_PAD, 1, tm2_load_pad);
 
     return 0;
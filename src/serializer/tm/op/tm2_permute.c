@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -57,6 +58,22 @@ static int tm2_load_permute(struct ir_graph* ir_graph, struct ir_node* ir_node,
     return 0;
 }
 
+static tm_uoffset_t tm2_save_permute(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct permute_param* permute_param = ( struct permute_param* )ir_node->op.param_mem;
+    TM2_PermuteParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_PermuteParam));
+
+    tm_param.flag = permute_param->flag;
+    tm_param.order0 = permute_param->order0;
+    tm_param.order1 = permute_param->order1;
+    tm_param.order2 = permute_param->order2;
+    tm_param.order3 = permute_param->order3;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_PermuteParam));
+}
+
 /* the auto register functions */
 
 static int reg_tm2_ops(void* arg)
@@ -70,6 +87,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_PERMUTE, 1, tm2_load_permute, permute_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_PERMUTE, 1, tm2_save_permute);
 
     return 0;
 }
@@ -78,6 +96,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_PERMUTE, 1, tm2_save_permute);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_PERMUTE, 1, tm2_load_permute);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -85,6 +86,34 @@ static int tm2_load_priorbox(struct ir_graph* ir_graph, struct ir_node* ir_node,
     return 0;
 }
 
+static tm_uoffset_t tm2_save_priorbox(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct priorbox_param* priorbox_param = ( struct priorbox_param* )ir_node->op.param_mem;
+    TM2_PriorBoxParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_PriorBoxParam));
+
+    /* the variance is always 4 floats */
+    tm_param.offset_vf_min_size = tm2_write_vector(w, priorbox_param->min_size, priorbox_param->min_size_num);
+    tm_param.offset_vf_max_size = tm2_write_vector(w, priorbox_param->max_size, priorbox_param->max_size_num);
+    tm_param.offset_vf_variance = tm2_write_vector(w, priorbox_param->variance, 4);
+    tm_param.offset_vf_aspect_ratio =
+        tm2_write_vector(w, priorbox_param->aspect_ratio, priorbox_param->aspect_ratio_size);
+
+    tm_param.clip = priorbox_param->clip;
+    tm_param.flip = priorbox_param->flip;
+    tm_param.img_h = priorbox_param->image_h;
+    tm_param.img_size = priorbox_param->image_size;
+    tm_param.img_w = priorbox_param->image_w;
+    tm_param.num_priors = priorbox_param->num_priors;
+    tm_param.offset = priorbox_param->offset;
+    tm_param.out_dim = priorbox_param->out_dim;
+    tm_param.step_h = priorbox_param->step_h;
+    tm_param.step_w = priorbox_param->step_w;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_PriorBoxParam));
+}
+
 // todo add uuload op
 
 static int reg_tm2_ops(void* arg)
@@ -98,6 +127,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_PRIORBOX, 1, tm2_load_priorbox, priorbox_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_PRIORBOX, 1, tm2_save_priorbox);
 
     return 0;
 }
@@ -106,6 +136,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_PRIORBOX, 1, tm2_save_priorbox);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_PRIORBOX, 1, tm2_load_priorbox);
 
     return 0;
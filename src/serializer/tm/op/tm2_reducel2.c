@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "sys_port.h"
 #include "module.h"
 #include "tengine_ir.h"
@@ -53,6 +54,19 @@ static int tm2_load_reducel2(struct ir_graph* ir_graph, struct ir_node* ir_node,
     return 0;
 }
 
+static tm_uoffset_t tm2_save_reducel2(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct reducel2_param* reducel2_param = ( struct reducel2_param* )ir_node->op.param_mem;
+    TM2_ReduceL2Param tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_ReduceL2Param));
+
+    tm_param.axis = reducel2_param->axis;
+    tm_param.keepdim = reducel2_param->keepdim;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_ReduceL2Param));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -64,6 +78,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_REDUCEL2, 1, tm2_load_reducel2, reducel2_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_REDUCEL2, 1, tm2_save_reducel2);
 
     return 0;
 }
@@ -72,6 +87,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_REDUCEL2, 1, tm2_save_reducel2);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_REDUCEL2, 1, tm2_load_reducel2);
 
     return 0;
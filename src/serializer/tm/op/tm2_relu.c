@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -53,6 +54,18 @@ static int tm2_load_relu(struct ir_graph* ir_graph, struct ir_node* ir_node, con
     return 0;
 }
 
+static tm_uoffset_t tm2_save_relu(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct relu_param* relu_param = ( struct relu_param* )ir_node->op.param_mem;
+    TM2_ReLuParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_ReLuParam));
+
+    tm_param.negative_slope = relu_param->negative_slope;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_ReLuParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -64,6 +77,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_RELU, 1, tm2_load_relu, relu_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_RELU, 1, tm2_save_relu);
 
     return 0;
 }
@@ -72,6 +86,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_RELU, 1, tm2_save_relu);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_RELU, 1, tm2_load_relu);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -74,6 +75,22 @@ static int tm2_load_reshape(struct ir_graph* ir_graph, struct ir_node* ir_node,
     return 0;
 }
 
+static tm_uoffset_t tm2_save_reshape(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct reshape_param* param = ( struct reshape_param* )ir_node->op.param_mem;
+    TM2_ReshapeParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_ReshapeParam));
+
+    tm_param.reverse = param->reverse ? 1 : 0;
+    tm_param.is_mxnet = param->is_mxnet ? 1 : 0;
+
+    if (param->re_shape != NULL)
+        tm_param.offset_re_shape = tm2_write_vector(w, param->re_shape, param->dim_size);
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_ReshapeParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -85,6 +102,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_RESHAPE, 1, tm2_load_reshape, reshape_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_RESHAPE, 1, tm2_save_reshape);
 
     return 0;
 }
@@ -93,6 +111,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_RESHAPE, 1, tm2_save_reshape);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_RESHAPE, 1, tm2_load_reshape);
 
     return 0;
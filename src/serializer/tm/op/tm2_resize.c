@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -54,6 +55,19 @@ static int tm2_load_resize(struct ir_graph* ir_graph, struct ir_node* ir_node, c
     return 0;
 }
 
+static tm_uoffset_t tm2_save_resize(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct resize_param* resize_param = ( struct resize_param* )ir_node->op.param_mem;
+    TM2_ResizeParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_ResizeParam));
+
+    tm_param.scale_x = resize_param->scale_h;
+    tm_param.scale_y = resize_param->scale_w;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_ResizeParam));
+}
+
 /* the auto register functions */
 
 static int reg_tm2_ops(void* arg)
@@ -67,6 +81,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_RESIZE, 1, tm2_load_resize, resize_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_RESIZE, 1, tm2_save_resize);
 
     return 0;
 }
@@ -75,6 +90,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_RESIZE, 1, tm2_save_resize);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_RESIZE, 1, tm2_load_resize);
 
     return 0;
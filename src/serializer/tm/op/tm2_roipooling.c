@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -55,6 +56,20 @@ static int tm2_load_roi_pooling(struct ir_graph* ir_graph, struct ir_node* ir_no
     return 0;
 }
 
+static tm_uoffset_t tm2_save_roi_pooling(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct roipooling_param* roi_pooling_param = ( struct roipooling_param* )ir_node->op.param_mem;
+    TM2_ROIPoolingParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_ROIPoolingParam));
+
+    tm_param.pooled_h = roi_pooling_param->pooled_h;
+    tm_param.pooled_w = roi_pooling_param->pooled_w;
+    tm_param.spatial_scale = roi_pooling_param->spatial_scale;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_ROIPoolingParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -66,6 +81,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_ROIPOOLING, 1, tm2_load_roi_pooling, roi_pooling_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_ROIPOOLING, 1, tm2_save_roi_pooling);
 
     return 0;
 }
@@ -74,6 +90,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_ROIPOOLING, 1, tm2_save_roi_pooling);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_ROIPOOLING, 1, tm2_load_roi_pooling);
 
     return 0;
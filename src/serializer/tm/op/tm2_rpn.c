@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -82,6 +83,25 @@ static int tm2_load_rpn(struct ir_graph* ir_graph, struct ir_node* ir_node, cons
     return 0;
 }
 
+static tm_uoffset_t tm2_save_rpn(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct rpn_param* rpn_param = ( struct rpn_param* )ir_node->op.param_mem;
+    TM2_RPNParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_RPNParam));
+
+    tm_param.basesize = rpn_param->basesize;
+    tm_param.feat_stride = rpn_param->feat_stride;
+    tm_param.min_size = rpn_param->min_size;
+    tm_param.nms_thresh = rpn_param->nms_thresh;
+    tm_param.per_nms_topn = rpn_param->per_nms_topn;
+    tm_param.post_nms_topn = rpn_param->post_nms_topn;
+    tm_param.offset_vf_anchor_scales = tm2_write_ir_vector(w, rpn_param->anchor_scales);
+    tm_param.offset_vf_ratios = tm2_write_ir_vector(w, rpn_param->ratios);
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_RPNParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -93,6 +113,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_RPN, 1, tm2_load_rpn, rpn_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_RPN, 1, tm2_save_rpn);
 
     return 0;
 }
@@ -101,6 +122,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_RPN, 1, tm2_save_rpn);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_RPN, 1, tm2_load_rpn);
 
     return 0;
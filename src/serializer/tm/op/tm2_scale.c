@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -55,6 +56,20 @@ static int tm2_load_scale(struct ir_graph* ir_graph, struct ir_node* ir_node, co
     return 0;
 }
 
+static tm_uoffset_t tm2_save_scale(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct scale_param* scale_param = ( struct scale_param* )ir_node->op.param_mem;
+    TM2_ScaleParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_ScaleParam));
+
+    tm_param.axis = scale_param->axis;
+    tm_param.num_axes = scale_param->num_axes;
+    tm_param.bias_term = scale_param->bias_term;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_ScaleParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -66,6 +81,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_SCALE, 1, tm2_load_scale, scale_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_SCALE, 1, tm2_save_scale);
 
     return 0;
 }
@@ -74,6 +90,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_SCALE, 1, tm2_save_scale);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_SCALE, 1, tm2_load_scale);
 
     return 0;
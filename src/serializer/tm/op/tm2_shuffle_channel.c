@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -53,6 +54,18 @@ static int tm2_load_shuffle_channel(struct ir_graph* ir_graph, struct ir_node* i
     return 0;
 }
 
+static tm_uoffset_t tm2_save_shuffle_channel(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct shuffle_channel_param* param = ( struct shuffle_channel_param* )ir_node->op.param_mem;
+    TM2_ShuffleChannelParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_ShuffleChannelParam));
+
+    tm_param.group = param->group;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_ShuffleChannelParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -65,6 +78,7 @@ static int reg_tm2_ops(void* arg)
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_SHUFFLECHANNEL, 1, tm2_load_shuffle_channel, shuffle_channel_op_map,
                               NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_SHUFFLECHANNEL, 1, tm2_save_shuffle_channel);
 
     return 0;
 }
@@ -73,6 +87,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_SHUFFLECHANNEL, 1, tm2_save_shuffle_channel);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_SHUFFLECHANNEL, 1, tm2_load_shuffle_channel);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -89,6 +90,26 @@ static int tm2_load_slice(struct ir_graph* ir_graph, struct ir_node* ir_node, co
     return 0;
 }
 
+static tm_uoffset_t tm2_save_slice(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct slice_param* slice_param = ( struct slice_param* )ir_node->op.param_mem;
+    TM2_SliceParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_SliceParam));
+
+    tm_param.axis = slice_param->axis;
+    tm_param.begin = slice_param->begin;
+    tm_param.end = slice_param->end;
+    tm_param.iscaffe = slice_param->iscaffe;
+    tm_param.ismxnet = slice_param->ismxnet;
+    tm_param.isonnx = slice_param->isonnx;
+    tm_param.offset_vi_begins = tm2_write_ir_vector(w, slice_param->begin_);
+    tm_param.offset_vi_sizes = tm2_write_ir_vector(w, slice_param->size_);
+    tm_param.offset_vi_slice_points = tm2_write_ir_vector(w, slice_param->slice_point_);
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_SliceParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -100,6 +121,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_SLICE, 1, tm2_load_slice, slice_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_SLICE, 1, tm2_save_slice);
 
     return 0;
 }
@@ -108,6 +130,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_SLICE, 1, tm2_save_slice);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_SLICE, 1, tm2_load_slice);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -58,6 +59,23 @@ static int tm2_load_spacetobatchnd(struct ir_graph* ir_graph, struct ir_node* ir
     return 0;
 }
 
+static tm_uoffset_t tm2_save_spacetobatchnd(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct spacetobatchnd_param* spacetobatchnd_param = ( struct spacetobatchnd_param* )ir_node->op.param_mem;
+    TM2_SpaceToBatchNDParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_SpaceToBatchNDParam));
+
+    tm_param.dilation_x = spacetobatchnd_param->dilation_x;
+    tm_param.dilation_y = spacetobatchnd_param->dilation_y;
+    tm_param.pad_top = spacetobatchnd_param->pad_top;
+    tm_param.pad_bottom = spacetobatchnd_param->pad_bottom;
+    tm_param.pad_left = spacetobatchnd_param->pad_left;
+    tm_param.pad_right = spacetobatchnd_param->pad_right;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_SpaceToBatchNDParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -70,6 +88,7 @@ static int reg_tm2_ops(void* arg)
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_SPACETOBATCHND, 1, tm2_load_spacetobatchnd, spacetobatchnd_op_map,
                               NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_SPACETOBATCHND, 1, tm2_save_spacetobatchnd);
 
     return 0;
 }
@@ -78,6 +97,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_SPACETOBATCHND, 1, tm2_save_spacetobatchnd);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_SPACETOBATCHND, 1, tm2_load_spacetobatchnd);
 
     return 0;
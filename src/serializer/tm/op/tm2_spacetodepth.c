@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -33,6 +34,7 @@
 #include "tengine_serializer.h"
 #include "tm2_serializer.h"
 #include "tengine_op.h"
+#include "spacetodepth_param.h"
 
 static int spacetodepth_op_map(int op)
 {
@@ -45,6 +47,18 @@ static int tm2_load_spacetodepth(struct ir_graph* ir_graph, struct ir_node* ir_n
     return 0;
 }
 
+static tm_uoffset_t tm2_save_spacetodepth(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct spacetodepth_param* spacetodepth_param = ( struct spacetodepth_param* )ir_node->op.param_mem;
+    TM2_SpaceToDepthParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_SpaceToDepthParam));
+
+    tm_param.block_size = spacetodepth_param->block_size;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_SpaceToDepthParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -56,6 +70,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_SPACETODEPTH, 1, tm2_load_spacetodepth, spacetodepth_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_SPACETODEPTH, 1, tm2_save_spacetodepth);
 
     return 0;
 }
@@ -64,6 +79,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_SPACETODEPTH, 1, tm2_save_spacetodepth);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_SPACETODEPTH, 1, tm2_load_spacetodepth);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -79,6 +80,26 @@ static int tm2_load_split(struct ir_graph* ir_graph, struct ir_node* ir_node, co
     return 0;
 }
 
+static tm_uoffset_t tm2_save_split(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct split_param* split_param = ( struct split_param* )ir_node->op.param_mem;
+    TM2_SplitParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_SplitParam));
+
+    tm_param.is_caffe = split_param->is_caffe ? 1 : 0;
+    tm_param.is_onnx = split_param->is_onnx ? 1 : 0;
+
+    if (!split_param->is_caffe)
+    {
+        tm_param.axis = split_param->axis;
+        tm_param.split_dim = split_param->split_dim;
+        tm_param.offset_split_sizes = tm2_write_ir_vector(w, split_param->split_sizes_);
+    }
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_SplitParam));
+}
+
 /* the auto register functions */
 
 static int reg_tm2_ops(void* arg)
@@ -92,6 +113,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_SPLIT, 1, tm2_load_split, split_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_SPLIT, 1, tm2_save_split);
 
     return 0;
 }
@@ -100,6 +122,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_SPLIT, 1, tm2_save_split);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_SPLIT, 1, tm2_load_split);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -64,6 +65,29 @@ static int tm2_load_strided_slice(struct ir_graph* ir_graph, struct ir_node* ir_
     return 0;
 }
 
+static tm_uoffset_t tm2_save_strided_slice(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct strided_slice_param* strided_slice_param = ( struct strided_slice_param* )ir_node->op.param_mem;
+    TM2_StridedSliceParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_StridedSliceParam));
+
+    tm_param.begin_n = strided_slice_param->begin[0];
+    tm_param.begin_c = strided_slice_param->begin[1];
+    tm_param.begin_h = strided_slice_param->begin[2];
+    tm_param.begin_w = strided_slice_param->begin[3];
+    tm_param.end_n = strided_slice_param->end[0];
+    tm_param.end_c = strided_slice_param->end[1];
+    tm_param.end_h = strided_slice_param->end[2];
+    tm_param.end_w = strided_slice_param->end[3];
+    tm_param.stride_n = strided_slice_param->stride[0];
+    tm_param.stride_c = strided_slice_param->stride[1];
+    tm_param.stride_h = strided_slice_param->stride[2];
+    tm_param.stride_w = strided_slice_param->stride[3];
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_StridedSliceParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -75,6 +99,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_STRIDEDSLICE, 1, tm2_load_strided_slice, strided_slice_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_STRIDEDSLICE, 1, tm2_save_strided_slice);
 
     return 0;
 }
@@ -83,6 +108,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_STRIDEDSLICE, 1, tm2_save_strided_slice);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_STRIDEDSLICE, 1, tm2_load_strided_slice);
     return 0;
 }
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -54,6 +55,19 @@ static int tm2_load_swap_axis(struct ir_graph* ir_graph, struct ir_node* ir_node
     return 0;
 }
 
+static tm_uoffset_t tm2_save_swap_axis(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct swap_axis_param* swap_axis_param = ( struct swap_axis_param* )ir_node->op.param_mem;
+    TM2_SwapAxisParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_SwapAxisParam));
+
+    tm_param.dim_0 = swap_axis_param->dim_0;
+    tm_param.dim_1 = swap_axis_param->dim_1;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_SwapAxisParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -65,6 +79,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_SWAPAXIS, 1, tm2_load_swap_axis, swap_axis_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_SWAPAXIS, 1, tm2_save_swap_axis);
 
     return 0;
 }
@@ -73,6 +88,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_SWAPAXIS, 1, tm2_save_swap_axis);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_SWAPAXIS, 1, tm2_load_swap_axis);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -57,6 +58,19 @@ static int tm2_load_topkv2(struct ir_graph* ir_graph, struct ir_node* ir_node, c
     return 0;
 }
 
+static tm_uoffset_t tm2_save_topkv2(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct topkv2_param* topkv2_param = ( struct topkv2_param* )ir_node->op.param_mem;
+    TM2_TopKV2Param tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_TopKV2Param));
+
+    tm_param.k = topkv2_param->k;
+    tm_param.sorted = topkv2_param->sorted ? 1 : 0;
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_TopKV2Param));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -68,6 +82,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_TOPKV2, 1, tm2_load_topkv2, topkv2_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_TOPKV2, 1, tm2_save_topkv2);
 
     return 0;
 }
@@ -76,6 +91,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_TOPKV2, 1, tm2_save_topkv2);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_TOPKV2, 1, tm2_load_topkv2);
 
     return 0;
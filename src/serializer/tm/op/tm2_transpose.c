@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "sys_port.h"
 #include "module.h"
@@ -63,6 +64,20 @@ static int tm2_load_transpose(struct ir_graph* ir_graph, struct ir_node* ir_node
     return 0;
 }
 
+static tm_uoffset_t tm2_save_transpose(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct transpose_param* transpose_param = ( struct transpose_param* )ir_node->op.param_mem;
+    TM2_TransposeParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_TransposeParam));
+
+    if (transpose_param->tr_shape != NULL)
+        tm_param.offset_tr_shape =
+            tm2_write_vector(w, transpose_param->tr_shape, transpose_param->tr_shape_size);
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_TransposeParam));
+}
+
 /* the auto register functions */
 
 static int reg_tm2_ops(void* arg)
@@ -76,6 +91,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_TRANSPOSE, 1, tm2_load_transpose, transpose_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_TRANSPOSE, 1, tm2_save_transpose);
 
     return 0;
 }
@@ -84,6 +100,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_TRANSPOSE, 1, tm2_save_transpose);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_TRANSPOSE, 1, tm2_load_transpose);
 
     return 0;
@@ -24,6 +24,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include "sys_port.h"
 #include "module.h"
 #include "tengine_ir.h"
@@ -59,6 +60,19 @@ static int tm2_load_unsqueeze(struct ir_graph* ir_graph, struct ir_node* ir_node
     return 0;
 }
 
+static tm_uoffset_t tm2_save_unsqueeze(struct tm2_writer* w, struct ir_graph* ir_graph, struct ir_node* ir_node)
+{
+    struct unsqueeze_param* unsqueeze_param = ( struct unsqueeze_param* )ir_node->op.param_mem;
+    TM2_UnsqueezeParam tm_param;
+
+    memset(&tm_param, 0, sizeof(TM2_UnsqueezeParam));
+
+    if (unsqueeze_param->axises != NULL)
+        tm_param.offset_vi_axises = tm2_write_vector(w, unsqueeze_param->axises, unsqueeze_param->axises_size);
+
+    return tm2_write_object(w, &tm_param, sizeof(TM2_UnsqueezeParam));
+}
+
 static int reg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
@@ -70,6 +84,7 @@ static int reg_tm2_ops(void* arg)
     }
 
     tm2_s->register_op_loader(tm2_s, TM2_OPTYPE_UNSQUEEZE, 1, tm2_load_unsqueeze, unsqueeze_op_map, NULL);
+    tm2_s->register_op_saver(tm2_s, TM2_OPTYPE_UNSQUEEZE, 1, tm2_save_unsqueeze);
 
     return 0;
 }
@@ -78,6 +93,7 @@ static int unreg_tm2_ops(void* arg)
 {
     struct serializer* tm2_s = find_serializer("tengine");
 
+    tm2_s->unregister_op_saver(tm2_s, TM2_OPTYPE_UNSQUEEZE, 1, tm2_save_unsqueeze);
     tm2_s->unregister_op_loader(tm2_s, TM2_OPTYPE_UNSQUEEZE, 1, tm2_load_unsqueeze);
 
     return 0;
@@ -436,6 +436,7 @@ typedef struct
 typedef struct
 {
     int32_t num_output;
+    int32_t activation; /* since op version 3, -1: none, 0: relu, 6: relu6 */
 } TM2_FCParam;
 
 typedef struct
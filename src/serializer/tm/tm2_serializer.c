@@ -36,8 +36,10 @@
 #include "tengine_log.h"
 #include "tengine_ir.h"
 #include "tengine_op.h"
+#include "tengine_utils.h"
 #include "tengine_serializer.h"
 #include "tm2_serializer.h"
+#include "weight_cache.h"
 
 struct op_loader_entry
 {
@@ -46,6 +48,7 @@ struct op_loader_entry
     tm2_op_loader_t loader;
     tm2_map_t op_map;
     tm2_map_t ver_map;
+    tm2_op_saver_t saver;
 };
 
 struct tm2_serializer
@@ -119,12 +122,65 @@ static int register_tm2_op_loader(struct tm2_serializer* s, int op_type, int op_
     e.loader = op_loader;
     e.op_map = op_map;
     e.ver_map = ver_map;
+    e.saver = NULL;
 
     push_vector_data(s->loader_list, &e);
 
     return 0;
 }
 
+static int register_tm2_op_saver(struct tm2_serializer* s, int op_type, int op_version, tm2_op_saver_t op_saver)
+{
+    struct op_loader_entry* e = find_op_loader(s, op_type, op_version);
+
+    if (e == NULL || e->saver != NULL)
+    {
+        TLOG_DEBUG("serializer: op: %d version %d has no loader or has saver already\n", op_type, op_version);
+        set_tengine_errno(EINVAL);
+        return -1;
+    }
+
+    e->saver = op_saver;
+
+    return 0;
+}
+
+static int unregister_tm2_op_saver(struct tm2_serializer* s, int op_type, int op_version, tm2_op_saver_t op_saver)
+{
+    struct op_loader_entry* e = find_op_loader(s, op_type, op_version);
+
+    if (e == NULL || e->saver != op_saver)
+        return -1;
+
+    e->saver = NULL;
+
+    return 0;
+}
+
+/* the tm op to save an ir op as, the entries with saver are preferred as some loaders share the op map */
+static struct op_loader_entry* find_op_saver(struct tm2_serializer* s, int ir_op_type)
+{
+    struct op_loader_entry* found = NULL;
+    int loader_num = get_vector_num(s->loader_list);
+
+    for (int i = 0; i < loader_num; i++)
+    {
+        struct op_loader_entry* e = ( struct op_loader_entry* )get_vector_data(s->loader_list, i);
+        int op_type = e->op_map ? e->op_map(e->op_type) : e->op_type;
+
+        if (op_type != ir_op_type)
+            continue;
+
+        if (e->saver != NULL)
+            return e;
+
+        if (found == NULL)
+            found = e;
+    }
+
+    return found;
+}
+
 static int unregister_tm2_op_loader(struct tm2_serializer* s, int op_type, int op_version, tm2_op_loader_t op_loader)
 {
     int n = get_vector_num(s->loader_list);
@@ -143,6 +199,180 @@ static int unregister_tm2_op_loader(struct tm2_serializer* s, int op_type, int o
     return -1;
 }
 
+struct permute_arg
+{
+    struct ir_tensor* ir_tensor;
+    const void* data; /* in the model memory */
+};
+
+/* permute the data of const tensor from nhwc to nchw */
+static int permute_tensor_data(void* mem, void* permute_arg)
+{
+    struct permute_arg* arg = ( struct permute_arg* )permute_arg;
+    struct ir_tensor* ir_tensor = arg->ir_tensor;
+
+    int type = ir_tensor->data_type;
+
+    if (type == TENGINE_DT_FP32)
+    {
+        const float* original_date = ( const float* )arg->data;
+
+        int dims[4];
+        dims[0] = ir_tensor->dims[0];
+        dims[1] = ir_tensor->dims[1];
+        dims[2] = ir_tensor->dims[2];
+        dims[3] = ir_tensor->dims[3];
+
+        /* nhwc to nchw */
+        //                    fprintf(stderr, "%s:\n", ir_tensor->name);
+        //                    fprintf(stderr, "original %d, %d, %d, %d\n", dims_org[0], dims_org[1], dims_org[2],
+        //                    dims_org[3]); fprintf(stderr, "permute  %d, %d, %d, %d\n", dims[0], dims[1], dims[2],
+        //                    dims[3]);
+
+        const float* input = original_date;
+        float* output = ( float* )mem;
+
+        int cout = dims[0];
+        int cin = dims[1];
+        int h = dims[2];
+        int w = dims[3];
+
+        if (cin == 1)
+        {
+            for (int co = 0; co < cout; co++)
+            {
+                for (int hi = 0; hi < h; hi++)
+                {
+                    for (int wi = 0; wi < w; wi++)
+                    {
+                        int offset_org = 0;
+                        offset_org += co;
+                        offset_org += hi * w * cout;
+                        offset_org += wi * cout;
+
+                        int offset = 0;
+                        offset += co * h * w;
+                        offset += hi * w;
+                        offset += wi;
+
+                        output[offset] = input[offset_org];
+                    }
+                }
+            }
+        }
+        else
+        {
+            for (int co = 0; co < cout; co++)
+            {
+                for (int ci = 0; ci < cin; ci++)
+                {
+                    for (int hi = 0; hi < h; hi++)
+                    {
+                        for (int wi = 0; wi < w; wi++)
+                        {
+                            int offset_org = 0;
+                            offset_org += co * cin * h * w;
+                            offset_org += ci;
+                            offset_org += hi * w * cin;
+                            offset_org += wi * cin;
+
+                            int offset = 0;
+                            offset += co * cin * h * w;
+                            offset += ci * h * w;
+                            offset += hi * w;
+                            offset += wi;
+
+                            output[offset] = input[offset_org];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    if (type == TENGINE_DT_UINT8 || type == TENGINE_DT_INT8)
+    {
+        const unsigned char* original_date = ( const unsigned char* )arg->data;
+
+        int dims[4];
+        dims[0] = ir_tensor->dims[0];
+        dims[1] = ir_tensor->dims[1];
+        dims[2] = ir_tensor->dims[2];
+        dims[3] = ir_tensor->dims[3];
+
+        /* nhwc to nchw */
+        // fprintf(stderr, "%s:\n", ir_tensor->name);
+        // fprintf(stderr, "original %d, %d, %d, %d\n", dims_org[0], dims_org[1], dims_org[2], dims_org[3]);
+        // fprintf(stderr, "permute  %d, %d, %d, %d\n", dims[0], dims[1], dims[2], dims[3]);
+
+        const unsigned char* input = original_date;
+        unsigned char* output = ( unsigned char* )mem;
+
+        int cout = dims[0];
+        int cin = dims[1];
+        int h = dims[2];
+        int w = dims[3];
+
+        if (cin == 1)
+        {
+            for (int co = 0; co < cout; co++)
+            {
+                for (int hi = 0; hi < h; hi++)
+                {
+                    for (int wi = 0; wi < w; wi++)
+                    {
+                        int offset_org = 0;
+                        offset_org += co;
+                        offset_org += hi * w * cout;
+                        offset_org += wi * cout;
+
+                        int offset = 0;
+                        offset += co * h * w;
+                        offset += hi * w;
+                        offset += wi;
+
+                        output[offset] = input[offset_org];
+                    }
+                }
+            }
+        }
+        else
+        {
+            for (int co = 0; co < cout; co++)
+            {
+                for (int ci = 0; ci < cin; ci++)
+                {
+                    for (int hi = 0; hi < h; hi++)
+                    {
+                        for (int wi = 0; wi < w; wi++)
+                        {
+                            int offset_org = 0;
+                            offset_org += co * cin * h * w;
+                            offset_org += ci;
+                            offset_org += hi * w * cin;
+                            offset_org += wi * cin;
+
+                            int offset = 0;
+                            offset += co * cin * h * w;
+                            offset += ci * h * w;
+                            offset += hi * w;
+                            offset += wi;
+
+                            output[offset] = input[offset_org];
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /* other types are kept as they are */
+    if (type != TENGINE_DT_FP32 && type != TENGINE_DT_UINT8 && type != TENGINE_DT_INT8)
+        memcpy(mem, arg->data, ir_tensor->elem_num * ir_tensor->elem_size);
+
+    return 0;
+}
+
 static int load_graph_tensors(struct tm2_serializer* tm2_s, struct ir_graph* graph, struct tm2_priv* priv)
 {
     char* mem_base = ( char* )priv->base;
@@ -245,180 +475,24 @@ static int load_graph_tensors(struct tm2_serializer* tm2_s, struct ir_graph* gra
                     return -1;
                 }
 
-                /* permute the data of tensor from nhwc to nchw */
+                /* permute the data of tensor from nhwc to nchw, shared by the graphs loaded from the model */
                 if (flag_permute)
                 {
-                    int size = ir_tensor->elem_num;
-                    int type = ir_tensor->data_type;
-
-                    if (type == TENGINE_DT_FP32)
-                    {
-                        float* tensor_data_org = ( float* )sys_malloc(size * sizeof(float));
-                        float* original_date = ir_tensor->data;
-
-                        for (int n = 0; n < size; n++)
-                        {
-                            tensor_data_org[n] = original_date[n];
-                        }
-
-                        int dims[4];
-                        dims[0] = ir_tensor->dims[0];
-                        dims[1] = ir_tensor->dims[1];
-                        dims[2] = ir_tensor->dims[2];
-                        dims[3] = ir_tensor->dims[3];
-
-                        /* nhwc to nchw */
-                        //                    fprintf(stderr, "%s:\n", ir_tensor->name);
-                        //                    fprintf(stderr, "original %d, %d, %d, %d\n", dims_org[0], dims_org[1], dims_org[2],
-                        //                    dims_org[3]); fprintf(stderr, "permute  %d, %d, %d, %d\n", dims[0], dims[1], dims[2],
-                        //                    dims[3]);
-
-                        float* input = tensor_data_org;
-                        float* output = ir_tensor->data;
+                    struct permute_arg arg;
 
-                        int cout = dims[0];
-                        int cin = dims[1];
-                        int h = dims[2];
-                        int w = dims[3];
+                    arg.ir_tensor = ir_tensor;
+                    arg.data = ir_tensor->data;
 
-                        if (cin == 1)
-                        {
-                            for (int co = 0; co < cout; co++)
-                            {
-                                for (int hi = 0; hi < h; hi++)
-                                {
-                                    for (int wi = 0; wi < w; wi++)
-                                    {
-                                        int offset_org = 0;
-                                        offset_org += co;
-                                        offset_org += hi * w * cout;
-                                        offset_org += wi * cout;
-
-                                        int offset = 0;
-                                        offset += co * h * w;
-                                        offset += hi * w;
-                                        offset += wi;
-
-                                        output[offset] = input[offset_org];
-                                    }
-                                }
-                            }
-                        }
-                        else
-                        {
-                            for (int co = 0; co < cout; co++)
-                            {
-                                for (int ci = 0; ci < cin; ci++)
-                                {
-                                    for (int hi = 0; hi < h; hi++)
-                                    {
-                                        for (int wi = 0; wi < w; wi++)
-                                        {
-                                            int offset_org = 0;
-                                            offset_org += co * cin * h * w;
-                                            offset_org += ci;
-                                            offset_org += hi * w * cin;
-                                            offset_org += wi * cin;
-
-                                            int offset = 0;
-                                            offset += co * cin * h * w;
-                                            offset += ci * h * w;
-                                            offset += hi * w;
-                                            offset += wi;
-
-                                            output[offset] = input[offset_org];
-                                        }
-                                    }
-                                }
-                            }
-                        }
+                    void* mem = get_shared_weight(graph->model_key, i, WEIGHT_CACHE_RAW,
+                                                  ir_tensor->elem_num * ir_tensor->elem_size, permute_tensor_data, &arg);
 
-                        sys_free(tensor_data_org);
-                    }
-
-                    if (type == TENGINE_DT_UINT8 || type == TENGINE_DT_INT8)
+                    if (mem == NULL || push_vector_data(priv->shared_list, &mem) < 0)
                     {
-                        unsigned char* tensor_data_org = ( unsigned char* )sys_malloc(size * sizeof(unsigned char));
-                        unsigned char* original_date = ir_tensor->data;
-
-                        for (int n = 0; n < size; n++)
-                        {
-                            tensor_data_org[n] = original_date[n];
-                        }
-
-                        int dims[4];
-                        dims[0] = ir_tensor->dims[0];
-                        dims[1] = ir_tensor->dims[1];
-                        dims[2] = ir_tensor->dims[2];
-                        dims[3] = ir_tensor->dims[3];
-
-                        /* nhwc to nchw */
-                        // fprintf(stderr, "%s:\n", ir_tensor->name);
-                        // fprintf(stderr, "original %d, %d, %d, %d\n", dims_org[0], dims_org[1], dims_org[2], dims_org[3]);
-                        // fprintf(stderr, "permute  %d, %d, %d, %d\n", dims[0], dims[1], dims[2], dims[3]);
-
-                        unsigned char* input = tensor_data_org;
-                        unsigned char* output = ir_tensor->data;
-
-                        int cout = dims[0];
-                        int cin = dims[1];
-                        int h = dims[2];
-                        int w = dims[3];
-
-                        if (cin == 1)
-                        {
-                            for (int co = 0; co < cout; co++)
-                            {
-                                for (int hi = 0; hi < h; hi++)
-                                {
-                                    for (int wi = 0; wi < w; wi++)
-                                    {
-                                        int offset_org = 0;
-                                        offset_org += co;
-                                        offset_org += hi * w * cout;
-                                        offset_org += wi * cout;
-
-                                        int offset = 0;
-                                        offset += co * h * w;
-                                        offset += hi * w;
-                                        offset += wi;
-
-                                        output[offset] = input[offset_org];
-                                    }
-                                }
-                            }
-                        }
-                        else
-                        {
-                            for (int co = 0; co < cout; co++)
-                            {
-                                for (int ci = 0; ci < cin; ci++)
-                                {
-                                    for (int hi = 0; hi < h; hi++)
-                                    {
-                                        for (int wi = 0; wi < w; wi++)
-                                        {
-                                            int offset_org = 0;
-                                            offset_org += co * cin * h * w;
-                                            offset_org += ci;
-                                            offset_org += hi * w * cin;
-                                            offset_org += wi * cin;
-
-                                            int offset = 0;
-                                            offset += co * cin * h * w;
-                                            offset += ci * h * w;
-                                            offset += hi * w;
-                                            offset += wi;
-
-                                            output[offset] = input[offset_org];
-                                        }
-                                    }
-                                }
-                            }
-                        }
-
-                        sys_free(tensor_data_org);
+                        TLOG_ERR("serializer: failed to permute tensor %s\n", ir_tensor->name);
+                        return -1;
                     }
+
+                    ir_tensor->data = mem;
                 }
             }
         }
@@ -789,6 +863,61 @@ error:
     return -1;
 }
 
+struct file_arg
+{
+    int fd;
+    int file_len;
+};
+
+static int read_model_file(void* mem, void* file_arg)
+{
+    struct file_arg* arg = ( struct file_arg* )file_arg;
+    int read_len = 0;
+
+    while (read_len < arg->file_len)
+    {
+        int ret = read(arg->fd, ( char* )mem + read_len, arg->file_len - read_len);
+
+        if (ret <= 0)
+        {
+            TLOG_ERR("serializer: failed to read model, errno: %d\n", errno);
+            set_tengine_errno(EIO);
+            return -1;
+        }
+
+        read_len += ret;
+    }
+
+    return 0;
+}
+
+/* the whole file in memory: mapped, so that the const tensors share the page cache
+   with the other graphs and processes loading the same model, or read once in the process as fallback */
+static void* load_file_mem(int fd, int file_len, const char* model_key, int* mem_type)
+{
+    /* private and writable: a page modified in place is copied, the others stay shared */
+    void* mem_base = mmap(NULL, file_len, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+    if (mem_base != MAP_FAILED)
+    {
+        *mem_type = TM2_MEM_MAPPED;
+        return mem_base;
+    }
+
+    TLOG_DEBUG("serializer: mmap failed, errno: %d, read the model instead\n", errno);
+
+    struct file_arg arg;
+
+    arg.fd = fd;
+    arg.file_len = file_len;
+
+    mem_base = get_shared_weight(model_key, -1, WEIGHT_CACHE_FILE, file_len, read_model_file, &arg);
+
+    *mem_type = TM2_MEM_SHARED;
+
+    return mem_base;
+}
+
 static int load_model(struct serializer* s, struct ir_graph* graph, const char* fname, va_list ap)
 {
     struct stat stat;
@@ -802,32 +931,54 @@ static int load_model(struct serializer* s, struct ir_graph* graph, const char*
         return -1;
     }
 
-    fstat(fd, &stat);
+    if (fstat(fd, &stat) < 0 || stat.st_size <= 0)
+    {
+        set_tengine_errno(EINVAL);
+        TLOG_ERR("cannot get the size of file %s\n", fname);
+        close(fd);
+        return -1;
+    }
 
     int file_len = stat.st_size;
+    int mem_type;
+    char model_key[128];
 
-    //    void* mem_base = mmap(NULL, file_len, PROT_READ, MAP_PRIVATE, fd, 0);
-    //
-    //    if(mem_base == MAP_FAILED)
-    //    {
-    //        set_tengine_errno(errno);
-    //        close(fd);
-    //        return -1;
-    //    }
+    /* the same file, even by another path, while not modified. a file rewritten within the same second
+       keeps st_mtime, so the nanoseconds are a part of the key too */
+#ifdef __APPLE__
+    long mtime_nsec = ( long )stat.st_mtimespec.tv_nsec;
+#else
+    long mtime_nsec = ( long )stat.st_mtim.tv_nsec;
+#endif
 
-    void* mem_base = ( void* )sys_malloc(file_len);
-    int ret = read(fd, mem_base, file_len);
+    snprintf(model_key, sizeof(model_key), "file:%lu:%lu:%ld:%ld.%09ld", ( unsigned long )stat.st_dev,
+             ( unsigned long )stat.st_ino, ( long )stat.st_size, ( long )stat.st_mtime, mtime_nsec);
+
+    void* mem_base = load_file_mem(fd, file_len, model_key, &mem_type);
+
+    /* the mapping does not need the file descriptor */
+    close(fd);
+
+    if (mem_base == NULL)
+        return -1;
 
     struct tm2_priv* priv = ( struct tm2_priv* )sys_malloc(sizeof(struct tm2_priv));
 
     if (priv == NULL)
     {
         set_tengine_errno(ENOMEM);
-        close(fd);
+
+        if (mem_type == TM2_MEM_MAPPED)
+            munmap(mem_base, file_len);
+        else
+            put_shared_weight(mem_base);
+
         return -1;
     }
 
-    priv->fd = fd;
+    priv->fd = -1;
+    priv->mem_type = mem_type;
+    priv->shared_list = create_vector(sizeof(void*), NULL);
     priv->mem_len = file_len;
     priv->base = mem_base;
     priv->header = get_tm_file_header(mem_base);
@@ -837,6 +988,14 @@ static int load_model(struct serializer* s, struct ir_graph* graph, const char*
     graph->serializer = s;
     graph->serializer_priv = priv;
     graph->dev_priv = NULL;
+    graph->model_key = strdup(model_key);
+
+    if (priv->shared_list == NULL || graph->model_key == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        unload_graph(s, graph, priv, NULL);
+        return -1;
+    }
 
     return load_graph(s, graph, priv);
 }
@@ -851,7 +1010,14 @@ static int load_mem(struct serializer* s, struct ir_graph* graph, const void* ad
         return -1;
     }
 
+    char model_key[64];
+
+    /* the same buffer loaded again */
+    snprintf(model_key, sizeof(model_key), "mem:%p:%d", addr, size);
+
     priv->fd = -1;
+    priv->mem_type = TM2_MEM_EXTERNAL;
+    priv->shared_list = create_vector(sizeof(void*), NULL);
     priv->mem_len = size;
     priv->base = addr;
     priv->header = get_tm_file_header(addr);
@@ -861,25 +1027,513 @@ static int load_mem(struct serializer* s, struct ir_graph* graph, const void* ad
     graph->serializer = s;
     graph->serializer_priv = priv;
     graph->dev_priv = NULL;
+    graph->model_key = strdup(model_key);
+
+    if (priv->shared_list == NULL || graph->model_key == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        unload_graph(s, graph, priv, NULL);
+        return -1;
+    }
 
     return load_graph(s, graph, priv);
 }
 
+tm_uoffset_t tm2_write_object(struct tm2_writer* w, const void* buf, int size)
+{
+    tm_uoffset_t offset = w->size;
+    int new_size = w->size + ((size + 3) & ~3);
+
+    if (w->error)
+        return TM2_NOT_SET;
+
+    if (new_size > w->capacity)
+    {
+        int capacity = w->capacity * 2;
+
+        if (capacity < new_size)
+            capacity = new_size;
+
+        char* p = ( char* )sys_realloc(w->base, capacity);
+
+        if (p == NULL)
+        {
+            w->error = 1;
+            return TM2_NOT_SET;
+        }
+
+        w->base = p;
+        w->capacity = capacity;
+    }
+
+    /* the object is 4 bytes aligned, a NULL buf leaves it zeroed */
+    memset(w->base + w->size, 0, new_size - w->size);
+
+    if (buf != NULL)
+        memcpy(w->base + w->size, buf, size);
+
+    w->size = new_size;
+
+    return offset;
+}
+
+tm_uoffset_t tm2_write_vector(struct tm2_writer* w, const void* data, int elem_num)
+{
+    /* the elements of all tm2 vectors are 4 bytes */
+    tm_size_t v_num = elem_num;
+    tm_uoffset_t offset = tm2_write_object(w, &v_num, sizeof(tm_size_t));
+
+    if (elem_num > 0)
+        tm2_write_object(w, data, elem_num * 4);
+
+    return offset;
+}
+
+/* the params keep some lists in struct vector, the leading 4 bytes of each element are written */
+tm_uoffset_t tm2_write_ir_vector(struct tm2_writer* w, struct vector* v)
+{
+    if (v == NULL)
+        return TM2_NOT_SET;
+
+    int num = get_vector_num(v);
+    uint32_t* data = ( uint32_t* )sys_malloc(sizeof(uint32_t) * (num + 1));
+
+    if (data == NULL)
+    {
+        w->error = 1;
+        return TM2_NOT_SET;
+    }
+
+    for (int i = 0; i < num; i++)
+        memcpy(&data[i], get_vector_data(v, i), sizeof(uint32_t));
+
+    tm_uoffset_t offset = tm2_write_vector(w, data, num);
+
+    sys_free(data);
+
+    return offset;
+}
+
+static tm_uoffset_t write_string(struct tm2_writer* w, const char* str)
+{
+    if (str == NULL)
+        return TM2_NOT_SET;
+
+    TM2_String tm_str;
+
+    tm_str.size = strlen(str);
+    tm_str.offset_data = tm2_write_object(w, str, tm_str.size);
+
+    return tm2_write_object(w, &tm_str, sizeof(TM2_String));
+}
+
+/* the indices are renumbered by map, if not NULL */
+static tm_uoffset_t write_tensor_indices(struct tm2_writer* w, const int16_t* tensors, int num, const int* map)
+{
+    if (num == 0)
+        return TM2_NOT_SET;
+
+    uint32_t* indices = ( uint32_t* )sys_malloc(sizeof(uint32_t) * num);
+
+    if (indices == NULL)
+    {
+        w->error = 1;
+        return TM2_NOT_SET;
+    }
+
+    for (int i = 0; i < num; i++)
+        indices[i] = map ? map[tensors[i]] : tensors[i];
+
+    tm_uoffset_t offset = tm2_write_vector(w, indices, num);
+
+    sys_free(indices);
+
+    return offset;
+}
+
+static tm_uoffset_t write_quant_params(struct tm2_writer* w, struct ir_tensor* ir_tensor)
+{
+    int num = ir_tensor->quant_param_num;
+
+    if (num == 0)
+        return TM2_NOT_SET;
+
+    tm_uoffset_t* offsets = ( tm_uoffset_t* )sys_malloc(sizeof(tm_uoffset_t) * num);
+
+    if (offsets == NULL)
+    {
+        w->error = 1;
+        return TM2_NOT_SET;
+    }
+
+    for (int i = 0; i < num; i++)
+    {
+        TM2_QuantParam tm_qtparam;
+
+        tm_qtparam.width = ir_tensor->elem_size * 8;
+
+        if (num == 1)
+        {
+            tm_qtparam.scale = ir_tensor->scale;
+            tm_qtparam.zero_point = ir_tensor->zero_point;
+        }
+        else
+        {
+            tm_qtparam.scale = ir_tensor->scale_list[i];
+            tm_qtparam.zero_point = ir_tensor->zp_list[i];
+        }
+
+        offsets[i] = tm2_write_object(w, &tm_qtparam, sizeof(TM2_QuantParam));
+    }
+
+    tm_uoffset_t offset = tm2_write_vector(w, offsets, num);
+
+    sys_free(offsets);
+
+    return offset;
+}
+
+/* the reorder nodes of the blocked layout are inserted in prerun for the cpu kernels, and are not saved.
+   their consumers read the tensors before them, so the graph is saved in the nchw form */
+struct save_map
+{
+    int* tensor_map; /* the saved index, that of the tensor before the reorders */
+    int* node_map; /* the saved index, or -1 */
+    int tensor_num;
+    int node_num;
+};
+
+static int is_dropped_tensor(struct ir_graph* ir_graph, struct ir_tensor* ir_tensor)
+{
+    return ir_tensor->producer >= 0 && get_ir_graph_node(ir_graph, ir_tensor->producer)->op.op_type == OP_REORDER;
+}
+
+static int create_save_map(struct ir_graph* ir_graph, struct save_map* map)
+{
+    map->tensor_map = ( int* )sys_malloc(sizeof(int) * (ir_graph->tensor_num + 1));
+    map->node_map = ( int* )sys_malloc(sizeof(int) * (ir_graph->node_num + 1));
+    map->tensor_num = 0;
+    map->node_num = 0;
+
+    if (map->tensor_map == NULL || map->node_map == NULL)
+    {
+        sys_free(map->tensor_map);
+        sys_free(map->node_map);
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    for (int i = 0; i < ir_graph->node_num; i++)
+    {
+        struct ir_node* ir_node = get_ir_graph_node(ir_graph, i);
+
+        map->node_map[i] = ir_node->op.op_type == OP_REORDER ? -1 : map->node_num++;
+    }
+
+    for (int i = 0; i < ir_graph->tensor_num; i++)
+    {
+        if (!is_dropped_tensor(ir_graph, get_ir_graph_tensor(ir_graph, i)))
+            map->tensor_map[i] = map->tensor_num++;
+    }
+
+    for (int i = 0; i < ir_graph->tensor_num; i++)
+    {
+        struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, i);
+
+        while (is_dropped_tensor(ir_graph, ir_tensor))
+        {
+            struct ir_node* reorder = get_ir_graph_node(ir_graph, ir_tensor->producer);
+
+            ir_tensor = get_ir_graph_tensor(ir_graph, reorder->input_tensors[0]);
+        }
+
+        map->tensor_map[i] = map->tensor_map[ir_tensor->idx];
+    }
+
+    return 0;
+}
+
+static void release_save_map(struct save_map* map)
+{
+    sys_free(map->tensor_map);
+    sys_free(map->node_map);
+}
+
+static int save_graph_tensors(struct tm2_writer* w, struct ir_graph* ir_graph, struct save_map* map,
+                              TM2_Subgraph* tm_graph)
+{
+    int tensor_num = ir_graph->tensor_num;
+    int buffer_num = 0;
+
+    tm_uoffset_t* tensor_offsets = ( tm_uoffset_t* )sys_malloc(sizeof(tm_uoffset_t) * (tensor_num + 1));
+    tm_uoffset_t* buffer_offsets = ( tm_uoffset_t* )sys_malloc(sizeof(tm_uoffset_t) * (tensor_num + 1));
+
+    if (tensor_offsets == NULL || buffer_offsets == NULL)
+    {
+        sys_free(tensor_offsets);
+        sys_free(buffer_offsets);
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    for (int i = 0; i < tensor_num; i++)
+    {
+        struct ir_tensor* ir_tensor = get_ir_graph_tensor(ir_graph, i);
+        TM2_Tensor tm_tensor;
+
+        if (is_dropped_tensor(ir_graph, ir_tensor))
+            continue;
+
+        memset(&tm_tensor, 0, sizeof(TM2_Tensor));
+
+        tm_tensor.tensor_id = map->tensor_map[i];
+        tm_tensor.layout = ir_tensor->layout == TENGINE_LAYOUT_NCHW8 ? TENGINE_LAYOUT_NCHW : ir_tensor->layout;
+        tm_tensor.type = ir_tensor->tensor_type;
+        tm_tensor.data_type = ir_tensor->data_type;
+
+        if (ir_tensor->dim_num > 0)
+            tm_tensor.offset_vd_dims = tm2_write_vector(w, ir_tensor->dims, ir_tensor->dim_num);
+
+        tm_tensor.offset_s_tname = write_string(w, ir_tensor->name);
+        tm_tensor.offect_vo_quantparams = write_quant_params(w, ir_tensor);
+
+        /* const tensors without data are zero filled when loaded */
+        if (ir_tensor->tensor_type == TENSOR_TYPE_CONST)
+        {
+            TM2_Buffer tm_buf;
+
+            tm_buf.size = ir_tensor->elem_num * ir_tensor->elem_size;
+            tm_buf.offset_data = TM2_NOT_SET;
+
+            if (ir_tensor->data != NULL)
+                tm_buf.offset_data = tm2_write_object(w, ir_tensor->data, tm_buf.size);
+
+            tm_tensor.buffer_id = buffer_num;
+            buffer_offsets[buffer_num++] = tm2_write_object(w, &tm_buf, sizeof(TM2_Buffer));
+        }
+
+        tensor_offsets[map->tensor_map[i]] = tm2_write_object(w, &tm_tensor, sizeof(TM2_Tensor));
+    }
+
+    tm_graph->offset_vo_tensors = tm2_write_vector(w, tensor_offsets, map->tensor_num);
+    tm_graph->offset_vo_buffers = tm2_write_vector(w, buffer_offsets, buffer_num);
+
+    sys_free(tensor_offsets);
+    sys_free(buffer_offsets);
+
+    return 0;
+}
+
+static int save_graph_nodes(struct tm2_serializer* tm2_s, struct tm2_writer* w, struct ir_graph* ir_graph,
+                            struct save_map* map, TM2_Subgraph* tm_graph)
+{
+    int node_num = ir_graph->node_num;
+    tm_uoffset_t* node_offsets = ( tm_uoffset_t* )sys_malloc(sizeof(tm_uoffset_t) * (node_num + 1));
+
+    if (node_offsets == NULL)
+    {
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    for (int i = 0; i < node_num; i++)
+    {
+        struct ir_node* ir_node = get_ir_graph_node(ir_graph, i);
+
+        if (map->node_map[i] < 0)
+            continue;
+
+        struct op_loader_entry* e = find_op_saver(tm2_s, ir_node->op.op_type);
+
+        /* the ops with param can only be saved by their saver */
+        if (e == NULL || (e->saver == NULL && ir_node->op.param_size > 0))
+        {
+            TLOG_ERR("serializer: cannot find op saver for op: %s node: %s\n", get_op_name(ir_node->op.op_type),
+                     ir_node->name);
+            sys_free(node_offsets);
+            set_tengine_errno(ENOTSUP);
+            return -1;
+        }
+
+        TM2_Operator tm_operator;
+
+        tm_operator.op_ver = e->op_version;
+        tm_operator.operator_type = e->op_type;
+        tm_operator.offset_t_param = TM2_NOT_SET;
+
+        if (e->saver != NULL)
+            tm_operator.offset_t_param = e->saver(w, ir_graph, ir_node);
+
+        TM2_Node tm_node;
+
+        memset(&tm_node, 0, sizeof(TM2_Node));
+
+        tm_node.node_id = map->node_map[i];
+        tm_node.offset_vi_input_tensors =
+            write_tensor_indices(w, ir_node->input_tensors, ir_node->input_num, map->tensor_map);
+        tm_node.offset_vi_output_tensors =
+            write_tensor_indices(w, ir_node->output_tensors, ir_node->output_num, map->tensor_map);
+        tm_node.offset_t_operator = tm2_write_object(w, &tm_operator, sizeof(TM2_Operator));
+        tm_node.offset_s_nname = write_string(w, ir_node->name);
+        tm_node.offset_vo_attrs = TM2_NOT_SET;
+        tm_node.dynamic_shape = ir_node->dynamic_shape;
+
+        node_offsets[map->node_map[i]] = tm2_write_object(w, &tm_node, sizeof(TM2_Node));
+    }
+
+    tm_graph->offset_vo_seq_nodes = tm2_write_vector(w, node_offsets, map->node_num);
+
+    sys_free(node_offsets);
+
+    return 0;
+}
+
+static int write_model_file(const char* fname, const char* buf, int size)
+{
+    int fd = open(fname, O_WRONLY | O_CREAT | O_TRUNC, 0666);
+
+    if (fd < 0)
+    {
+        TLOG_ERR("cannot open file %s\n", fname);
+        set_tengine_errno(errno);
+        return -1;
+    }
+
+    int offset = 0;
+
+    while (offset < size)
+    {
+        int n = write(fd, buf + offset, size - offset);
+
+        if (n <= 0)
+        {
+            TLOG_ERR("write file %s failed\n", fname);
+            set_tengine_errno(EIO);
+            close(fd);
+            return -1;
+        }
+
+        offset += n;
+    }
+
+    if (close(fd) < 0)
+    {
+        set_tengine_errno(EIO);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int save_model(struct serializer* s, struct ir_graph* graph, const char* fname, va_list ap)
+{
+    struct tm2_serializer* tm2_s = ( struct tm2_serializer* )s;
+
+    /* the params and data of nhwc models are permuted when loaded, and reshape still depends on model_layout */
+    if (graph->model_layout != TENGINE_LAYOUT_NCHW || graph->graph_layout != TENGINE_LAYOUT_NCHW)
+    {
+        TLOG_ERR("serializer: only nchw graph can be saved\n");
+        set_tengine_errno(ENOTSUP);
+        return -1;
+    }
+
+    struct save_map map;
+
+    if (create_save_map(graph, &map) < 0)
+        return -1;
+
+    struct tm2_writer w;
+
+    w.base = NULL;
+    w.size = 0;
+    w.capacity = 0;
+    w.error = 0;
+
+    /* header first, offset_root is filled at last */
+    tm2_write_object(&w, NULL, sizeof(TM2_Header));
+
+    TM2_Subgraph tm_graph;
+
+    memset(&tm_graph, 0, sizeof(TM2_Subgraph));
+
+    tm_graph.subgraph_id = 0;
+    tm_graph.graph_layout = graph->graph_layout;
+    tm_graph.model_layout = graph->model_layout;
+    tm_graph.offset_vi_input_indices = write_tensor_indices(&w, graph->input_nodes, graph->input_num, map.node_map);
+    tm_graph.offset_vi_output_indices =
+        write_tensor_indices(&w, graph->output_nodes, graph->output_num, map.node_map);
+    tm_graph.offset_s_sname = TM2_NOT_SET;
+
+    int ret = save_graph_tensors(&w, graph, &map, &tm_graph);
+
+    if (ret == 0)
+        ret = save_graph_nodes(tm2_s, &w, graph, &map, &tm_graph);
+
+    release_save_map(&map);
+
+    if (ret < 0)
+    {
+        sys_free(w.base);
+        return -1;
+    }
+
+    tm_uoffset_t offset_subgraph = tm2_write_object(&w, &tm_graph, sizeof(TM2_Subgraph));
+
+    TM2_Model tm_model;
+
+    tm_model.orig_format = graph->model_format;
+    tm_model.sub_format = 0;
+    tm_model.offset_vo_subgraphs = tm2_write_vector(&w, &offset_subgraph, 1);
+    tm_model.offset_s_mname = TM2_NOT_SET;
+
+    TM2_Header header;
+
+    memset(&header, 0, sizeof(TM2_Header));
+
+    header.ver_main = TM2_FILE_VER_MAIN;
+    header.ver_sub = TM2_FILE_VER_SUB;
+    header.ver_compile = TM2_FILE_VER_COMPILE;
+    header.offset_root = tm2_write_object(&w, &tm_model, sizeof(TM2_Model));
+
+    if (w.error)
+    {
+        sys_free(w.base);
+        set_tengine_errno(ENOMEM);
+        return -1;
+    }
+
+    memcpy(w.base, &header, sizeof(TM2_Header));
+
+    ret = write_model_file(fname, w.base, w.size);
+
+    sys_free(w.base);
+
+    return ret;
+}
+
 static int unload_graph(struct serializer* s, struct ir_graph* graph, void* s_priv, void* dev_priv)
 {
     struct tm2_priv* priv = ( struct tm2_priv* )s_priv;
 
-    if (priv->base)
-        sys_free(( void* )priv->base);
+    /* the const tensors point into the model memory, the buffer given to load_mem is the caller's */
+    if (priv->mem_type == TM2_MEM_MAPPED)
+        munmap(( void* )priv->base, priv->mem_len);
+    else if (priv->mem_type == TM2_MEM_SHARED)
+        put_shared_weight(( void* )priv->base);
+
+    if (priv->shared_list)
+    {
+        for (int i = 0; i < get_vector_num(priv->shared_list); i++)
+            put_shared_weight(*( void** )get_vector_data(priv->shared_list, i));
+
+        release_vector(priv->shared_list);
+    }
 
     graph->serializer = NULL;
     graph->serializer_priv = NULL;
 
     if (priv->fd >= 0)
-    {
-        munmap(( void* )priv->base, priv->mem_len);
         close(priv->fd);
-    }
 
     sys_free(priv);
 
@@ -906,6 +1560,22 @@ static int unregister_op_loader(struct serializer* s, int op_type, int op_ver, v
     return unregister_tm2_op_loader(tm2_s, op_type, op_ver, op_load);
 }
 
+static int register_op_saver(struct serializer* s, int op_type, int op_ver, void* op_save_func)
+{
+    struct tm2_serializer* tm2_s = ( struct tm2_serializer* )s;
+    tm2_op_saver_t op_save = op_save_func;
+
+    return register_tm2_op_saver(tm2_s, op_type, op_ver, op_save);
+}
+
+static int unregister_op_saver(struct serializer* s, int op_type, int op_ver, void* op_save_func)
+{
+    struct tm2_serializer* tm2_s = ( struct tm2_serializer* )s;
+    tm2_op_saver_t op_save = op_save_func;
+
+    return unregister_tm2_op_saver(tm2_s, op_type, op_ver, op_save);
+}
+
 static const char* get_name(struct serializer* s)
 {
     return tm2_name;
@@ -954,9 +1624,12 @@ static struct tm2_serializer tm2_serializer = {
             .get_name = get_name,
             .load_model = load_model,
             .load_mem = load_mem,
+            .save_model = save_model,
             .unload_graph = unload_graph,
             .register_op_loader = register_op_loader,
             .unregister_op_loader = unregister_op_loader,
+            .register_op_saver = register_op_saver,
+            .unregister_op_saver = unregister_op_saver,
             .init = init_tm2_serializer,
             .release = release_tm2_serializer,
         },
@@ -29,9 +29,16 @@
 
 #define NULL_TM2_OP_LOADER (( tm2_op_loader_t )0x1)
 
+/* where the model memory comes from */
+#define TM2_MEM_EXTERNAL 0 /* given by load_mem, not released */
+#define TM2_MEM_MAPPED 1 /* file mapping, the const tensors point into it */
+#define TM2_MEM_SHARED 2 /* file read into the weight cache, when mmap fails */
+
 struct tm2_priv
 {
     int fd; /* for file load */
+    int mem_type;
+    struct vector* shared_list; /* the weight cache entries used by the const tensors */
     int mem_len;
     const char* base; /* mem base for model */
     const TM2_Header* header; /* file header */
@@ -43,4 +50,20 @@ typedef int (*tm2_op_loader_t)(struct ir_graph*, struct ir_node*, const TM2_Node
 
 typedef int (*tm2_map_t)(int);
 
+/* the model being saved, objects are appended to the buffer */
+struct tm2_writer
+{
+    char* base;
+    int size;
+    int capacity;
+    int error;
+};
+
+/* returns the offset of the op param, or TM2_NOT_SET */
+typedef tm_uoffset_t (*tm2_op_saver_t)(struct tm2_writer*, struct ir_graph*, struct ir_node*);
+
+tm_uoffset_t tm2_write_object(struct tm2_writer* w, const void* buf, int size);
+tm_uoffset_t tm2_write_vector(struct tm2_writer* w, const void* data, int elem_num);
+tm_uoffset_t tm2_write_ir_vector(struct tm2_writer* w, struct vector* v);
+
 #endif